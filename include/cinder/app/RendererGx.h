@@ -28,6 +28,7 @@
 
 #include "cinder/graphics/platform.h"
 #include "cinder/graphics/wrapper.h"
+#include "cinder/graphics/ContextStateCache.h"
 
 namespace cinder { namespace app {
 
@@ -116,6 +117,10 @@ class CI_API RendererGx : public Renderer {
 	const std::vector<gx::DeviceContextRef>& getDeferredContexts() const { return mDeferredContexts; }
 	gx::DeviceContext*						 getDeferredContext( size_t index ) { return mDeferredContexts[index]; }
 	size_t									 getDeferredContextsCount() const { return mDeferredContexts.size(); }
+	//! Returns the ContextStateCache shadowing \a context, or nullptr if \a context isn't the immediate context or one of the deferred contexts. Pass it to the ContextStateCache* overloads to skip redundant binds.
+	gx::ContextStateCache*					 getContextStateCache( gx::DeviceContext* context );
+	//! Invalidates the ContextStateCache of every context
+	void									 invalidateContextStateCaches();
 
 	gx::EngineFactory*						 getEngineFactory() { return mEngineFactory; }
 	gx::ShaderSourceInputStreamFactory*		 getDefaultShaderSourceStreamFactory();
@@ -129,6 +134,7 @@ protected:
 	gx::RenderDeviceRef					mDevice;
 	gx::DeviceContextRef				mImmediateContext;
 	std::vector<gx::DeviceContextRef>	mDeferredContexts;
+	std::vector<std::shared_ptr<gx::ContextStateCache>>	mContextStateCaches;
 	gx::SwapChainRef					mSwapChain;
 	gx::GraphicsAdapterInfo				mAdapterAttribs;
 	std::vector<gx::DisplayModeAttribs>	mDisplayModes;
@@ -161,6 +167,8 @@ inline gx::IDeviceContext* getImmediateContext() { return std::static_pointer_ca
 inline const std::vector<gx::DeviceContextRef>& getDeferredContexts() { return std::static_pointer_cast<RendererGx>( app::App::get()->getRenderer() )->getDeferredContexts(); }
 inline gx::DeviceContext* getDeferredContext( size_t index ) { return std::static_pointer_cast<RendererGx>( app::App::get()->getRenderer() )->getDeferredContext( index ); }
 inline size_t getDeferredContextsCount() { return std::static_pointer_cast<RendererGx>( app::App::get()->getRenderer() )->getDeferredContextsCount(); }
+inline gx::ContextStateCache* getContextStateCache() { auto renderer = std::static_pointer_cast<RendererGx>( app::App::get()->getRenderer() ); return renderer->getContextStateCache( renderer->getImmediateContext() ); }
+inline gx::ContextStateCache* getContextStateCache( gx::DeviceContext* context ) { return std::static_pointer_cast<RendererGx>( app::App::get()->getRenderer() )->getContextStateCache( context ); }
 inline gx::ShaderSourceInputStreamFactory* getDefaultShaderSourceStreamFactory() { return std::static_pointer_cast<RendererGx>( app::App::get()->getRenderer() )->getDefaultShaderSourceStreamFactory(); }
 
 } } // namespace cinder::app
@@ -26,8 +26,12 @@
 #include "cinder/graphics/Mesh.h"
 #include "cinder/graphics/PipelineState.h"
 
+#include "cinder/Frustum.h"
+
 namespace cinder { namespace graphics {
 
+typedef std::shared_ptr<class GpuCulling> GpuCullingRef;
+
 //! A Batch is a collection of Meshes, the GraphicsPipeline used to render them and the ShaderResourceBinding object associated with it
 class Batch {
 public:
@@ -38,6 +42,14 @@ public:
 	Batch( const Mesh &mesh, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
 	Batch( const std::vector<Mesh> &meshes, const PipelineStateRef &pipelineState );
 	Batch( const std::vector<Mesh> &meshes, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
+	//! Creates a Batch drawn with drawInstanced(). The per-instance attributes of \a instanceLayout are read from the vertex buffer slot following the mesh buffers.
+	Batch( const Mesh &mesh, const Mesh::BufferInfo &instanceLayout, const PipelineStateRef &pipelineState );
+	//! Creates a Batch drawn with drawInstanced(). The per-instance attributes of \a instanceLayout are appended to the pipeline input layout when it is empty.
+	Batch( const Mesh &mesh, const Mesh::BufferInfo &instanceLayout, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
+	//! Creates a Batch drawn with drawInstanced(). The per-instance attributes of \a instanceLayout are read from the vertex buffer slot following the mesh buffers.
+	Batch( const std::vector<Mesh> &meshes, const Mesh::BufferInfo &instanceLayout, const PipelineStateRef &pipelineState );
+	//! Creates a Batch drawn with drawInstanced(). The per-instance attributes of \a instanceLayout are appended to the pipeline input layout when it is empty.
+	Batch( const std::vector<Mesh> &meshes, const Mesh::BufferInfo &instanceLayout, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
 
 	Batch( RenderDevice* device, const PipelineStateRef &pipelineState );
 	Batch( RenderDevice* device, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
@@ -45,6 +57,10 @@ public:
 	Batch( RenderDevice* device, const Mesh &mesh, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
 	Batch( RenderDevice* device, const std::vector<Mesh> &meshes, const PipelineStateRef &pipelineState );
 	Batch( RenderDevice* device, const std::vector<Mesh> &meshes, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
+	Batch( RenderDevice* device, const Mesh &mesh, const Mesh::BufferInfo &instanceLayout, const PipelineStateRef &pipelineState );
+	Batch( RenderDevice* device, const Mesh &mesh, const Mesh::BufferInfo &instanceLayout, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
+	Batch( RenderDevice* device, const std::vector<Mesh> &meshes, const Mesh::BufferInfo &instanceLayout, const PipelineStateRef &pipelineState );
+	Batch( RenderDevice* device, const std::vector<Mesh> &meshes, const Mesh::BufferInfo &instanceLayout, const GraphicsPipelineCreateInfo &pipelineCreateInfo );
 
 	//! Binds a static shader resource variable to Batch's ShaderResourceBinding object
 	void setStaticVariable( SHADER_TYPE shaderType, const char* name, IDeviceObject* pObject );
@@ -70,7 +86,10 @@ public:
 	//! Returns  shader resource variable by its index.
 	ShaderResourceVariable* getVariable( SHADER_TYPE shaderType, uint32_t index );
 
-	//! Returns the batch's shader resource binding object 
+	//! Binds the shader resource view of the vertex buffer at \a bufferIndex of each mesh to the \a name variable before drawing it, see Mesh::BufferInfo::vertexPulling(). The variable has to be dynamic unless every mesh shares the same vertex storage.
+	void setVertexPullingVariable( SHADER_TYPE shaderType, const char* name, size_t bufferIndex = 0 );
+
+	//! Returns the batch's shader resource binding object. Its resources are committed again by the next draw.
 	ShaderResourceBindingRef	getShaderResourceBinding();
 	//! Returns the batch's vector of meshes
 	const std::vector<Mesh>&	getMeshes() const { return mMeshes; }
@@ -79,13 +98,116 @@ public:
 
 	void draw();
 	void draw( DeviceContext* context );
+	//! Draws the batch on the DeviceContext shadowed by \a stateCache, skipping redundant binds
+	void draw( ContextStateCache* stateCache );
+	//! Draws each mesh at the lowest level of detail whose error projects to less than \a pixelError pixels, see Mesh::selectLod()
+	void draw( const mat4 &modelViewProjection, float viewportHeight, float pixelError = 1.0f );
+	//! Draws each mesh at the lowest level of detail whose error projects to less than \a pixelError pixels, see Mesh::selectLod()
+	void draw( DeviceContext* context, const mat4 &modelViewProjection, float viewportHeight, float pixelError = 1.0f );
+	//! Draws each mesh at the lowest level of detail whose error projects to less than \a pixelError pixels, see Mesh::selectLod()
+	void draw( ContextStateCache* stateCache, const mat4 &modelViewProjection, float viewportHeight, float pixelError = 1.0f );
+	//! Draws the meshes whose bounds intersect \a frustum, expressed in the object space of the meshes. Nothing is bound when every mesh is culled. Meshes without bounds are always drawn.
+	void draw( const Frustum &frustum );
+	//! Draws the meshes whose bounds intersect \a frustum, expressed in the object space of the meshes. Nothing is bound when every mesh is culled. Meshes without bounds are always drawn.
+	void draw( DeviceContext* context, const Frustum &frustum );
+	//! Draws the meshes whose bounds intersect \a frustum, expressed in the object space of the meshes. Nothing is bound when every mesh is culled. Meshes without bounds are always drawn.
+	void draw( ContextStateCache* stateCache, const Frustum &frustum );
+
+	//! Streams \a count instances to the instance ring buffer and draws every mesh once per instance. Splits into several draws when \a count exceeds the instance capacity. \a InstanceData must match the instance layout.
+	template<typename InstanceData>
+	void drawInstanced( const InstanceData* data, size_t count ) { drawInstanced( static_cast<const void*>( data ), sizeof( InstanceData ), count ); }
+	//! Streams \a count instances to the instance ring buffer and draws every mesh once per instance. Splits into several draws when \a count exceeds the instance capacity. \a InstanceData must match the instance layout.
+	template<typename InstanceData>
+	void drawInstanced( DeviceContext* context, const InstanceData* data, size_t count ) { drawInstanced( context, static_cast<const void*>( data ), sizeof( InstanceData ), count ); }
+	//! Streams \a count instances to the instance ring buffer and draws every mesh once per instance. Splits into several draws when \a count exceeds the instance capacity. \a InstanceData must match the instance layout.
+	template<typename InstanceData>
+	void drawInstanced( ContextStateCache* stateCache, const InstanceData* data, size_t count ) { drawInstanced( stateCache, static_cast<const void*>( data ), sizeof( InstanceData ), count ); }
+	//! Streams \a count instances of \a stride bytes to the instance ring buffer and draws every mesh once per instance
+	void drawInstanced( const void* data, uint32_t stride, size_t count );
+	//! Streams \a count instances of \a stride bytes to the instance ring buffer and draws every mesh once per instance
+	void drawInstanced( DeviceContext* context, const void* data, uint32_t stride, size_t count );
+	//! Streams \a count instances of \a stride bytes to the instance ring buffer and draws every mesh once per instance
+	void drawInstanced( ContextStateCache* stateCache, const void* data, uint32_t stride, size_t count );
+
+	//! Draws the objects of \a culling that passed the last GpuCulling::cull() with a single indirect draw. The Batch must be created with GpuCulling::getObjectIdLayout() as its instance layout and its first mesh must share the buffers of the culled objects.
+	void drawIndirect( const GpuCullingRef &culling );
+	//! Draws the objects of \a culling that passed the last GpuCulling::cull() with a single indirect draw
+	void drawIndirect( DeviceContext* context, const GpuCullingRef &culling );
+	//! Draws the objects of \a culling that passed the last GpuCulling::cull() with a single indirect draw
+	void drawIndirect( ContextStateCache* stateCache, const GpuCullingRef &culling );
+
+	//! Merges the meshes into a single Mesh drawn with one draw call. The meshes must share their vertex layout and a triangle or line list topology, and are read back from the GPU once. When \a transforms is not empty, the float positions, normals, tangents and bitangents of each mesh are transformed by its matrix. Only the full detail level is kept.
+	void bakeStatic( const std::vector<mat4> &transforms = {} );
+	//! Merges the meshes into a single Mesh drawn with one draw call, reading them back with \a context. The meshes must share their vertex layout and a triangle or line list topology.
+	void bakeStatic( DeviceContext* context, const std::vector<mat4> &transforms = {} );
+	//! Merges the meshes into a single Mesh drawn with one draw call and tags every vertex with the index of its mesh. The tags are a structured buffer of uint bound to the \a name variable with setVertexPullingVariable(), from which shaders read the mesh index with SV_VertexID to fetch per-mesh transforms.
+	void bakeStatic( SHADER_TYPE shaderType, const char* name );
+	//! Merges the meshes into a single Mesh drawn with one draw call and tags every vertex with the index of its mesh, reading them back with \a context
+	void bakeStatic( DeviceContext* context, SHADER_TYPE shaderType, const char* name );
+
+	//! Sets the number of instances the ring buffer holds per frame. Defaults to 4096.
+	void						setInstanceCapacity( uint32_t capacity );
+	//! Returns the number of instances the ring buffer holds per frame
+	uint32_t					getInstanceCapacity() const { return mInstanceCapacity; }
+	//! Returns the per-instance layout
+	const Mesh::BufferInfo&		getInstanceLayout() const { return mInstanceLayout; }
+
+	//! Merges meshes read back to the CPU the way bakeStatic() does. The vertices are appended and the 32-bit indices offset, non-indexed meshes get sequential indices when others are indexed. Each mesh is transformed by the matching entry of \a transforms unless it is empty. \a tagMeshIndices appends a vertex pulling buffer holding the mesh index of every vertex. The meshes must share their vertex layout.
+	static Mesh::SourceData		mergeSourceData( const std::vector<Mesh::SourceData> &meshes, const std::vector<mat4> &transforms = {}, bool tagMeshIndices = false );
+
+	//! Frustum planes stored as structure of arrays so that a box is tested against four planes at once. The two padding lanes repeat the first plane.
+	struct FrustumPlanes {
+		FrustumPlanes( const Frustum &frustum );
+
+		//! Returns false if \a box is entirely behind one of the planes, the planes pointing inside the frustum
+		bool	intersects( const AxisAlignedBox &box ) const;
+
+		alignas( 16 ) float nx[8];
+		alignas( 16 ) float ny[8];
+		alignas( 16 ) float nz[8];
+		alignas( 16 ) float ax[8];
+		alignas( 16 ) float ay[8];
+		alignas( 16 ) float az[8];
+		alignas( 16 ) float d[8];
+	};
 	
 protected:
+	//! Creates the ShaderResourceBinding if needed, without changing its revision
+	ShaderResourceBinding*		getOrCreateShaderResourceBinding();
+	//! Signals that the ShaderResourceBinding variables might have changed and need to be committed again
+	void						updateShaderResourceBindingRevision();
+	//! Commits the ShaderResourceBinding under a new revision. Only the meshes of a single draw share a commit.
+	void						commitShaderResources( ContextStateCache* stateCache );
+	//! Replaces the meshes with a single merged Mesh, returns false if the meshes can't be merged
+	bool						bakeMeshes( DeviceContext* context, const std::vector<mat4> &transforms, bool tagMeshIndices );
+	//! Binds the vertex pulling view of \a mesh and commits the ShaderResourceBinding again when it changed
+	void						commitVertexPulling( ContextStateCache* stateCache, const Mesh &mesh );
+	//! Copies \a count instances to the ring buffer, discarding it at the start of a frame or when full, and returns the location of the first one
+	uint32_t					streamInstances( DeviceContext* context, const void* data, uint32_t count );
+
+	//! Ring buffer shared by the copies of a Batch so that they never overwrite each other's instances
+	struct InstanceRing {
+		BufferRef	buffer;
+		uint32_t	offset = 0;
+		uint64_t	frameNumber = ~0ull;
+	};
+
 	RenderDevice*				mDevice;
 	std::vector<Mesh>			mMeshes;
 	PipelineStateRef			mPso;
 	ShaderResourceBindingRef	mSrb;
+	uint64_t					mSrbRevision = 0;
+	Mesh::BufferInfo			mInstanceLayout;
+	uint32_t					mInstanceStride = 0;
+	uint32_t					mInstanceSlot = 0;
+	uint32_t					mInstanceCapacity = 4096;
+	std::shared_ptr<InstanceRing>	mInstanceRing;
+	SHADER_TYPE					mVertexPullingShaderType = SHADER_TYPE_VERTEX;
+	std::string					mVertexPullingName;
+	size_t						mVertexPullingBufferIndex = 0;
+	BufferView*					mVertexPullingView = nullptr;
 	friend class Device;
+	friend class RenderQueue;
 };
 
 }
@@ -65,6 +65,11 @@ CI_API BufferRef createBuffer( const Diligent::BufferDesc &buffDesc, const Dilig
 //! Creates a new buffer object using the default RenderDevice
 CI_API BufferRef createBuffer( const Diligent::BufferDesc &buffDesc, const void* data, uint32_t dataSize );
 
+//! Copies \a size bytes of \a buffer starting at \a offset to a staging buffer and reads them back using the default RenderDevice and immediate context. A \a size of 0 reads to the end of the buffer. Waits for the GPU to be idle.
+CI_API std::vector<uint8_t> readBuffer( Buffer* buffer, uint32_t offset = 0, uint32_t size = 0 );
+//! Copies \a size bytes of \a buffer starting at \a offset to a staging buffer and reads them back using \a context. A \a size of 0 reads to the end of the buffer. Waits for the GPU to be idle.
+CI_API std::vector<uint8_t> readBuffer( RenderDevice* device, DeviceContext* context, Buffer* buffer, uint32_t offset = 0, uint32_t size = 0 );
+
 //! Buffer view description
 struct CI_API BufferViewDesc : public Diligent::BufferViewDesc {
     //! View type. See Diligent::BUFFER_VIEW_TYPE for details.
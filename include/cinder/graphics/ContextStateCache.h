@@ -0,0 +1,107 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/graphics/wrapper.h"
+
+namespace cinder { namespace graphics {
+
+//! Shadows the state bound to a DeviceContext to skip redundant PipelineState, ShaderResourceBinding, vertex and index buffer binds.
+//! Only the ContextStateCache* overloads bind through the cache, the DeviceContext* overloads and the gx:: wrappers bind directly on the context.
+//! The cache expects to see every bind issued to its context. Binding state any other way, including ImGui or raw Diligent calls, requires a call to invalidate().
+class CI_API ContextStateCache {
+public:
+	//! Counts the binds issued to the context and the ones skipped as redundant
+	struct Stats {
+		uint64_t pipelineStateBinds = 0;
+		uint64_t pipelineStateBindsSkipped = 0;
+		uint64_t shaderResourcesCommits = 0;
+		uint64_t shaderResourcesCommitsSkipped = 0;
+		uint64_t vertexBuffersBinds = 0;
+		uint64_t vertexBuffersBindsSkipped = 0;
+		uint64_t indexBufferBinds = 0;
+		uint64_t indexBufferBindsSkipped = 0;
+	};
+
+	//! Creates a cache shadowing \a context. A cache created with \a filterRedundantBinds false issues every bind.
+	ContextStateCache( DeviceContext* context, bool filterRedundantBinds = true );
+
+	//! Sets the pipeline state unless it is already bound. Binding a different pipeline state requires shader resources to be committed again.
+	void setPipelineState( PipelineState* pipelineState );
+	//! Commits shader resources unless \a shaderResourceBinding was already committed with the same \a revision since the last pipeline state change. \a revision should change every time the variables of \a shaderResourceBinding are modified. Resources referenced by a skipped commit are not transitioned again.
+	void commitShaderResources( ShaderResourceBinding* shaderResourceBinding, RESOURCE_STATE_TRANSITION_MODE stateTransitionMode, uint64_t revision = 0 );
+	//! Binds vertex buffers unless the same buffers are already bound at the same offsets.
+	void setVertexBuffers( uint32_t startSlot, uint32_t numBuffersSet, Buffer* const* ppBuffers, const uint64_t* pOffsets, RESOURCE_STATE_TRANSITION_MODE stateTransitionMode, SET_VERTEX_BUFFERS_FLAGS flags );
+	//! Binds an index buffer unless it is already bound at the same offset.
+	void setIndexBuffer( Buffer* indexBuffer, uint64_t byteOffset, RESOURCE_STATE_TRANSITION_MODE stateTransitionMode );
+
+	//! Forgets the whole shadowed state. Must be called after binding state directly on the context, executing or finishing command lists.
+	void invalidate();
+	//! Forgets the committed ShaderResourceBinding so that the next commit is always issued
+	void invalidateShaderResources();
+
+	//! Returns the DeviceContext shadowed by this cache
+	DeviceContext*	getContext() const { return mContext; }
+	//! Returns the number of issued and skipped binds since the last call to resetStats()
+	const Stats&	getStats() const { return mStats; }
+	//! Resets the bind counters
+	void			resetStats() { mStats = Stats(); }
+
+protected:
+	DeviceContext*				mContext;
+	bool						mFilterRedundantBinds;
+	PipelineStateRef			mPipelineState;
+	ShaderResourceBindingRef	mShaderResourceBinding;
+	uint64_t					mShaderResourceBindingRevision;
+	BufferRef					mVertexBuffers[MAX_BUFFER_SLOTS];
+	uint64_t					mVertexBufferOffsets[MAX_BUFFER_SLOTS];
+	uint32_t					mNumVertexBuffers;
+	BufferRef					mIndexBuffer;
+	uint64_t					mIndexBufferOffset;
+	Stats						mStats;
+};
+
+//! Wraps a DeviceContext in a temporary ContextStateCache that issues every bind, so that the DeviceContext* overloads share the code of the
+//! ContextStateCache* overloads while binding unconditionally. Redundant binds are only skipped when passing the cache returned by
+//! app::getContextStateCache(), or one owned by the caller, to the ContextStateCache* overloads.
+class CI_API ScopedContextStateCache {
+public:
+	explicit ScopedContextStateCache( DeviceContext* context );
+
+	ScopedContextStateCache( const ScopedContextStateCache &other ) = delete;
+	ScopedContextStateCache& operator=( const ScopedContextStateCache &other ) = delete;
+
+	//! Returns the temporary ContextStateCache, valid for the lifetime of this object
+	ContextStateCache*	get() { return &mCache; }
+	ContextStateCache*	operator->() { return &mCache; }
+	operator ContextStateCache*() { return &mCache; }
+
+protected:
+	ContextStateCache	mCache;
+};
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
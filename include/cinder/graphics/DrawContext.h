@@ -27,6 +27,7 @@
 #include "cinder/Camera.h"
 #include "cinder/GeomIo.h"
 #include "cinder/graphics/Buffer.h"
+#include "cinder/graphics/ContextStateCache.h"
 #include "cinder/graphics/PipelineState.h"
 
 #include <unordered_map>
@@ -41,6 +42,61 @@
 
 namespace cinder { namespace graphics {
 
+//! Re-submittable draw stream baked from a DrawContext. Owns immutable copies of the geometry and constants and a 
+//! compact list of pre-resolved draws, only the viewport and the stream transform can change between replays.
+class CI_API DrawStream {
+public:
+    DrawStream();
+
+    //! Replays the stream on the app default Immediate DeviceContext
+    void replay();
+    //! Replays the stream on \a context. The stream can be replayed any number of times and on any context.
+    void replay( DeviceContext* context );
+    //! Replays the stream through \a stateCache, skipping redundant binds.
+    void replay( ContextStateCache* stateCache );
+
+    //! Overrides the viewport of every draw in the stream based on a pair<vec2,vec2> representing the position of the lower-left corner and the size, respectively. Scissors that matched the baked viewport follow the new one.
+    void setViewport( const std::pair<vec2, vec2> &viewport );
+    //! Restores the viewports recorded when the stream was baked
+    void resetViewport();
+    //! Sets the transform applied after the baked model-view-projection transforms, in clip space. The transform is uploaded by every replay, the stream can be replayed on several contexts.
+    void setTransform( const mat4 &transform );
+    //! Returns the transform applied after the baked model-view-projection transforms
+    const mat4& getTransform() const { return mTransform; }
+
+    //! Returns whether the stream has any draws
+    bool    empty() const { return mDraws.empty(); }
+    //! Returns the number of draws in the stream
+    size_t  getNumDraws() const { return mDraws.size(); }
+
+protected:
+    struct Draw {
+        PipelineState*          pipeline;
+        ShaderResourceBinding*  srb;
+        vec4                    viewport;
+        ivec4                   scissor;
+        bool                    scissorFollowsViewport;
+        uint32_t                indexOffset;
+        uint32_t                indexCount;
+    };
+
+    BufferRef                               mVertexBuffer;
+    BufferRef                               mIndexBuffer;
+    BufferRef                               mConstantsBuffer;
+    BufferRef                               mStreamConstantsBuffer;
+    std::vector<PipelineStateRef>           mPipelines;
+    std::vector<ShaderResourceBindingRef>   mShaderResourceBindings;
+    std::vector<Draw>                       mDraws;
+    VALUE_TYPE                              mIndexType;
+
+    mat4    mTransform;
+    bool    mHasTransform;
+    vec4    mViewport;
+    bool    mViewportOverride;
+
+    friend class DrawContext;
+};
+
 class CI_API DrawContext {
 public:
     DrawContext();
@@ -65,13 +121,28 @@ public:
     void submit( bool flushAfterSubmit = true );
     //! Submits the current DrawContext on a a\ RenderDevice and \a DeviceContext
     void submit( RenderDevice* device, DeviceContext* context, bool flushAfterSubmit = true );
+    //! Submits the current DrawContext on \a device through \a stateCache, skipping redundant binds.
+    void submit( RenderDevice* device, ContextStateCache* stateCache, bool flushAfterSubmit = true );
     //! Bakes the current DrawContext into a CommandList, useful for submitting later or from a separate thread.
     gx::CommandListRef bake( DeviceContext* context );
     //! Bakes the current DrawContext into a CommandList, useful for submitting later or from a separate thread.
     gx::CommandListRef bake( RenderDevice* device, DeviceContext* context );
+    //! Bakes the current DrawContext into a DrawStream that can be replayed every frame without being re-recorded or re-uploaded.
+    DrawStream bakeStream();
+    //! Bakes the current DrawContext into a DrawStream that can be replayed every frame without being re-recorded or re-uploaded.
+    DrawStream bakeStream( RenderDevice* device );
     //! Clears the current DrawContext in preparation for a new frame
     void flush();
 
+    //! Enables or disables partial redraw. When enabled the DrawContext renders into a persistent render target matching the app SwapChain, only redraws the \a tileSize screen tiles whose content changed since the previous submit and composites the result onto the SwapChain back buffer. Mostly useful for static 2D content.
+    void enablePartialRedraw( bool enable = true, const ivec2 &tileSize = ivec2( 64 ), const ColorAf &clearColor = ColorAf::black() );
+    //! Disables partial redraw and releases its render targets
+    void disablePartialRedraw() { enablePartialRedraw( false ); }
+    //! Returns whether partial redraw is enabled
+    bool isPartialRedrawEnabled() const { return mPartialRedraw; }
+    //! Returns the screen rectangles (left, top, right, bottom) redrawn by the last submit when partial redraw is enabled
+    const std::vector<ivec4>& getDirtyRects() const { return mDirtyRects; }
+
 #if defined( IMGUI_DEGUG )
     void debugSubmit( const char* label, bool* open = nullptr, bool flushAfterSubmit = true );
 #endif
@@ -329,6 +400,7 @@ protected:
     BufferRef                mVertexBuffer;
     BufferRef                mConstantsBuffer;
     BufferView*              mConstantsBufferSRV;
+    BufferRef                mStreamConstantsBuffer;
 
     uint32_t                 mIndexBufferSize;
     uint32_t                 mVertexBufferSize;
@@ -419,6 +491,19 @@ protected:
     };
 
     Pipeline initializePipelineState( RenderDevice* device, const State &state );
+    //! Prepares the recorded Commands for submission, returns \c false if there is nothing to draw
+    bool prepareCommands( RenderDevice* device );
+    //! Writes the dynamic Transforms to their target constants
+    void resolveTransforms();
+    //! Creates or updates the vertex, index and constants buffers and binds the index buffer
+    void uploadBuffers( RenderDevice* device, ContextStateCache* stateCache );
+    //! Draws the prepared Commands. If \a clipRect is not null only the Commands intersecting it are drawn, scissored to the rect
+    void drawCommands( ContextStateCache* stateCache, const ivec4* clipRect );
+    //! Redraws the tiles that changed since the previous submit into the persistent render target and composites it
+    void submitPartialRedraw( RenderDevice* device, ContextStateCache* stateCache, bool hasCommands );
+    //! Computes the screen bounds of the Commands and the hashes of the screen tiles, fills mDirtyRects
+    void updateDirtyRects();
+    void initializePartialRedrawPipelines( RenderDevice* device );
 
     class DrawScope : private Noncopyable {
     public:
@@ -494,6 +579,32 @@ protected:
     std::vector<mat4>		 mViewMatrixStack;
     std::vector<mat4>		 mProjectionMatrixStack;
 
+    //! Range of vertices and indices recorded by a single startDraw, tracked for partial redraw
+    struct Primitive {
+        uint32_t vertexOffset;
+        uint32_t vertexCount;
+        uint32_t indexOffset;
+        uint32_t indexCount;
+    };
+
+    bool                        mPartialRedraw;
+    ivec2                       mPartialRedrawTileSize;
+    ColorAf                     mPartialRedrawClearColor;
+    ivec2                       mPartialRedrawSize;
+    TextureRef                  mPartialRedrawColor;
+    TextureRef                  mPartialRedrawDepth;
+    BufferRef                   mPartialRedrawConstants;
+    PipelineStateRef            mPartialRedrawClearPso;
+    PipelineStateRef            mPartialRedrawCompositePso;
+    ShaderResourceBindingRef    mPartialRedrawClearSrb;
+    ShaderResourceBindingRef    mPartialRedrawCompositeSrb;
+    bool                        mPartialRedrawConstantsValid;
+    std::vector<Primitive>      mPrimitives;
+    std::vector<ivec4>          mCommandBounds;
+    std::vector<uint64_t>       mTileHashes;
+    std::vector<uint64_t>       mPreviousTileHashes;
+    std::vector<ivec4>          mDirtyRects;
+
     std::vector<std::pair<vec2, vec2>> mViewportStack;
     std::vector<std::pair<ivec2, ivec2>> mScissorStack;
 
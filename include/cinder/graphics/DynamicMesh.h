@@ -0,0 +1,157 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/graphics/Mesh.h"
+
+namespace cinder { namespace graphics {
+
+typedef std::shared_ptr<class DynamicMesh> DynamicMeshRef;
+
+//! Mesh whose vertices and indices are rewritten after construction, sharing a single interleaved vertex layout.
+//! USAGE_DEFAULT storage keeps its content between frames and is updated by ranges with updateRange() and updateIndexRange().
+//! USAGE_DYNAMIC storage lives in the per-frame ring of the device and must be fully rewritten with mapVertices() and mapIndices() every frame it is drawn.
+class CI_API DynamicMesh {
+public:
+	struct CI_API Options {
+	public:
+		Options() : mVertexCapacity( 0 ), mIndexCapacity( 0 ), mIndexType( VT_UINT32 ), mUsage( USAGE_DEFAULT ), mPrimitive( geom::Primitive::TRIANGLES ), mName( "DynamicMesh" ) {}
+
+		//! Specifies the initial number of vertices the storage can hold
+		Options& vertexCapacity( uint32_t capacity ) { mVertexCapacity = capacity; return *this; }
+		//! Specifies the initial number of indices the storage can hold. A capacity of 0 creates a non-indexed mesh.
+		Options& indexCapacity( uint32_t capacity ) { mIndexCapacity = capacity; return *this; }
+		//! Specifies the index type, VT_UINT16 or VT_UINT32. Defaults to VT_UINT32.
+		Options& indexType( VALUE_TYPE indexType ) { mIndexType = indexType; return *this; }
+		//! Specifies the storage usage, USAGE_DEFAULT for persistent storage updated by ranges or USAGE_DYNAMIC for storage rewritten every frame. Defaults to USAGE_DEFAULT.
+		Options& usage( USAGE usage ) { mUsage = usage; return *this; }
+		//! Specifies the primitive type. Defaults to geom::Primitive::TRIANGLES.
+		Options& primitive( geom::Primitive primitive ) { mPrimitive = primitive; return *this; }
+		//! Specifies the name of the buffers
+		Options& name( const std::string &name ) { mName = name; return *this; }
+
+	protected:
+		uint32_t		mVertexCapacity;
+		uint32_t		mIndexCapacity;
+		VALUE_TYPE		mIndexType;
+		USAGE			mUsage;
+		geom::Primitive	mPrimitive;
+		std::string		mName;
+
+		friend class DynamicMesh;
+	};
+
+	//! Creates a DynamicMesh with the interleaved vertex \a layout
+	static DynamicMeshRef create( const Mesh::BufferInfo &layout, const Options &options = Options() );
+	//! Creates a DynamicMesh with the interleaved vertex \a layout
+	static DynamicMeshRef create( RenderDevice* device, const Mesh::BufferInfo &layout, const Options &options = Options() );
+
+	DynamicMesh( const DynamicMesh &other ) = delete;
+	DynamicMesh& operator=( const DynamicMesh &other ) = delete;
+
+	//! Grows the storage to hold at least \a numVertices vertices and \a numIndices indices, copying the current content of USAGE_DEFAULT storage using the immediate context
+	void		reserve( uint32_t numVertices, uint32_t numIndices );
+	//! Grows the storage to hold at least \a numVertices vertices and \a numIndices indices, copying the current content of USAGE_DEFAULT storage using \a context
+	void		reserve( DeviceContext* context, uint32_t numVertices, uint32_t numIndices );
+	//! Sets the number of vertices drawn, which must not exceed the vertex capacity
+	void		setNumVertices( uint32_t numVertices );
+	//! Sets the number of indices drawn, which must not exceed the index capacity
+	void		setNumIndices( uint32_t numIndices );
+
+	//! Returns the number of vertices drawn
+	uint32_t	getNumVertices() const { return mMesh.getNumVertices(); }
+	//! Returns the number of indices drawn
+	uint32_t	getNumIndices() const { return mMesh.getNumIndices(); }
+	//! Returns the number of vertices the storage can hold
+	uint32_t	getVertexCapacity() const { return mVertexCapacity; }
+	//! Returns the number of indices the storage can hold
+	uint32_t	getIndexCapacity() const { return mIndexCapacity; }
+	//! Returns the size in bytes of a vertex
+	uint32_t	getVertexStride() const { return mVertexStride; }
+
+	//! Replaces \a count vertices starting at vertex \a offset using the immediate context. Requires USAGE_DEFAULT storage.
+	void		updateRange( uint32_t offset, uint32_t count, const void* data );
+	//! Replaces \a count vertices starting at vertex \a offset using \a context. Requires USAGE_DEFAULT storage.
+	void		updateRange( DeviceContext* context, uint32_t offset, uint32_t count, const void* data );
+	//! Replaces \a count indices of the mesh index type starting at index \a offset using the immediate context. Requires USAGE_DEFAULT storage.
+	void		updateIndexRange( uint32_t offset, uint32_t count, const void* data );
+	//! Replaces \a count indices of the mesh index type starting at index \a offset using \a context. Requires USAGE_DEFAULT storage.
+	void		updateIndexRange( DeviceContext* context, uint32_t offset, uint32_t count, const void* data );
+
+	//! Maps the whole vertex storage for writing using the immediate context, discarding its previous content. Requires USAGE_DYNAMIC storage.
+	void*		mapVertices();
+	//! Maps the whole vertex storage for writing using \a context, discarding its previous content. Requires USAGE_DYNAMIC storage.
+	void*		mapVertices( DeviceContext* context );
+	//! Unmaps the vertex storage mapped by mapVertices() using the immediate context
+	void		unmapVertices();
+	//! Unmaps the vertex storage mapped by mapVertices() using \a context
+	void		unmapVertices( DeviceContext* context );
+	//! Maps the whole index storage for writing using the immediate context, discarding its previous content. Requires USAGE_DYNAMIC storage.
+	void*		mapIndices();
+	//! Maps the whole index storage for writing using \a context, discarding its previous content. Requires USAGE_DYNAMIC storage.
+	void*		mapIndices( DeviceContext* context );
+	//! Unmaps the index storage mapped by mapIndices() using the immediate context
+	void		unmapIndices();
+	//! Unmaps the index storage mapped by mapIndices() using \a context
+	void		unmapIndices( DeviceContext* context );
+
+	//! Returns the Mesh drawing the current vertices and indices. Copies keep the counts and buffers they were made with, reserve() might reallocate the buffers.
+	const Mesh&	getMesh() const { return mMesh; }
+	//! Returns the interleaved vertex layout
+	const Mesh::BufferInfo& getLayout() const { return mLayout; }
+
+	//! Draws the current vertices and indices. Nothing is drawn while an indexed mesh has no indices or the mesh has no vertices.
+	void draw( const Mesh::DrawAttribs &attribs = {} ) const;
+	void draw( DeviceContext* context, const Mesh::DrawAttribs &attribs = {} ) const;
+	void draw( ContextStateCache* stateCache, const Mesh::DrawAttribs &attribs = {} ) const;
+
+protected:
+	DynamicMesh( RenderDevice* device, const Mesh::BufferInfo &layout, const Options &options );
+
+	//! Creates a buffer of \a size bytes with the storage usage
+	BufferRef	createStorage( BIND_FLAGS bindFlags, uint32_t size, const std::string &name ) const;
+	//! Rebuilds the Mesh referencing the current buffers
+	void		updateMesh( uint32_t numVertices, uint32_t numIndices );
+	//! Returns whether there is nothing to draw. An indexed mesh without indices would otherwise be drawn as a non-indexed one.
+	bool		isEmpty() const { return mIndexCapacity ? ! getNumIndices() : ! getNumVertices(); }
+	uint32_t	getIndexSize() const { return mIndexType == VT_UINT16 ? sizeof( uint16_t ) : sizeof( uint32_t ); }
+
+	RenderDevice*		mDevice;
+	Mesh::BufferInfo	mLayout;
+	Mesh				mMesh;
+	BufferRef			mVertexBuffer;
+	BufferRef			mIndexBuffer;
+	uint32_t			mVertexStride;
+	uint32_t			mVertexCapacity;
+	uint32_t			mIndexCapacity;
+	VALUE_TYPE			mIndexType;
+	USAGE				mUsage;
+	geom::Primitive		mPrimitive;
+	std::string			mName;
+};
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
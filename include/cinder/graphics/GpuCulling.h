@@ -0,0 +1,133 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/graphics/Mesh.h"
+#include "cinder/AxisAlignedBox.h"
+
+#include <memory>
+
+namespace cinder { namespace graphics {
+
+class ContextStateCache;
+
+typedef std::shared_ptr<class GpuCulling> GpuCullingRef;
+
+//! Frustum culls objects on the GPU and draws the visible ones with a single indirect draw. A compute pass tests the bounds of every object against the frustum and writes one DrawIndexedIndirect command per visible object.
+//! All the objects share the vertex and index buffers of the first added Mesh, typically meshes allocated from a MeshPool. Each command draws a single instance whose location is the object id, see getObjectIdLayout().
+class CI_API GpuCulling {
+public:
+	struct CI_API Options {
+	public:
+		Options() : mCapacity( 65536 ), mName( "GpuCulling" ) {}
+
+		//! Specifies the maximum number of objects. Defaults to 65536.
+		Options& capacity( uint32_t capacity ) { mCapacity = capacity; return *this; }
+		//! Specifies the name of the culling buffers and pipeline
+		Options& name( const std::string &name ) { mName = name; return *this; }
+
+	protected:
+		uint32_t	mCapacity;
+		std::string	mName;
+
+		friend class GpuCulling;
+	};
+
+	//! Creates a GpuCulling object holding up to Options::capacity() objects
+	static GpuCullingRef create( const Options &options = Options() );
+	//! Creates a GpuCulling object holding up to Options::capacity() objects
+	static GpuCullingRef create( RenderDevice* device, const Options &options = Options() );
+
+	GpuCulling( const GpuCulling &other ) = delete;
+	GpuCulling& operator=( const GpuCulling &other ) = delete;
+
+	//! Adds an object drawing the level of detail \a lod of \a mesh within \a worldBounds and returns its id. Returns ~0u if the capacity is reached or if \a mesh doesn't share the vertex and index buffers of the objects already added.
+	uint32_t	add( const Mesh &mesh, const AxisAlignedBox &worldBounds, uint32_t lod = 0 );
+	//! Updates the world space bounds of the object \a id
+	void		setBounds( uint32_t id, const AxisAlignedBox &worldBounds );
+	//! Removes all the objects
+	void		clear();
+
+	//! Uploads the modified objects and culls them against the frustum of \a viewProjection using the immediate context
+	void		cull( const mat4 &viewProjection );
+	//! Uploads the modified objects and culls them against the frustum of \a viewProjection using \a context
+	void		cull( DeviceContext* context, const mat4 &viewProjection );
+	//! Uploads the modified objects and culls them against the frustum of \a viewProjection on the DeviceContext shadowed by \a stateCache
+	void		cull( ContextStateCache* stateCache, const mat4 &viewProjection );
+	//! Issues the indirect draw of the objects that passed the last cull(). The pipeline, the vertex buffers, the index buffer and the object id buffer must already be bound, see Batch::drawIndirect().
+	void		drawIndirect( DeviceContext* context, VALUE_TYPE indexType ) const;
+
+	//! Returns the number of objects
+	uint32_t			getNumObjects() const { return static_cast<uint32_t>( mObjects.size() ); }
+	//! Returns the maximum number of objects
+	uint32_t			getCapacity() const { return mCapacity; }
+	//! Returns whether visible commands are compacted and counted on the GPU. Otherwise culled commands are kept with an instance count of zero.
+	bool				isCompacting() const { return mCompact; }
+	//! Returns the per-instance vertex buffer holding the object ids
+	const BufferRef&	getObjectIdBuffer() const { return mObjectIdBuffer; }
+	//! Returns the structured buffer holding the bounds and draw ranges of the objects
+	const BufferRef&	getObjectsBuffer() const { return mObjectsBuffer; }
+	//! Returns the buffer holding the DrawIndexedIndirect commands
+	const BufferRef&	getDrawArgsBuffer() const { return mDrawArgsBuffer; }
+	//! Returns the buffer holding the number of visible objects when compacting
+	const BufferRef&	getDrawCountBuffer() const { return mDrawCountBuffer; }
+
+	//! Returns the per-instance layout of the object id buffer, an int read from \a attrib. Used as the instance layout of a Batch drawn with Batch::drawIndirect().
+	static Mesh::BufferInfo	getObjectIdLayout( geom::Attrib attrib = geom::Attrib::CUSTOM_9 );
+
+protected:
+	GpuCulling( RenderDevice* device, const Options &options );
+
+	//! Object as read by the culling shader, 48 bytes
+	struct Object {
+		vec3		center;
+		uint32_t	numIndices;
+		vec3		extents;
+		uint32_t	firstIndex;
+		int32_t		baseVertex;
+		uint32_t	padding[3];
+	};
+
+	RenderDevice*				mDevice;
+	std::string					mName;
+	uint32_t					mCapacity;
+	bool						mCompact;
+	std::vector<Object>			mObjects;
+	uint32_t					mDirtyBegin;
+	uint32_t					mDirtyEnd;
+	BufferRef					mSourceIndexBuffer;
+	std::vector<BufferRef>		mSourceVertexBuffers;
+	BufferRef					mObjectIdBuffer;
+	BufferRef					mObjectsBuffer;
+	BufferRef					mDrawArgsBuffer;
+	BufferRef					mDrawCountBuffer;
+	BufferRef					mConstantsBuffer;
+	PipelineStateRef			mPso;
+	ShaderResourceBindingRef	mSrb;
+};
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -24,14 +24,39 @@
 #pragma once
 
 #include "cinder/graphics/Buffer.h"
+#include "cinder/graphics/ContextStateCache.h"
 
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
 #include "cinder/TriMesh.h"
 #include "cinder/GeomIo.h"
+#include "cinder/Sphere.h"
+
+#include <future>
 
 namespace cinder { namespace graphics {
 	
 class CI_API Mesh {
 public:
+	//! Storage format of a vertex attribute. Three components 8 and 16-bit formats are padded to four components, the padding being 1.
+	enum class AttribFormat : uint8_t {
+		//! 32-bit floats or integers depending on the attribute geom::DataType. The default.
+		FLOAT32,
+		//! 16-bit half floats
+		FLOAT16,
+		//! 16-bit signed normalized integers. POSITION is remapped to the mesh bounds, see getPositionScale() and getPositionOffset().
+		SNORM16,
+		//! 16-bit unsigned normalized integers. POSITION is remapped to the mesh bounds, see getPositionScale() and getPositionOffset().
+		UNORM16,
+		//! 8-bit signed normalized integers
+		SNORM8,
+		//! 8-bit unsigned normalized integers, typically for RGBA8 colors
+		UNORM8,
+		//! Unit vectors octahedral-encoded in two 16-bit signed normalized integers. Decoded with n = float3( e, 1 - abs( e.x ) - abs( e.y ) ); n.xy += ( n.xy >= 0 ? -1 : 1 ) * saturate( -n.z ); n = normalize( n )
+		OCT_SNORM16
+	};
+
 	//! BufferInfo describes both the layout of a vertex buffer and its initial format
 	class CI_API BufferInfo : public geom::BufferLayout {
 	public:
@@ -50,8 +75,12 @@ public:
 		BufferInfo& cpuAccess( CPU_ACCESS_FLAGS cpuAccessFlags ) { mCPUAccessFlags = cpuAccessFlags; return *this; }
 		//! Buffer mode, see Diligent::BUFFER_MODE
 		BufferInfo& mode( BUFFER_MODE mode ) { mMode = mode; return *this; }
+		//! Stores the vertices in a structured or raw buffer bound as a shader resource instead of a vertex buffer. Shaders fetch the vertices by SV_VertexID, which includes the base vertex of indexed draws on D3D and Vulkan. The attributes keep their offsets and stride but produce no LayoutElement.
+		BufferInfo& vertexPulling( BUFFER_MODE mode = BUFFER_MODE_STRUCTURED ) { mMode = mode; mBindFlags = ( mBindFlags & ~BIND_VERTEX_BUFFER ) | BIND_SHADER_RESOURCE; return *this; }
 		//! For signed and unsigned integer value types indicates if the value should be normalized to [-1,+1] or [0, 1] range respectively. For floating point types, this member is ignored.
 		BufferInfo& normalized( bool normalized ) { mIsNormalized = normalized; return *this; }
+		//! Specifies the storage format of \a attrib. When building from a geom::Source the attribute is converted, otherwise the format describes the provided data.
+		BufferInfo& attribFormat( geom::Attrib attrib, AttribFormat format );
 		//! Specifies the Buffer name
 		BufferInfo& name( const std::string &name ) { mName = name; return *this; }
 
@@ -63,10 +92,24 @@ public:
 		CPU_ACCESS_FLAGS	getCPUAccessFlags() const { return mCPUAccessFlags; }
 		//! Returns Buffer mode, see Diligent::BUFFER_MODE
 		BUFFER_MODE			getMode() const { return mMode; }
+		//! Returns whether the vertices are fetched by the shaders from a structured or raw buffer rather than bound as a vertex buffer, see vertexPulling()
+		bool				isVertexPulled() const { return ( mMode == BUFFER_MODE_STRUCTURED || mMode == BUFFER_MODE_RAW ) && ! ( mBindFlags & BIND_VERTEX_BUFFER ); }
 		//! For signed and unsigned integer value types indicates if the value should be normalized to [-1,+1] or [0, 1] range respectively. For floating point types, this member is ignored.
 		bool				getIsNormalized() const { return mIsNormalized; }
 		//! Returns the Buffer name
 		std::string			getName() const { return mName; }
+		//! Returns the storage format of \a attrib, AttribFormat::FLOAT32 if not specified
+		AttribFormat		getAttribFormat( geom::Attrib attrib ) const;
+		//! Returns the size in bytes of \a attribInfo once stored in its AttribFormat
+		size_t				calcAttribByteSize( const geom::AttribInfo &attribInfo ) const;
+		//! Returns a copy of the BufferInfo with the attributes interleaved in declaration order, at packed offsets and sharing a single stride
+		BufferInfo			calcInterleaved() const;
+		//! Returns the size of a vertex in bytes, the shared stride of interleaved attributes or the packed size of a single attribute
+		size_t				calcVertexByteSize() const;
+		//! Returns the description of a buffer of \a sizeInBytes created from this BufferInfo. Structured buffers use the vertex stride as element stride. The name points to the BufferInfo name.
+		BufferDesc			calcBufferDesc( uint32_t sizeInBytes ) const;
+		//! Returns the LayoutElements reading the attributes from \a bufferSlot, numbered from \a firstInputIndex. Attributes with an instance divisor are read per instance.
+		std::vector<LayoutElement> calcLayoutElements( uint32_t bufferSlot, uint32_t firstInputIndex = 0 ) const;
 	protected:
 		BIND_FLAGS			mBindFlags;
 		USAGE				mUsage;
@@ -74,6 +117,7 @@ public:
 		BUFFER_MODE			mMode;
 		bool				mIsNormalized;
 		std::string			mName;
+		std::vector<std::pair<geom::Attrib, AttribFormat>> mAttribFormats;
 
 		friend Mesh;
 		friend class MeshGeomTarget;
@@ -92,25 +136,119 @@ public:
 		BufferInfo	mBufferInfo;
 	};
 		
+	//! Mesh statistics before and after optimization, see Optimization::report()
+	struct CI_API OptimizationReport {
+		//! Average Cache Miss Ratio, post-transform vertices per triangle
+		float	acmrBefore = 0.0f;
+		float	acmrAfter = 0.0f;
+		//! Average Transformed Vertex Ratio, post-transform vertices per unique vertex
+		float	atvrBefore = 0.0f;
+		float	atvrAfter = 0.0f;
+		size_t	indexBytesBefore = 0;
+		size_t	indexBytesAfter = 0;
+		size_t	vertexBytesBefore = 0;
+		size_t	vertexBytesAfter = 0;
+	};
+
+	//! Describes the optimizations applied to the index and vertex order when building a Mesh from a geom::Source. Only indexed triangle lists are reordered.
+	class CI_API Optimization {
+	public:
+		//! Disables all optimizations by default, see all() or the individual setters to enable them
+		Optimization() : mVertexCache( false ), mOverdraw( false ), mVertexFetch( false ), mNarrowIndices( false ), mOverdrawThreshold( 1.05f ), mCacheSize( 16 ), mReport( nullptr ) {}
+		//! Returns an Optimization with vertex cache, overdraw, vertex fetch and index narrowing enabled
+		static Optimization all() { return Optimization().vertexCache().overdraw().vertexFetch().narrowIndices(); }
+
+		//! Reorders triangles to improve post-transform vertex cache hits
+		Optimization& vertexCache( bool enable = true ) { mVertexCache = enable; return *this; }
+		//! Reorders clusters of triangles outside-in to reduce overdraw. \a threshold specifies how much the vertex cache efficiency can degrade, 1.05 allowing 5% more vertex transforms.
+		Optimization& overdraw( bool enable = true, float threshold = 1.05f ) { mOverdraw = enable; mOverdrawThreshold = threshold; return *this; }
+		//! Reorders vertices in order of first use by the indices and removes unreferenced vertices
+		Optimization& vertexFetch( bool enable = true ) { mVertexFetch = enable; return *this; }
+		//! Uses 16-bit indices whenever the number of vertices allows it
+		Optimization& narrowIndices( bool enable = true ) { mNarrowIndices = enable; return *this; }
+		//! Specifies the size of the simulated post-transform vertex cache. Defaults to 16.
+		Optimization& cacheSize( uint32_t cacheSize ) { mCacheSize = cacheSize; return *this; }
+		//! Specifies an OptimizationReport to be filled with the mesh statistics before and after optimization
+		Optimization& report( OptimizationReport* report ) { mReport = report; return *this; }
+		//! Appends a level of detail simplified from the full detail mesh until \a targetRatio of its indices remain or the error would exceed \a targetError, relative to the mesh extent. Simplification stops earlier on meshes that can't be reduced further.
+		Optimization& lod( float targetRatio, float targetError = 0.01f ) { mLods.push_back( { targetRatio, targetError } ); return *this; }
+
+	protected:
+		bool				mVertexCache;
+		bool				mOverdraw;
+		bool				mVertexFetch;
+		bool				mNarrowIndices;
+		float				mOverdrawThreshold;
+		uint32_t			mCacheSize;
+		OptimizationReport*	mReport;
+		std::vector<std::pair<float, float>> mLods;
+
+		friend class MeshGeomTarget;
+	};
+
+	//! Range of the index buffer drawn at a level of detail. All the levels share the mesh vertex buffers.
+	struct Lod {
+		uint32_t	firstIndex = 0;
+		uint32_t	numIndices = 0;
+		//! Maximum distance between the level and the full detail mesh, in object space units
+		float		error = 0.0f;
+	};
+
+	//! Vertex and index data loaded from a geom::Source on the CPU, before any GPU resource is created
+	struct CI_API SourceData {
+		//! Interleaved vertex data, one entry per vertex buffer
+		std::vector<std::pair<BufferInfo, std::vector<uint8_t>>> vertexBuffers;
+		//! Indices of all the levels of detail
+		std::vector<uint32_t>	indices;
+		//! Whether the index buffer should use 16-bit indices
+		bool					use16BitIndices = true;
+		uint32_t				numVertices = 0;
+		geom::Primitive			primitive = geom::Primitive::TRIANGLES;
+		AxisAlignedBox			bounds;
+		Sphere					boundingSphere = Sphere( vec3( 0.0f ), 0.0f );
+		vec3					positionScale = vec3( 1.0f );
+		vec3					positionOffset = vec3( 0.0f );
+		std::vector<Lod>		lods;
+	};
+
+	//! Loads, converts and optimizes \a source on the CPU without creating any GPU resource. Safe to call from any thread.
+	static SourceData loadSource( const geom::Source &source, const std::vector<BufferInfo> &bufferInfos = {}, const Optimization &optimization = Optimization() );
+	//! Writes \a data to \a path in the binary mesh format read by load(). \a encodeIndices compresses triangle list indices with encodeIndexBuffer(), at the cost of decoding them on load.
+	static void save( const fs::path &path, const SourceData &data, bool encodeIndices = false );
+	//! Reads a mesh written by save() on the CPU without creating any GPU resource, encoded indices are decoded. Safe to call from any thread. Throws MeshDataExc on failure.
+	static SourceData loadSource( const fs::path &path );
+	//! Loads a mesh written by save(). The file is memory-mapped and its vertex and index data handed to CreateBuffer without intermediate copies, encoded indices are decoded first. Throws MeshDataExc on failure.
+	static Mesh load( const fs::path &path );
+	//! Loads a mesh written by save(). The file is memory-mapped and its vertex and index data handed to CreateBuffer without intermediate copies, encoded indices are decoded first. Throws MeshDataExc on failure.
+	static Mesh load( RenderDevice* device, const fs::path &path );
+
 	Mesh() = default;
 
 	Mesh( const geom::Source &source );
 	Mesh( const geom::Source &source, const geom::AttribSet &requestedAttribs );
 	Mesh( const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos );
+	Mesh( const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos, const Optimization &optimization );
 	Mesh( uint32_t numVertices, const std::vector<std::pair<BufferInfo, BufferRef>> &vertexBuffers, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
 	Mesh( uint32_t numVertices, const void* vertexData, uint32_t vertexDataSize, const BufferInfo &bufferInfo, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
 	Mesh( const std::vector<std::pair<BufferInfo, BufferRef>> &vertexBuffers, uint32_t numIndices, const BufferRef &indexBuffer, VALUE_TYPE indexType = VT_UINT16, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
 	Mesh( const void* vertexData, uint32_t vertexDataSize, const BufferInfo &bufferInfo, uint32_t numIndices, const void *indexData, VALUE_TYPE indexType = VT_UINT16, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
 	Mesh( const std::vector<StreamData> &vertexStreams, uint32_t numIndices, const void *indexData, VALUE_TYPE indexType = VT_UINT16, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
+	Mesh( const SourceData &data );
+	//! Interleaves \a triMesh into a single staging allocation and creates the buffers, bypassing geom::Source::loadInto
+	Mesh( const TriMesh &triMesh, const std::vector<Mesh::BufferInfo> &bufferInfos = {} );
 
 	Mesh( RenderDevice* device, const geom::Source &source );
 	Mesh( RenderDevice* device, const geom::Source &source, const geom::AttribSet &requestedAttribs );
 	Mesh( RenderDevice* device, const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos );
+	Mesh( RenderDevice* device, const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos, const Optimization &optimization );
 	Mesh( RenderDevice* device, uint32_t numVertices, const std::vector<std::pair<BufferInfo, BufferRef>> &vertexBuffers, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
 	Mesh( RenderDevice* device, uint32_t numVertices, const void* vertexData, uint32_t vertexDataSize, const BufferInfo &bufferInfo, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
 	Mesh( RenderDevice* device, const std::vector<std::pair<BufferInfo, BufferRef>> &vertexBuffers, uint32_t numIndices, const BufferRef &indexBuffer, VALUE_TYPE indexType = VT_UINT16, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
 	Mesh( RenderDevice* device, const void* vertexData, uint32_t vertexDataSize, const BufferInfo &bufferInfo, uint32_t numIndices, const void *indexData, VALUE_TYPE indexType = VT_UINT16, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
 	Mesh( RenderDevice* device, const std::vector<StreamData> &vertexStreams, uint32_t numIndices, const void *indexData, VALUE_TYPE indexType = VT_UINT16, geom::Primitive primitiveType = geom::Primitive::TRIANGLES );
+	Mesh( RenderDevice* device, const SourceData &data );
+	//! Interleaves \a triMesh into a single staging allocation and creates the buffers, bypassing geom::Source::loadInto
+	Mesh( RenderDevice* device, const TriMesh &triMesh, const std::vector<Mesh::BufferInfo> &bufferInfos = {} );
 
 	//! Returns the number of vertices in the mesh
 	uint32_t				getNumVertices() const { return mNumVertices; }
@@ -124,11 +262,38 @@ public:
 	uint8_t					getAttribDims( geom::Attrib attr ) const;
 	//! Returns AttribSet of geom::Attribs present in the Mesh
 	geom::AttribSet			getAttribs() const;
+	//! Returns the scale applied to normalized integer positions, position = encoded * scale + offset
+	const vec3&				getPositionScale() const { return mPositionScale; }
+	//! Returns the offset applied to normalized integer positions, position = encoded * scale + offset
+	const vec3&				getPositionOffset() const { return mPositionOffset; }
+	//! Returns the location of the first vertex of the mesh in its vertex buffers, non-zero for meshes allocated from a MeshPool
+	uint32_t				getBaseVertex() const { return mBaseVertex; }
+	//! Returns the location of the first index of the mesh in its index buffer, non-zero for meshes allocated from a MeshPool
+	uint32_t				getFirstIndex() const { return mFirstIndex; }
+	//! Returns the object space bounds of the mesh. Only available for meshes built from a geom::Source or a TriMesh, otherwise empty.
+	const AxisAlignedBox&	getBounds() const { return mBounds; }
+	//! Returns the object space bounding sphere of the mesh, centered on the bounds. Only available for meshes built from a geom::Source or a TriMesh, otherwise empty.
+	const Sphere&			getBoundingSphere() const { return mBoundingSphere; }
+	//! Returns whether the bounds are known. Meshes built from buffers have empty bounds and are never culled.
+	bool					hasBounds() const { return mBounds.getSize() != vec3( 0.0f ); }
+
+	//! Returns the number of levels of detail, the full detail mesh being level 0
+	uint32_t				getNumLods() const { return mLods.empty() ? 1 : static_cast<uint32_t>( mLods.size() ); }
+	//! Returns the levels of detail, empty if the mesh only has its full detail indices
+	const std::vector<Lod>&	getLods() const { return mLods; }
+	//! Specifies the levels of detail as ranges of the index buffer, sorted from full to lowest detail
+	void					setLods( const std::vector<Lod> &lods ) { mLods = lods; }
+	//! Returns the lowest detail level whose error projects to less than \a pixelError pixels, given the \a modelViewProjection matrix and the viewport height in pixels
+	uint32_t				selectLod( const mat4 &modelViewProjection, float viewportHeight, float pixelError = 1.0f ) const;
 
 	//! Returns the Buffer containing the indices of the mesh, or a NULL for non-indexed geometry
 	BufferRef						  getIndexBuffer() const { return mIndices; }
 	//! Returns the vector of BufferRefs for the vertex data of the mesh
 	const std::vector<BufferRef>&	  getVertexBuffers() const { return mVertexBuffers; }
+	//! Returns the shader resource view of the vertex buffer at \a index, used to fetch the vertices of buffers created with BufferInfo::vertexPulling()
+	BufferView*						  getVertexBufferView( size_t index ) const;
+	//! Returns the number of vertex buffer slots bound by draw(), which excludes the buffers fetched with vertex pulling
+	uint32_t						  getNumVertexBufferSlots() const { return static_cast<uint32_t>( mVertexBufferPtrs.size() ); }
 	//! Returns the vector of BufferRefs for the vertex data of the mesh
 	const std::vector<BufferInfo>&	  getVertexBuffersInfo() const { return mVertexBuffersInfos; }
 	//! Returns the vector of BufferRefs for the vertex data of the mesh
@@ -136,6 +301,11 @@ public:
 	//! Builds and returns a InputLayoutDesc from the Mesh vertex LayoutElements
 	InputLayoutDesc					  getInputLayoutDesc() const;
 
+	//! Reads the vertex and index buffers back using the immediate context and writes the mesh to \a path, see load(). Waits for the GPU to be idle.
+	void save( const fs::path &path, bool encodeIndices = false ) const;
+	//! Reads the vertex and index buffers back using \a context and writes the mesh to \a path, see load(). Waits for the GPU to be idle.
+	void save( DeviceContext* context, const fs::path &path, bool encodeIndices = false ) const;
+
 	//! Describes the draw call attributes and the buffer transition modes. Also allows to specifies a set of geom attributes
 	class DrawAttribs {
 	public:
@@ -161,7 +331,9 @@ public:
 		//! Additional flags. See Diligent::SET_VERTEX_BUFFERS_FLAGS for a list of allowed values.
 		DrawAttribs& vertexBuffersFlags( SET_VERTEX_BUFFERS_FLAGS vertexBuffersFlags ) { mVertexBuffersFlags = vertexBuffersFlags; return *this; }
 		//! Specifies a set of Attribs to determine which vertex buffers will be bound before drawing the mesh
-		DrawAttribs& attribs( const geom::AttribSet &attribs ) { mAttribs = attribs; return *this; }
+		DrawAttribs& attribs( const geom::AttribSet &attribs ) { mAttribsMask = Mesh::calcAttribsMask( attribs ); return *this; }
+		//! Specifies the level of detail to draw, clamped to the available levels. firstIndexLocation is relative to the level range.
+		DrawAttribs& lod( uint32_t lod ) { mLod = lod; return *this; }
 	protected:
 		uint32_t mNumInstances;
 		uint32_t mFirstIndexLocation;
@@ -174,7 +346,8 @@ public:
 		RESOURCE_STATE_TRANSITION_MODE mIndexBufferTransitionMode;
 		SET_VERTEX_BUFFERS_FLAGS mVertexBuffersFlags;
 
-		geom::AttribSet mAttribs;
+		uint64_t		mAttribsMask = 0;
+		uint32_t		mLod = 0;
 		friend class Mesh;
 	};
 
@@ -182,8 +355,20 @@ public:
 	void draw( const DrawAttribs &attribs = {} ) const;
 	//! Draws the mesh on the specified DeviceContext
 	void draw( DeviceContext* context, const DrawAttribs &attribs = {} ) const;
+	//! Draws the mesh on the DeviceContext shadowed by \a stateCache, skipping redundant vertex and index buffer binds
+	void draw( ContextStateCache* stateCache, const DrawAttribs &attribs = {} ) const;
+	//! Binds the vertex buffers and the index buffer without drawing, for indirect draws. Only the vertex buffers flags, transition modes and attribs of \a attribs are used.
+	void bind( ContextStateCache* stateCache, const DrawAttribs &attribs = {} ) const;
 	
 protected:
+	//! Delegated to by the raw data constructors once their indices have been narrowed
+	Mesh( RenderDevice* device, const std::vector<std::pair<BufferInfo, BufferRef>> &vertexBuffers, uint32_t numIndices, const std::pair<BufferRef, VALUE_TYPE> &indexBuffer, geom::Primitive primitiveType );
+
+	//! Returns a bitmask with one bit set per geom::Attrib in \a attribs
+	static uint64_t calcAttribsMask( const geom::AttribSet &attribs );
+	//! Caches the raw vertex buffer pointers, offsets and attrib masks used by draw()
+	void cacheVertexBufferBindings();
+
 	uint32_t					mNumVertices;
 	uint32_t					mNumIndices;
 	PRIMITIVE_TOPOLOGY			mPrimitiveTopology;
@@ -193,10 +378,38 @@ protected:
 	std::vector<BufferInfo>		mVertexBuffersInfos;
 	std::vector<LayoutElement>	mVertexLayoutElements;
 	BufferRef					mIndices;
+	vec3						mPositionScale = vec3( 1.0f );
+	vec3						mPositionOffset = vec3( 0.0f );
+	AxisAlignedBox				mBounds;
+	Sphere						mBoundingSphere = Sphere( vec3( 0.0f ), 0.0f );
+	std::vector<Lod>			mLods;
+	uint32_t					mBaseVertex = 0;
+	uint32_t					mFirstIndex = 0;
+	//! Releases the MeshPool ranges when the last copy of the mesh is destroyed
+	std::shared_ptr<void>		mPoolAllocation;
+
+	std::vector<Buffer*>		mVertexBufferPtrs;
+	std::vector<uint64_t>		mVertexBufferOffsets;
+	std::vector<uint64_t>		mVertexBufferAttribsMasks;
 	
 	friend class MeshGeomTarget;
+	friend class MeshPool;
+	friend class DynamicMesh;
+	friend class SkinnedMesh;
 };
 
+CI_API std::ostream& operator<<( std::ostream &os, const Mesh::OptimizationReport &report );
+
+class CI_API MeshDataExc : public Exception {
+public:
+	MeshDataExc( const std::string &description ) : Exception( description ) {}
+};
+
+//! Loads and optimizes a copy of \a source on the default ThreadPool and creates the Mesh buffers. The buffers are created on the worker thread when the device supports MultithreadedResourceCreation, otherwise on the main thread through App::dispatchAsync, in which case the main thread must not block on the future.
+CI_API std::future<Mesh> createMeshAsync( const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos = {}, const Mesh::Optimization &optimization = Mesh::Optimization() );
+//! Loads and optimizes a copy of \a source on the default ThreadPool and creates the Mesh buffers. The buffers are created on the worker thread when the device supports MultithreadedResourceCreation, otherwise on the main thread through App::dispatchAsync, in which case the main thread must not block on the future.
+CI_API std::future<Mesh> createMeshAsync( RenderDevice* device, const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos = {}, const Mesh::Optimization &optimization = Mesh::Optimization() );
+
 }
 
 namespace gx = graphics;
@@ -0,0 +1,97 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Export.h"
+#include "cinder/Vector.h"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace cinder { namespace graphics {
+
+//! Post-transform vertex cache statistics of a triangle list, see analyzeVertexCache()
+struct VertexCacheStats {
+	//! Number of vertices transformed, e.g. missing from the simulated cache
+	size_t	numTransformed = 0;
+	//! Average Cache Miss Ratio: vertices transformed per triangle, 3 in the worst case and close to 0.5 for the best regular grids
+	float	acmr = 0.0f;
+	//! Average Transformed Vertex Ratio: vertices transformed per unique vertex referenced, 1 being optimal
+	float	atvr = 0.0f;
+};
+
+//! Cluster of triangles sharing a small set of vertices, see buildMeshlets()
+struct Meshlet {
+	//! Location of the first vertex of the meshlet in the meshlet vertices array
+	uint32_t	vertexOffset = 0;
+	//! Location of the first triangle of the meshlet in the meshlet triangles array, each triangle being three local vertex indices
+	uint32_t	triangleOffset = 0;
+	uint32_t	numVertices = 0;
+	uint32_t	numTriangles = 0;
+};
+
+//! Bounding sphere and normal cone of a meshlet, see computeMeshletBounds()
+struct MeshletBounds {
+	vec3	center = vec3( 0.0f );
+	float	radius = 0.0f;
+	//! Average normal of the meshlet triangles
+	vec3	coneAxis = vec3( 0.0f, 0.0f, 1.0f );
+	//! Sine of the spread of the normals. The meshlet faces away from a viewer at \a p if dot( center - p, coneAxis ) >= coneCutoff * length( center - p ) + radius. 1 disables the test.
+	float	coneCutoff = 1.0f;
+};
+
+//! Returns the maximum number of meshlets buildMeshlets() can write for \a numIndices indices
+CI_API size_t buildMeshletsBound( size_t numIndices, size_t maxVertices = 64, size_t maxTriangles = 124 );
+//! Splits the triangle list \a indices in meshlets of at most \a maxVertices vertices and \a maxTriangles triangles, in index order. \a meshletVertices receives the vertex indices of each meshlet and \a meshletTriangles three local indices per triangle. \a meshlets must hold buildMeshletsBound() meshlets, \a meshletVertices and \a meshletTriangles \a numIndices entries each. Returns the number of meshlets. \a indices should be optimized for the vertex cache first.
+CI_API size_t buildMeshlets( Meshlet* meshlets, uint32_t* meshletVertices, uint8_t* meshletTriangles, const uint32_t* indices, size_t numIndices, size_t numVertices, size_t maxVertices = 64, size_t maxTriangles = 124 );
+//! Computes the bounding sphere and the normal cone of \a meshlet
+CI_API MeshletBounds computeMeshletBounds( const Meshlet &meshlet, const uint32_t* meshletVertices, const uint8_t* meshletTriangles, const vec3* positions );
+
+//! Simulates a FIFO post-transform vertex cache of \a cacheSize entries over the triangle list \a indices
+CI_API VertexCacheStats analyzeVertexCache( const uint32_t* indices, size_t numIndices, size_t numVertices, uint32_t cacheSize = 16 );
+//! Reorders the triangles of \a indices to improve post-transform vertex cache hits (Tipsify, Sander et al. 2007). \a dst can alias \a indices.
+CI_API void optimizeVertexCache( uint32_t* dst, const uint32_t* indices, size_t numIndices, size_t numVertices, uint32_t cacheSize = 16 );
+//! Reorders clusters of triangles so that the ones facing away from the mesh center are drawn first, reducing overdraw. Clusters are split where the vertex cache efficiency stays within \a threshold of the input order. \a indices should be optimized for the vertex cache first. \a dst can alias \a indices.
+CI_API void optimizeOverdraw( uint32_t* dst, const uint32_t* indices, size_t numIndices, const vec3* positions, size_t numVertices, float threshold = 1.05f, uint32_t cacheSize = 16 );
+//! Simplifies the triangle list \a indices by collapsing edges onto existing vertices (Garland and Heckbert 1997) until \a targetIndexCount is reached or the error would exceed \a targetError, relative to the mesh extent. Borders are preserved. Writes at most \a numIndices indices to \a dst, which can alias \a indices, and returns the number written. \a resultError receives the error of the result relative to the mesh extent.
+CI_API size_t simplify( uint32_t* dst, const uint32_t* indices, size_t numIndices, const vec3* positions, size_t numVertices, size_t targetIndexCount, float targetError, float* resultError = nullptr );
+//! Rewrites \a indices so that vertices are numbered in order of first use and fills \a remap with the new location of each vertex, or ~0 for unreferenced vertices. Returns the number of vertices referenced.
+CI_API size_t optimizeVertexFetchRemap( uint32_t* remap, uint32_t* indices, size_t numIndices, size_t numVertices );
+
+//! Returns the maximum number of bytes encodeIndexBuffer() writes for \a numIndices indices
+CI_API size_t encodeIndexBufferBound( size_t numIndices );
+//! Compresses the triangle list \a indices by referencing the edges and vertices of the previous triangles, in the spirit of the meshoptimizer index codec. Writes at most encodeIndexBufferBound() bytes to \a buffer and returns the number written, or 0 if \a bufferSize is too small. Triangles may be rotated but keep their winding. Works best on indices optimized for the vertex cache and the vertex fetch.
+CI_API size_t encodeIndexBuffer( uint8_t* buffer, size_t bufferSize, const uint32_t* indices, size_t numIndices );
+//! Decodes \a numIndices indices written by encodeIndexBuffer() to \a dst as 16-bit or 32-bit indices depending on \a indexSize. Returns false if \a buffer is malformed.
+CI_API bool decodeIndexBuffer( void* dst, size_t numIndices, size_t indexSize, const uint8_t* buffer, size_t bufferSize );
+
+//! Returns the largest of \a count indices, 0 if \a count is 0
+CI_API uint32_t calcMaxIndex( const uint32_t* indices, size_t count );
+//! Copies \a count indices lower than 65536 to the 16-bit \a dst
+CI_API void narrowIndices( const uint32_t* indices, size_t count, uint16_t* dst );
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -0,0 +1,161 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/graphics/Mesh.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace cinder { namespace graphics {
+
+//! Allocates ranges of a linear address space. Free ranges are kept sorted by offset and by size, allocations use the smallest free range that fits and released ranges coalesce with their free neighbors.
+class CI_API OffsetAllocator {
+public:
+	static constexpr uint32_t INVALID_OFFSET = ~0u;
+
+	OffsetAllocator( uint32_t size = 0 );
+
+	//! Returns the offset of a range of \a size units, or INVALID_OFFSET if no free range is large enough
+	uint32_t	allocate( uint32_t size );
+	//! Returns the range of \a size units at \a offset to the free list
+	void		release( uint32_t offset, uint32_t size );
+
+	//! Returns the size of the address space
+	uint32_t	getSize() const { return mSize; }
+	//! Returns the number of free units
+	uint32_t	getNumFree() const { return mNumFree; }
+	//! Returns the size of the largest free range
+	uint32_t	getLargestFreeRange() const { return mFreeRangesBySize.empty() ? 0 : mFreeRangesBySize.rbegin()->first; }
+
+protected:
+	void		insertFreeRange( uint32_t offset, uint32_t size );
+	void		eraseFreeRange( std::map<uint32_t, uint32_t>::iterator range );
+
+	//! Free ranges sizes by offset
+	std::map<uint32_t, uint32_t>				mFreeRangesByOffset;
+	//! Free ranges sorted by size then offset
+	std::set<std::pair<uint32_t, uint32_t>>		mFreeRangesBySize;
+	uint32_t							mSize;
+	uint32_t							mNumFree;
+};
+
+typedef std::shared_ptr<class MeshPool> MeshPoolRef;
+
+//! Sub-allocates the vertices and indices of many Meshes from a shared vertex buffer and a shared index buffer. Pooled meshes draw with a base vertex and a first index, so consecutive draws keep the same buffer bindings.
+//! All the meshes of a pool share the same interleaved vertex layout. Ranges are returned to the pool when the last copy of a Mesh is destroyed.
+class CI_API MeshPool : public std::enable_shared_from_this<MeshPool> {
+public:
+	struct CI_API Options {
+	public:
+		Options() : mNumVertices( 1 << 20 ), mNumIndices( 1 << 22 ), mIndexType( VT_UINT32 ), mName( "MeshPool" ) {}
+
+		//! Specifies the capacity of the vertex buffer in vertices. Defaults to 1M vertices.
+		Options& numVertices( uint32_t numVertices ) { mNumVertices = numVertices; return *this; }
+		//! Specifies the capacity of the index buffer in indices. Defaults to 4M indices.
+		Options& numIndices( uint32_t numIndices ) { mNumIndices = numIndices; return *this; }
+		//! Specifies the index type, VT_UINT16 or VT_UINT32. Indices are relative to the base vertex of each mesh, so 16-bit indices only limit meshes to 65536 vertices. Defaults to VT_UINT32.
+		Options& indexType( VALUE_TYPE indexType ) { mIndexType = indexType; return *this; }
+		//! Specifies the name of the pool buffers
+		Options& name( const std::string &name ) { mName = name; return *this; }
+
+	protected:
+		uint32_t	mNumVertices;
+		uint32_t	mNumIndices;
+		VALUE_TYPE	mIndexType;
+		std::string	mName;
+
+		friend class MeshPool;
+	};
+
+	//! Creates a pool of meshes sharing the interleaved vertex \a layout
+	static MeshPoolRef create( const Mesh::BufferInfo &layout, const Options &options = Options() );
+	//! Creates a pool of meshes sharing the interleaved vertex \a layout
+	static MeshPoolRef create( RenderDevice* device, const Mesh::BufferInfo &layout, const Options &options = Options() );
+
+	MeshPool( const MeshPool &other ) = delete;
+	MeshPool& operator=( const MeshPool &other ) = delete;
+
+	//! Loads \a source with the pool layout and uploads it to the pool buffers using the immediate context
+	Mesh createMesh( const geom::Source &source, const Mesh::Optimization &optimization = Mesh::Optimization() );
+	//! Loads \a source with the pool layout and uploads it to the pool buffers using \a context
+	Mesh createMesh( DeviceContext* context, const geom::Source &source, const Mesh::Optimization &optimization = Mesh::Optimization() );
+	//! Uploads \a data to the pool buffers using \a context. \a data must have a single vertex buffer matching the pool layout. Falls back to a standalone Mesh when the pool is full.
+	Mesh createMesh( DeviceContext* context, const Mesh::SourceData &data );
+	//! Uploads \a numVertices vertices matching the pool layout and \a numIndices 32-bit indices to the pool buffers using \a context. Falls back to a standalone Mesh when the pool is full or its 16-bit indices can't address \a numVertices.
+	Mesh createMesh( DeviceContext* context, const void* vertexData, uint32_t numVertices, const uint32_t* indexData, uint32_t numIndices, geom::Primitive primitive = geom::Primitive::TRIANGLES );
+
+	//! Returns the interleaved vertex layout shared by the meshes of the pool
+	const Mesh::BufferInfo&	getLayout() const { return mLayout; }
+	//! Returns the size in bytes of a vertex
+	uint32_t				getVertexStride() const { return mVertexStride; }
+	//! Returns the shared vertex buffer
+	const BufferRef&		getVertexBuffer() const { return mVertexBuffer; }
+	//! Returns the shared index buffer
+	const BufferRef&		getIndexBuffer() const { return mIndexBuffer; }
+	//! Returns the index type of the shared index buffer
+	VALUE_TYPE				getIndexType() const { return mIndexType; }
+	//! Returns the number of vertices that can still be allocated, possibly fragmented
+	uint32_t				getNumFreeVertices() const;
+	//! Returns the number of indices that can still be allocated, possibly fragmented
+	uint32_t				getNumFreeIndices() const;
+
+protected:
+	MeshPool( RenderDevice* device, const Mesh::BufferInfo &layout, const Options &options );
+
+	//! Vertex and index ranges owned by the copies of a pooled Mesh
+	struct Allocation {
+		~Allocation();
+
+		MeshPoolRef	mPool;
+		uint32_t	mVertexOffset;
+		uint32_t	mNumVertices;
+		uint32_t	mIndexOffset;
+		uint32_t	mNumIndices;
+	};
+
+	//! Allocates the vertex and index ranges, returns null if the pool is full
+	std::shared_ptr<Allocation>	allocate( uint32_t numVertices, uint32_t numIndices );
+	//! Uploads the vertices and indices of \a allocation to the pool buffers
+	void						upload( DeviceContext* context, const Allocation &allocation, const void* vertexData, const uint32_t* indexData );
+	//! Returns a Mesh drawing the ranges of \a allocation
+	Mesh						makeMesh( const std::shared_ptr<Allocation> &allocation, geom::Primitive primitive );
+
+	RenderDevice*		mDevice;
+	Mesh::BufferInfo	mLayout;
+	uint32_t			mVertexStride;
+	VALUE_TYPE			mIndexType;
+	BufferRef			mVertexBuffer;
+	BufferRef			mIndexBuffer;
+	mutable std::mutex	mMutex;
+	OffsetAllocator		mVertexAllocator;
+	OffsetAllocator		mIndexAllocator;
+};
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -0,0 +1,129 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/graphics/Mesh.h"
+#include "cinder/graphics/MeshOptimizer.h"
+
+#include <memory>
+
+namespace cinder { namespace graphics {
+
+class ContextStateCache;
+
+typedef std::shared_ptr<class MeshletMesh> MeshletMeshRef;
+
+//! A Mesh split in meshlets, small clusters of triangles with a bounding sphere and a normal cone. A compute pass culls the meshlets against the frustum and the normal cones and compacts the indices of the visible ones, drawn with a single indirect draw.
+//! The compute path only relies on structured and raw buffers and works on every backend. Devices supporting mesh shaders can read the meshlet buffers directly, see drawMeshTasks().
+class CI_API MeshletMesh {
+public:
+	struct CI_API Options {
+	public:
+		Options() : mMaxVertices( 64 ), mMaxTriangles( 124 ), mOptimizeVertexCache( true ), mName( "MeshletMesh" ) {}
+
+		//! Specifies the maximum number of vertices per meshlet, up to 256. Defaults to 64.
+		Options& maxVertices( uint32_t maxVertices ) { mMaxVertices = maxVertices; return *this; }
+		//! Specifies the maximum number of triangles per meshlet. Defaults to 124.
+		Options& maxTriangles( uint32_t maxTriangles ) { mMaxTriangles = maxTriangles; return *this; }
+		//! Specifies whether the triangles are reordered for the vertex cache before being split, which produces fewer and tighter meshlets. Defaults to true.
+		Options& optimizeVertexCache( bool optimize = true ) { mOptimizeVertexCache = optimize; return *this; }
+		//! Specifies the name of the meshlet buffers and pipeline
+		Options& name( const std::string &name ) { mName = name; return *this; }
+
+	protected:
+		uint32_t	mMaxVertices;
+		uint32_t	mMaxTriangles;
+		bool		mOptimizeVertexCache;
+		std::string	mName;
+
+		friend class MeshletMesh;
+	};
+
+	//! Creates the Mesh of \a triMesh with \a bufferInfos and splits its triangles in meshlets
+	static MeshletMeshRef create( const TriMesh &triMesh, const std::vector<Mesh::BufferInfo> &bufferInfos = {}, const Options &options = Options() );
+	//! Creates the Mesh of \a triMesh with \a bufferInfos and splits its triangles in meshlets
+	static MeshletMeshRef create( RenderDevice* device, const TriMesh &triMesh, const std::vector<Mesh::BufferInfo> &bufferInfos = {}, const Options &options = Options() );
+
+	MeshletMesh( const MeshletMesh &other ) = delete;
+	MeshletMesh& operator=( const MeshletMesh &other ) = delete;
+
+	//! Culls the meshlets against the frustum of \a modelViewProjection and the normal cones seen from \a cameraPosition, in object space, using the immediate context
+	void		cull( const mat4 &modelViewProjection, const vec3 &cameraPosition );
+	//! Culls the meshlets against the frustum of \a modelViewProjection and the normal cones seen from \a cameraPosition, in object space, using \a context
+	void		cull( DeviceContext* context, const mat4 &modelViewProjection, const vec3 &cameraPosition );
+	//! Culls the meshlets against the frustum of \a modelViewProjection and the normal cones seen from \a cameraPosition, in object space, on the DeviceContext shadowed by \a stateCache. Binds the culling pipeline, so cull() has to be called before binding the graphics pipeline.
+	void		cull( ContextStateCache* stateCache, const mat4 &modelViewProjection, const vec3 &cameraPosition );
+
+	//! Draws the triangles of the meshlets that passed the last cull() using the immediate context. The graphics pipeline must already be bound.
+	void		draw( const Mesh::DrawAttribs &attribs = {} ) const;
+	//! Draws the triangles of the meshlets that passed the last cull() using \a context. The graphics pipeline must already be bound.
+	void		draw( DeviceContext* context, const Mesh::DrawAttribs &attribs = {} ) const;
+	//! Draws the triangles of the meshlets that passed the last cull() on the DeviceContext shadowed by \a stateCache. Only the vertex buffers flags, transition modes and attribs of \a attribs are used.
+	void		draw( ContextStateCache* stateCache, const Mesh::DrawAttribs &attribs = {} ) const;
+
+	//! Returns whether the device supports mesh shaders, in which case drawMeshTasks() can replace cull() and draw()
+	bool		isMeshShaderSupported() const;
+	//! Dispatches one mesh shader thread group per meshlet. The mesh pipeline must already be bound and read the meshlet buffers.
+	void		drawMeshTasks( DeviceContext* context ) const;
+
+	//! Returns the Mesh holding the vertex buffers and the original index buffer
+	const Mesh&						getMesh() const { return mMesh; }
+	//! Returns the meshlets, in the order of the meshlet buffer
+	const std::vector<Meshlet>&		getMeshlets() const { return mMeshlets; }
+	//! Returns the bounds of the meshlets
+	const std::vector<MeshletBounds>& getMeshletBounds() const { return mMeshletBounds; }
+	//! Returns the number of meshlets
+	uint32_t						getNumMeshlets() const { return static_cast<uint32_t>( mMeshlets.size() ); }
+	//! Returns the structured buffer of meshlets: center, radius, cone axis, cone cutoff, vertex offset, triangle offset, number of vertices and number of triangles
+	const BufferRef&				getMeshletsBuffer() const { return mMeshletsBuffer; }
+	//! Returns the raw buffer of 32-bit vertex indices referenced by the meshlets
+	const BufferRef&				getMeshletVerticesBuffer() const { return mMeshletVerticesBuffer; }
+	//! Returns the raw buffer of triangles, three 8-bit local vertex indices packed in 32 bits
+	const BufferRef&				getMeshletTrianglesBuffer() const { return mMeshletTrianglesBuffer; }
+	//! Returns the 32-bit index buffer written by cull()
+	const BufferRef&				getCulledIndexBuffer() const { return mCulledIndexBuffer; }
+	//! Returns the DrawIndexedIndirect arguments written by cull()
+	const BufferRef&				getDrawArgsBuffer() const { return mDrawArgsBuffer; }
+
+protected:
+	MeshletMesh( RenderDevice* device, const TriMesh &triMesh, const std::vector<Mesh::BufferInfo> &bufferInfos, const Options &options );
+
+	RenderDevice*				mDevice;
+	Mesh						mMesh;
+	std::vector<Meshlet>		mMeshlets;
+	std::vector<MeshletBounds>	mMeshletBounds;
+	BufferRef					mMeshletsBuffer;
+	BufferRef					mMeshletVerticesBuffer;
+	BufferRef					mMeshletTrianglesBuffer;
+	BufferRef					mCulledIndexBuffer;
+	BufferRef					mDrawArgsBuffer;
+	BufferRef					mConstantsBuffer;
+	PipelineStateRef			mPso;
+	ShaderResourceBindingRef	mSrb;
+};
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
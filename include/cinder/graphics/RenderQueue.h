@@ -0,0 +1,166 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/graphics/Batch.h"
+#include "cinder/graphics/ContextStateCache.h"
+#include "cinder/CinderAssert.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace cinder { namespace graphics {
+
+//! Collects Batch and Mesh draws with their per-draw constants, sorts them by pipeline state, shader resources, mesh and depth and records them in parallel on the RendererGx deferred contexts.
+//! Draws must be added from a single thread. The queue keeps raw pointers to the Batches and Meshes until clear() is called.
+class CI_API RenderQueue {
+public:
+	struct CI_API Options {
+	public:
+		Options() : mConstantsSize( 0 ), mConstantsName( "DrawConstants" ), mMaxThreads( ~0u ), mMinDrawsPerThread( 256 ) {}
+
+		//! Specifies the size in bytes of the per-draw constants. Defaults to 0, disabling per-draw constants.
+		Options& constantsSize( uint32_t size ) { mConstantsSize = size; return *this; }
+		//! Specifies the name of the constant buffer the per-draw constants are bound to. The variable has to be mutable or dynamic. Defaults to "DrawConstants".
+		Options& constantsName( const std::string &name ) { mConstantsName = name; return *this; }
+		//! Specifies the maximum number of worker threads. Each worker uses one of the RendererGx deferred contexts. Defaults to all the deferred contexts.
+		Options& maxThreads( uint32_t maxThreads ) { mMaxThreads = maxThreads; return *this; }
+		//! Specifies the minimum number of draws recorded by each thread. Defaults to 256.
+		Options& minDrawsPerThread( uint32_t minDraws ) { mMinDrawsPerThread = minDraws; return *this; }
+
+		using PrepareContextFn = std::function<void( DeviceContext* )>;
+		//! Specifies a function called on every context before recording, for instance to map the dynamic buffers shared by all draws. Called from the worker threads.
+		Options& prepareContextFn( const PrepareContextFn &prepareContextFn ) { mPrepareContextFn = prepareContextFn; return *this; }
+
+	protected:
+		uint32_t			mConstantsSize;
+		std::string			mConstantsName;
+		uint32_t			mMaxThreads;
+		uint32_t			mMinDrawsPerThread;
+		PrepareContextFn	mPrepareContextFn;
+
+		friend class RenderQueue;
+	};
+
+	RenderQueue( const Options &options = Options() );
+	RenderQueue( RenderDevice* device, const Options &options = Options() );
+	~RenderQueue();
+
+	RenderQueue( const RenderQueue &other ) = delete;
+	RenderQueue& operator=( const RenderQueue &other ) = delete;
+
+	//! Adds a draw of every Mesh of \a batch. \a depth is used to sort draws sharing the same state front to back.
+	void add( Batch* batch, float depth = 0.0f, const void* constants = nullptr );
+	//! Adds a draw of \a mesh using \a batch pipeline state and shader resources. \a constants must point to Options::constantsSize bytes, or be null to use zeros.
+	void add( Batch* batch, const Mesh* mesh, const Mesh::DrawAttribs &attribs = Mesh::DrawAttribs(), float depth = 0.0f, const void* constants = nullptr );
+	//! Adds a draw of \a mesh using \a batch pipeline state and shader resources with \a constants as per-draw constants.
+	template<typename T>
+	void add( Batch* batch, const Mesh* mesh, const T &constants, float depth = 0.0f, const Mesh::DrawAttribs &attribs = Mesh::DrawAttribs() ) { CI_ASSERT( sizeof( T ) == mOptions.mConstantsSize ); add( batch, mesh, attribs, depth, &constants ); }
+
+	//! Sorts the draws. Called by submit() if needed.
+	void sort();
+	//! Records and executes the draws, rendering to the swap chain back buffer
+	void submit();
+	//! Records and executes the draws, rendering to \a renderTarget and \a depthStencil
+	void submit( TextureView* renderTarget, TextureView* depthStencil );
+	//! Removes all the draws
+	void clear();
+
+	//! Returns the number of draws in the queue
+	size_t		getNumDraws() const { return mDraws.size(); }
+	//! Returns the dynamic buffer the per-draw constants are written to
+	BufferRef	getConstantsBuffer() const { return mConstantsBuffer; }
+
+	//! Sort key and index of a draw
+	struct SortItem {
+		uint64_t			key;
+		uint32_t			index;
+	};
+	//! Stable LSD radix sort of \a items by key, \a scratch is resized and used as the ping-pong buffer
+	static void	radixSort( std::vector<SortItem> &items, std::vector<SortItem> &scratch );
+
+protected:
+	struct Draw {
+		Batch*				batch;
+		const Mesh*			mesh;
+		Mesh::DrawAttribs	attribs;
+		uint32_t			constantsOffset;
+	};
+	struct Worker {
+		std::thread			thread;
+		DeviceContext*		context;
+		ContextStateCache*	stateCache;
+		CommandListRef		commandList;
+		size_t				begin;
+		size_t				end;
+	};
+
+	//! Returns the id of \a key in \a ids, appending \a object to \a objects the first time \a key is seen
+	template<typename T>
+	static uint16_t getId( std::unordered_map<const void*, uint16_t> &ids, const void* key, std::vector<T*> &objects, T* object );
+	//! Transitions the resources to the states expected by the recording threads and binds the constants buffer
+	void prepare( DeviceContext* context );
+	//! Records the sorted draws in [begin, end) on the context shadowed by \a stateCache
+	void record( ContextStateCache* stateCache, size_t begin, size_t end, TextureView* renderTarget, TextureView* depthStencil );
+	void startWorkers( size_t numWorkers );
+	void stopWorkers();
+	void workerLoop( Worker* worker, uint64_t frame );
+
+	Options								mOptions;
+	RenderDevice*						mDevice;
+	BufferRef							mConstantsBuffer;
+	std::vector<Draw>					mDraws;
+	std::vector<SortItem>				mSortItems;
+	std::vector<SortItem>				mSortScratch;
+	std::vector<uint8_t>				mConstants;
+	bool								mSorted;
+
+	std::unordered_map<const void*, uint16_t>	mPipelineIds;
+	std::unordered_map<const void*, uint16_t>	mSrbIds;
+	std::unordered_map<const void*, uint16_t>	mMeshIds;
+	std::vector<PipelineState*>			mPipelines;
+	std::vector<Batch*>					mBatches;
+	std::vector<const Mesh*>			mMeshes;
+	std::vector<StateTransitionDesc>	mBarriers;
+	std::vector<CommandList*>			mCommandLists;
+
+	std::vector<std::unique_ptr<Worker>>	mWorkers;
+	std::mutex							mWorkersMutex;
+	std::condition_variable				mWorkersCondition;
+	std::condition_variable				mWorkersDoneCondition;
+	uint64_t							mRecordFrame;
+	uint64_t							mFinishFrame;
+	size_t								mNumWorkersDone;
+	bool								mStopWorkers;
+	TextureView*						mRenderTarget;
+	TextureView*						mDepthStencil;
+};
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -0,0 +1,139 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/graphics/Mesh.h"
+
+#include <memory>
+
+namespace cinder { namespace graphics {
+
+class ContextStateCache;
+
+typedef std::shared_ptr<class SkinnedMesh> SkinnedMeshRef;
+
+//! Skins a Mesh on the GPU. A compute pass blends the bind pose positions and normals with the morph targets, transforms them by up to four bone matrices per vertex and writes them to a vertex buffer that replaces them when drawing getMesh(), for instance with a Batch.
+//! The pass only runs when the bone matrices or the morph weights changed since the last update(). Instances created with createInstance() share the source mesh, the morph targets and the skinning pipeline.
+class CI_API SkinnedMesh {
+public:
+	struct CI_API Options {
+	public:
+		Options() : mBoneIndicesAttrib( geom::Attrib::BONE_INDEX ), mBoneWeightsAttrib( geom::Attrib::BONE_WEIGHT ), mMaxBones( 256 ), mName( "SkinnedMesh" ) {}
+
+		//! Specifies the attribute holding up to four bone indices per vertex, stored as floats or 32-bit integers. Defaults to geom::Attrib::BONE_INDEX.
+		Options& boneIndicesAttrib( geom::Attrib attrib ) { mBoneIndicesAttrib = attrib; return *this; }
+		//! Specifies the attribute holding the float weights of the bones. Defaults to geom::Attrib::BONE_WEIGHT.
+		Options& boneWeightsAttrib( geom::Attrib attrib ) { mBoneWeightsAttrib = attrib; return *this; }
+		//! Specifies the capacity of the bone matrices buffer. Defaults to 256.
+		Options& maxBones( uint32_t maxBones ) { mMaxBones = maxBones; return *this; }
+		//! Appends a morph target, one position delta and optionally one normal delta per vertex of the mesh
+		Options& morphTarget( const std::vector<vec3> &positionDeltas, const std::vector<vec3> &normalDeltas = {} ) { mMorphTargets.push_back( { positionDeltas, normalDeltas } ); return *this; }
+		//! Specifies the name of the skinning buffers and pipeline
+		Options& name( const std::string &name ) { mName = name; return *this; }
+
+	protected:
+		geom::Attrib	mBoneIndicesAttrib;
+		geom::Attrib	mBoneWeightsAttrib;
+		uint32_t		mMaxBones;
+		std::vector<std::pair<std::vector<vec3>, std::vector<vec3>>> mMorphTargets;
+		std::string		mName;
+
+		friend class SkinnedMesh;
+	};
+
+	//! Creates the skinning pass of \a mesh. The buffers holding the positions, normals, bone indices and bone weights must be raw buffers bound as shader resources, and these attributes must be stored as FLOAT32.
+	//! Buffers also holding other attributes, such as texture coordinates, are drawn from and must be bound as vertex buffers too, for instance with Mesh::BufferInfo().mode( BUFFER_MODE_RAW ).bindFlags( BIND_VERTEX_BUFFER | BIND_SHADER_RESOURCE ).
+	//! Buffers only holding skinned attributes can use Mesh::BufferInfo::vertexPulling( BUFFER_MODE_RAW ).
+	static SkinnedMeshRef create( const Mesh &mesh, const Options &options = Options() );
+	//! Creates the skinning pass of \a mesh on \a device, see create( const Mesh&, const Options& ) for the requirements on the mesh buffers.
+	static SkinnedMeshRef create( RenderDevice* device, const Mesh &mesh, const Options &options = Options() );
+
+	SkinnedMesh( const SkinnedMesh &other ) = delete;
+	SkinnedMesh& operator=( const SkinnedMesh &other ) = delete;
+
+	//! Creates a SkinnedMesh with its own pose and output buffer, sharing the source mesh, the morph targets and the skinning pipeline of this one
+	SkinnedMeshRef	createInstance() const;
+
+	//! Sets the bone matrices, transforming the bind pose to the pose of the mesh. Matrices identical to the previous ones don't trigger a new skinning pass. Normals are transformed by the inverse transpose of each matrix and may use non-uniform scales.
+	void			setBoneMatrices( const std::vector<mat4> &matrices );
+	//! Sets \a count bone matrices, transforming the bind pose to the pose of the mesh. Matrices identical to the previous ones don't trigger a new skinning pass.
+	void			setBoneMatrices( const mat4* matrices, size_t count );
+	//! Sets the weights of the morph targets, in the order they were added to the Options
+	void			setMorphWeights( const std::vector<float> &weights );
+
+	//! Skins the mesh using the immediate context if the pose changed since the last update. Returns whether the skinning pass ran.
+	bool			update();
+	//! Skins the mesh using \a context if the pose changed since the last update. Returns whether the skinning pass ran.
+	bool			update( DeviceContext* context );
+	//! Skins the mesh on the DeviceContext shadowed by \a stateCache if the pose changed since the last update. Binds the skinning pipeline, so update() has to be called before binding the graphics pipeline.
+	bool			update( ContextStateCache* stateCache );
+
+	//! Returns the Mesh drawing the skinned positions and normals, at input indices 0 and 1, followed by the attributes of the source mesh other than the bone indices and weights. Its bounds are empty so that it is never culled.
+	const Mesh&			getMesh() const { return mMesh; }
+	//! Returns the source Mesh in bind pose
+	const Mesh&			getSourceMesh() const { return mShared->sourceMesh; }
+	//! Returns the vertex buffer written by the skinning pass, an interleaved float3 position followed by a float3 normal when the source mesh has normals
+	const BufferRef&	getOutputBuffer() const { return mOutputBuffer; }
+	//! Returns the number of morph targets
+	uint32_t			getNumMorphTargets() const { return mShared->numMorphTargets; }
+
+protected:
+	//! State shared by the instances of a SkinnedMesh
+	struct Shared {
+		RenderDevice*		device = nullptr;
+		Mesh				sourceMesh;
+		std::vector<std::pair<Mesh::BufferInfo, BufferRef>> drawBuffers;
+		Mesh::BufferInfo	outputInfo;
+		BufferRef			constantsBuffer;
+		BufferRef			morphDeltasBuffer;
+		BufferView*			positionsView = nullptr;
+		BufferView*			normalsView = nullptr;
+		BufferView*			boneIndicesView = nullptr;
+		BufferView*			boneWeightsView = nullptr;
+		PipelineStateRef	pso;
+		uint32_t			numMorphTargets = 0;
+		uint32_t			maxBones = 0;
+		std::string			name;
+	};
+
+	SkinnedMesh( RenderDevice* device, const Mesh &mesh, const Options &options );
+	SkinnedMesh( const std::shared_ptr<Shared> &shared );
+	//! Creates the output and pose buffers of this instance and binds them with the shared resources
+	void			createInstanceResources();
+
+	std::shared_ptr<Shared>		mShared;
+	Mesh						mMesh;
+	BufferRef					mOutputBuffer;
+	BufferRef					mBonesBuffer;
+	BufferRef					mMorphWeightsBuffer;
+	ShaderResourceBindingRef	mSrb;
+	std::vector<mat4>			mBoneMatrices;
+	std::vector<float>			mMorphWeights;
+	bool						mPoseChanged = true;
+};
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
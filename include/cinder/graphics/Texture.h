@@ -43,6 +43,9 @@ namespace cinder { namespace graphics {
 
 //! Texture description
 struct CI_API TextureDesc : public Diligent::TextureDesc {
+    //! Filter used to generate the mip chain at load time. BOX averages 2x2 texels, KAISER and LANCZOS are sharper windowed sinc filters.
+    enum class MipFilter { BOX, KAISER, LANCZOS };
+
     //! Texture type. See Diligent::RESOURCE_DIMENSION for details.
     TextureDesc& type( RESOURCE_DIMENSION type ) { Type = type; return *this; }
     //! Texture width and height, in pixels.
@@ -82,6 +85,11 @@ struct CI_API TextureDesc : public Diligent::TextureDesc {
     TextureDesc& srgb( bool srgb ) { mSrgb = srgb; return *this; }
     //! Specifies whether a mip chain needs to be created at load time. Ignored when creating the texture with raw data
     TextureDesc& generateMips( bool mips ) { mGenerateMips = mips; return *this; }
+    //! Specifies the filter used to generate the mip chain at load time. sRGB data is always filtered in linear space. Defaults to MipFilter::BOX.
+    TextureDesc& mipFilter( MipFilter filter ) { mMipFilter = filter; return *this; }
+    //! Specifies a DeviceContext that generates the mip chain instead of the CPU, nullptr keeps the CPU path. Only mip 0 is uploaded, formats that can't be filtered and rendered keep the CPU path. Adds BIND_RENDER_TARGET and MISC_TEXTURE_FLAG_GENERATE_MIPS to the texture.
+    //! The upload and mip generation are recorded on \a context by the loading thread: pass the immediate context only when loading on the main thread, and a deferred context owned by the loading thread otherwise.
+    TextureDesc& generateMipsOnGpu( DeviceContext* context ) { mGenerateMipsContext = context; return *this; }
 
     TextureDesc();
     TextureDesc( const TextureDesc &other );
@@ -95,6 +103,12 @@ struct CI_API TextureDesc : public Diligent::TextureDesc {
     bool isSrgb() const { return mSrgb; }
     //! Returns whether a mip chain needs to be created. 
     bool needsGenerateMips() const { return mGenerateMips; }
+    //! Returns the filter used to generate the mip chain.
+    MipFilter getMipFilter() const { return mMipFilter; }
+    //! Returns whether the mip chain is generated on the GPU.
+    bool needsGenerateMipsOnGpu() const { return mGenerateMipsContext != nullptr; }
+    //! Returns the DeviceContext generating the mip chain, or nullptr when it is generated on the CPU.
+    DeviceContext* getGenerateMipsContext() const { return mGenerateMipsContext; }
     //! Returns whether a mip chain needs to be created. 
     bool isUsageDefault() const { return mDefaultUsage; }
     //! Returns whether a mip chain needs to be created. 
@@ -104,10 +118,12 @@ protected:
     void swap( TextureDesc &other ) noexcept;
 
     std::string mName;
-    bool        mSrgb;
-    bool        mGenerateMips;
-    bool        mDefaultUsage;
-    bool        mDefaultMips;
+    bool        mSrgb = true;
+    bool        mGenerateMips = true;
+    bool        mDefaultUsage = true;
+    bool        mDefaultMips = true;
+    DeviceContext* mGenerateMipsContext = nullptr;
+    MipFilter   mMipFilter = MipFilter::BOX;
 };
 
 //! Constructs a Texture based on the contents of \a data.
@@ -126,9 +142,9 @@ CI_API TextureRef createTexture( const Surface32f &surface, const TextureDesc &d
 CI_API TextureRef createTexture( const Channel32f &channel, const TextureDesc &desc = TextureDesc() );
 //! Constructs a Texture based on \a imageSource using the default RenderDevice.
 CI_API TextureRef createTexture( ImageSourceRef imageSource, const TextureDesc &desc = TextureDesc() );
-//! Constructs a Texture from an optionally compressed KTX file using the default RenderDevice.
+//! Constructs a Texture from an optionally compressed KTX or KTX2 file using the default RenderDevice. See the RenderDevice overload for KTX2 support.
 CI_API TextureRef createTextureFromKtx( const DataSourceRef &dataSource, const TextureDesc &desc = TextureDesc() );
-//! Constructs a Texture from a DDS file using the default RenderDevice. Supports DXT1, DTX3, and DTX5. Supports BC7 in the presence of \c GL_ARB_texture_compression_bptc.
+//! Constructs a Texture from a DDS file using the default RenderDevice. Supports legacy and DX10 headers, mips, arrays, cubemaps and volumes. Subresources are uploaded straight from \a dataSource's buffer.
 CI_API TextureRef createTextureFromDds( const DataSourceRef &dataSource, const TextureDesc &desc = TextureDesc() );
 //! Automatically infers Horizontal Cross, Vertical Cross, Row, or Column based on image aspect ratio
 CI_API TextureRef createTextureCubeMap( const ImageSourceRef &imageSource, const TextureDesc &desc = TextureDesc() );
@@ -151,15 +167,31 @@ CI_API TextureRef createTexture( RenderDevice* device, const Surface32f &surface
 CI_API TextureRef createTexture( RenderDevice* device, const Channel32f &channel, const TextureDesc &desc = TextureDesc() );
 //! Constructs a Texture based on \a imageSource.
 CI_API TextureRef createTexture( RenderDevice* device, ImageSourceRef imageSource, const TextureDesc &desc = TextureDesc() );
-//! Constructs a Texture from an optionally compressed KTX file.
+//! Constructs a Texture from an optionally compressed KTX or KTX2 file. zstd supercompression requires the \c CINDER_GX_WITH_ZSTD CMake option, Basis Universal ETC1S/UASTC files require \c CINDER_GX_WITH_BASISU and are transcoded in parallel to BC1/BC7, or RGBA8 without BC support.
 CI_API TextureRef createTextureFromKtx( RenderDevice* device, const DataSourceRef &dataSource, const TextureDesc &desc = TextureDesc() );
-//! Constructs a Texture from a DDS file. Supports DXT1, DTX3, and DTX5. Supports BC7 in the presence of \c GL_ARB_texture_compression_bptc.
+//! Constructs a Texture from a DDS file. Supports legacy and DX10 headers, mips, arrays, cubemaps and volumes. Subresources are uploaded straight from \a dataSource's buffer.
 CI_API TextureRef createTextureFromDds( RenderDevice* device, const DataSourceRef &dataSource, const TextureDesc &desc = TextureDesc() );
 //! Automatically infers Horizontal Cross, Vertical Cross, Row, or Column based on image aspect ratio
 CI_API TextureRef createTextureCubeMap( RenderDevice* device, const ImageSourceRef &imageSource, const TextureDesc &desc = TextureDesc() );
 //! Expects images ordered { +X, -X, +Y, -Y, +Z, -Z }
 CI_API TextureRef createTextureCubeMap( RenderDevice* device, const ImageSourceRef images[6], const TextureDesc &desc = TextureDesc() );
 
+//! Texture description and subresources of a texture file parsed without a RenderDevice, ordered as createTexture expects them.
+struct CI_API TextureSourceData {
+    TextureDesc                         desc;
+    std::vector<TextureSubResData>      subresources;
+    //! Decompressed or transcoded texel data the subresources point into, empty when they point into the file.
+    std::vector<std::vector<uint8_t>>   storage;
+};
+
+//! Parses the DDS file \a data of \a dataSize bytes, as createTextureFromDds does. The subresources point into \a data, which has to outlive the result. Throws TextureDataExc if the file is invalid, truncated or in an unsupported format.
+CI_API TextureSourceData parseDds( const void* data, size_t dataSize, const TextureDesc &desc = TextureDesc() );
+//! Parses the KTX2 file \a data of \a dataSize bytes, as createTextureFromKtx does. Uncompressed subresources point into \a data, which has to outlive the result, zstd levels are inflated and Basis Universal files transcoded into the result's storage, to BC1/BC7 or RGBA8 without \a supportsBC. Throws TextureDataExc if the file is invalid, truncated or in an unsupported format.
+CI_API TextureSourceData parseKtx2( const void* data, size_t dataSize, const TextureDesc &desc = TextureDesc(), bool supportsBC = true );
+
+//! Filters the \a srcWidth by \a srcHeight level \a src into the next mip level \a dst of max( srcWidth / 2, 1 ) by max( srcHeight / 2, 1 ) texels on the default ThreadPool, as the texture loaders do. Odd sizes clamp the last column and row of the box filter and sRGB texels are filtered in linear space.
+//! Returns false if \a format isn't an R, RG or RGBA 8-bit unorm, 16-bit unorm or 32-bit float format, or RGBA8 sRGB.
+CI_API bool generateMipLevel( const void* src, uint32_t srcStride, uint32_t srcWidth, uint32_t srcHeight, void* dst, uint32_t dstStride, TEXTURE_FORMAT format, TextureDesc::MipFilter filter = TextureDesc::MipFilter::BOX );
 
 class CI_API TextureDataExc : public Exception {
 public:
@@ -0,0 +1,86 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Export.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cinder { namespace graphics {
+
+//! Fixed set of worker threads executing tasks in submission order. Used for CPU work that doesn't touch a DeviceContext, such as geometry loading or mip generation.
+class CI_API ThreadPool {
+public:
+	//! Starts \a numThreads workers. Defaults to one less than the number of hardware threads, leaving one for the main thread.
+	explicit ThreadPool( size_t numThreads = 0 );
+	//! Finishes the pending tasks and joins the workers
+	~ThreadPool();
+
+	ThreadPool( const ThreadPool &other ) = delete;
+	ThreadPool& operator=( const ThreadPool &other ) = delete;
+
+	//! Queues \a fn and returns a future holding its result or the exception it threw
+	template<typename Fn>
+	auto submit( Fn &&fn ) -> std::future<decltype( fn() )>;
+
+	//! Returns the number of worker threads
+	size_t getNumThreads() const { return mThreads.size(); }
+	//! Returns whether the calling thread is one of the workers
+	bool isWorkerThread() const;
+
+	//! Returns the pool shared by the graphics module, created on first use
+	static ThreadPool& getDefault();
+
+protected:
+	void workerLoop();
+	void push( std::function<void()> &&task );
+
+	std::vector<std::thread>			mThreads;
+	std::deque<std::function<void()>>	mTasks;
+	std::mutex							mMutex;
+	std::condition_variable				mCondition;
+	bool								mStop;
+};
+
+template<typename Fn>
+auto ThreadPool::submit( Fn &&fn ) -> std::future<decltype( fn() )>
+{
+	// std::function requires copyable callables, hence the shared packaged_task
+	auto task = std::make_shared<std::packaged_task<decltype( fn() )()>>( std::forward<Fn>( fn ) );
+	auto future = task->get_future();
+	push( [task]() { ( *task )(); } );
+	return future;
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
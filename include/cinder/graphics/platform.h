@@ -57,4 +57,12 @@
 	#endif
 #elif defined( CINDER_MAC )
 	#define PLATFORM_MACOS 1
-#endif
\ No newline at end of file
+#endif
+
+// SIMD instruction sets used by the cpu-side vertex and image processing
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+	#define CINDER_GX_SSE2 1
+#endif
+#if defined( __F16C__ ) || defined( __AVX2__ )
+	#define CINDER_GX_F16C 1
+#endif
@@ -96,7 +96,7 @@ CI_API void commitShaderResources( ShaderResourceBinding* shaderResourceBinding,
 CI_API void setStencilRef( uint32_t StencilRef);
 //! \param [in] pBlendFactors - Array of four blend factors, one for each RGBA component. 
 CI_API void setBlendFactors( const float* pBlendFactors = nullptr );
-//! Invalidates the cached context state.
+//! Invalidates the cached context state, including the immediate context ContextStateCache.
 CI_API void invalidateState();
 
 //! Binds vertex buffers to the pipeline.
@@ -167,6 +167,34 @@ struct DrawIndexedAttribs : public Diligent::DrawIndexedAttribs {
 
 //! Executes an indexed draw command
 CI_API void drawIndexed( const Diligent::DrawIndexedAttribs &attribs );
+
+//! Defines the indexed indirect draw command attributes.
+struct DrawIndexedIndirectAttribs : public Diligent::DrawIndexedIndirectAttribs {
+    //! A pointer to the buffer, from which indirect draw attributes will be read.
+    DrawIndexedIndirectAttribs& attribsBuffer( Buffer* buffer ) { pAttribsBuffer = buffer; return *this; }
+    //! Offset from the beginning of the buffer to the location of draw command attributes.
+    DrawIndexedIndirectAttribs& drawArgsOffset( uint64_t offset ) { DrawArgsOffset = offset; return *this; }
+    //! The type of the elements in the index buffer. Allowed values: VT_UINT16 and VT_UINT32.
+    DrawIndexedIndirectAttribs& indexType( VALUE_TYPE indexType ) { IndexType = indexType; return *this; }
+    //! Additional flags, see Diligent::DRAW_FLAGS.
+    DrawIndexedIndirectAttribs& flags( DRAW_FLAGS flags ) { Flags = flags; return *this; }
+    //! The number of draws to execute, or the maximum number of draws if a counter buffer is used.
+    DrawIndexedIndirectAttribs& drawCount( uint32_t drawCount ) { DrawCount = drawCount; return *this; }
+    //! When DrawCount > 1, the byte stride between successive sets of draw parameters.
+    DrawIndexedIndirectAttribs& drawArgsStride( uint32_t drawArgsStride ) { DrawArgsStride = drawArgsStride; return *this; }
+    //! State transition mode for the indirect draw arguments buffer.
+    DrawIndexedIndirectAttribs& attribsBufferStateTransitionMode( RESOURCE_STATE_TRANSITION_MODE mode ) { AttribsBufferStateTransitionMode = mode; return *this; }
+    //! A pointer to the optional buffer from which the number of draws will be read.
+    DrawIndexedIndirectAttribs& counterBuffer( Buffer* buffer ) { pCounterBuffer = buffer; return *this; }
+    //! Offset from the beginning of the counter buffer to the location of the draw count.
+    DrawIndexedIndirectAttribs& counterOffset( uint64_t offset ) { CounterOffset = offset; return *this; }
+    //! State transition mode for the counter buffer.
+    DrawIndexedIndirectAttribs& counterBufferStateTransitionMode( RESOURCE_STATE_TRANSITION_MODE mode ) { CounterBufferStateTransitionMode = mode; return *this; }
+
+    /// Initializes the structure members with default values.
+    DrawIndexedIndirectAttribs() noexcept : Diligent::DrawIndexedIndirectAttribs() {}
+};
+
 //! Executes an indexed indirect draw command
 CI_API void drawIndexedIndirect( const Diligent::DrawIndexedIndirectAttribs &attribs );
 //! Executes a mesh draw command
@@ -0,0 +1,153 @@
+#include "cinder/app/App.h"
+#include "cinder/app/RendererGx.h"
+
+#include "cinder/graphics/wrapper.h"
+#include "cinder/graphics/Batch.h"
+#include "cinder/graphics/PipelineState.h"
+#include "cinder/graphics/SkinnedMesh.h"
+#include "cinder/graphics/Texture.h"
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+//! Bends a textured tube with two bones. The texture coordinates are drawn straight from the source buffer while the
+//! positions and normals come from the skinning pass, which requires the source buffer to be both a raw shader resource
+//! and a vertex buffer.
+class SkinnedMeshApp : public App {
+public:
+    void setup() override;
+    void update() override;
+    void draw() override;
+
+    gx::Mesh createTube();
+
+    gx::SkinnedMeshRef  mSkinnedMesh;
+    gx::Batch           mBatch;
+    gx::BufferRef       mConstants;
+    mat4                mWorld;
+    mat4                mWorldViewProj;
+};
+
+void SkinnedMeshApp::setup()
+{
+    mSkinnedMesh = gx::SkinnedMesh::create( createTube(), gx::SkinnedMesh::Options().maxBones( 2 ) );
+
+    mConstants = gx::createBuffer( gx::BufferDesc()
+        .name( "VS constants CB" )
+        .size( 2 * sizeof( mat4 ) )
+        .usage( gx::USAGE_DYNAMIC )
+        .bindFlags( gx::BIND_UNIFORM_BUFFER )
+        .cpuAccessFlags( gx::CPU_ACCESS_WRITE )
+    );
+
+    // the input layout is taken from the skinned mesh: position, normal and texture coordinates
+    mBatch = gx::Batch( mSkinnedMesh->getMesh(), gx::GraphicsPipelineCreateInfo()
+        .name( "Skinned Tube PSO" )
+        .vertexShader( gx::ShaderCreateInfo()
+            .name( "Skinned Tube VS" )
+            .sourceLanguage( gx::SHADER_SOURCE_LANGUAGE_HLSL )
+            .useCombinedTextureSamplers( true )
+            .filePath( getAssetPath( "skinned.vsh" ) )
+        )
+        .pixelShader( gx::ShaderCreateInfo()
+            .name( "Skinned Tube PS" )
+            .sourceLanguage( gx::SHADER_SOURCE_LANGUAGE_HLSL )
+            .useCombinedTextureSamplers( true )
+            .filePath( getAssetPath( "skinned.psh" ) )
+        )
+        .variables( { { gx::SHADER_TYPE_PIXEL, "g_Texture", gx::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE } } )
+        .immutableSamplers( { { gx::SHADER_TYPE_PIXEL, "g_Texture", Diligent::SamplerDesc() } } )
+    );
+    mBatch.getStaticVariable( gx::SHADER_TYPE_VERTEX, "Constants" )->Set( mConstants );
+
+    // checkerboard making the texture coordinates visible
+    Surface8u checker( 256, 256, false );
+    for( int y = 0; y < checker.getHeight(); ++y ) {
+        for( int x = 0; x < checker.getWidth(); ++x ) {
+            checker.setPixel( ivec2( x, y ), ( x / 32 + y / 32 ) % 2 ? Color8u( 230, 120, 40 ) : Color8u( 240, 240, 240 ) );
+        }
+    }
+    gx::TextureRef texture = gx::createTexture( checker );
+    mBatch.setVariable( gx::SHADER_TYPE_PIXEL, "g_Texture", texture->GetDefaultView( gx::TEXTURE_VIEW_SHADER_RESOURCE ) );
+}
+
+gx::Mesh SkinnedMeshApp::createTube()
+{
+    struct Vertex {
+        vec3 position;
+        vec3 normal;
+        vec2 uv;
+        vec2 boneIndices;
+        vec2 boneWeights;
+    };
+
+    const int numSegments = 32;
+    const int numRings = 24;
+    const float radius = 0.4f;
+    const float height = 4.0f;
+
+    // the bottom half follows bone 0 and the top half bone 1, blending around the pivot at the origin
+    vector<Vertex> vertices;
+    for( int ring = 0; ring <= numRings; ++ring ) {
+        const float v = ring / float( numRings );
+        const float y = ( v - 0.5f ) * height;
+        const float weight = glm::smoothstep( -0.5f, 0.5f, y );
+        for( int segment = 0; segment <= numSegments; ++segment ) {
+            const float u = segment / float( numSegments );
+            const vec3 normal( glm::cos( u * glm::two_pi<float>() ), 0.0f, glm::sin( u * glm::two_pi<float>() ) );
+            vertices.push_back( { normal * radius + vec3( 0.0f, y, 0.0f ), normal, vec2( u * 2.0f, v * 4.0f ), vec2( 0.0f, 1.0f ), vec2( 1.0f - weight, weight ) } );
+        }
+    }
+
+    vector<uint32_t> indices;
+    for( int ring = 0; ring < numRings; ++ring ) {
+        for( int segment = 0; segment < numSegments; ++segment ) {
+            const uint32_t i0 = ring * ( numSegments + 1 ) + segment;
+            const uint32_t i1 = i0 + numSegments + 1;
+            indices.insert( indices.end(), { i0, i1, i0 + 1, i0 + 1, i1, i1 + 1 } );
+        }
+    }
+
+    // the skinning pass reads the raw buffer as a shader resource, the texture coordinates are drawn from it as a vertex buffer
+    const gx::Mesh::BufferInfo bufferInfo = gx::Mesh::BufferInfo()
+        .attrib( geom::Attrib::POSITION, 3, sizeof( Vertex ), offsetof( Vertex, position ) )
+        .attrib( geom::Attrib::NORMAL, 3, sizeof( Vertex ), offsetof( Vertex, normal ) )
+        .attrib( geom::Attrib::TEX_COORD_0, 2, sizeof( Vertex ), offsetof( Vertex, uv ) )
+        .attrib( geom::Attrib::BONE_INDEX, 2, sizeof( Vertex ), offsetof( Vertex, boneIndices ) )
+        .attrib( geom::Attrib::BONE_WEIGHT, 2, sizeof( Vertex ), offsetof( Vertex, boneWeights ) )
+        .mode( gx::BUFFER_MODE_RAW )
+        .bindFlags( gx::BIND_VERTEX_BUFFER | gx::BIND_SHADER_RESOURCE );
+
+    return gx::Mesh( vertices.data(), static_cast<uint32_t>( vertices.size() * sizeof( Vertex ) ), bufferInfo, static_cast<uint32_t>( indices.size() ), indices.data(), gx::VT_UINT32 );
+}
+
+void SkinnedMeshApp::update()
+{
+    // bone 1 bends the top half of the tube back and forth
+    const mat4 bones[2] = { mat4( 1.0f ), glm::rotate( glm::sin( (float) getElapsedSeconds() ) * 1.2f, vec3( 0.0f, 0.0f, 1.0f ) ) };
+    mSkinnedMesh->setBoneMatrices( bones, 2 );
+
+    mWorld = glm::rotate( (float) getElapsedSeconds() * 0.3f, vec3( 0.0f, 1.0f, 0.0f ) );
+    mat4 view = glm::lookAt( vec3( 0.0f, 0.0f, 8.0f ), vec3( 0.0f ), vec3( 0.0f, 1.0f, 0.0f ) );
+    mat4 proj = glm::perspective( glm::pi<float>() / 4.0f, getWindowAspectRatio(), 0.1f, 100.f );
+    mWorldViewProj = proj * view * mWorld;
+}
+
+void SkinnedMeshApp::draw()
+{
+    gx::clear( ColorA( 0.350f, 0.350f, 0.350f, 1.0f ) );
+
+    // the skinning pass binds its compute pipeline, so it runs before the batch binds its graphics pipeline
+    mSkinnedMesh->update();
+
+    {
+        gx::MapHelper<mat4> constants( getImmediateContext(), mConstants, gx::MAP_WRITE, gx::MAP_FLAG_DISCARD );
+        constants[0] = glm::transpose( mWorldViewProj );
+        constants[1] = glm::transpose( mWorld );
+    }
+
+    mBatch.draw();
+}
+
+CINDER_APP( SkinnedMeshApp, RendererGx )
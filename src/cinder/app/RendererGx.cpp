@@ -24,6 +24,7 @@
 #include "cinder/app/RendererGx.h"
 #include "cinder/Log.h"
 #include "cinder/Breakpoint.h"
+#include "cinder/CinderAssert.h"
 
 #if defined( CINDER_MSW )
 #include "cinder/app/msw/AppImplMsw.h"
@@ -401,6 +402,11 @@ void RendererGx::initializeDiligentEngine( const Diligent::NativeWindow* pWindow
     for( Uint32 ctx = 0; ctx < NumDeferredCtx; ++ctx )
         mDeferredContexts[ctx].Attach( ppContexts[1 + ctx] );
 
+    // the immediate context cache is always first, followed by the deferred contexts ones
+    mContextStateCaches.push_back( make_shared<gx::ContextStateCache>( mImmediateContext ) );
+    for( auto &context : mDeferredContexts )
+        mContextStateCaches.push_back( make_shared<gx::ContextStateCache>( context ) );
+
     //if( mScreenCaptureInfo.AllowCapture ) {
     //    if( mGoldenImgMode != GoldenImageMode::None ) {
     //        // Capture only one frame
@@ -424,6 +430,21 @@ gx::ShaderSourceInputStreamFactory* RendererGx::getDefaultShaderSourceStreamFact
     return mShaderSourceInputStreamFactory;
 }
 
+gx::ContextStateCache* RendererGx::getContextStateCache( gx::DeviceContext* context )
+{
+    for( auto &cache : mContextStateCaches ) {
+        if( cache->getContext() == context )
+            return cache.get();
+    }
+    return nullptr;
+}
+
+void RendererGx::invalidateContextStateCaches()
+{
+    for( auto &cache : mContextStateCaches )
+        cache->invalidate();
+}
+
 HWND RendererGx::getHwnd() const
 {
 	return mWindowImpl->getHwnd();
@@ -436,6 +457,7 @@ HDC RendererGx::getDc() const
 
 RendererGx::~RendererGx()
 {
+    mContextStateCaches.clear();
     if( ! mDeferredContexts.empty() ) {
         for( auto &context : mDeferredContexts ) {
             context->Flush();
@@ -487,6 +509,9 @@ void RendererGx::startDraw()
     if( ! mImmediateContext || ! mSwapChain )
         return;
 
+    // anything might have been bound directly on the contexts since the last frame
+    invalidateContextStateCaches();
+
     ITextureView* pRTV = mSwapChain->GetCurrentBackBufferRTV();
     ITextureView* pDSV = mSwapChain->GetDepthBufferDSV();
     mImmediateContext->SetRenderTargets( 1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
@@ -22,9 +22,20 @@
 */
 
 #include "cinder/graphics/Batch.h"
+#include "cinder/graphics/GpuCulling.h"
 #include "cinder/graphics/wrapper.h"
 #include "cinder/app/RendererGx.h"
 
+#include "cinder/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined( CINDER_GX_SSE2 )
+	#include <emmintrin.h>
+#endif
+
 using namespace std;
 using namespace ci::app;
 
@@ -60,7 +71,30 @@ Batch::Batch( const std::vector<Mesh> &meshes, const GraphicsPipelineCreateInfo
 {
 }
 
+Batch::Batch( const Mesh &mesh, const Mesh::BufferInfo &instanceLayout, const PipelineStateRef &pipelineState )
+	: Batch( app::getRenderDevice(), mesh, instanceLayout, pipelineState )
+{
+}
+
+Batch::Batch( const Mesh &mesh, const Mesh::BufferInfo &instanceLayout, const GraphicsPipelineCreateInfo &pipelineCreateInfo )
+	: Batch( app::getRenderDevice(), mesh, instanceLayout, pipelineCreateInfo )
+{
+}
+
+Batch::Batch( const std::vector<Mesh> &meshes, const Mesh::BufferInfo &instanceLayout, const PipelineStateRef &pipelineState )
+	: Batch( app::getRenderDevice(), meshes, instanceLayout, pipelineState )
+{
+}
+
+Batch::Batch( const std::vector<Mesh> &meshes, const Mesh::BufferInfo &instanceLayout, const GraphicsPipelineCreateInfo &pipelineCreateInfo )
+	: Batch( app::getRenderDevice(), meshes, instanceLayout, pipelineCreateInfo )
+{
+}
+
 namespace {
+	//! Shared between batches as copies of a Batch share their ShaderResourceBinding
+	std::atomic<uint64_t> sNextSrbRevision( 1 );
+
 	PipelineStateRef createPipeline( RenderDevice* device, const GraphicsPipelineCreateInfo &pipelineCreateInfo )
 	{
 		return createGraphicsPipelineState( device, pipelineCreateInfo );
@@ -73,6 +107,151 @@ namespace {
 		}
 		return createGraphicsPipelineState( device, pipelineCreateInfo );
 	}
+
+	//! Layouts without explicit strides are packed, otherwise they are expected to match the instance struct
+	Mesh::BufferInfo prepareInstanceLayout( const Mesh::BufferInfo &instanceLayout )
+	{
+		const auto &attribs = instanceLayout.getAttribs();
+		return attribs.empty() || attribs.front().getStride() ? instanceLayout : instanceLayout.calcInterleaved();
+	}
+
+	PipelineStateRef createPipeline( RenderDevice* device, GraphicsPipelineCreateInfo pipelineCreateInfo, const Mesh &mesh, const Mesh::BufferInfo &instanceLayout )
+	{
+		if( pipelineCreateInfo.getLayoutElements().empty() ) {
+			// the instance attributes follow the mesh attributes and read from the slot after the mesh buffers
+			std::vector<LayoutElement> elements = mesh.getVertexLayoutElements();
+			for( LayoutElement element : prepareInstanceLayout( instanceLayout ).calcLayoutElements( mesh.getNumVertexBufferSlots(), static_cast<uint32_t>( elements.size() ) ) ) {
+				element.Frequency = INPUT_ELEMENT_FREQUENCY_PER_INSTANCE;
+				element.InstanceDataStepRate = std::max( element.InstanceDataStepRate, 1u );
+				elements.push_back( element );
+			}
+			pipelineCreateInfo.inputLayout( elements );
+		}
+		return createGraphicsPipelineState( device, pipelineCreateInfo );
+	}
+
+	//! Copies ranges of buffers to staging buffers and reads them all back after a single wait for the GPU
+	class BufferReadback {
+	public:
+		BufferReadback( RenderDevice* device, DeviceContext* context )
+			: mDevice( device ), mContext( context )
+		{
+		}
+
+		//! Schedules the copy of \a size bytes of \a buffer at \a offset to \a dst
+		void add( Buffer* buffer, uint32_t offset, uint32_t size, uint8_t* dst )
+		{
+			if( ! size ) {
+				return;
+			}
+			BufferRef staging;
+			mDevice->CreateBuffer( BufferDesc()
+				.name( "Batch bake staging buffer" )
+				.usage( USAGE_STAGING )
+				.cpuAccessFlags( CPU_ACCESS_READ )
+				.size( size ),
+				nullptr, &staging );
+			mContext->CopyBuffer( buffer, offset, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, staging, 0, size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+			mReads.push_back( { staging, size, dst } );
+		}
+
+		//! Waits for the copies and fills the destinations
+		void flush()
+		{
+			mContext->WaitForIdle();
+			for( const Read &read : mReads ) {
+				PVoid mappedData = nullptr;
+				mContext->MapBuffer( read.staging, MAP_READ, MAP_FLAG_DO_NOT_WAIT, mappedData );
+				if( mappedData ) {
+					std::memcpy( read.dst, mappedData, read.size );
+				}
+				mContext->UnmapBuffer( read.staging, MAP_READ );
+			}
+			mReads.clear();
+		}
+
+	protected:
+		struct Read {
+			BufferRef	staging;
+			uint32_t	size;
+			uint8_t*	dst;
+		};
+
+		RenderDevice*		mDevice;
+		DeviceContext*		mContext;
+		std::vector<Read>	mReads;
+	};
+
+	bool isTransformedAttrib( geom::Attrib attrib )
+	{
+		return attrib == geom::Attrib::POSITION || attrib == geom::Attrib::NORMAL || attrib == geom::Attrib::TANGENT || attrib == geom::Attrib::BITANGENT;
+	}
+
+	//! Transforms the positions, normals, tangents and bitangents of \a numVertices float vertices in place. Normals use the inverse transpose so that they stay perpendicular to the tangents under non-uniform scales.
+	void transformVertices( uint8_t* data, uint32_t numVertices, const Mesh::BufferInfo &info, const mat4 &transform )
+	{
+		const mat3 tangentMatrix = mat3( transform );
+		const mat3 normalMatrix = glm::transpose( glm::inverse( tangentMatrix ) );
+		const size_t vertexSize = info.calcVertexByteSize();
+		for( const auto &attribInfo : info.getAttribs() ) {
+			if( ! isTransformedAttrib( attribInfo.getAttrib() ) || attribInfo.getDims() < 3 ) {
+				continue;
+			}
+			const bool isPosition = attribInfo.getAttrib() == geom::Attrib::POSITION;
+			const mat3 &directionMatrix = attribInfo.getAttrib() == geom::Attrib::NORMAL ? normalMatrix : tangentMatrix;
+			uint8_t* attribData = data + attribInfo.getOffset();
+			for( uint32_t i = 0; i < numVertices; ++i ) {
+				float* value = reinterpret_cast<float*>( attribData + i * vertexSize );
+				vec3 result = vec3( value[0], value[1], value[2] );
+				if( isPosition ) {
+					result = vec3( transform * vec4( result, 1.0f ) );
+				}
+				else {
+					result = directionMatrix * result;
+					const float length2 = glm::dot( result, result );
+					result = length2 > 0.0f ? result / glm::sqrt( length2 ) : result;
+				}
+				value[0] = result.x;
+				value[1] = result.y;
+				value[2] = result.z;
+			}
+		}
+	}
+
+	//! Returns an empty string if \a mesh can be merged with \a reference, otherwise the reason why it can't
+	std::string checkBakeCompatibility( const Mesh &reference, const Mesh &mesh, bool transformed )
+	{
+		if( mesh.getPrimitiveTopology() != reference.getPrimitiveTopology() ) {
+			return "meshes have different primitive topologies";
+		}
+		if( mesh.getPrimitiveTopology() != PRIMITIVE_TOPOLOGY_TRIANGLE_LIST && mesh.getPrimitiveTopology() != PRIMITIVE_TOPOLOGY_LINE_LIST ) {
+			return "only triangle and line lists can be merged";
+		}
+		if( mesh.getPositionScale() != reference.getPositionScale() || mesh.getPositionOffset() != reference.getPositionOffset() ) {
+			return "meshes have different position quantizations";
+		}
+		const auto &infos = mesh.getVertexBuffersInfo();
+		const auto &referenceInfos = reference.getVertexBuffersInfo();
+		if( infos.size() != referenceInfos.size() ) {
+			return "meshes have different numbers of vertex buffers";
+		}
+		for( size_t i = 0; i < infos.size(); ++i ) {
+			if( infos[i].calcVertexByteSize() != referenceInfos[i].calcVertexByteSize() || infos[i].getAttribs().size() != referenceInfos[i].getAttribs().size() ) {
+				return "meshes have different vertex layouts";
+			}
+			for( size_t a = 0; a < infos[i].getAttribs().size(); ++a ) {
+				const geom::AttribInfo &attribInfo = infos[i].getAttribs()[a];
+				const geom::AttribInfo &referenceAttribInfo = referenceInfos[i].getAttribs()[a];
+				if( attribInfo.getAttrib() != referenceAttribInfo.getAttrib() || attribInfo.getOffset() != referenceAttribInfo.getOffset() || infos[i].getAttribFormat( attribInfo.getAttrib() ) != referenceInfos[i].getAttribFormat( referenceAttribInfo.getAttrib() ) ) {
+					return "meshes have different vertex layouts";
+				}
+				if( transformed && isTransformedAttrib( attribInfo.getAttrib() ) && ( attribInfo.getDataType() != geom::DataType::FLOAT || infos[i].getAttribFormat( attribInfo.getAttrib() ) != Mesh::AttribFormat::FLOAT32 ) ) {
+					return "transforms can only be baked into float attributes";
+				}
+			}
+		}
+		return "";
+	}
 }
 
 Batch::Batch( RenderDevice* device, const PipelineStateRef &pipelineState )
@@ -108,6 +287,32 @@ Batch::Batch( RenderDevice* device, const std::vector<Mesh> &meshes, const Graph
 {
 }
 
+Batch::Batch( RenderDevice* device, const Mesh &mesh, const Mesh::BufferInfo &instanceLayout, const PipelineStateRef &pipelineState )
+	: Batch( device, std::vector<Mesh>{ mesh }, instanceLayout, pipelineState )
+{
+}
+
+Batch::Batch( RenderDevice* device, const Mesh &mesh, const Mesh::BufferInfo &instanceLayout, const GraphicsPipelineCreateInfo &pipelineCreateInfo )
+	: Batch( device, std::vector<Mesh>{ mesh }, instanceLayout, createPipeline( device, pipelineCreateInfo, mesh, instanceLayout ) )
+{
+}
+
+Batch::Batch( RenderDevice* device, const std::vector<Mesh> &meshes, const Mesh::BufferInfo &instanceLayout, const PipelineStateRef &pipelineState )
+	: mDevice( device ),
+	mPso( pipelineState ),
+	mMeshes( meshes ),
+	mInstanceLayout( prepareInstanceLayout( instanceLayout ) ),
+	mInstanceSlot( meshes.empty() ? 0 : meshes.front().getNumVertexBufferSlots() ),
+	mInstanceRing( std::make_shared<InstanceRing>() )
+{
+	mInstanceStride = mInstanceLayout.getAttribs().empty() ? 0 : static_cast<uint32_t>( mInstanceLayout.getAttribs().front().getStride() );
+}
+
+Batch::Batch( RenderDevice* device, const std::vector<Mesh> &meshes, const Mesh::BufferInfo &instanceLayout, const GraphicsPipelineCreateInfo &pipelineCreateInfo )
+	: Batch( device, meshes, instanceLayout, createPipeline( device, pipelineCreateInfo, meshes.front(), instanceLayout ) )
+{
+}
+
 void Batch::setStaticVariable( SHADER_TYPE shaderType, const char* name, IDeviceObject* pObject )
 {
 	if( ShaderResourceVariable* variable = mPso->GetStaticVariableByName( shaderType, name ) ) {
@@ -139,34 +344,39 @@ ShaderResourceVariable* Batch::getStaticVariable( SHADER_TYPE shaderType, uint32
 
 void Batch::setVariable( SHADER_TYPE shaderType, const char* name, IDeviceObject* pObject )
 {
-	if( ShaderResourceVariable* variable = getShaderResourceBinding()->GetVariableByName( shaderType, name ) ) {
+	if( ShaderResourceVariable* variable = getOrCreateShaderResourceBinding()->GetVariableByName( shaderType, name ) ) {
 		variable->Set( pObject );
 	}
 }
 
 void Batch::setVariable( SHADER_TYPE shaderType, uint32_t index, IDeviceObject* pObject )
 {
-	if( ShaderResourceVariable* variable = getShaderResourceBinding()->GetVariableByIndex( shaderType, index ) ) {
+	if( ShaderResourceVariable* variable = getOrCreateShaderResourceBinding()->GetVariableByIndex( shaderType, index ) ) {
 		variable->Set( pObject );
 	}
 }
 
 uint32_t Batch::getVariableCount( SHADER_TYPE shaderType )
 {
-	return getShaderResourceBinding()->GetVariableCount( shaderType );
+	return getOrCreateShaderResourceBinding()->GetVariableCount( shaderType );
 }
 
 ShaderResourceVariable* Batch::getVariable( SHADER_TYPE shaderType, const char* name )
 {
-	return getShaderResourceBinding()->GetVariableByName( shaderType, name );
+	return getOrCreateShaderResourceBinding()->GetVariableByName( shaderType, name );
 }
 
 ShaderResourceVariable* Batch::getVariable( SHADER_TYPE shaderType, uint32_t index )
 {
-	return getShaderResourceBinding()->GetVariableByIndex( shaderType, index );
+	return getOrCreateShaderResourceBinding()->GetVariableByIndex( shaderType, index );
 }
 
 ShaderResourceBindingRef Batch::getShaderResourceBinding()
+{
+	return getOrCreateShaderResourceBinding();
+}
+
+ShaderResourceBinding* Batch::getOrCreateShaderResourceBinding()
 {
 	if( ! mSrb ) {
 		mPso->CreateShaderResourceBinding( &mSrb, true );
@@ -174,6 +384,44 @@ ShaderResourceBindingRef Batch::getShaderResourceBinding()
 	return mSrb;
 }
 
+void Batch::updateShaderResourceBindingRevision()
+{
+	mSrbRevision = sNextSrbRevision++;
+}
+
+void Batch::commitShaderResources( ContextStateCache* stateCache )
+{
+	// the variables might have been set through a kept ShaderResourceVariable since the last draw, so each draw commits with a new revision
+	updateShaderResourceBindingRevision();
+	stateCache->commitShaderResources( getOrCreateShaderResourceBinding(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION, mSrbRevision );
+}
+
+void Batch::setVertexPullingVariable( SHADER_TYPE shaderType, const char* name, size_t bufferIndex )
+{
+	mVertexPullingShaderType = shaderType;
+	mVertexPullingName = name ? name : "";
+	mVertexPullingBufferIndex = bufferIndex;
+	mVertexPullingView = nullptr;
+}
+
+void Batch::commitVertexPulling( ContextStateCache* stateCache, const Mesh &mesh )
+{
+	if( mVertexPullingName.empty() ) {
+		return;
+	}
+	// meshes sharing their vertex storage, such as the meshes of a MeshPool, keep the same view and skip the commit
+	BufferView* view = mesh.getVertexBufferView( mVertexPullingBufferIndex );
+	if( view == mVertexPullingView ) {
+		return;
+	}
+	if( ShaderResourceVariable* variable = getOrCreateShaderResourceBinding()->GetVariableByName( mVertexPullingShaderType, mVertexPullingName.c_str() ) ) {
+		variable->Set( view );
+		updateShaderResourceBindingRevision();
+		stateCache->commitShaderResources( mSrb, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, mSrbRevision );
+	}
+	mVertexPullingView = view;
+}
+
 void Batch::draw()
 {
 	draw( app::getImmediateContext() );
@@ -181,12 +429,409 @@ void Batch::draw()
 
 void Batch::draw( DeviceContext* context )
 {
-	context->SetPipelineState( mPso );
-	context->CommitShaderResources( getShaderResourceBinding(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	draw( ScopedContextStateCache( context ) );
+}
+
+void Batch::draw( ContextStateCache* stateCache )
+{
+	stateCache->setPipelineState( mPso );
+	commitShaderResources( stateCache );
+
+	for( const Mesh &mesh : mMeshes ) {
+		commitVertexPulling( stateCache, mesh );
+		mesh.draw( stateCache );
+	}
+}
+
+void Batch::draw( const mat4 &modelViewProjection, float viewportHeight, float pixelError )
+{
+	draw( app::getImmediateContext(), modelViewProjection, viewportHeight, pixelError );
+}
+
+void Batch::draw( DeviceContext* context, const mat4 &modelViewProjection, float viewportHeight, float pixelError )
+{
+	draw( ScopedContextStateCache( context ), modelViewProjection, viewportHeight, pixelError );
+}
+
+void Batch::draw( ContextStateCache* stateCache, const mat4 &modelViewProjection, float viewportHeight, float pixelError )
+{
+	stateCache->setPipelineState( mPso );
+	commitShaderResources( stateCache );
+
+	for( const Mesh &mesh : mMeshes ) {
+		commitVertexPulling( stateCache, mesh );
+		mesh.draw( stateCache, Mesh::DrawAttribs().lod( mesh.selectLod( modelViewProjection, viewportHeight, pixelError ) ) );
+	}
+}
+
+Batch::FrustumPlanes::FrustumPlanes( const Frustum &frustum )
+{
+	for( int i = 0; i < 8; ++i ) {
+		const Plane &plane = frustum.getPlane( static_cast<Frustum::FrustumSection>( i < 6 ? i : 0 ) );
+		const vec3 &normal = plane.getNormal();
+		nx[i] = normal.x;
+		ny[i] = normal.y;
+		nz[i] = normal.z;
+		ax[i] = glm::abs( normal.x );
+		ay[i] = glm::abs( normal.y );
+		az[i] = glm::abs( normal.z );
+		d[i] = plane.getDistance();
+	}
+}
+
+bool Batch::FrustumPlanes::intersects( const AxisAlignedBox &box ) const
+{
+	const vec3 center = box.getCenter();
+	const vec3 extents = box.getExtents();
+#if defined( CINDER_GX_SSE2 )
+	const __m128 cx = _mm_set1_ps( center.x ), cy = _mm_set1_ps( center.y ), cz = _mm_set1_ps( center.z );
+	const __m128 ex = _mm_set1_ps( extents.x ), ey = _mm_set1_ps( extents.y ), ez = _mm_set1_ps( extents.z );
+	for( int i = 0; i < 8; i += 4 ) {
+		const __m128 distance = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_load_ps( nx + i ), cx ), _mm_mul_ps( _mm_load_ps( ny + i ), cy ) ), _mm_mul_ps( _mm_load_ps( nz + i ), cz ) ), _mm_load_ps( d + i ) );
+		const __m128 radius = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_load_ps( ax + i ), ex ), _mm_mul_ps( _mm_load_ps( ay + i ), ey ) ), _mm_mul_ps( _mm_load_ps( az + i ), ez ) );
+		if( _mm_movemask_ps( _mm_cmplt_ps( _mm_add_ps( distance, radius ), _mm_setzero_ps() ) ) ) {
+			return false;
+		}
+	}
+#else
+	for( int i = 0; i < 6; ++i ) {
+		if( nx[i] * center.x + ny[i] * center.y + nz[i] * center.z - d[i] + ax[i] * extents.x + ay[i] * extents.y + az[i] * extents.z < 0.0f ) {
+			return false;
+		}
+	}
+#endif
+	return true;
+}
+
+void Batch::draw( const Frustum &frustum )
+{
+	draw( app::getImmediateContext(), frustum );
+}
+
+void Batch::draw( DeviceContext* context, const Frustum &frustum )
+{
+	draw( ScopedContextStateCache( context ), frustum );
+}
+
+void Batch::draw( ContextStateCache* stateCache, const Frustum &frustum )
+{
+	const FrustumPlanes planes( frustum );
+	bool pipelineBound = false;
+	for( const Mesh &mesh : mMeshes ) {
+		if( mesh.hasBounds() && ! planes.intersects( mesh.getBounds() ) ) {
+			continue;
+		}
+		// the pipeline is only bound once a mesh is known to be visible
+		if( ! pipelineBound ) {
+			stateCache->setPipelineState( mPso );
+			commitShaderResources( stateCache );
+			pipelineBound = true;
+		}
+		commitVertexPulling( stateCache, mesh );
+		mesh.draw( stateCache );
+	}
+}
+
+
+void Batch::bakeStatic( const std::vector<mat4> &transforms )
+{
+	bakeStatic( app::getImmediateContext(), transforms );
+}
+
+void Batch::bakeStatic( DeviceContext* context, const std::vector<mat4> &transforms )
+{
+	bakeMeshes( context, transforms, false );
+}
+
+void Batch::bakeStatic( SHADER_TYPE shaderType, const char* name )
+{
+	bakeStatic( app::getImmediateContext(), shaderType, name );
+}
 
+void Batch::bakeStatic( DeviceContext* context, SHADER_TYPE shaderType, const char* name )
+{
+	if( bakeMeshes( context, {}, true ) ) {
+		// the mesh indices are the last vertex buffer of the baked mesh
+		setVertexPullingVariable( shaderType, name, mMeshes.front().getVertexBuffers().size() - 1 );
+	}
+}
+
+bool Batch::bakeMeshes( DeviceContext* context, const std::vector<mat4> &transforms, bool tagMeshIndices )
+{
+	if( mMeshes.empty() ) {
+		return false;
+	}
+	if( ! transforms.empty() && transforms.size() != mMeshes.size() ) {
+		CI_LOG_E( "Batch::bakeStatic requires one transform per mesh" );
+		return false;
+	}
+	const Mesh &reference = mMeshes.front();
 	for( const Mesh &mesh : mMeshes ) {
-		mesh.draw( context );
+		const std::string error = checkBakeCompatibility( reference, mesh, ! transforms.empty() );
+		if( ! error.empty() ) {
+			CI_LOG_E( "Batch::bakeStatic failed: " << error );
+			return false;
+		}
+	}
+
+	// every buffer is allocated before the reads are scheduled so that their destinations stay put
+	std::vector<Mesh::SourceData> meshData( mMeshes.size() );
+	std::vector<std::vector<uint8_t>> indexData( mMeshes.size() );
+	for( size_t m = 0; m < mMeshes.size(); ++m ) {
+		const Mesh &mesh = mMeshes[m];
+		Mesh::SourceData &data = meshData[m];
+		data.primitive = mesh.getPrimitiveTopology() == PRIMITIVE_TOPOLOGY_LINE_LIST ? geom::Primitive::LINES : geom::Primitive::TRIANGLES;
+		data.numVertices = mesh.getNumVertices();
+		data.positionScale = mesh.getPositionScale();
+		data.positionOffset = mesh.getPositionOffset();
+		data.bounds = mesh.getBounds();
+		data.boundingSphere = mesh.getBoundingSphere();
+		for( const auto &info : mesh.getVertexBuffersInfo() ) {
+			data.vertexBuffers.push_back( { info, std::vector<uint8_t>( mesh.getNumVertices() * info.calcVertexByteSize() ) } );
+		}
+		indexData[m].resize( mesh.getNumIndices() * ( mesh.getIndexDataType() == VT_UINT16 ? sizeof( uint16_t ) : sizeof( uint32_t ) ) );
+	}
+
+	// only the full detail range of the indices is kept
+	BufferReadback readback( mDevice, context );
+	for( size_t m = 0; m < mMeshes.size(); ++m ) {
+		const Mesh &mesh = mMeshes[m];
+		for( size_t b = 0; b < meshData[m].vertexBuffers.size(); ++b ) {
+			const uint32_t vertexSize = static_cast<uint32_t>( meshData[m].vertexBuffers[b].first.calcVertexByteSize() );
+			readback.add( mesh.getVertexBuffers()[b], mesh.getBaseVertex() * vertexSize, mesh.getNumVertices() * vertexSize, meshData[m].vertexBuffers[b].second.data() );
+		}
+		if( mesh.getNumIndices() ) {
+			const uint32_t indexSize = mesh.getIndexDataType() == VT_UINT16 ? sizeof( uint16_t ) : sizeof( uint32_t );
+			const uint32_t firstIndex = mesh.getFirstIndex() + ( mesh.getLods().empty() ? 0 : mesh.getLods().front().firstIndex );
+			readback.add( mesh.getIndexBuffer(), firstIndex * indexSize, mesh.getNumIndices() * indexSize, indexData[m].data() );
+		}
+	}
+	readback.flush();
+
+	for( size_t m = 0; m < mMeshes.size(); ++m ) {
+		std::vector<uint32_t> &indices = meshData[m].indices;
+		indices.resize( mMeshes[m].getNumIndices() );
+		if( mMeshes[m].getIndexDataType() == VT_UINT16 ) {
+			const uint16_t* indices16 = reinterpret_cast<const uint16_t*>( indexData[m].data() );
+			std::copy( indices16, indices16 + indices.size(), indices.begin() );
+		}
+		else if( ! indices.empty() ) {
+			std::memcpy( indices.data(), indexData[m].data(), indices.size() * sizeof( uint32_t ) );
+		}
+	}
+
+	mMeshes = { Mesh( mDevice, mergeSourceData( meshData, transforms, tagMeshIndices ) ) };
+	return true;
+}
+
+Mesh::SourceData Batch::mergeSourceData( const std::vector<Mesh::SourceData> &meshes, const std::vector<mat4> &transforms, bool tagMeshIndices )
+{
+	CI_ASSERT( ! meshes.empty() && ( transforms.empty() || transforms.size() == meshes.size() ) );
+
+	// meshes are appended one after the other, their indices offset by the vertices of the previous meshes
+	const Mesh::SourceData &reference = meshes.front();
+	Mesh::SourceData data;
+	data.primitive = reference.primitive;
+	data.positionScale = reference.positionScale;
+	data.positionOffset = reference.positionOffset;
+	std::vector<uint32_t> vertexOffsets;
+	bool isIndexed = false;
+	for( const Mesh::SourceData &mesh : meshes ) {
+		vertexOffsets.push_back( data.numVertices );
+		data.numVertices += mesh.numVertices;
+		isIndexed |= ! mesh.indices.empty();
+	}
+	data.use16BitIndices = data.numVertices <= 65536;
+
+	// the baked buffers are never updated again
+	for( const auto &vertexBuffer : reference.vertexBuffers ) {
+		Mesh::BufferInfo bakedInfo = vertexBuffer.first;
+		bakedInfo.usage( USAGE_IMMUTABLE ).cpuAccess( CPU_ACCESS_NONE );
+		data.vertexBuffers.push_back( { bakedInfo, std::vector<uint8_t>( data.numVertices * bakedInfo.calcVertexByteSize() ) } );
+	}
+
+	AxisAlignedBox bounds;
+	std::vector<Sphere> spheres;
+	bool hasBounds = true;
+	for( size_t m = 0; m < meshes.size(); ++m ) {
+		const Mesh::SourceData &mesh = meshes[m];
+		for( size_t b = 0; b < data.vertexBuffers.size(); ++b ) {
+			const Mesh::BufferInfo &info = data.vertexBuffers[b].first;
+			const size_t vertexSize = info.calcVertexByteSize();
+			CI_ASSERT( mesh.vertexBuffers[b].second.size() >= mesh.numVertices * vertexSize );
+			uint8_t* vertices = data.vertexBuffers[b].second.data() + vertexOffsets[m] * vertexSize;
+			std::memcpy( vertices, mesh.vertexBuffers[b].second.data(), mesh.numVertices * vertexSize );
+			if( ! transforms.empty() ) {
+				transformVertices( vertices, mesh.numVertices, info, transforms[m] );
+			}
+		}
+		if( isIndexed ) {
+			if( mesh.indices.empty() ) {
+				for( uint32_t i = 0; i < mesh.numVertices; ++i ) {
+					data.indices.push_back( vertexOffsets[m] + i );
+				}
+			}
+			else {
+				for( uint32_t index : mesh.indices ) {
+					data.indices.push_back( vertexOffsets[m] + index );
+				}
+			}
+		}
+
+		AxisAlignedBox meshBounds = mesh.bounds;
+		Sphere meshSphere = mesh.boundingSphere;
+		if( ! transforms.empty() ) {
+			const mat4 &transform = transforms[m];
+			const float scale = glm::max( glm::length( vec3( transform[0] ) ), glm::max( glm::length( vec3( transform[1] ) ), glm::length( vec3( transform[2] ) ) ) );
+			meshBounds = meshBounds.transformed( transform );
+			meshSphere = Sphere( vec3( transform * vec4( meshSphere.getCenter(), 1.0f ) ), meshSphere.getRadius() * scale );
+		}
+		hasBounds &= mesh.bounds.getSize() != vec3( 0.0f );
+		if( m == 0 ) {
+			bounds = meshBounds;
+		}
+		else {
+			bounds.include( meshBounds );
+		}
+		spheres.push_back( meshSphere );
+	}
+
+	// meshes without bounds make the baked mesh unculled
+	if( hasBounds ) {
+		data.bounds = bounds;
+		float radius = 0.0f;
+		for( const Sphere &sphere : spheres ) {
+			radius = glm::max( radius, glm::length( sphere.getCenter() - bounds.getCenter() ) + sphere.getRadius() );
+		}
+		data.boundingSphere = Sphere( bounds.getCenter(), radius );
+	}
+
+	if( tagMeshIndices ) {
+		std::vector<uint8_t> meshIndices( data.numVertices * sizeof( uint32_t ) );
+		uint32_t* meshIndex = reinterpret_cast<uint32_t*>( meshIndices.data() );
+		for( size_t m = 0; m < meshes.size(); ++m ) {
+			std::fill( meshIndex + vertexOffsets[m], meshIndex + vertexOffsets[m] + meshes[m].numVertices, static_cast<uint32_t>( m ) );
+		}
+		const Mesh::BufferInfo meshIndexInfo = Mesh::BufferInfo( { geom::AttribInfo( geom::Attrib::CUSTOM_9, geom::DataType::INTEGER, 1, sizeof( uint32_t ), 0, 0 ) } )
+			.vertexPulling()
+			.name( "Batch mesh index buffer" );
+		data.vertexBuffers.push_back( { meshIndexInfo, std::move( meshIndices ) } );
+	}
+	return data;
+}
+
+void Batch::setInstanceCapacity( uint32_t capacity )
+{
+	mInstanceCapacity = std::max( capacity, 1u );
+	mInstanceRing = std::make_shared<InstanceRing>();
+}
+
+uint32_t Batch::streamInstances( DeviceContext* context, const void* data, uint32_t count )
+{
+	InstanceRing &ring = *mInstanceRing;
+	if( ! ring.buffer ) {
+		mDevice->CreateBuffer( BufferDesc()
+			.name( "Batch instance ring buffer" )
+			.usage( USAGE_DYNAMIC )
+			.bindFlags( BIND_VERTEX_BUFFER )
+			.cpuAccessFlags( CPU_ACCESS_WRITE )
+			.size( mInstanceCapacity * mInstanceStride ),
+			nullptr, &ring.buffer );
+	}
+
+	// dynamic buffers have to be discarded once per frame before being appended to without overwrite
+	const uint64_t frameNumber = context->GetFrameNumber();
+	MAP_FLAGS mapFlags = MAP_FLAG_NO_OVERWRITE;
+	if( ring.frameNumber != frameNumber || ring.offset + count > mInstanceCapacity ) {
+		mapFlags = MAP_FLAG_DISCARD;
+		ring.offset = 0;
+		ring.frameNumber = frameNumber;
+	}
+	PVoid mappedData = nullptr;
+	context->MapBuffer( ring.buffer, MAP_WRITE, mapFlags, mappedData );
+	if( mappedData ) {
+		std::memcpy( static_cast<uint8_t*>( mappedData ) + ring.offset * mInstanceStride, data, count * mInstanceStride );
+	}
+	context->UnmapBuffer( ring.buffer, MAP_WRITE );
+
+	const uint32_t firstInstance = ring.offset;
+	ring.offset += count;
+	return firstInstance;
+}
+
+void Batch::drawInstanced( const void* data, uint32_t stride, size_t count )
+{
+	drawInstanced( app::getImmediateContext(), data, stride, count );
+}
+
+void Batch::drawInstanced( DeviceContext* context, const void* data, uint32_t stride, size_t count )
+{
+	drawInstanced( ScopedContextStateCache( context ), data, stride, count );
+}
+
+void Batch::drawInstanced( ContextStateCache* stateCache, const void* data, uint32_t stride, size_t count )
+{
+	if( ! mInstanceRing || ! mInstanceStride ) {
+		CI_LOG_E( "Batch::drawInstanced requires a Batch created with an instance layout" );
+		return;
+	}
+	CI_ASSERT_MSG( stride == mInstanceStride, "instance data doesn't match the instance layout stride" );
+
+	stateCache->setPipelineState( mPso );
+	commitShaderResources( stateCache );
+
+	// split the instances in chunks that fit in the ring buffer
+	const uint8_t* instances = static_cast<const uint8_t*>( data );
+	while( count ) {
+		const uint32_t numInstances = static_cast<uint32_t>( std::min<size_t>( count, mInstanceCapacity ) );
+		const uint32_t firstInstance = streamInstances( stateCache->getContext(), instances, numInstances );
+
+		Buffer* instanceBuffer = mInstanceRing->buffer;
+		const uint64_t offset = 0;
+		stateCache->setVertexBuffers( mInstanceSlot, 1, &instanceBuffer, &offset, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_NONE );
+		for( const Mesh &mesh : mMeshes ) {
+			commitVertexPulling( stateCache, mesh );
+			// the instance buffer slot has to survive the binding of the mesh buffers
+			mesh.draw( stateCache, Mesh::DrawAttribs()
+				.numInstances( numInstances )
+				.firstInstanceLocation( firstInstance )
+				.vertexBuffersFlags( SET_VERTEX_BUFFERS_FLAG_NONE ) );
+		}
+
+		instances += numInstances * mInstanceStride;
+		count -= numInstances;
+	}
+}
+
+void Batch::drawIndirect( const GpuCullingRef &culling )
+{
+	drawIndirect( app::getImmediateContext(), culling );
+}
+
+void Batch::drawIndirect( DeviceContext* context, const GpuCullingRef &culling )
+{
+	drawIndirect( ScopedContextStateCache( context ), culling );
+}
+
+void Batch::drawIndirect( ContextStateCache* stateCache, const GpuCullingRef &culling )
+{
+	if( mMeshes.empty() || ! mInstanceStride ) {
+		CI_LOG_E( "Batch::drawIndirect requires a Batch created with a mesh and GpuCulling::getObjectIdLayout()" );
+		return;
 	}
+	CI_ASSERT_MSG( mInstanceStride == sizeof( int32_t ), "instance layout doesn't match GpuCulling::getObjectIdLayout()" );
+
+	stateCache->setPipelineState( mPso );
+	commitShaderResources( stateCache );
+
+	// every command draws one instance located at its object id
+	Buffer* objectIdBuffer = culling->getObjectIdBuffer();
+	const uint64_t offset = 0;
+	stateCache->setVertexBuffers( mInstanceSlot, 1, &objectIdBuffer, &offset, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_NONE );
+	const Mesh &mesh = mMeshes.front();
+	commitVertexPulling( stateCache, mesh );
+	mesh.bind( stateCache, Mesh::DrawAttribs().vertexBuffersFlags( SET_VERTEX_BUFFERS_FLAG_NONE ) );
+	culling->drawIndirect( stateCache->getContext(), mesh.getIndexDataType() );
 }
 
 }
@@ -24,6 +24,8 @@
 #include "cinder/graphics/Buffer.h"
 #include "cinder/app/RendererGx.h"
 
+#include <cstring>
+
 using namespace std;
 using namespace ci::app;
 
@@ -102,6 +104,41 @@ BufferRef createBuffer( const Diligent::BufferDesc &buffDesc, const void* data,
 	return createBuffer( buffDesc, &bufferData );
 }
 
+std::vector<uint8_t> readBuffer( Buffer* buffer, uint32_t offset, uint32_t size )
+{
+	return readBuffer( getRenderDevice(), getImmediateContext(), buffer, offset, size );
+}
+
+std::vector<uint8_t> readBuffer( RenderDevice* device, DeviceContext* context, Buffer* buffer, uint32_t offset, uint32_t size )
+{
+	const uint32_t bufferSize = static_cast<uint32_t>( buffer->GetDesc().Size );
+	if( offset >= bufferSize ) {
+		return {};
+	}
+	if( size == 0 || offset + size > bufferSize ) {
+		size = bufferSize - offset;
+	}
+
+	BufferRef staging;
+	device->CreateBuffer( BufferDesc()
+		.name( "Readback staging buffer" )
+		.usage( USAGE_STAGING )
+		.cpuAccessFlags( CPU_ACCESS_READ )
+		.size( size ),
+		nullptr, &staging );
+	context->CopyBuffer( buffer, offset, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, staging, 0, size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	context->WaitForIdle();
+
+	std::vector<uint8_t> data( size );
+	PVoid mappedData = nullptr;
+	context->MapBuffer( staging, MAP_READ, MAP_FLAG_DO_NOT_WAIT, mappedData );
+	if( mappedData ) {
+		std::memcpy( data.data(), mappedData, size );
+	}
+	context->UnmapBuffer( staging, MAP_READ );
+	return data;
+}
+
 }
 
 namespace gx = graphics;
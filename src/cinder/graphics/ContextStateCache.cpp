@@ -0,0 +1,159 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/ContextStateCache.h"
+#include "cinder/CinderAssert.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+namespace {
+	//! Returns whether a skipped bind would have left \a buffer in a different state
+	bool isBufferInState( Buffer* buffer, RESOURCE_STATE requiredState, RESOURCE_STATE_TRANSITION_MODE stateTransitionMode )
+	{
+		if( ! buffer || stateTransitionMode != RESOURCE_STATE_TRANSITION_MODE_TRANSITION ) {
+			return true;
+		}
+		// untracked buffers are never transitioned by the context
+		const RESOURCE_STATE state = buffer->GetState();
+		return state == RESOURCE_STATE_UNKNOWN || ( state & requiredState ) == requiredState;
+	}
+}
+
+ContextStateCache::ContextStateCache( DeviceContext* context, bool filterRedundantBinds )
+	: mContext( context ),
+	mFilterRedundantBinds( filterRedundantBinds ),
+	mShaderResourceBindingRevision( 0 ),
+	mVertexBufferOffsets{},
+	mNumVertexBuffers( 0 ),
+	mIndexBufferOffset( 0 )
+{
+}
+
+void ContextStateCache::setPipelineState( PipelineState* pipelineState )
+{
+	if( mFilterRedundantBinds && mPipelineState.RawPtr() == pipelineState ) {
+		mStats.pipelineStateBindsSkipped++;
+		return;
+	}
+
+	mContext->SetPipelineState( pipelineState );
+	mPipelineState = pipelineState;
+	mShaderResourceBinding.Release();
+	mStats.pipelineStateBinds++;
+}
+
+void ContextStateCache::commitShaderResources( ShaderResourceBinding* shaderResourceBinding, RESOURCE_STATE_TRANSITION_MODE stateTransitionMode, uint64_t revision )
+{
+	if( mFilterRedundantBinds && mShaderResourceBinding.RawPtr() == shaderResourceBinding && mShaderResourceBindingRevision == revision ) {
+		mStats.shaderResourcesCommitsSkipped++;
+		return;
+	}
+
+	mContext->CommitShaderResources( shaderResourceBinding, stateTransitionMode );
+	mShaderResourceBinding = shaderResourceBinding;
+	mShaderResourceBindingRevision = revision;
+	mStats.shaderResourcesCommits++;
+}
+
+void ContextStateCache::setVertexBuffers( uint32_t startSlot, uint32_t numBuffersSet, Buffer* const* ppBuffers, const uint64_t* pOffsets, RESOURCE_STATE_TRANSITION_MODE stateTransitionMode, SET_VERTEX_BUFFERS_FLAGS flags )
+{
+	CI_ASSERT( startSlot + numBuffersSet <= MAX_BUFFER_SLOTS );
+
+	const bool reset = ( flags & SET_VERTEX_BUFFERS_FLAG_RESET ) != 0;
+	bool redundant = mFilterRedundantBinds && ( ! reset || mNumVertexBuffers <= startSlot + numBuffersSet );
+	for( uint32_t slot = 0; slot < startSlot && redundant && reset; ++slot ) {
+		redundant = ! mVertexBuffers[slot];
+	}
+	for( uint32_t i = 0; i < numBuffersSet && redundant; ++i ) {
+		Buffer* buffer = ppBuffers ? ppBuffers[i] : nullptr;
+		const uint64_t offset = pOffsets ? pOffsets[i] : 0;
+		redundant = mVertexBuffers[startSlot + i].RawPtr() == buffer
+			&& mVertexBufferOffsets[startSlot + i] == offset
+			&& isBufferInState( buffer, RESOURCE_STATE_VERTEX_BUFFER, stateTransitionMode );
+	}
+	if( redundant ) {
+		mStats.vertexBuffersBindsSkipped++;
+		return;
+	}
+
+	mContext->SetVertexBuffers( startSlot, numBuffersSet, const_cast<Buffer**>( ppBuffers ), pOffsets, stateTransitionMode, flags );
+	if( reset ) {
+		for( uint32_t slot = 0; slot < mNumVertexBuffers; ++slot ) {
+			mVertexBuffers[slot].Release();
+			mVertexBufferOffsets[slot] = 0;
+		}
+		mNumVertexBuffers = 0;
+	}
+	for( uint32_t i = 0; i < numBuffersSet; ++i ) {
+		mVertexBuffers[startSlot + i] = ppBuffers ? ppBuffers[i] : nullptr;
+		mVertexBufferOffsets[startSlot + i] = pOffsets ? pOffsets[i] : 0;
+	}
+	mNumVertexBuffers = std::max( mNumVertexBuffers, startSlot + numBuffersSet );
+	mStats.vertexBuffersBinds++;
+}
+
+void ContextStateCache::setIndexBuffer( Buffer* indexBuffer, uint64_t byteOffset, RESOURCE_STATE_TRANSITION_MODE stateTransitionMode )
+{
+	if( mFilterRedundantBinds && mIndexBuffer.RawPtr() == indexBuffer && mIndexBufferOffset == byteOffset && isBufferInState( indexBuffer, RESOURCE_STATE_INDEX_BUFFER, stateTransitionMode ) ) {
+		mStats.indexBufferBindsSkipped++;
+		return;
+	}
+
+	mContext->SetIndexBuffer( indexBuffer, byteOffset, stateTransitionMode );
+	mIndexBuffer = indexBuffer;
+	mIndexBufferOffset = byteOffset;
+	mStats.indexBufferBinds++;
+}
+
+void ContextStateCache::invalidate()
+{
+	mPipelineState.Release();
+	mShaderResourceBinding.Release();
+	mShaderResourceBindingRevision = 0;
+	for( uint32_t slot = 0; slot < mNumVertexBuffers; ++slot ) {
+		mVertexBuffers[slot].Release();
+		mVertexBufferOffsets[slot] = 0;
+	}
+	mNumVertexBuffers = 0;
+	mIndexBuffer.Release();
+	mIndexBufferOffset = 0;
+}
+
+void ContextStateCache::invalidateShaderResources()
+{
+	mShaderResourceBinding.Release();
+}
+
+ScopedContextStateCache::ScopedContextStateCache( DeviceContext* context )
+	: mCache( context, false )
+{
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
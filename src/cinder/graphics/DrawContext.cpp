@@ -60,6 +60,9 @@ DrawContext::DrawContext()
 	mConstantBufferImmutable( true ),
 	mTextureIndex( 0 ),
 	mTextureCount( 1 ),
+	mPartialRedraw( false ),
+	mPartialRedrawTileSize( 64 ),
+	mPartialRedrawConstantsValid( false ),
 	// TODO/NOTES: Currently unbounded arrays of Texture seem to be disabled by default in the HLSL compiler as 
 	// they are known to cause issues with graphics / frame capture tools. Instead of depending on those
 	// it might be a good idea to lower the maximum number of textures and ensure that commands stop being 
@@ -90,13 +93,17 @@ DrawContext::Pipeline DrawContext::initializePipelineState( RenderDevice* device
 	bindlessMacro.AddShaderMacro( "BINDLESS_RESOURCES", 1 );
 	bindlessMacro.AddShaderMacro( "NUM_TEXTURES", mMaxBindlessTextures );
 
-	string vertexShader = R"( #line 94
+	string vertexShader = R"( #line 97
 
 		struct Constant {
 			float4x4 transform;
 		};
 
 		StructuredBuffer<Constant> constantBuffer;
+
+		cbuffer StreamConstants {
+			float4x4 streamTransform;
+		};
  
 		struct VSInput {
 			float3 position : ATTRIB0;
@@ -116,14 +123,14 @@ DrawContext::Pipeline DrawContext::initializePipelineState( RenderDevice* device
 		void main( in VSInput vsIn, out PSInput psIn ) 
 		{
 			const float4x4 transform = constantBuffer[vsIn.constant].transform;
-			psIn.position  = mul( float4( vsIn.position, 1.0f ), transform );
+			psIn.position  = mul( mul( float4( vsIn.position, 1.0f ), transform ), streamTransform );
 			psIn.color     = vsIn.color;
 			psIn.uv		 = vsIn.uv;
 			psIn.textureId = vsIn.textureId;
 		}
 	)";
 
-	string pixelShader = R"( #line 127
+	string pixelShader = R"( #line 134
 
 		#ifdef BINDLESS_RESOURCES
 			Texture2D    rTexture[NUM_TEXTURES];
@@ -185,7 +192,8 @@ DrawContext::Pipeline DrawContext::initializePipelineState( RenderDevice* device
 		) )
 		.variables( {
 			{ gx::SHADER_TYPE_PIXEL, "rTexture", gx::SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC },
-			{ gx::SHADER_TYPE_VERTEX, "constantBuffer", gx::SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC }
+			{ gx::SHADER_TYPE_VERTEX, "constantBuffer", gx::SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC },
+			{ gx::SHADER_TYPE_VERTEX, "StreamConstants", gx::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE }
 			} )
 		.immutableSamplers( { { gx::SHADER_TYPE_PIXEL, "rTexture", Diligent::SamplerDesc() } } )
 		.depthStencilDesc( DepthStencilStateDesc()
@@ -213,6 +221,19 @@ DrawContext::Pipeline DrawContext::initializePipelineState( RenderDevice* device
 		) );
 	pipeline.pso->CreateShaderResourceBinding( &pipeline.srb, true );
 
+	// DrawStreams bind their own stream transform, DrawContext always uses identity
+	if( ! mStreamConstantsBuffer ) {
+		const mat4 identity;
+		BufferData data = { &identity, sizeof( mat4 ) };
+		device->CreateBuffer( BufferDesc()
+			.name( "DrawContext stream constants buffer" )
+			.usage( USAGE_IMMUTABLE )
+			.bindFlags( BIND_UNIFORM_BUFFER )
+			.size( sizeof( mat4 ) ),
+			&data, &mStreamConstantsBuffer );
+	}
+	pipeline.srb->GetVariableByName( SHADER_TYPE_VERTEX, "StreamConstants" )->Set( mStreamConstantsBuffer );
+
 	return pipeline;
 }
 
@@ -334,14 +355,17 @@ void DrawContext::submit( bool flushAfterSubmit )
 	submit( app::getRenderDevice(), app::getImmediateContext(), flushAfterSubmit );
 }
 
-void DrawContext::submit( RenderDevice* device, DeviceContext* context, bool flushAfterSubmit )
+bool DrawContext::prepareCommands( RenderDevice* device )
 {
 	if( mCommands.empty() ) {
-		return;
+		return false;
 	}
 	// Remove empty trailing command
 	if( mCommands.back().indexCount == 0 ) {
 		mCommands.pop_back();
+		if( mCommands.empty() ) {
+			return false;
+		}
 	}
 	// Verify device features if not done previously
 	if( mVerifyDeviceFeatures ) {
@@ -368,6 +392,77 @@ void DrawContext::submit( RenderDevice* device, DeviceContext* context, bool flu
 		}
 	}
 
+	// Make sure pipelines and srbs are initialized
+	if( ! mPSOsValid ) {
+		for( size_t i = 0; i < mCommands.size(); i++ ) {
+			Command &command = mCommands[i];
+			size_t stateHash = command.state.hash();
+			if( i == 0 || stateHash != mCommands[i - 1].state.hash() ) {
+				if( ! mPipelines.count( stateHash ) ) {
+					mPipelines.insert( { stateHash, initializePipelineState( device, command.state ) } );
+				}
+			}
+		}
+		mPSOsValid = true;
+	}
+
+	// Merge subsequent commands
+	// TODO: Only merges two subsequent commands, should probably switch to a double for-loop to be 
+	//		 able to merge more than two in a row.
+	for( size_t i = 1; i < mCommands.size(); i++ ) {
+		// when bindless resources are available commands that differ only 
+		// by their texture index can be merged into a single command
+		if( mBindlessResources &&
+			mCommands[i].state.hash() == mCommands[i-1].state.hash() &&
+			mCommands[i].viewport == mCommands[i-1].viewport &&
+			mCommands[i].scissor == mCommands[i-1].scissor &&
+			mCommands[i].resources.textureIndex != mCommands[i-1].resources.textureIndex ) {
+			// merge and shift left
+			mCommands[i-1].indexCount += mCommands[i].indexCount;
+			mCommands.erase( mCommands.begin() + i );
+		}
+	}
+
+	return true;
+}
+
+void DrawContext::resolveTransforms()
+{
+	for( const auto &namedTransform : mTransforms ) {
+		const Transform& transform = namedTransform.second;
+		if( transform.mActive ) {
+			mConstants[transform.mTargetIndex].transform = glm::transpose( transform.mParentTransform * transform.mTransform );
+		}
+	}
+}
+
+void DrawContext::submit( RenderDevice* device, DeviceContext* context, bool flushAfterSubmit )
+{
+	submit( device, ScopedContextStateCache( context ), flushAfterSubmit );
+}
+
+void DrawContext::submit( RenderDevice* device, ContextStateCache* stateCache, bool flushAfterSubmit )
+{
+	const bool hasCommands = prepareCommands( device );
+	if( mPartialRedraw ) {
+		submitPartialRedraw( device, stateCache, hasCommands );
+	}
+	else if( hasCommands ) {
+		uploadBuffers( device, stateCache );
+		drawCommands( stateCache, nullptr );
+	}
+	else {
+		return;
+	}
+
+	if( flushAfterSubmit ) {
+		flush();
+	}
+}
+
+void DrawContext::uploadBuffers( RenderDevice* device, ContextStateCache* stateCache )
+{
+	DeviceContext* context = stateCache->getContext();
 	// update vertex and index buffer
 
 	// NOTES: The following considers the data to be immutable if the same data is submitted multiple times or dynamic 
@@ -443,14 +538,7 @@ void DrawContext::submit( RenderDevice* device, DeviceContext* context, bool flu
 				constantsImmutable ? &data : nullptr, &mConstantsBuffer );
 			mConstantsBufferSRV = mConstantsBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE );
 		}
-		{
-			for( const auto &namedTransform : mTransforms ) {
-				const Transform& transform = namedTransform.second;
-				if( transform.mActive ) {
-					mConstants[transform.mTargetIndex].transform = glm::transpose( transform.mParentTransform * transform.mTransform );
-				}
-			}
-		}
+		resolveTransforms();
 		// Copy constant data
 		if( ! constantsImmutable ) {
 			MapHelper<Constants> constants( context, mConstantsBuffer, MAP_WRITE, MAP_FLAG_DISCARD );
@@ -462,50 +550,364 @@ void DrawContext::submit( RenderDevice* device, DeviceContext* context, bool flu
 	}
 
 	// Bind the index buffer once now, index offsets are provided on a draw call basis 
-	context->SetIndexBuffer( mIndexBuffer, 0, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	stateCache->setIndexBuffer( mIndexBuffer, 0, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+}
+
+void DrawContext::enablePartialRedraw( bool enable, const ivec2 &tileSize, const ColorAf &clearColor )
+{
+	mPartialRedraw = enable;
+	mPartialRedrawTileSize = glm::max( tileSize, ivec2( 1 ) );
+	mPartialRedrawClearColor = clearColor;
+	mPartialRedrawConstantsValid = false;
+	// everything needs to be redrawn after a configuration change
+	mPreviousTileHashes.clear();
+
+	if( ! enable ) {
+		mPartialRedrawColor.Release();
+		mPartialRedrawDepth.Release();
+		mPartialRedrawCompositeSrb.Release();
+		mPartialRedrawSize = ivec2( 0 );
+		mPrimitives.clear();
+		mCommandBounds.clear();
+		mTileHashes.clear();
+		mDirtyRects.clear();
+	}
+}
 
-	// Make sure pipelines and srbs are initialized
-	if( ! mPSOsValid ) {
-		for( size_t i = 0; i < mCommands.size(); i++ ) {
-			Command &command = mCommands[i];
-			size_t stateHash = command.state.hash();
-			if( i == 0 || stateHash != mCommands[i - 1].state.hash() ) {
-				if( ! mPipelines.count( stateHash ) ) {
-					mPipelines.insert( { stateHash, initializePipelineState( device, command.state ) } );
-				}
+void DrawContext::initializePartialRedrawPipelines( RenderDevice* device )
+{
+	string vertexShader = R"( #line 574
+
+		struct PSInput { 
+			float4 position : SV_POSITION; 
+		};
+
+		void main( in uint vertexId : SV_VertexID, out PSInput psIn ) 
+		{
+			// fullscreen triangle at the far plane
+			float2 uv = float2( ( vertexId << 1 ) & 2, vertexId & 2 );
+			psIn.position = float4( uv * float2( 2.0, -2.0 ) + float2( -1.0, 1.0 ), 1.0, 1.0 );
+		}
+	)";
+
+	string clearPixelShader = R"( #line 588
+
+		cbuffer ClearConstants {
+			float4 clearColor;
+		};
+
+		struct PSInput { 
+			float4 position : SV_POSITION; 
+		};
+
+		float4 main( in PSInput psIn ) : SV_TARGET
+		{
+			return clearColor;
+		}
+	)";
+
+	string compositePixelShader = R"( #line 604
+
+		Texture2D rTexture;
+
+		struct PSInput { 
+			float4 position : SV_POSITION; 
+		};
+
+		float4 main( in PSInput psIn ) : SV_TARGET
+		{
+			return rTexture.Load( int3( psIn.position.xy, 0 ) );
+		}
+	)";
+
+	auto createShader = []( const string &name, SHADER_TYPE type, const string &source ) {
+		return gx::createShader( gx::ShaderCreateInfo()
+			.name( name )
+			.sourceLanguage( gx::SHADER_SOURCE_LANGUAGE_HLSL )
+			.shaderType( type )
+			.source( source )
+		);
+	};
+
+	ShaderRef fullscreenVS = createShader( "DrawContext Fullscreen VS", gx::SHADER_TYPE_VERTEX, vertexShader );
+
+	device->CreateBuffer( BufferDesc()
+		.name( "DrawContext partial redraw constants buffer" )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_UNIFORM_BUFFER )
+		.size( sizeof( vec4 ) ),
+		nullptr, &mPartialRedrawConstants );
+	mPartialRedrawConstantsValid = false;
+
+	// Clears the color and depth of the scissored area
+	mPartialRedrawClearPso = gx::createGraphicsPipelineState( device, gx::GraphicsPipelineCreateInfo()
+		.name( "DrawContext Partial Redraw Clear Pipeline" )
+		.vertexShader( fullscreenVS )
+		.pixelShader( createShader( "DrawContext Partial Redraw Clear PS", gx::SHADER_TYPE_PIXEL, clearPixelShader ) )
+		.variables( { { gx::SHADER_TYPE_PIXEL, "ClearConstants", gx::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE } } )
+		.depthStencilDesc( DepthStencilStateDesc()
+			.depthEnable( true )
+			.depthWriteEnable( true )
+			.depthFunc( COMPARISON_FUNC_ALWAYS )
+		)
+		.rasterizerStateDesc( RasterizerStateDesc()
+			.scissorEnable( true )
+			.cullMode( CULL_MODE_NONE )
+		)
+		.primitiveTopology( PRIMITIVE_TOPOLOGY_TRIANGLE_LIST ) );
+	mPartialRedrawClearPso->CreateShaderResourceBinding( &mPartialRedrawClearSrb, true );
+	mPartialRedrawClearSrb->GetVariableByName( SHADER_TYPE_PIXEL, "ClearConstants" )->Set( mPartialRedrawConstants );
+
+	// Copies the persistent render target to the back buffer
+	mPartialRedrawCompositePso = gx::createGraphicsPipelineState( device, gx::GraphicsPipelineCreateInfo()
+		.name( "DrawContext Partial Redraw Composite Pipeline" )
+		.vertexShader( fullscreenVS )
+		.pixelShader( createShader( "DrawContext Partial Redraw Composite PS", gx::SHADER_TYPE_PIXEL, compositePixelShader ) )
+		.variables( { { gx::SHADER_TYPE_PIXEL, "rTexture", gx::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE } } )
+		.depthStencilDesc( DepthStencilStateDesc()
+			.depthEnable( false )
+			.depthWriteEnable( false )
+		)
+		.rasterizerStateDesc( RasterizerStateDesc()
+			.cullMode( CULL_MODE_NONE )
+		)
+		.primitiveTopology( PRIMITIVE_TOPOLOGY_TRIANGLE_LIST ) );
+}
+
+namespace {
+	// FNV-1a
+	inline uint64_t hashBytes( uint64_t seed, const void* data, size_t size )
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>( data );
+		for( size_t i = 0; i < size; ++i ) {
+			seed ^= bytes[i];
+			seed *= 0x100000001b3ull;
+		}
+		return seed;
+	}
+} // anonymous namespace
+
+void DrawContext::updateDirtyRects()
+{
+	const ivec2 numTiles = ( mPartialRedrawSize + mPartialRedrawTileSize - ivec2( 1 ) ) / mPartialRedrawTileSize;
+	mTileHashes.assign( static_cast<size_t>( numTiles.x ) * numTiles.y, 0 );
+	mCommandBounds.assign( mCommands.size(), ivec4( numeric_limits<int>::max(), numeric_limits<int>::max(), numeric_limits<int>::min(), numeric_limits<int>::min() ) );
+
+	for( const Primitive &primitive : mPrimitives ) {
+		if( primitive.vertexCount == 0 || primitive.indexCount == 0 ) {
+			continue;
+		}
+		// find the command the primitive ended up in, commands might have been merged since it was recorded
+		auto commandIt = std::upper_bound( mCommands.begin(), mCommands.end(), primitive.indexOffset, []( uint32_t offset, const Command &command ) { return offset < command.indexOffset; } );
+		if( commandIt == mCommands.begin() ) {
+			continue;
+		}
+		const size_t commandIndex = std::distance( mCommands.begin(), commandIt ) - 1;
+		const Command &command = mCommands[commandIndex];
+		const Vertex* vertices = &mVertices[primitive.vertexOffset];
+		const mat4 transform = glm::transpose( mConstants[vertices[0].constantsIndex].transform );
+
+		// screen bounds of the primitive, clipped to the command scissor
+		vec2 minBounds( numeric_limits<float>::max() ), maxBounds( numeric_limits<float>::lowest() );
+		bool behindEye = false;
+		for( uint32_t i = 0; i < primitive.vertexCount; ++i ) {
+			const vec4 clip = transform * vec4( vertices[i].position, 1.0f );
+			if( clip.w <= 1e-6f ) {
+				behindEye = true;
+				break;
+			}
+			const vec2 ndc = vec2( clip ) / clip.w;
+			const vec2 window = vec2( command.viewport ) + ( ndc * vec2( 0.5f, -0.5f ) + vec2( 0.5f ) ) * vec2( command.viewport.z, command.viewport.w );
+			minBounds = glm::min( minBounds, window );
+			maxBounds = glm::max( maxBounds, window );
+		}
+		ivec4 bounds = behindEye ? ivec4( command.viewport.x, command.viewport.y, command.viewport.x + command.viewport.z, command.viewport.y + command.viewport.w )
+								 : ivec4( glm::floor( minBounds ) - vec2( 1.0f ), glm::ceil( maxBounds ) + vec2( 1.0f ) );
+		bounds = ivec4( glm::max( ivec2( bounds ), glm::max( ivec2( command.scissor ), ivec2( 0 ) ) ),
+						glm::min( ivec2( bounds.z, bounds.w ), glm::min( ivec2( command.scissor.z, command.scissor.w ), mPartialRedrawSize ) ) );
+		if( bounds.x >= bounds.z || bounds.y >= bounds.w ) {
+			continue;
+		}
+		ivec4 &commandBounds = mCommandBounds[commandIndex];
+		commandBounds = ivec4( glm::min( ivec2( commandBounds ), ivec2( bounds ) ), glm::max( ivec2( commandBounds.z, commandBounds.w ), ivec2( bounds.z, bounds.w ) ) );
+
+		// hash everything that affects the pixels covered by the primitive
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for( uint32_t i = 0; i < primitive.vertexCount; ++i ) {
+			hash = hashBytes( hash, &vertices[i], offsetof( Vertex, constantsIndex ) );
+		}
+		for( uint32_t i = 0; i < primitive.indexCount; ++i ) {
+			const uint32_t index = mIndices[primitive.indexOffset + i] - primitive.vertexOffset;
+			hash = hashBytes( hash, &index, sizeof( index ) );
+		}
+		const IDeviceObject* texture = getTextureAt( vertices[0].textureIndex );
+		const size_t stateHash = command.state.hash();
+		hash = hashBytes( hash, &transform, sizeof( transform ) );
+		hash = hashBytes( hash, &texture, sizeof( texture ) );
+		hash = hashBytes( hash, &stateHash, sizeof( stateHash ) );
+		hash = hashBytes( hash, &command.viewport, sizeof( command.viewport ) );
+		hash = hashBytes( hash, &command.scissor, sizeof( command.scissor ) );
+
+		// accumulate in draw order in every tile the primitive touches
+		const ivec2 firstTile = ivec2( bounds ) / mPartialRedrawTileSize;
+		const ivec2 lastTile = ( ivec2( bounds.z, bounds.w ) - ivec2( 1 ) ) / mPartialRedrawTileSize;
+		for( int y = firstTile.y; y <= lastTile.y; ++y ) {
+			for( int x = firstTile.x; x <= lastTile.x; ++x ) {
+				uint64_t &tileHash = mTileHashes[static_cast<size_t>( y ) * numTiles.x + x];
+				tileHash = hashBytes( tileHash ^ 0x9e3779b97f4a7c15ull, &hash, sizeof( hash ) );
 			}
 		}
-		mPSOsValid = true;
 	}
 
-	// Merge subsequent commands
-	// TODO: Only merges two subsequent commands, should probably switch to a double for-loop to be 
-	//		 able to merge more than two in a row.
-	for( size_t i = 1; i < mCommands.size(); i++ ) {
-		// when bindless resources are available commands that differ only 
-		// by their texture index can be merged into a single command
-		if( mBindlessResources &&
-			mCommands[i].state.hash() == mCommands[i-1].state.hash() &&
-			mCommands[i].viewport == mCommands[i-1].viewport &&
-			mCommands[i].scissor == mCommands[i-1].scissor &&
-			mCommands[i].resources.textureIndex != mCommands[i-1].resources.textureIndex ) {
-			// merge and shift left
-			mCommands[i-1].indexCount += mCommands[i].indexCount;
-			mCommands.erase( mCommands.begin() + i );
+	// merge the dirty tiles into rects, first as horizontal runs then vertically when runs line up
+	mDirtyRects.clear();
+	const bool allDirty = mPreviousTileHashes.size() != mTileHashes.size();
+	std::vector<ivec4> openRects; // in tiles: x0, y0, x1, y1 (exclusive)
+	std::vector<ivec4> rowRects;
+	for( int y = 0; y <= numTiles.y; ++y ) {
+		rowRects.clear();
+		for( int x = 0; y < numTiles.y && x < numTiles.x; ) {
+			const size_t tile = static_cast<size_t>( y ) * numTiles.x + x;
+			if( ! allDirty && mTileHashes[tile] == mPreviousTileHashes[tile] ) {
+				++x;
+				continue;
+			}
+			int x1 = x + 1;
+			while( x1 < numTiles.x && ( allDirty || mTileHashes[static_cast<size_t>( y ) * numTiles.x + x1] != mPreviousTileHashes[static_cast<size_t>( y ) * numTiles.x + x1] ) ) {
+				++x1;
+			}
+			rowRects.push_back( ivec4( x, y, x1, y + 1 ) );
+			x = x1;
+		}
+		// extend the open rects that match a run of this row, emit the others
+		std::vector<ivec4> nextOpenRects;
+		for( const ivec4 &open : openRects ) {
+			auto run = std::find_if( rowRects.begin(), rowRects.end(), [&open]( const ivec4 &r ) { return r.x == open.x && r.z == open.z; } );
+			if( run != rowRects.end() ) {
+				nextOpenRects.push_back( ivec4( open.x, open.y, open.z, run->w ) );
+				rowRects.erase( run );
+			}
+			else {
+				const ivec4 rect = ivec4( ivec2( open.x, open.y ) * mPartialRedrawTileSize, glm::min( ivec2( open.z, open.w ) * mPartialRedrawTileSize, mPartialRedrawSize ) );
+				mDirtyRects.push_back( rect );
+			}
+		}
+		nextOpenRects.insert( nextOpenRects.end(), rowRects.begin(), rowRects.end() );
+		openRects.swap( nextOpenRects );
+	}
+}
+
+void DrawContext::submitPartialRedraw( RenderDevice* device, ContextStateCache* stateCache, bool hasCommands )
+{
+	DeviceContext* context = stateCache->getContext();
+	SwapChain* swapChain = app::getSwapChain();
+	const SwapChainDesc &swapChainDesc = swapChain->GetDesc();
+	const ivec2 size( swapChainDesc.Width, swapChainDesc.Height );
+
+	// (Re)create the persistent render target when needed
+	if( ! mPartialRedrawColor || size != mPartialRedrawSize ) {
+		mPartialRedrawSize = size;
+		mPartialRedrawColor = gx::createTexture( device, TextureDesc()
+			.name( "DrawContext partial redraw color" )
+			.size( size )
+			.type( RESOURCE_DIM_TEX_2D )
+			.format( swapChainDesc.ColorBufferFormat )
+			.usage( USAGE_DEFAULT )
+			.bindFlags( BIND_RENDER_TARGET | BIND_SHADER_RESOURCE ) );
+		mPartialRedrawDepth.Release();
+		if( swapChainDesc.DepthBufferFormat != TEX_FORMAT_UNKNOWN ) {
+			mPartialRedrawDepth = gx::createTexture( device, TextureDesc()
+				.name( "DrawContext partial redraw depth" )
+				.size( size )
+				.type( RESOURCE_DIM_TEX_2D )
+				.format( swapChainDesc.DepthBufferFormat )
+				.usage( USAGE_DEFAULT )
+				.bindFlags( BIND_DEPTH_STENCIL ) );
+		}
+		if( ! mPartialRedrawClearPso ) {
+			initializePartialRedrawPipelines( device );
 		}
+		mPartialRedrawCompositeSrb.Release();
+		mPartialRedrawCompositePso->CreateShaderResourceBinding( &mPartialRedrawCompositeSrb, true );
+		mPartialRedrawCompositeSrb->GetVariableByName( SHADER_TYPE_PIXEL, "rTexture" )->Set( mPartialRedrawColor->GetDefaultView( TEXTURE_VIEW_SHADER_RESOURCE ) );
+		mPreviousTileHashes.clear();
 	}
-	
-	// Submit commands list
+	if( ! mPartialRedrawConstantsValid ) {
+		context->UpdateBuffer( mPartialRedrawConstants, 0, sizeof( vec4 ), &mPartialRedrawClearColor, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+		mPartialRedrawConstantsValid = true;
+	}
+
+	if( hasCommands ) {
+		resolveTransforms();
+	}
+	else {
+		mCommands.clear();
+		mPrimitives.clear();
+	}
+	updateDirtyRects();
+
+	// Redraw the dirty rects into the persistent render target
+	if( ! mDirtyRects.empty() ) {
+		if( hasCommands ) {
+			uploadBuffers( device, stateCache );
+		}
+
+		ITextureView* rtv = mPartialRedrawColor->GetDefaultView( TEXTURE_VIEW_RENDER_TARGET );
+		ITextureView* dsv = mPartialRedrawDepth ? mPartialRedrawDepth->GetDefaultView( TEXTURE_VIEW_DEPTH_STENCIL ) : nullptr;
+		context->SetRenderTargets( 1, &rtv, dsv, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+		const Viewport fullViewport( 0.0f, 0.0f, static_cast<float>( size.x ), static_cast<float>( size.y ) );
+		for( const ivec4 &rect : mDirtyRects ) {
+			stateCache->setPipelineState( mPartialRedrawClearPso );
+			stateCache->commitShaderResources( mPartialRedrawClearSrb, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+			context->SetViewports( 1, &fullViewport, 0, 0 );
+			const gx::Rect scissor( rect.x, rect.y, rect.z, rect.w );
+			context->SetScissorRects( 1, &scissor, 0, 0 );
+			context->Draw( gx::DrawAttribs().numVertices( 3 ) );
+
+			if( hasCommands ) {
+				drawCommands( stateCache, &rect );
+			}
+		}
+	}
+	mPreviousTileHashes.swap( mTileHashes );
+
+	// Composite onto the back buffer
+	ITextureView* backBufferRTV = swapChain->GetCurrentBackBufferRTV();
+	ITextureView* backBufferDSV = swapChain->GetDepthBufferDSV();
+	context->SetRenderTargets( 1, &backBufferRTV, backBufferDSV, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	stateCache->setPipelineState( mPartialRedrawCompositePso );
+	stateCache->commitShaderResources( mPartialRedrawCompositeSrb, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	const Viewport viewport( 0.0f, 0.0f, static_cast<float>( size.x ), static_cast<float>( size.y ) );
+	context->SetViewports( 1, &viewport, 0, 0 );
+	context->Draw( gx::DrawAttribs().numVertices( 3 ) );
+}
+
+void DrawContext::drawCommands( ContextStateCache* stateCache, const ivec4* clipRect )
+{
+	DeviceContext* context = stateCache->getContext();
+	bool pipelineBound = false;
+	size_t boundStateHash = 0;
+	uint32_t boundTextureIndex = 0;
 	for( size_t i = 0; i < mCommands.size(); i++ ) {
 		Command &command = mCommands[i];
 
+		// when clipping only the commands touching the clip rect are drawn, scissored to the rect
+		ivec4 scissorRect = command.scissor;
+		if( clipRect ) {
+			const ivec4 &bounds = mCommandBounds[i];
+			if( bounds.x >= clipRect->z || bounds.z <= clipRect->x || bounds.y >= clipRect->w || bounds.w <= clipRect->y ) {
+				continue;
+			}
+			scissorRect = ivec4( glm::max( ivec2( scissorRect ), ivec2( *clipRect ) ), glm::min( ivec2( scissorRect.z, scissorRect.w ), ivec2( clipRect->z, clipRect->w ) ) );
+		}
+
 		const Viewport viewport( command.viewport.x, command.viewport.y, command.viewport.z, command.viewport.w );
 		context->SetViewports( 1, &viewport, 0, 0 );
-		const gx::Rect scissor( command.scissor.x, command.scissor.y, command.scissor.z, command.scissor.w );
+		const gx::Rect scissor( scissorRect.x, scissorRect.y, scissorRect.z, scissorRect.w );
 		context->SetScissorRects( 1, &scissor, 0, 0 );
 
 		size_t stateHash = command.state.hash();
-		if( i == 0 || stateHash != mCommands[i-1].state.hash() ) {
+		if( ! pipelineBound || stateHash != boundStateHash ) {
 			Pipeline &pipeline = mPipelines[stateHash];
 			pipeline.srb->GetVariableByName( SHADER_TYPE_VERTEX, "constantBuffer" )->Set( mConstantsBufferSRV );
 			if( ! mBindlessResources ) {
@@ -514,19 +916,26 @@ void DrawContext::submit( RenderDevice* device, DeviceContext* context, bool flu
 			else {
 				pipeline.srb->GetVariableByName( SHADER_TYPE_PIXEL, "rTexture" )->SetArray( &mTextures[0], 0, static_cast<uint32_t>( mTextures.size() ) );
 			}
-			context->SetPipelineState( pipeline.pso );
-			context->CommitShaderResources( pipeline.srb, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+			// the variables have just been set so the srb always needs to be committed again
+			stateCache->setPipelineState( pipeline.pso );
+			stateCache->invalidateShaderResources();
+			stateCache->commitShaderResources( pipeline.srb, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+			pipelineBound = true;
+			boundStateHash = stateHash;
+			boundTextureIndex = command.resources.textureIndex;
 		}
 		// if bindless resources are not supported srb might need to be updated
-		else if( ! mBindlessResources && command.resources.textureIndex != mCommands[i-1].resources.textureIndex ) {
+		else if( ! mBindlessResources && command.resources.textureIndex != boundTextureIndex ) {
 			Pipeline &pipeline = mPipelines[stateHash];
 			pipeline.srb->GetVariableByName( SHADER_TYPE_PIXEL, "rTexture" )->Set( getTextureAt( command.resources.textureIndex ) );
-			context->CommitShaderResources( pipeline.srb, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+			stateCache->invalidateShaderResources();
+			stateCache->commitShaderResources( pipeline.srb, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+			boundTextureIndex = command.resources.textureIndex;
 		}
 
 		uint64_t offsets[] = { /*command.vertexOffset*/0 };
 		Buffer* buffers[] = { mVertexBuffer };
-		context->SetVertexBuffers( 0, 1, buffers, offsets, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, gx::SET_VERTEX_BUFFERS_FLAG_RESET );
+		stateCache->setVertexBuffers( 0, 1, buffers, offsets, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, gx::SET_VERTEX_BUFFERS_FLAG_RESET );
 
 		context->DrawIndexed( gx::DrawIndexedAttribs()
 			.indexType( sizeof( Index ) == 2 ? VT_UINT16 : VT_UINT32 )
@@ -535,10 +944,6 @@ void DrawContext::submit( RenderDevice* device, DeviceContext* context, bool flu
 			.firstIndexLocation( command.indexOffset )
 		);
 	}
-
-	if( flushAfterSubmit ) {
-		flush();
-	}
 }
 
 #if defined( IMGUI_DEGUG )
@@ -773,11 +1178,179 @@ gx::CommandListRef DrawContext::bake( DeviceContext* context )
 gx::CommandListRef DrawContext::bake( RenderDevice* device, DeviceContext* context )
 {
 	gx::CommandListRef commandList;
-	submit( device, context, true );
+	submit( device, ScopedContextStateCache( context ), true );
 	context->FinishCommandList( &commandList );
 	return commandList;
 }
 
+DrawStream DrawContext::bakeStream()
+{
+	return bakeStream( app::getRenderDevice() );
+}
+
+DrawStream DrawContext::bakeStream( RenderDevice* device )
+{
+	DrawStream stream;
+	if( ! prepareCommands( device ) ) {
+		return stream;
+	}
+	resolveTransforms();
+
+	// Immutable copies of the geometry and constants, owned by the stream
+	uint32_t vertexCount = static_cast<uint32_t>( mVertex - mVertices.data() );
+	uint32_t indexCount = static_cast<uint32_t>( mIndex - mIndices.data() );
+	BufferData vertexData = { mVertices.data(), vertexCount * sizeof( Vertex ) };
+	device->CreateBuffer( BufferDesc()
+		.name( "DrawStream vertex buffer" )
+		.usage( USAGE_IMMUTABLE )
+		.bindFlags( BIND_VERTEX_BUFFER )
+		.size( vertexCount * sizeof( Vertex ) ),
+		&vertexData, &stream.mVertexBuffer );
+	BufferData indexData = { mIndices.data(), indexCount * sizeof( Index ) };
+	device->CreateBuffer( BufferDesc()
+		.name( "DrawStream index buffer" )
+		.usage( USAGE_IMMUTABLE )
+		.bindFlags( BIND_INDEX_BUFFER )
+		.size( indexCount * sizeof( Index ) ),
+		&indexData, &stream.mIndexBuffer );
+	BufferData constantsData = { mConstants.data(), mConstantCount * sizeof( Constants ) };
+	device->CreateBuffer( BufferDesc()
+		.name( "DrawStream constants buffer" )
+		.usage( USAGE_IMMUTABLE )
+		.bindFlags( BIND_SHADER_RESOURCE )
+		.mode( BUFFER_MODE_STRUCTURED )
+		.size( mConstantCount * sizeof( Constants ) )
+		.elementByteStride( sizeof( Constants ) ),
+		&constantsData, &stream.mConstantsBuffer );
+	const mat4 identity;
+	BufferData streamConstantsData = { &identity, sizeof( mat4 ) };
+	device->CreateBuffer( BufferDesc()
+		.name( "DrawStream stream constants buffer" )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_UNIFORM_BUFFER )
+		.size( sizeof( mat4 ) ),
+		&streamConstantsData, &stream.mStreamConstantsBuffer );
+	BufferView* constantsSRV = stream.mConstantsBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE );
+	stream.mIndexType = sizeof( Index ) == 2 ? VT_UINT16 : VT_UINT32;
+
+	// Resolve one srb per pipeline, or per pipeline and texture if bindless resources are not available
+	std::unordered_map<size_t, ShaderResourceBinding*> srbs;
+	stream.mDraws.reserve( mCommands.size() );
+	for( const Command &command : mCommands ) {
+		size_t stateHash = command.state.hash();
+		size_t srbHash = stateHash;
+		if( ! mBindlessResources ) {
+			hash_combine( srbHash, hash_value( command.resources.textureIndex ) );
+		}
+
+		Pipeline &pipeline = mPipelines[stateHash];
+		auto srbIt = srbs.find( srbHash );
+		if( srbIt == srbs.end() ) {
+			ShaderResourceBindingRef srb;
+			pipeline.pso->CreateShaderResourceBinding( &srb, true );
+			srb->GetVariableByName( SHADER_TYPE_VERTEX, "StreamConstants" )->Set( stream.mStreamConstantsBuffer );
+			srb->GetVariableByName( SHADER_TYPE_VERTEX, "constantBuffer" )->Set( constantsSRV );
+			if( ! mBindlessResources ) {
+				srb->GetVariableByName( SHADER_TYPE_PIXEL, "rTexture" )->Set( getTextureAt( command.resources.textureIndex ) );
+			}
+			else {
+				srb->GetVariableByName( SHADER_TYPE_PIXEL, "rTexture" )->SetArray( &mTextures[0], 0, static_cast<uint32_t>( mTextures.size() ) );
+			}
+			srbIt = srbs.insert( { srbHash, srb.RawPtr() } ).first;
+			stream.mPipelines.push_back( pipeline.pso );
+			stream.mShaderResourceBindings.push_back( srb );
+		}
+
+		DrawStream::Draw draw;
+		draw.pipeline = pipeline.pso;
+		draw.srb = srbIt->second;
+		draw.viewport = command.viewport;
+		draw.scissor = command.scissor;
+		draw.scissorFollowsViewport = ivec4( command.viewport ) == command.scissor;
+		draw.indexOffset = command.indexOffset;
+		draw.indexCount = command.indexCount;
+		stream.mDraws.push_back( draw );
+	}
+
+	flush();
+
+	return stream;
+}
+
+DrawStream::DrawStream()
+	: mIndexType( VT_UINT32 ),
+	mHasTransform( false ),
+	mViewportOverride( false )
+{
+}
+
+void DrawStream::setViewport( const std::pair<vec2, vec2> &viewport )
+{
+	mViewport = vec4( viewport.first, viewport.second );
+	mViewportOverride = true;
+}
+
+void DrawStream::resetViewport()
+{
+	mViewportOverride = false;
+}
+
+void DrawStream::setTransform( const mat4 &transform )
+{
+	mTransform = transform;
+	mHasTransform = true;
+}
+
+void DrawStream::replay()
+{
+	replay( app::getImmediateContext() );
+}
+
+void DrawStream::replay( DeviceContext* context )
+{
+	replay( ScopedContextStateCache( context ) );
+}
+
+void DrawStream::replay( ContextStateCache* stateCache )
+{
+	if( mDraws.empty() ) {
+		return;
+	}
+
+	DeviceContext* context = stateCache->getContext();
+
+	// the constants buffer is shared by every context replaying the stream, an upload skipped here could leave the transform of another replay in place
+	if( mHasTransform ) {
+		const mat4 transform = glm::transpose( mTransform );
+		context->UpdateBuffer( mStreamConstantsBuffer, 0, sizeof( mat4 ), &transform, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+
+	uint64_t offsets[] = { 0 };
+	Buffer* buffers[] = { mVertexBuffer };
+	stateCache->setVertexBuffers( 0, 1, buffers, offsets, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, gx::SET_VERTEX_BUFFERS_FLAG_RESET );
+	stateCache->setIndexBuffer( mIndexBuffer, 0, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+
+	for( const Draw &draw : mDraws ) {
+		// the stream srbs are never modified after baking so redundant commits can be skipped
+		stateCache->setPipelineState( draw.pipeline );
+		stateCache->commitShaderResources( draw.srb, gx::RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+
+		const vec4 &vp = mViewportOverride ? mViewport : draw.viewport;
+		const ivec4 sc = mViewportOverride && draw.scissorFollowsViewport ? ivec4( mViewport ) : draw.scissor;
+		const Viewport viewport( vp.x, vp.y, vp.z, vp.w );
+		context->SetViewports( 1, &viewport, 0, 0 );
+		const gx::Rect scissor( sc.x, sc.y, sc.z, sc.w );
+		context->SetScissorRects( 1, &scissor, 0, 0 );
+
+		context->DrawIndexed( gx::DrawIndexedAttribs()
+			.indexType( mIndexType )
+			.numIndices( draw.indexCount )
+			.flags( gx::DRAW_FLAG_VERIFY_STATES )
+			.firstIndexLocation( draw.indexOffset )
+		);
+	}
+}
+
 void DrawContext::flush()
 {
 	mVertexIndex = 0;
@@ -788,6 +1361,7 @@ void DrawContext::flush()
 	mTextureCount = 1;
 
 	mCommands.clear();
+	mPrimitives.clear();
 }
 
 void DrawContext::startDraw( uint32_t indexCount, uint32_t vertexCount )
@@ -836,6 +1410,10 @@ void DrawContext::startDraw( uint32_t indexCount, uint32_t vertexCount )
 		mIndices.resize( mIndices.size() + indexCount );
 		mIndex = &mIndices[currentIndexIndex];
 	}
+	// keep track of the primitive ranges to be able to find which screen tiles changed
+	if( mPartialRedraw ) {
+		mPrimitives.push_back( { static_cast<uint32_t>( currentVertexIndex ), vertexCount, static_cast<uint32_t>( currentIndexIndex ), indexCount } );
+	}
 	// sets the default values on the allocated vertices
 	for( size_t i = 0; i < vertexCount; ++i ) {
 		mVertex[i].setConstantsIndex( mConstantIndex );
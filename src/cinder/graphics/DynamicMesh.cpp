@@ -0,0 +1,254 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/DynamicMesh.h"
+#include "cinder/app/RendererGx.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/Log.h"
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+DynamicMeshRef DynamicMesh::create( const Mesh::BufferInfo &layout, const Options &options )
+{
+	return create( app::getRenderDevice(), layout, options );
+}
+
+DynamicMeshRef DynamicMesh::create( RenderDevice* device, const Mesh::BufferInfo &layout, const Options &options )
+{
+	return DynamicMeshRef( new DynamicMesh( device, layout, options ) );
+}
+
+DynamicMesh::DynamicMesh( RenderDevice* device, const Mesh::BufferInfo &layout, const Options &options )
+	: mDevice( device ),
+	mVertexCapacity( options.mVertexCapacity ),
+	mIndexCapacity( options.mIndexCapacity ),
+	mIndexType( options.mIndexType ),
+	mUsage( options.mUsage ),
+	mPrimitive( options.mPrimitive ),
+	mName( options.mName )
+{
+	CI_ASSERT_MSG( mIndexType == VT_UINT16 || mIndexType == VT_UINT32, "DynamicMesh indices must be VT_UINT16 or VT_UINT32" );
+	CI_ASSERT_MSG( mUsage == USAGE_DEFAULT || mUsage == USAGE_DYNAMIC, "DynamicMesh storage must be USAGE_DEFAULT or USAGE_DYNAMIC" );
+
+	mLayout = layout.calcInterleaved()
+		.bindFlags( layout.getBindFlags() | BIND_VERTEX_BUFFER )
+		.usage( mUsage )
+		.cpuAccess( mUsage == USAGE_DYNAMIC ? CPU_ACCESS_WRITE : CPU_ACCESS_NONE )
+		.name( mName + " Vertex Buffer" );
+	mVertexStride = mLayout.getAttribs().empty() ? 0 : static_cast<uint32_t>( mLayout.getAttribs().front().getStride() );
+
+	if( mVertexCapacity ) {
+		mVertexBuffer = createStorage( mLayout.getBindFlags(), mVertexCapacity * mVertexStride, mLayout.getName() );
+	}
+	if( mIndexCapacity ) {
+		mIndexBuffer = createStorage( BIND_INDEX_BUFFER, mIndexCapacity * getIndexSize(), mName + " Index Buffer" );
+	}
+	updateMesh( 0, 0 );
+}
+
+BufferRef DynamicMesh::createStorage( BIND_FLAGS bindFlags, uint32_t size, const std::string &name ) const
+{
+	BufferRef buffer;
+	mDevice->CreateBuffer( BufferDesc()
+		.name( name.c_str() )
+		.usage( mUsage )
+		.bindFlags( bindFlags )
+		.cpuAccessFlags( mUsage == USAGE_DYNAMIC ? CPU_ACCESS_WRITE : CPU_ACCESS_NONE )
+		.size( size ),
+		nullptr, &buffer );
+	return buffer;
+}
+
+void DynamicMesh::updateMesh( uint32_t numVertices, uint32_t numIndices )
+{
+	mMesh = Mesh( mDevice, { { mLayout, mVertexBuffer } }, numIndices, mIndexBuffer, mIndexType, mPrimitive );
+	mMesh.mNumVertices = numVertices;
+}
+
+void DynamicMesh::reserve( uint32_t numVertices, uint32_t numIndices )
+{
+	reserve( app::getImmediateContext(), numVertices, numIndices );
+}
+
+void DynamicMesh::reserve( DeviceContext* context, uint32_t numVertices, uint32_t numIndices )
+{
+	if( numVertices <= mVertexCapacity && numIndices <= mIndexCapacity ) {
+		return;
+	}
+
+	// grow geometrically so that meshes growing a little every frame don't reallocate every frame
+	if( numVertices > mVertexCapacity ) {
+		const uint32_t capacity = std::max( numVertices, mVertexCapacity + mVertexCapacity / 2 );
+		BufferRef buffer = createStorage( mLayout.getBindFlags(), capacity * mVertexStride, mLayout.getName() );
+		// dynamic storage is rewritten every frame, only default storage needs its content preserved
+		if( mUsage == USAGE_DEFAULT && mVertexBuffer && getNumVertices() ) {
+			context->CopyBuffer( mVertexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, buffer, 0, getNumVertices() * mVertexStride, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+		}
+		mVertexBuffer = buffer;
+		mVertexCapacity = capacity;
+	}
+	if( numIndices > mIndexCapacity ) {
+		const uint32_t capacity = std::max( numIndices, mIndexCapacity + mIndexCapacity / 2 );
+		BufferRef buffer = createStorage( BIND_INDEX_BUFFER, capacity * getIndexSize(), mName + " Index Buffer" );
+		if( mUsage == USAGE_DEFAULT && mIndexBuffer && getNumIndices() ) {
+			context->CopyBuffer( mIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, buffer, 0, getNumIndices() * getIndexSize(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+		}
+		mIndexBuffer = buffer;
+		mIndexCapacity = capacity;
+	}
+	updateMesh( getNumVertices(), getNumIndices() );
+}
+
+void DynamicMesh::setNumVertices( uint32_t numVertices )
+{
+	if( numVertices > mVertexCapacity ) {
+		CI_LOG_E( "DynamicMesh vertex count " << numVertices << " exceeds its capacity of " << mVertexCapacity << ", call reserve() first" );
+		numVertices = mVertexCapacity;
+	}
+	mMesh.mNumVertices = numVertices;
+}
+
+void DynamicMesh::setNumIndices( uint32_t numIndices )
+{
+	if( numIndices > mIndexCapacity ) {
+		CI_LOG_E( "DynamicMesh index count " << numIndices << " exceeds its capacity of " << mIndexCapacity << ", call reserve() first" );
+		numIndices = mIndexCapacity;
+	}
+	mMesh.mNumIndices = numIndices;
+}
+
+void DynamicMesh::updateRange( uint32_t offset, uint32_t count, const void* data )
+{
+	updateRange( app::getImmediateContext(), offset, count, data );
+}
+
+void DynamicMesh::updateRange( DeviceContext* context, uint32_t offset, uint32_t count, const void* data )
+{
+	CI_ASSERT_MSG( mUsage == USAGE_DEFAULT, "USAGE_DYNAMIC storage is written with mapVertices()" );
+	if( offset + count > mVertexCapacity ) {
+		CI_LOG_E( "DynamicMesh vertex range [" << offset << ", " << offset + count << ") exceeds its capacity of " << mVertexCapacity );
+		return;
+	}
+	if( count ) {
+		context->UpdateBuffer( mVertexBuffer, offset * mVertexStride, count * mVertexStride, data, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+}
+
+void DynamicMesh::updateIndexRange( uint32_t offset, uint32_t count, const void* data )
+{
+	updateIndexRange( app::getImmediateContext(), offset, count, data );
+}
+
+void DynamicMesh::updateIndexRange( DeviceContext* context, uint32_t offset, uint32_t count, const void* data )
+{
+	CI_ASSERT_MSG( mUsage == USAGE_DEFAULT, "USAGE_DYNAMIC storage is written with mapIndices()" );
+	if( offset + count > mIndexCapacity ) {
+		CI_LOG_E( "DynamicMesh index range [" << offset << ", " << offset + count << ") exceeds its capacity of " << mIndexCapacity );
+		return;
+	}
+	if( count ) {
+		context->UpdateBuffer( mIndexBuffer, offset * getIndexSize(), count * getIndexSize(), data, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+}
+
+void* DynamicMesh::mapVertices()
+{
+	return mapVertices( app::getImmediateContext() );
+}
+
+void* DynamicMesh::mapVertices( DeviceContext* context )
+{
+	CI_ASSERT_MSG( mUsage == USAGE_DYNAMIC, "USAGE_DEFAULT storage is written with updateRange()" );
+	PVoid data = nullptr;
+	if( mVertexBuffer ) {
+		context->MapBuffer( mVertexBuffer, MAP_WRITE, MAP_FLAG_DISCARD, data );
+	}
+	return data;
+}
+
+void DynamicMesh::unmapVertices()
+{
+	unmapVertices( app::getImmediateContext() );
+}
+
+void DynamicMesh::unmapVertices( DeviceContext* context )
+{
+	if( mVertexBuffer ) {
+		context->UnmapBuffer( mVertexBuffer, MAP_WRITE );
+	}
+}
+
+void* DynamicMesh::mapIndices()
+{
+	return mapIndices( app::getImmediateContext() );
+}
+
+void* DynamicMesh::mapIndices( DeviceContext* context )
+{
+	CI_ASSERT_MSG( mUsage == USAGE_DYNAMIC, "USAGE_DEFAULT storage is written with updateIndexRange()" );
+	PVoid data = nullptr;
+	if( mIndexBuffer ) {
+		context->MapBuffer( mIndexBuffer, MAP_WRITE, MAP_FLAG_DISCARD, data );
+	}
+	return data;
+}
+
+void DynamicMesh::unmapIndices()
+{
+	unmapIndices( app::getImmediateContext() );
+}
+
+void DynamicMesh::unmapIndices( DeviceContext* context )
+{
+	if( mIndexBuffer ) {
+		context->UnmapBuffer( mIndexBuffer, MAP_WRITE );
+	}
+}
+
+void DynamicMesh::draw( const Mesh::DrawAttribs &attribs ) const
+{
+	if( ! isEmpty() ) {
+		mMesh.draw( attribs );
+	}
+}
+
+void DynamicMesh::draw( DeviceContext* context, const Mesh::DrawAttribs &attribs ) const
+{
+	if( ! isEmpty() ) {
+		mMesh.draw( context, attribs );
+	}
+}
+
+void DynamicMesh::draw( ContextStateCache* stateCache, const Mesh::DrawAttribs &attribs ) const
+{
+	if( ! isEmpty() ) {
+		mMesh.draw( stateCache, attribs );
+	}
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -0,0 +1,328 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/GpuCulling.h"
+#include "cinder/graphics/ContextStateCache.h"
+#include "cinder/graphics/PipelineState.h"
+#include "cinder/app/RendererGx.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/Log.h"
+
+#include <glm/gtc/matrix_access.hpp>
+#include <numeric>
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+namespace {
+
+//! Size in bytes of a DrawIndexedIndirect command: NumIndices, NumInstances, FirstIndexLocation, BaseVertex, FirstInstanceLocation
+constexpr uint32_t DRAW_ARGS_STRIDE = 5 * sizeof( uint32_t );
+
+struct CullingConstants {
+	vec4		planes[6];
+	uint32_t	numObjects;
+	uint32_t	compact;
+	uint32_t	padding[2];
+};
+
+} // anonymous namespace
+
+GpuCullingRef GpuCulling::create( const Options &options )
+{
+	return create( app::getRenderDevice(), options );
+}
+
+GpuCullingRef GpuCulling::create( RenderDevice* device, const Options &options )
+{
+	return GpuCullingRef( new GpuCulling( device, options ) );
+}
+
+GpuCulling::GpuCulling( RenderDevice* device, const Options &options )
+	: mDevice( device ),
+	mName( options.mName ),
+	mCapacity( std::max( options.mCapacity, 1u ) ),
+	mDirtyBegin( 0 ),
+	mDirtyEnd( 0 )
+{
+	static_assert( sizeof( Object ) == 48, "GpuCulling::Object must match the culling shader layout" );
+
+	// without counter buffer support the commands can't be compacted and culled objects are drawn with zero instances
+	mCompact = ( device->GetAdapterInfo().DrawCommand.CapFlags & DRAW_COMMAND_CAP_FLAG_DRAW_INDIRECT_COUNTER_BUFFER ) != 0;
+
+	// the object id is the instance location of each command, so the ids are read from a per-instance buffer of consecutive integers
+	vector<int32_t> objectIds( mCapacity );
+	std::iota( objectIds.begin(), objectIds.end(), 0 );
+	BufferData objectIdData = { objectIds.data(), mCapacity * sizeof( int32_t ) };
+	const string objectIdName = mName + " Object Id Buffer";
+	device->CreateBuffer( BufferDesc()
+		.name( objectIdName.c_str() )
+		.usage( USAGE_IMMUTABLE )
+		.bindFlags( BIND_VERTEX_BUFFER )
+		.size( mCapacity * sizeof( int32_t ) ),
+		&objectIdData, &mObjectIdBuffer );
+
+	const string objectsName = mName + " Objects Buffer";
+	device->CreateBuffer( BufferDesc()
+		.name( objectsName.c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_SHADER_RESOURCE )
+		.mode( BUFFER_MODE_STRUCTURED )
+		.elementByteStride( sizeof( Object ) )
+		.size( mCapacity * sizeof( Object ) ),
+		nullptr, &mObjectsBuffer );
+
+	const string drawArgsName = mName + " Draw Args Buffer";
+	device->CreateBuffer( BufferDesc()
+		.name( drawArgsName.c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_INDIRECT_DRAW_ARGS | BIND_UNORDERED_ACCESS )
+		.mode( BUFFER_MODE_RAW )
+		.elementByteStride( sizeof( uint32_t ) )
+		.size( mCapacity * DRAW_ARGS_STRIDE ),
+		nullptr, &mDrawArgsBuffer );
+
+	const string drawCountName = mName + " Draw Count Buffer";
+	device->CreateBuffer( BufferDesc()
+		.name( drawCountName.c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_INDIRECT_DRAW_ARGS | BIND_UNORDERED_ACCESS )
+		.mode( BUFFER_MODE_RAW )
+		.elementByteStride( sizeof( uint32_t ) )
+		.size( sizeof( uint32_t ) ),
+		nullptr, &mDrawCountBuffer );
+
+	const string constantsName = mName + " Constants Buffer";
+	device->CreateBuffer( BufferDesc()
+		.name( constantsName.c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_UNIFORM_BUFFER )
+		.size( sizeof( CullingConstants ) ),
+		nullptr, &mConstantsBuffer );
+
+	string computeShader = R"( #line 124
+
+		struct Object {
+			float3	center;
+			uint	numIndices;
+			float3	extents;
+			uint	firstIndex;
+			int		baseVertex;
+			uint3	padding;
+		};
+
+		cbuffer CullingConstants {
+			float4	planes[6];
+			uint	numObjects;
+			uint	compact;
+			uint2	padding;
+		};
+
+		StructuredBuffer<Object>	Objects;
+		RWByteAddressBuffer			DrawArgs;
+		RWByteAddressBuffer			DrawCount;
+
+		[numthreads( 64, 1, 1 )]
+		void main( uint3 threadId : SV_DispatchThreadID )
+		{
+			uint objectId = threadId.x;
+			if( objectId >= numObjects ) {
+				return;
+			}
+
+			// the box is outside a plane when its projected radius doesn't reach the plane
+			Object object = Objects[objectId];
+			bool visible = true;
+			[unroll]
+			for( uint i = 0; i < 6; ++i ) {
+				float3 n = planes[i].xyz;
+				visible = visible && dot( n, object.center ) + planes[i].w >= -dot( object.extents, abs( n ) );
+			}
+
+			uint slot = objectId;
+			if( compact ) {
+				if( ! visible ) {
+					return;
+				}
+				DrawCount.InterlockedAdd( 0, 1, slot );
+			}
+			DrawArgs.Store4( slot * 20, uint4( object.numIndices, visible ? 1 : 0, object.firstIndex, asuint( object.baseVertex ) ) );
+			DrawArgs.Store( slot * 20 + 16, objectId );
+		}
+	)";
+
+	mPso = gx::createComputePipelineState( device, gx::ComputePipelineCreateInfo()
+		.name( mName + " Pipeline" )
+		.shader( gx::ShaderCreateInfo()
+			.name( mName + " CS" )
+			.sourceLanguage( gx::SHADER_SOURCE_LANGUAGE_HLSL )
+			.shaderType( gx::SHADER_TYPE_COMPUTE )
+			.source( computeShader )
+		)
+		.defaultVariableType( gx::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE ) );
+	mPso->CreateShaderResourceBinding( &mSrb, true );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "CullingConstants" )->Set( mConstantsBuffer );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "Objects" )->Set( mObjectsBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE ) );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "DrawArgs" )->Set( mDrawArgsBuffer->GetDefaultView( BUFFER_VIEW_UNORDERED_ACCESS ) );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "DrawCount" )->Set( mDrawCountBuffer->GetDefaultView( BUFFER_VIEW_UNORDERED_ACCESS ) );
+}
+
+uint32_t GpuCulling::add( const Mesh &mesh, const AxisAlignedBox &worldBounds, uint32_t lod )
+{
+	if( mObjects.size() >= mCapacity ) {
+		CI_LOG_E( "GpuCulling capacity of " << mCapacity << " objects reached" );
+		return ~0u;
+	}
+	if( ! mesh.getNumIndices() ) {
+		CI_LOG_E( "GpuCulling only supports indexed meshes" );
+		return ~0u;
+	}
+
+	// a single indirect draw can't rebind buffers between commands
+	if( ! mObjects.empty() && ( mSourceIndexBuffer != mesh.getIndexBuffer() || mSourceVertexBuffers != mesh.getVertexBuffers() ) ) {
+		CI_LOG_E( "GpuCulling objects must share the same vertex and index buffers, see MeshPool" );
+		return ~0u;
+	}
+	if( mObjects.empty() ) {
+		mSourceIndexBuffer = mesh.getIndexBuffer();
+		mSourceVertexBuffers = mesh.getVertexBuffers();
+	}
+
+	Object object = {};
+	object.numIndices = mesh.getNumIndices();
+	object.firstIndex = mesh.getFirstIndex();
+	object.baseVertex = static_cast<int32_t>( mesh.getBaseVertex() );
+	if( ! mesh.getLods().empty() ) {
+		const Mesh::Lod &level = mesh.getLods()[std::min<size_t>( lod, mesh.getLods().size() - 1 )];
+		object.firstIndex += level.firstIndex;
+		object.numIndices = level.numIndices;
+	}
+
+	const uint32_t id = getNumObjects();
+	mObjects.push_back( object );
+	setBounds( id, worldBounds );
+	return id;
+}
+
+void GpuCulling::setBounds( uint32_t id, const AxisAlignedBox &worldBounds )
+{
+	CI_ASSERT( id < mObjects.size() );
+	mObjects[id].center = worldBounds.getCenter();
+	mObjects[id].extents = worldBounds.getExtents();
+
+	if( mDirtyBegin == mDirtyEnd ) {
+		mDirtyBegin = id;
+		mDirtyEnd = id + 1;
+	}
+	else {
+		mDirtyBegin = std::min( mDirtyBegin, id );
+		mDirtyEnd = std::max( mDirtyEnd, id + 1 );
+	}
+}
+
+void GpuCulling::clear()
+{
+	mObjects.clear();
+	mSourceIndexBuffer.Release();
+	mSourceVertexBuffers.clear();
+	mDirtyBegin = mDirtyEnd = 0;
+}
+
+void GpuCulling::cull( const mat4 &viewProjection )
+{
+	cull( app::getImmediateContext(), viewProjection );
+}
+
+void GpuCulling::cull( DeviceContext* context, const mat4 &viewProjection )
+{
+	cull( ScopedContextStateCache( context ), viewProjection );
+}
+
+void GpuCulling::cull( ContextStateCache* stateCache, const mat4 &viewProjection )
+{
+	DeviceContext* context = stateCache->getContext();
+
+	if( mDirtyBegin < mDirtyEnd ) {
+		context->UpdateBuffer( mObjectsBuffer, mDirtyBegin * sizeof( Object ), ( mDirtyEnd - mDirtyBegin ) * sizeof( Object ), &mObjects[mDirtyBegin], RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+		mDirtyBegin = mDirtyEnd = 0;
+	}
+
+	// the planes are extracted from the rows of the matrix. The near plane uses the [-1,1] depth range, which is conservative for a [0,1] range.
+	const vec4 row0 = glm::row( viewProjection, 0 );
+	const vec4 row1 = glm::row( viewProjection, 1 );
+	const vec4 row2 = glm::row( viewProjection, 2 );
+	const vec4 row3 = glm::row( viewProjection, 3 );
+	CullingConstants constants = {};
+	constants.planes[0] = row3 + row0;
+	constants.planes[1] = row3 - row0;
+	constants.planes[2] = row3 + row1;
+	constants.planes[3] = row3 - row1;
+	constants.planes[4] = row3 + row2;
+	constants.planes[5] = row3 - row2;
+	constants.numObjects = getNumObjects();
+	constants.compact = mCompact ? 1 : 0;
+	context->UpdateBuffer( mConstantsBuffer, 0, sizeof( CullingConstants ), &constants, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+
+	const uint32_t zero = 0;
+	context->UpdateBuffer( mDrawCountBuffer, 0, sizeof( uint32_t ), &zero, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+
+	if( mObjects.empty() ) {
+		return;
+	}
+
+	// the buffers have just been updated so the commit has to transition them again
+	stateCache->setPipelineState( mPso );
+	stateCache->invalidateShaderResources();
+	stateCache->commitShaderResources( mSrb, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	context->DispatchCompute( DispatchComputeAttribs( ( getNumObjects() + 63 ) / 64, 1, 1 ) );
+}
+
+void GpuCulling::drawIndirect( DeviceContext* context, VALUE_TYPE indexType ) const
+{
+	if( mObjects.empty() ) {
+		return;
+	}
+
+	gx::DrawIndexedIndirectAttribs attribs = gx::DrawIndexedIndirectAttribs()
+		.attribsBuffer( mDrawArgsBuffer )
+		.indexType( indexType )
+		.drawCount( getNumObjects() )
+		.drawArgsStride( DRAW_ARGS_STRIDE )
+		.attribsBufferStateTransitionMode( RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	if( mCompact ) {
+		attribs.counterBuffer( mDrawCountBuffer )
+			.counterBufferStateTransitionMode( RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+	context->DrawIndexedIndirect( attribs );
+}
+
+Mesh::BufferInfo GpuCulling::getObjectIdLayout( geom::Attrib attrib )
+{
+	return Mesh::BufferInfo( { geom::AttribInfo( attrib, geom::DataType::INTEGER, 1, sizeof( int32_t ), 0, 1 ) } );
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -22,47 +22,429 @@
 */
 
 #include "cinder/graphics/Mesh.h"
+#include "cinder/graphics/MeshOptimizer.h"
+#include "cinder/graphics/ThreadPool.h"
 #include "cinder/app/RendererGx.h"
 #include "cinder/Log.h"
 
+#include <glm/gtc/matrix_access.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <ostream>
+
+#if defined( CINDER_MSW )
+	#if ! defined( NOMINMAX )
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#if defined( CINDER_GX_SSE2 )
+	#include <emmintrin.h>
+#endif
+#if defined( CINDER_GX_F16C )
+	#include <immintrin.h>
+#endif
+
 using namespace std;
 
 namespace cinder { namespace graphics {
 
+namespace {
+	//! Returns the number of components stored for an attribute of \a dims dimensions in \a format
+	uint8_t getStorageDims( Mesh::AttribFormat format, uint8_t dims )
+	{
+		switch( format ) {
+		case Mesh::AttribFormat::FLOAT32:
+			return dims;
+		case Mesh::AttribFormat::OCT_SNORM16:
+			return 2;
+		default:
+			// there are no 3 components 8 and 16-bit vertex formats
+			return dims == 3 ? 4 : dims;
+		}
+	}
+
+	//! Returns the size in bytes of a single component stored in \a format
+	size_t getComponentByteSize( Mesh::AttribFormat format, geom::DataType dataType )
+	{
+		switch( format ) {
+		case Mesh::AttribFormat::FLOAT32:
+			return dataType == geom::DataType::DOUBLE ? sizeof( double ) : dataType == geom::DataType::INTEGER ? sizeof( int ) : sizeof( float );
+		case Mesh::AttribFormat::SNORM8:
+		case Mesh::AttribFormat::UNORM8:
+			return 1;
+		default:
+			return 2;
+		}
+	}
+
+	bool isNormalizedInteger( Mesh::AttribFormat format )
+	{
+		return format == Mesh::AttribFormat::SNORM16 || format == Mesh::AttribFormat::UNORM16 || format == Mesh::AttribFormat::SNORM8 || format == Mesh::AttribFormat::UNORM8;
+	}
+
+	//! Scalar version of the SSE2 conversion below, rounds to nearest even like the F16C instructions. glm::packHalf1x16 rounds ties away from zero.
+	uint16_t floatToHalf( float value )
+	{
+		uint32_t bits;
+		std::memcpy( &bits, &value, sizeof( bits ) );
+		const uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+		uint32_t half;
+		if( bits >= ( 127 + 16 ) << 23 ) {
+			// overflow to infinity, NaNs stay quiet NaNs
+			half = bits > 0x7f800000u ? 0x7e00 : 0x7c00;
+		}
+		else if( bits < ( 127 - 14 ) << 23 ) {
+			// the float addition aligns the subnormal mantissa and rounds it
+			const uint32_t magicBits = ( ( 127 - 15 ) + ( 23 - 10 ) + 1 ) << 23;
+			float magic, absValue;
+			std::memcpy( &magic, &magicBits, sizeof( magic ) );
+			std::memcpy( &absValue, &bits, sizeof( absValue ) );
+			absValue += magic;
+			std::memcpy( &half, &absValue, sizeof( half ) );
+			half -= magicBits;
+		}
+		else {
+			const uint32_t mantissaOdd = ( bits >> 13 ) & 1;
+			half = ( bits + 0xfff - ( ( 127 - 15 ) << 23 ) + mantissaOdd ) >> 13;
+		}
+		return static_cast<uint16_t>( half | ( sign >> 16 ) );
+	}
+
+	void floatToHalf( const float* src, uint16_t* dst, size_t count )
+	{
+		size_t i = 0;
+#if defined( CINDER_GX_F16C )
+		for( ; i + 4 <= count; i += 4 ) {
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( dst + i ), _mm_cvtps_ph( _mm_loadu_ps( src + i ), _MM_FROUND_TO_NEAREST_INT ) );
+		}
+#elif defined( CINDER_GX_SSE2 )
+		// round to nearest even conversion from https://gist.github.com/rygorous/2156668
+		const __m128i signMask = _mm_set1_epi32( 0x80000000u );
+		const __m128i f16Max = _mm_set1_epi32( ( 127 + 16 ) << 23 );
+		const __m128i nanBit = _mm_set1_epi32( 0x200 );
+		const __m128i infinity = _mm_set1_epi32( 0x7c00 );
+		const __m128i minNormal = _mm_set1_epi32( ( 127 - 14 ) << 23 );
+		const __m128i subnormalMagic = _mm_set1_epi32( ( ( 127 - 15 ) + ( 23 - 10 ) + 1 ) << 23 );
+		const __m128i normalBias = _mm_set1_epi32( 0xfff - ( ( 127 - 15 ) << 23 ) );
+		for( ; i + 4 <= count; i += 4 ) {
+			const __m128 f = _mm_loadu_ps( src + i );
+			const __m128 sign = _mm_and_ps( _mm_castsi128_ps( signMask ), f );
+			const __m128 absf = _mm_xor_ps( f, sign );
+			const __m128i absi = _mm_castps_si128( absf );
+			const __m128i isRegular = _mm_cmpgt_epi32( f16Max, absi );
+			const __m128i infOrNan = _mm_or_si128( _mm_and_si128( _mm_castps_si128( _mm_cmpunord_ps( absf, absf ) ), nanBit ), infinity );
+			const __m128i isSubnormal = _mm_cmpgt_epi32( minNormal, absi );
+			const __m128i subnormal = _mm_sub_epi32( _mm_castps_si128( _mm_add_ps( absf, _mm_castsi128_ps( subnormalMagic ) ) ), subnormalMagic );
+			const __m128i mantissaOdd = _mm_srai_epi32( _mm_slli_epi32( absi, 31 - 13 ), 31 );
+			const __m128i normal = _mm_srli_epi32( _mm_sub_epi32( _mm_add_epi32( absi, normalBias ), mantissaOdd ), 13 );
+			const __m128i nonSpecial = _mm_or_si128( _mm_and_si128( subnormal, isSubnormal ), _mm_andnot_si128( isSubnormal, normal ) );
+			const __m128i joined = _mm_or_si128( _mm_and_si128( nonSpecial, isRegular ), _mm_andnot_si128( isRegular, infOrNan ) );
+			const __m128i half = _mm_or_si128( joined, _mm_srai_epi32( _mm_castps_si128( sign ), 16 ) );
+			// sign extend the low 16 bits so that the saturating pack leaves them untouched
+			const __m128i halfExtended = _mm_srai_epi32( _mm_slli_epi32( half, 16 ), 16 );
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( dst + i ), _mm_packs_epi32( halfExtended, halfExtended ) );
+		}
+#endif
+		for( ; i < count; ++i ) {
+			dst[i] = floatToHalf( src[i] );
+		}
+	}
+
+	void floatToSnorm16( const float* src, int16_t* dst, size_t count )
+	{
+		size_t i = 0;
+#if defined( CINDER_GX_SSE2 )
+		const __m128 one = _mm_set1_ps( 1.0f ), minusOne = _mm_set1_ps( -1.0f ), scale = _mm_set1_ps( 32767.0f );
+		for( ; i + 8 <= count; i += 8 ) {
+			const __m128i a = _mm_cvtps_epi32( _mm_mul_ps( _mm_max_ps( _mm_min_ps( _mm_loadu_ps( src + i ), one ), minusOne ), scale ) );
+			const __m128i b = _mm_cvtps_epi32( _mm_mul_ps( _mm_max_ps( _mm_min_ps( _mm_loadu_ps( src + i + 4 ), one ), minusOne ), scale ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packs_epi32( a, b ) );
+		}
+#endif
+		for( ; i < count; ++i ) {
+			dst[i] = static_cast<int16_t>( std::round( glm::clamp( src[i], -1.0f, 1.0f ) * 32767.0f ) );
+		}
+	}
+
+	void floatToUnorm16( const float* src, uint16_t* dst, size_t count )
+	{
+		size_t i = 0;
+#if defined( CINDER_GX_SSE2 )
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1.0f ), scale = _mm_set1_ps( 65535.0f );
+		const __m128i bias32 = _mm_set1_epi32( 32768 );
+		const __m128i bias16 = _mm_set1_epi16( static_cast<int16_t>( 0x8000 ) );
+		for( ; i + 8 <= count; i += 8 ) {
+			// sse2 only has a signed saturating pack, so the values are biased to the signed range and back
+			const __m128i a = _mm_sub_epi32( _mm_cvtps_epi32( _mm_mul_ps( _mm_max_ps( _mm_min_ps( _mm_loadu_ps( src + i ), one ), zero ), scale ) ), bias32 );
+			const __m128i b = _mm_sub_epi32( _mm_cvtps_epi32( _mm_mul_ps( _mm_max_ps( _mm_min_ps( _mm_loadu_ps( src + i + 4 ), one ), zero ), scale ) ), bias32 );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_xor_si128( _mm_packs_epi32( a, b ), bias16 ) );
+		}
+#endif
+		for( ; i < count; ++i ) {
+			dst[i] = static_cast<uint16_t>( std::round( glm::clamp( src[i], 0.0f, 1.0f ) * 65535.0f ) );
+		}
+	}
+
+	void floatToSnorm8( const float* src, int8_t* dst, size_t count )
+	{
+		size_t i = 0;
+#if defined( CINDER_GX_SSE2 )
+		const __m128 one = _mm_set1_ps( 1.0f ), minusOne = _mm_set1_ps( -1.0f ), scale = _mm_set1_ps( 127.0f );
+		for( ; i + 16 <= count; i += 16 ) {
+			__m128i v[4];
+			for( size_t j = 0; j < 4; ++j ) {
+				v[j] = _mm_cvtps_epi32( _mm_mul_ps( _mm_max_ps( _mm_min_ps( _mm_loadu_ps( src + i + j * 4 ), one ), minusOne ), scale ) );
+			}
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packs_epi16( _mm_packs_epi32( v[0], v[1] ), _mm_packs_epi32( v[2], v[3] ) ) );
+		}
+#endif
+		for( ; i < count; ++i ) {
+			dst[i] = static_cast<int8_t>( std::round( glm::clamp( src[i], -1.0f, 1.0f ) * 127.0f ) );
+		}
+	}
+
+	void floatToUnorm8( const float* src, uint8_t* dst, size_t count )
+	{
+		size_t i = 0;
+#if defined( CINDER_GX_SSE2 )
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1.0f ), scale = _mm_set1_ps( 255.0f );
+		for( ; i + 16 <= count; i += 16 ) {
+			__m128i v[4];
+			for( size_t j = 0; j < 4; ++j ) {
+				v[j] = _mm_cvtps_epi32( _mm_mul_ps( _mm_max_ps( _mm_min_ps( _mm_loadu_ps( src + i + j * 4 ), one ), zero ), scale ) );
+			}
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( _mm_packs_epi32( v[0], v[1] ), _mm_packs_epi32( v[2], v[3] ) ) );
+		}
+#endif
+		for( ; i < count; ++i ) {
+			dst[i] = static_cast<uint8_t>( std::round( glm::clamp( src[i], 0.0f, 1.0f ) * 255.0f ) );
+		}
+	}
+
+	//! Octahedral encoding of the unit vector \a n
+	vec2 octEncode( vec3 n )
+	{
+		const float length = glm::abs( n.x ) + glm::abs( n.y ) + glm::abs( n.z );
+		if( length <= 0.0f ) {
+			return vec2( 0.0f );
+		}
+		n /= length;
+		vec2 e( n.x, n.y );
+		if( n.z < 0.0f ) {
+			e = ( vec2( 1.0f ) - glm::abs( vec2( e.y, e.x ) ) ) * vec2( e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f );
+		}
+		return e;
+	}
+
+	//! Computes the bounds of \a count positions of \a srcDims components. Missing components are 0, components past the third are ignored.
+	void calcBounds( const float* srcData, uint8_t srcDims, size_t count, vec3* minBounds, vec3* maxBounds )
+	{
+		vec3 minimum( std::numeric_limits<float>::max() ), maximum( std::numeric_limits<float>::lowest() );
+		const uint8_t dims = std::min<uint8_t>( srcDims, 3 );
+		size_t i = 0;
+#if defined( CINDER_GX_SSE2 )
+		if( srcDims == 3 ) {
+			// four packed positions span three registers, x0y0z0x1 y1z1x2y2 z2x3y3z3, so lane j always holds component j % 3
+			__m128 min0 = _mm_set1_ps( std::numeric_limits<float>::max() ), min1 = min0, min2 = min0;
+			__m128 max0 = _mm_set1_ps( std::numeric_limits<float>::lowest() ), max1 = max0, max2 = max0;
+			for( ; i + 4 <= count; i += 4 ) {
+				const float* positions = srcData + i * 3;
+				const __m128 a = _mm_loadu_ps( positions ), b = _mm_loadu_ps( positions + 4 ), c = _mm_loadu_ps( positions + 8 );
+				min0 = _mm_min_ps( min0, a ); min1 = _mm_min_ps( min1, b ); min2 = _mm_min_ps( min2, c );
+				max0 = _mm_max_ps( max0, a ); max1 = _mm_max_ps( max1, b ); max2 = _mm_max_ps( max2, c );
+			}
+			float lanesMin[12], lanesMax[12];
+			_mm_storeu_ps( lanesMin, min0 ); _mm_storeu_ps( lanesMin + 4, min1 ); _mm_storeu_ps( lanesMin + 8, min2 );
+			_mm_storeu_ps( lanesMax, max0 ); _mm_storeu_ps( lanesMax + 4, max1 ); _mm_storeu_ps( lanesMax + 8, max2 );
+			for( size_t j = 0; j < 12; ++j ) {
+				minimum[j % 3] = std::min( minimum[j % 3], lanesMin[j] );
+				maximum[j % 3] = std::max( maximum[j % 3], lanesMax[j] );
+			}
+		}
+		else if( srcDims == 4 ) {
+			__m128 min0 = _mm_set1_ps( std::numeric_limits<float>::max() ), min1 = min0;
+			__m128 max0 = _mm_set1_ps( std::numeric_limits<float>::lowest() ), max1 = max0;
+			for( ; i + 2 <= count; i += 2 ) {
+				const __m128 a = _mm_loadu_ps( srcData + i * 4 ), b = _mm_loadu_ps( srcData + i * 4 + 4 );
+				min0 = _mm_min_ps( min0, a ); min1 = _mm_min_ps( min1, b );
+				max0 = _mm_max_ps( max0, a ); max1 = _mm_max_ps( max1, b );
+			}
+			float lanesMin[4], lanesMax[4];
+			_mm_storeu_ps( lanesMin, _mm_min_ps( min0, min1 ) );
+			_mm_storeu_ps( lanesMax, _mm_max_ps( max0, max1 ) );
+			minimum = vec3( lanesMin[0], lanesMin[1], lanesMin[2] );
+			maximum = vec3( lanesMax[0], lanesMax[1], lanesMax[2] );
+		}
+#endif
+		for( ; i < count; ++i ) {
+			for( uint8_t c = 0; c < dims; ++c ) {
+				minimum[c] = std::min( minimum[c], srcData[i * srcDims + c] );
+				maximum[c] = std::max( maximum[c], srcData[i * srcDims + c] );
+			}
+		}
+		for( uint8_t c = dims; c < 3; ++c ) {
+			minimum[c] = maximum[c] = 0.0f;
+		}
+		*minBounds = minimum;
+		*maxBounds = maximum;
+	}
+
+	//! Returns the distance from \a center to the furthest of \a count positions of \a srcDims components
+	float calcBoundingRadius( const float* srcData, uint8_t srcDims, size_t count, const vec3 &center )
+	{
+		const uint8_t dims = std::min<uint8_t>( srcDims, 3 );
+		float maxDistance2 = 0.0f;
+		for( size_t i = 0; i < count; ++i ) {
+			vec3 position( 0.0f );
+			for( uint8_t c = 0; c < dims; ++c ) {
+				position[c] = srcData[i * srcDims + c];
+			}
+			maxDistance2 = std::max( maxDistance2, glm::dot( position - center, position - center ) );
+		}
+		return glm::sqrt( maxDistance2 );
+	}
+
+	//! Computes the offset and scale remapping the bounds of \a count positions to the range of \a format
+	void calcPositionQuantization( Mesh::AttribFormat format, const float* srcData, uint8_t srcDims, size_t count, vec3* offset, vec3* scale )
+	{
+		vec3 minBounds, maxBounds;
+		calcBounds( srcData, srcDims, count, &minBounds, &maxBounds );
+
+		const bool isSigned = format == Mesh::AttribFormat::SNORM16 || format == Mesh::AttribFormat::SNORM8;
+		*offset = isSigned ? ( minBounds + maxBounds ) * 0.5f : minBounds;
+		*scale = isSigned ? ( maxBounds - minBounds ) * 0.5f : maxBounds - minBounds;
+		for( uint8_t c = 0; c < 3; ++c ) {
+			if( (*scale)[c] <= 0.0f ) {
+				(*scale)[c] = 1.0f;
+			}
+		}
+	}
+
+	//! Converts \a count elements of \a srcDims floats to \a dims components in \a format, written \a dstStride bytes apart. The first three components are remapped with \a offset and \a scale.
+	void convertAttrib( Mesh::AttribFormat format, const float* srcData, uint8_t srcDims, size_t count, uint8_t dims, size_t dstStride, uint8_t* dstData, const vec3 &offset, const vec3 &scale )
+	{
+		// expand, encode and remap blocks of elements to flat arrays of floats on the stack so that the quantization works on contiguous data without heap allocations
+		constexpr size_t kBlockSize = 256;
+		alignas( 16 ) float components[kBlockSize * 4];
+		alignas( 16 ) uint8_t packed[kBlockSize * 4 * sizeof( float )];
+
+		const uint8_t storageDims = getStorageDims( format, dims );
+		const size_t componentSize = getComponentByteSize( format, geom::DataType::FLOAT );
+		const size_t elementSize = storageDims * componentSize;
+		const uint8_t copyDims = std::min( srcDims, dims );
+		const vec3 invScale = 1.0f / scale;
+		for( size_t first = 0; first < count; first += kBlockSize ) {
+			const size_t blockCount = std::min( kBlockSize, count - first );
+			const size_t numComponents = blockCount * storageDims;
+			float* dst = components;
+			if( format == Mesh::AttribFormat::OCT_SNORM16 ) {
+				for( size_t i = first; i < first + blockCount; ++i, dst += 2 ) {
+					const float* src = srcData + i * srcDims;
+					const vec2 e = octEncode( vec3( src[0], srcDims > 1 ? src[1] : 0.0f, srcDims > 2 ? src[2] : 0.0f ) );
+					dst[0] = e.x;
+					dst[1] = e.y;
+				}
+			}
+			else {
+				for( size_t i = first; i < first + blockCount; ++i ) {
+					const float* src = srcData + i * srcDims;
+					for( uint8_t c = 0; c < storageDims; ++c ) {
+						const float value = c < copyDims ? src[c] : ( c == 3 ? 1.0f : 0.0f );
+						*dst++ = c < 3 ? ( value - offset[c] ) * invScale[c] : value;
+					}
+				}
+			}
+
+			switch( format ) {
+			case Mesh::AttribFormat::FLOAT16:
+				floatToHalf( components, reinterpret_cast<uint16_t*>( packed ), numComponents );
+				break;
+			case Mesh::AttribFormat::SNORM16:
+			case Mesh::AttribFormat::OCT_SNORM16:
+				floatToSnorm16( components, reinterpret_cast<int16_t*>( packed ), numComponents );
+				break;
+			case Mesh::AttribFormat::UNORM16:
+				floatToUnorm16( components, reinterpret_cast<uint16_t*>( packed ), numComponents );
+				break;
+			case Mesh::AttribFormat::SNORM8:
+				floatToSnorm8( components, reinterpret_cast<int8_t*>( packed ), numComponents );
+				break;
+			case Mesh::AttribFormat::UNORM8:
+				floatToUnorm8( components, packed, numComponents );
+				break;
+			default:
+				break;
+			}
+
+			// scatter the packed elements to the interleaved destination
+			for( size_t i = 0; i < blockCount; ++i ) {
+				std::memcpy( dstData + ( first + i ) * dstStride, packed + i * elementSize, elementSize );
+			}
+		}
+	}
+} // anonymous namespace
+
 class MeshGeomTarget : public geom::Target {
   public:
-	struct BufferData {
-		BufferData( const Mesh::BufferInfo &info, uint8_t *data, size_t dataSize )
-			: mInfo( info ), mData( data ), mDataSize( dataSize )
-		{}
-		BufferData( BufferData &&rhs )
-			: mInfo( rhs.mInfo ), mData( std::move( rhs.mData ) ), mDataSize( rhs.mDataSize )
-		{}
-	
-		Mesh::BufferInfo			mInfo;
-		std::unique_ptr<uint8_t[]>	mData;
-		size_t						mDataSize;
-	};
-
-	MeshGeomTarget( Mesh *mesh, const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos );
+	MeshGeomTarget( Mesh::SourceData *data, const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos, const Mesh::Optimization &optimization );
 	
 	uint8_t	getAttribDims( geom::Attrib attr ) const override;
 	void	copyAttrib( geom::Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count ) override;
 	void	copyIndices( geom::Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex ) override;
 
-	const std::vector<BufferData>& getBufferData() const { return mBufferData; }
-	size_t getNumVertices() const { return mNumVertices; }
+	//! Reorders the indices and vertices loaded from the source
+	void	optimize();
+
+	//! Returns \a bufferInfos with the attributes missing from \a source removed and packed strides and offsets, or a single interleaved layout of all the source attributes if empty
+	static std::vector<Mesh::BufferInfo> approveBufferInfos( const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos );
+
+	size_t	getNumVertices() const { return mNumVertices; }
+	//! Returns whether the indices fit in 16 bits, taking index narrowing into account
+	bool	use16BitIndices() const;
 	
   protected:
-	std::vector<BufferData>	mBufferData;
+	//! Appends the simplified levels of detail to the indices
+	void	generateLods();
+	//! Moves each vertex to the location specified by \a remap, dropping the ones remapped to ~0
+	void	remapVertices( const std::vector<uint32_t> &remap, size_t numVertices );
+	//! Returns the size of the index buffer required by the current indices
+	size_t	calcIndexBytes() const;
+	//! Returns the total size of the vertex buffers
+	size_t	calcVertexBytes() const;
+
+	Mesh::SourceData		*mData;
 	size_t					mNumVertices;
-	Mesh					*mMesh;
+	Mesh::Optimization		mOptimization;
+	uint8_t					mRequiredBytesPerIndex;
+	std::vector<vec3>		mPositions;
 };
 
-MeshGeomTarget::MeshGeomTarget( Mesh *mesh, const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos )
-	: mMesh( mesh ),
-	mNumVertices( source.getNumVertices() )
+MeshGeomTarget::MeshGeomTarget( Mesh::SourceData *data, const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos, const Mesh::Optimization &optimization )
+	: mData( data ),
+	mNumVertices( source.getNumVertices() ),
+	mOptimization( optimization ),
+	mRequiredBytesPerIndex( 0 )
 {	
+	const std::vector<Mesh::BufferInfo> infos = approveBufferInfos( source, bufferInfos );
+	// allocate the vertex data
+	for( const auto &info : infos ) {
+		size_t requiredBytes = info.calcRequiredStorage( mNumVertices );
+		mData->vertexBuffers.push_back( { info, vector<uint8_t>( requiredBytes ) } );
+	}
+}
+
+std::vector<Mesh::BufferInfo> MeshGeomTarget::approveBufferInfos( const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos )
+{
 	// if no buffer infos available deduce them from what is available in the source
 	std::vector<Mesh::BufferInfo> infos;
 	if( bufferInfos.empty() ) {
@@ -93,29 +475,25 @@ MeshGeomTarget::MeshGeomTarget( Mesh *mesh, const geom::Source &source, const st
 				if( source.getAttribDims( attribInfo.getAttrib() ) ) {
 					uint8_t dims = attribInfo.getDims() ? attribInfo.getDims() : source.getAttribDims( attribInfo.getAttrib() );
 					attribInfos.push_back( { attribInfo.getAttrib(), dims, 0, totalByteSize } );
-					size_t byteSize = attribInfo.getDataType() == geom::DataType::FLOAT ? sizeof( float ) : attribInfo.getDataType() == geom::DataType::INTEGER ? sizeof( int ) : sizeof( double );
-					totalByteSize += dims * byteSize;
+					totalByteSize += bufferInfo.calcAttribByteSize( geom::AttribInfo( attribInfo.getAttrib(), attribInfo.getDataType(), dims, 0, 0, 0 ) );
 				}
 			}
-			Mesh::BufferInfo approvedBufferInfo = Mesh::BufferInfo().bindFlags( bufferInfo.mBindFlags ).cpuAccess( bufferInfo.mCPUAccessFlags ).usage( bufferInfo.mUsage ).mode( bufferInfo.mMode );
+			Mesh::BufferInfo approvedBufferInfo = Mesh::BufferInfo().bindFlags( bufferInfo.mBindFlags ).cpuAccess( bufferInfo.mCPUAccessFlags ).usage( bufferInfo.mUsage ).mode( bufferInfo.mMode ).name( bufferInfo.mName );
+			approvedBufferInfo.mAttribFormats = bufferInfo.mAttribFormats;
 			for( const auto &attribInfo : attribInfos ) {
 				approvedBufferInfo.append( attribInfo.getAttrib(), attribInfo.getDataType(), attribInfo.getDims(), totalByteSize, attribInfo.getOffset() );
 			}
 			infos.push_back( approvedBufferInfo );
 		}
 	}
-	// allocate the list of BufferData
-	for( const auto &info : infos ) {
-		size_t requiredBytes = info.calcRequiredStorage( mNumVertices );
-		mBufferData.push_back( BufferData( info, new uint8_t[requiredBytes], requiredBytes ) );
-	}
+	return infos;
 }
 
 uint8_t	MeshGeomTarget::getAttribDims( geom::Attrib attrib ) const
 {
-	for( const auto &data : mBufferData ) {
-		if( data.mInfo.hasAttrib( attrib ) ) {
-			return data.mInfo.getAttribDims( attrib );
+	for( const auto &bufferData : mData->vertexBuffers ) {
+		if( bufferData.first.hasAttrib( attrib ) ) {
+			return bufferData.first.getAttribDims( attrib );
 		}
 	}
 	return 0;
@@ -127,17 +505,19 @@ void MeshGeomTarget::copyAttrib( geom::Attrib attr, uint8_t dims, size_t /*strid
 	if( getAttribDims( attr ) == 0 )
 		return;
 
-	// we need to find which element of 'mBufferData' containts 'attr'
+	// we need to find which element of 'mData->vertexBuffers' containts 'attr'
 	uint8_t *dstData = nullptr;
 	uint8_t dstDims = 0;
 	size_t dstStride = 0, dstDataSize = 0;
-	for( const auto &bufferData : mBufferData ) {
-		if( bufferData.mInfo.hasAttrib( attr ) ) {
-			auto attrInfo = bufferData.mInfo.getAttribInfo( attr );
+	Mesh::AttribFormat dstFormat = Mesh::AttribFormat::FLOAT32;
+	for( auto &bufferData : mData->vertexBuffers ) {
+		if( bufferData.first.hasAttrib( attr ) ) {
+			auto attrInfo = bufferData.first.getAttribInfo( attr );
+			dstFormat = bufferData.first.getAttribFormat( attr );
 			dstDims = attrInfo.getDims();
 			dstStride = attrInfo.getStride();
-			dstData = bufferData.mData.get() + attrInfo.getOffset();
-			dstDataSize = bufferData.mDataSize;
+			dstData = bufferData.second.data() + attrInfo.getOffset();
+			dstDataSize = bufferData.second.size();
 			break;
 		}
 	}
@@ -156,46 +536,176 @@ void MeshGeomTarget::copyAttrib( geom::Attrib attr, uint8_t dims, size_t /*strid
 		return;
 	}
 
-	if( dstData )
+	if( ! dstData ) {
+		return;
+	}
+	if( attr == geom::Attrib::POSITION ) {
+		vec3 minBounds, maxBounds;
+		calcBounds( srcData, dims, count, &minBounds, &maxBounds );
+		mData->bounds = count ? AxisAlignedBox( minBounds, maxBounds ) : AxisAlignedBox();
+		mData->boundingSphere = Sphere( mData->bounds.getCenter(), calcBoundingRadius( srcData, dims, count, mData->bounds.getCenter() ) );
+
+		// keep a full precision copy of the positions for the overdraw optimization and the simplification
+		if( mOptimization.mOverdraw || ! mOptimization.mLods.empty() ) {
+			mPositions.assign( count, vec3( 0.0f ) );
+			for( size_t i = 0; i < count; ++i ) {
+				for( uint8_t c = 0; c < std::min<uint8_t>( dims, 3 ); ++c ) {
+					mPositions[i][c] = srcData[i * dims + c];
+				}
+			}
+		}
+	}
+	if( dstFormat == Mesh::AttribFormat::FLOAT32 ) {
 		geom::copyData( dims, srcData, count, dstDims, dstStride, reinterpret_cast<float*>( dstData ) );
+	}
+	else {
+		vec3 offset( 0.0f ), scale( 1.0f );
+		if( attr == geom::Attrib::POSITION && isNormalizedInteger( dstFormat ) ) {
+			calcPositionQuantization( dstFormat, srcData, dims, count, &offset, &scale );
+			mData->positionOffset = offset;
+			mData->positionScale = scale;
+		}
+		convertAttrib( dstFormat, srcData, dims, count, dstDims, dstStride, dstData, offset, scale );
+	}
 }
 
 void MeshGeomTarget::copyIndices( geom::Primitive /*primitive*/, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex )
 {
-	mMesh->mNumIndices = (uint32_t) numIndices;
-	if( mMesh->mNumIndices == 0 ) {
-		mMesh->mIndices = BufferRef();
-	}
-	else if( requiredBytesPerIndex <= 2 ) {
-		mMesh->mIndexType = VT_UINT16;
-		std::unique_ptr<uint16_t[]> indices( new uint16_t[numIndices] );
-		copyIndexData( source, mMesh->mNumIndices, indices.get() );
-		
-		mMesh->mIndices.Release();
-		gx::BufferData data = { indices.get(), mMesh->mNumIndices * sizeof( uint16_t ) };
-		mMesh->mDevice->CreateBuffer( BufferDesc()
-			.name( "Mesh Index Buffer" )
-			.usage( USAGE_IMMUTABLE )
-			.bindFlags( BIND_INDEX_BUFFER )
-			.cpuAccessFlags( CPU_ACCESS_NONE )
-			.size( mMesh->mNumIndices * sizeof( uint16_t ) ),
-			&data, &mMesh->mIndices );
+	// the index buffer is created once the source is fully loaded so that indices and vertices can be reordered together
+	mData->indices.assign( source, source + numIndices );
+	mRequiredBytesPerIndex = requiredBytesPerIndex;
+}
+
+void MeshGeomTarget::optimize()
+{
+	const Mesh::Optimization &opt = mOptimization;
+	if( ! opt.mVertexCache && ! opt.mOverdraw && ! opt.mVertexFetch && ! opt.mNarrowIndices && ! opt.mReport && opt.mLods.empty() ) {
+		return;
 	}
-	else {
-		mMesh->mIndexType = VT_UINT32;
-		std::unique_ptr<uint32_t[]> indices( new uint32_t[numIndices] );
-		copyIndexData( source, mMesh->mNumIndices, indices.get() );
 
-		mMesh->mIndices.Release();
-		gx::BufferData data ={ indices.get(), mMesh->mNumIndices * sizeof( uint32_t ) };
-		mMesh->mDevice->CreateBuffer( BufferDesc()
-			.name( "Mesh Index Buffer" )
-			.usage( USAGE_IMMUTABLE )
-			.bindFlags( BIND_INDEX_BUFFER )
-			.cpuAccessFlags( CPU_ACCESS_NONE )
-			.size( mMesh->mNumIndices * sizeof( uint32_t ) ),
-			&data, &mMesh->mIndices );
+	const bool isIndexedTriangleList = mData->primitive == geom::Primitive::TRIANGLES && ! mData->indices.empty();
+	Mesh::OptimizationReport report;
+	report.indexBytesBefore = calcIndexBytes();
+	report.vertexBytesBefore = calcVertexBytes();
+	if( isIndexedTriangleList ) {
+		const VertexCacheStats stats = analyzeVertexCache( mData->indices.data(), mData->indices.size(), mNumVertices, opt.mCacheSize );
+		report.acmrBefore = stats.acmr;
+		report.atvrBefore = stats.atvr;
+	}
+
+	if( ! isIndexedTriangleList && ( opt.mVertexCache || opt.mOverdraw || opt.mVertexFetch || ! opt.mLods.empty() ) ) {
+		CI_LOG_W( "Mesh index and vertex reordering only supports indexed triangle lists" );
+	}
+	else if( isIndexedTriangleList ) {
+		if( opt.mVertexCache ) {
+			optimizeVertexCache( mData->indices.data(), mData->indices.data(), mData->indices.size(), mNumVertices, opt.mCacheSize );
+		}
+		if( opt.mOverdraw ) {
+			if( mPositions.size() == mNumVertices ) {
+				optimizeOverdraw( mData->indices.data(), mData->indices.data(), mData->indices.size(), mPositions.data(), mNumVertices, opt.mOverdrawThreshold, opt.mCacheSize );
+			}
+			else {
+				CI_LOG_W( "Mesh overdraw optimization requires geom::Attrib::POSITION" );
+			}
+		}
+		if( ! opt.mLods.empty() ) {
+			if( mPositions.size() == mNumVertices ) {
+				generateLods();
+			}
+			else {
+				CI_LOG_W( "Mesh level of detail generation requires geom::Attrib::POSITION" );
+			}
+		}
+		// the levels of detail are appended to the full detail indices, so that the vertices are fetched in order of first use by the full detail mesh
+		if( opt.mVertexFetch ) {
+			vector<uint32_t> remap( mNumVertices );
+			const size_t numVertices = optimizeVertexFetchRemap( remap.data(), mData->indices.data(), mData->indices.size(), mNumVertices );
+			remapVertices( remap, numVertices );
+		}
+	}
+
+	report.indexBytesAfter = calcIndexBytes();
+	report.vertexBytesAfter = calcVertexBytes();
+	if( isIndexedTriangleList ) {
+		const VertexCacheStats stats = analyzeVertexCache( mData->indices.data(), mData->indices.size(), mNumVertices, opt.mCacheSize );
+		report.acmrAfter = stats.acmr;
+		report.atvrAfter = stats.atvr;
+	}
+	if( opt.mReport ) {
+		*opt.mReport = report;
+	}
+}
+
+void MeshGeomTarget::generateLods()
+{
+	// every level is simplified from the full detail indices so that its error is relative to the full detail mesh
+	const vector<uint32_t> fullDetail( mData->indices );
+	const vec3 size = mData->bounds.getSize();
+	const float extent = std::max( size.x, std::max( size.y, size.z ) );
+	mData->lods = { { 0, static_cast<uint32_t>( fullDetail.size() ), 0.0f } };
+
+	vector<uint32_t> indices( fullDetail.size() );
+	for( const auto &target : mOptimization.mLods ) {
+		const size_t targetIndexCount = static_cast<size_t>( fullDetail.size() * target.first ) / 3 * 3;
+		float error = 0.0f;
+		const size_t numIndices = simplify( indices.data(), fullDetail.data(), fullDetail.size(), mPositions.data(), mNumVertices, targetIndexCount, target.second, &error );
+		// stop when the previous level could not be reduced any further
+		if( numIndices == 0 || numIndices >= mData->lods.back().numIndices ) {
+			break;
+		}
+		if( mOptimization.mVertexCache ) {
+			optimizeVertexCache( indices.data(), indices.data(), numIndices, mNumVertices, mOptimization.mCacheSize );
+		}
+		mData->lods.push_back( { static_cast<uint32_t>( mData->indices.size() ), static_cast<uint32_t>( numIndices ), error * extent } );
+		mData->indices.insert( mData->indices.end(), indices.begin(), indices.begin() + numIndices );
+	}
+}
+
+void MeshGeomTarget::remapVertices( const vector<uint32_t> &remap, size_t numVertices )
+{
+	for( auto &bufferData : mData->vertexBuffers ) {
+		if( bufferData.first.getAttribs().empty() ) {
+			continue;
+		}
+		// MeshGeomTarget buffers are always interleaved
+		const size_t stride = bufferData.first.getAttribs().front().getStride();
+		vector<uint8_t> data( numVertices * stride );
+		for( size_t v = 0; v < mNumVertices; ++v ) {
+			if( remap[v] != ~0u ) {
+				std::memcpy( data.data() + remap[v] * stride, bufferData.second.data() + v * stride, stride );
+			}
+		}
+		bufferData.second = std::move( data );
+	}
+	if( mPositions.size() == mNumVertices ) {
+		vector<vec3> positions( numVertices );
+		for( size_t v = 0; v < mNumVertices; ++v ) {
+			if( remap[v] != ~0u ) {
+				positions[remap[v]] = mPositions[v];
+			}
+		}
+		mPositions = std::move( positions );
+	}
+	mNumVertices = numVertices;
+}
+
+bool MeshGeomTarget::use16BitIndices() const
+{
+	return mOptimization.mNarrowIndices ? mNumVertices <= 65536 : mRequiredBytesPerIndex <= 2;
+}
+
+size_t MeshGeomTarget::calcIndexBytes() const
+{
+	return mData->indices.size() * ( use16BitIndices() ? sizeof( uint16_t ) : sizeof( uint32_t ) );
+}
+
+size_t MeshGeomTarget::calcVertexBytes() const
+{
+	size_t bytes = 0;
+	for( const auto &bufferData : mData->vertexBuffers ) {
+		bytes += bufferData.second.size();
 	}
+	return bytes;
 }
 
 Mesh::Mesh( const geom::Source &source )
@@ -213,6 +723,11 @@ Mesh::Mesh( const geom::Source &source, const std::vector<Mesh::BufferInfo> &buf
 {
 }
 
+Mesh::Mesh( const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos, const Optimization &optimization )
+	: Mesh( app::getRenderDevice(), source, bufferInfos, optimization )
+{
+}
+
 Mesh::Mesh( uint32_t numVertices, const std::vector<std::pair<BufferInfo, BufferRef>> &vertexBuffers, geom::Primitive primitiveType )
 	: Mesh( app::getRenderDevice(), numVertices, vertexBuffers, primitiveType )
 {
@@ -239,6 +754,38 @@ Mesh::Mesh( const std::vector<StreamData> &vertexStreams, uint32_t numIndices, c
 }
 
 namespace {
+	//! Sets the value type, number of components and normalization of \a layout from the format of \a attribInfo
+	void setLayoutElementFormat( LayoutElement &layout, const Mesh::BufferInfo &bufferInfo, const geom::AttribInfo &attribInfo )
+	{
+		const Mesh::AttribFormat format = bufferInfo.getAttribFormat( attribInfo.getAttrib() );
+		layout.NumComponents = getStorageDims( format, attribInfo.getDims() );
+		layout.IsNormalized = true;
+		switch( format ) {
+		case Mesh::AttribFormat::FLOAT32:
+			CI_ASSERT_MSG( attribInfo.getDataType() != geom::DataType::DOUBLE, "geom::DataType::DOUBLE not supported" );
+			layout.ValueType = attribInfo.getDataType() == geom::DataType::INTEGER ? VT_INT32 : VT_FLOAT32;
+			layout.IsNormalized = bufferInfo.getIsNormalized();
+			break;
+		case Mesh::AttribFormat::FLOAT16:
+			layout.ValueType = VT_FLOAT16;
+			layout.IsNormalized = false;
+			break;
+		case Mesh::AttribFormat::SNORM16:
+		case Mesh::AttribFormat::OCT_SNORM16:
+			layout.ValueType = VT_INT16;
+			break;
+		case Mesh::AttribFormat::UNORM16:
+			layout.ValueType = VT_UINT16;
+			break;
+		case Mesh::AttribFormat::SNORM8:
+			layout.ValueType = VT_INT8;
+			break;
+		case Mesh::AttribFormat::UNORM8:
+			layout.ValueType = VT_UINT8;
+			break;
+		}
+	}
+
 	vector<Mesh::BufferInfo> makeInterleavedBufferInfos( const geom::AttribSet &requestedAttribs )
 	{
 		if( ! requestedAttribs.empty() ) {
@@ -311,10 +858,16 @@ Mesh::Mesh( RenderDevice* device, const geom::Source &source, const geom::Attrib
 }
 
 Mesh::Mesh( RenderDevice* device, const geom::Source &source, const std::vector<BufferInfo> &bufferInfos )
-	: mDevice( device ),
-	mNumVertices( 0 ),
-	mNumIndices( 0 ),
-	mPrimitiveTopology( convertPrimitiveType( source.getPrimitive() ) )
+	: Mesh( device, source, bufferInfos, Optimization() )
+{
+}
+
+Mesh::Mesh( RenderDevice* device, const geom::Source &source, const std::vector<BufferInfo> &bufferInfos, const Optimization &optimization )
+	: Mesh( device, loadSource( source, bufferInfos, optimization ) )
+{
+}
+
+Mesh::SourceData Mesh::loadSource( const geom::Source &source, const std::vector<BufferInfo> &bufferInfos, const Optimization &optimization )
 {
 	// determine set of attributes to request from the source
 	geom::AttribSet requestedAttribs;
@@ -329,38 +882,15 @@ Mesh::Mesh( RenderDevice* device, const geom::Source &source, const std::vector<
 		requestedAttribs = source.getAvailableAttribs();
 	}
 	// load vertices and indices from the source
-	MeshGeomTarget target( this, source, bufferInfos );
+	SourceData data;
+	data.primitive = source.getPrimitive();
+	MeshGeomTarget target( &data, source, bufferInfos, optimization );
 	source.loadInto( &target, requestedAttribs );
+	target.optimize();
 
-	// allocate vertex buffers and build LayoutElement data 
-	uint32_t bufferSlot = 0;
-	uint32_t inputIndex = 0;
-	for( const auto &bufferData : target.getBufferData() ) {
-		BufferRef buffer;
-		BufferData data = { bufferData.mData.get(), static_cast<uint32_t>( bufferData.mDataSize ) };
-		device->CreateBuffer( BufferDesc()
-				.name( bufferData.mInfo.mName.c_str() )
-				.usage( bufferData.mInfo.mUsage )
-				.bindFlags( bufferData.mInfo.mBindFlags )
-				.cpuAccessFlags( bufferData.mInfo.mCPUAccessFlags )
-				.size( static_cast<uint32_t>( bufferData.mDataSize ) ),
-			&data, &buffer );
-		mVertexBuffers.push_back( buffer );
-		mVertexBuffersInfos.push_back( bufferData.mInfo );
-		for( const auto &attribInfo : bufferData.mInfo.getAttribs() ) {
-			LayoutElement layout;
-			layout.InputIndex = inputIndex;
-			layout.BufferSlot = bufferSlot;
-			layout.NumComponents = static_cast<uint32_t>( attribInfo.getDims() );
-			layout.ValueType = VT_FLOAT32;
-			layout.IsNormalized = bufferData.mInfo.mIsNormalized; //TODO: wrong! should be per attrib
-			mVertexLayoutElements.push_back( layout );
-			inputIndex++;
-		}
-		bufferSlot++;
-	}
-
-	mNumVertices = static_cast<uint32_t>( target.getNumVertices() );
+	data.numVertices = static_cast<uint32_t>( target.getNumVertices() );
+	data.use16BitIndices = target.use16BitIndices();
+	return data;
 }
 
 namespace {
@@ -368,13 +898,7 @@ namespace {
 	{
 		gx::BufferData data = { vertexData, vertexDataSize };
 		gx::BufferRef buffer;
-		device->CreateBuffer( gx::BufferDesc()
-			.name( bufferInfo.getName().c_str() )
-			.usage( bufferInfo.getUsage() )
-			.bindFlags( bufferInfo.getBindFlags() )
-			.size( vertexDataSize ),
-			&data, &buffer
-		);
+		device->CreateBuffer( bufferInfo.calcBufferDesc( vertexDataSize ), &data, &buffer );
 
 		return { bufferInfo, buffer };
 	}
@@ -403,6 +927,174 @@ namespace {
 
 		return buffer;
 	}
+
+	//! Creates the index buffer of the raw data constructors, 32-bit indices are narrowed to 16 bits when they all fit
+	std::pair<BufferRef, VALUE_TYPE> makeNarrowedIndexBuffer( RenderDevice* device, uint32_t numIndices, const void *indexData, VALUE_TYPE indexType )
+	{
+		if( indexType == VT_UINT32 && numIndices && indexData ) {
+			const uint32_t* indices = static_cast<const uint32_t*>( indexData );
+			if( calcMaxIndex( indices, numIndices ) <= 0xFFFF ) {
+				std::unique_ptr<uint16_t[]> narrowed( new uint16_t[numIndices] );
+				narrowIndices( indices, numIndices, narrowed.get() );
+				return { makeIndexBuffer( device, numIndices, narrowed.get(), VT_UINT16 ), VT_UINT16 };
+			}
+		}
+		return { makeIndexBuffer( device, numIndices, indexData, indexType ), indexType };
+	}
+}
+
+Mesh::Mesh( const SourceData &data )
+	: Mesh( app::getRenderDevice(), data )
+{
+}
+
+Mesh::Mesh( RenderDevice* device, const SourceData &data )
+	: mDevice( device ),
+	mNumVertices( data.numVertices ),
+	mNumIndices( data.lods.empty() ? static_cast<uint32_t>( data.indices.size() ) : data.lods.front().numIndices ),
+	mPrimitiveTopology( convertPrimitiveType( data.primitive ) ),
+	mIndexType( data.use16BitIndices ? VT_UINT16 : VT_UINT32 ),
+	mPositionScale( data.positionScale ),
+	mPositionOffset( data.positionOffset ),
+	mBounds( data.bounds ),
+	mBoundingSphere( data.boundingSphere ),
+	mLods( data.lods )
+{
+	// allocate vertex buffers and build LayoutElement data 
+	uint32_t bufferSlot = 0;
+	uint32_t inputIndex = 0;
+	for( const auto &vertexBuffer : data.vertexBuffers ) {
+		const BufferInfo &info = vertexBuffer.first;
+		BufferRef buffer;
+		BufferData bufferData = { vertexBuffer.second.data(), static_cast<uint32_t>( vertexBuffer.second.size() ) };
+		device->CreateBuffer( info.calcBufferDesc( static_cast<uint32_t>( vertexBuffer.second.size() ) ), &bufferData, &buffer );
+		mVertexBuffers.push_back( buffer );
+		mVertexBuffersInfos.push_back( info );
+		// vertex pulled buffers are fetched by the shaders and take no input slot
+		if( info.isVertexPulled() ) {
+			continue;
+		}
+		for( const auto &attribInfo : info.getAttribs() ) {
+			LayoutElement layout;
+			layout.InputIndex = inputIndex;
+			layout.BufferSlot = bufferSlot;
+			layout.RelativeOffset = static_cast<uint32_t>( attribInfo.getOffset() );
+			layout.Stride = static_cast<uint32_t>( attribInfo.getStride() );
+			setLayoutElementFormat( layout, info, attribInfo );
+			mVertexLayoutElements.push_back( layout );
+			inputIndex++;
+		}
+		bufferSlot++;
+	}
+
+	// the full detail mesh only covers the first range of the index buffer when levels of detail were generated
+	if( ! data.indices.empty() ) {
+		if( data.use16BitIndices ) {
+			vector<uint16_t> indices( data.indices.size() );
+			narrowIndices( data.indices.data(), data.indices.size(), indices.data() );
+			mIndices = makeIndexBuffer( device, static_cast<uint32_t>( indices.size() ), indices.data(), VT_UINT16 );
+		}
+		else {
+			mIndices = makeIndexBuffer( device, static_cast<uint32_t>( data.indices.size() ), data.indices.data(), VT_UINT32 );
+		}
+	}
+
+	cacheVertexBufferBindings();
+}
+
+Mesh::Mesh( const TriMesh &triMesh, const std::vector<BufferInfo> &bufferInfos )
+	: Mesh( app::getRenderDevice(), triMesh, bufferInfos )
+{
+}
+
+Mesh::Mesh( RenderDevice* device, const TriMesh &triMesh, const std::vector<BufferInfo> &bufferInfos )
+	: mDevice( device ),
+	mNumVertices( static_cast<uint32_t>( triMesh.getNumVertices() ) ),
+	mNumIndices( static_cast<uint32_t>( triMesh.getNumIndices() ) ),
+	mPrimitiveTopology( convertPrimitiveType( triMesh.getPrimitive() ) ),
+	mIndexType( triMesh.getNumVertices() <= 65536 ? VT_UINT16 : VT_UINT32 )
+{
+	const uint8_t positionDims = triMesh.getAttribDims( geom::Attrib::POSITION );
+	if( mNumVertices && positionDims ) {
+		const float* positions = triMesh.getBufferForAttrib( geom::Attrib::POSITION );
+		vec3 minBounds, maxBounds;
+		calcBounds( positions, positionDims, mNumVertices, &minBounds, &maxBounds );
+		mBounds = AxisAlignedBox( minBounds, maxBounds );
+		mBoundingSphere = Sphere( mBounds.getCenter(), calcBoundingRadius( positions, positionDims, mNumVertices, mBounds.getCenter() ) );
+	}
+
+	// interleave every vertex buffer straight from the TriMesh arrays into a single staging allocation
+	const std::vector<BufferInfo> infos = MeshGeomTarget::approveBufferInfos( triMesh, bufferInfos );
+	std::vector<size_t> stagingOffsets;
+	size_t stagingSize = 0;
+	for( const auto &info : infos ) {
+		stagingOffsets.push_back( stagingSize );
+		stagingSize += info.calcRequiredStorage( mNumVertices );
+	}
+	std::unique_ptr<uint8_t[]> staging( new uint8_t[stagingSize] );
+
+	uint32_t bufferSlot = 0;
+	uint32_t inputIndex = 0;
+	for( size_t i = 0; i < infos.size(); ++i ) {
+		const BufferInfo &info = infos[i];
+		uint8_t* bufferData = staging.get() + stagingOffsets[i];
+		for( const auto &attribInfo : info.getAttribs() ) {
+			const geom::Attrib attrib = attribInfo.getAttrib();
+			const AttribFormat format = info.getAttribFormat( attrib );
+			const float* srcData = triMesh.getBufferForAttrib( attrib );
+			const uint8_t srcDims = triMesh.getAttribDims( attrib );
+			uint8_t* dstData = bufferData + attribInfo.getOffset();
+			if( format == AttribFormat::FLOAT32 ) {
+				geom::copyData( srcDims, srcData, mNumVertices, attribInfo.getDims(), attribInfo.getStride(), reinterpret_cast<float*>( dstData ) );
+			}
+			else {
+				vec3 offset( 0.0f ), scale( 1.0f );
+				if( attrib == geom::Attrib::POSITION && isNormalizedInteger( format ) ) {
+					calcPositionQuantization( format, srcData, srcDims, mNumVertices, &offset, &scale );
+					mPositionOffset = offset;
+					mPositionScale = scale;
+				}
+				convertAttrib( format, srcData, srcDims, mNumVertices, attribInfo.getDims(), attribInfo.getStride(), dstData, offset, scale );
+			}
+
+			if( info.isVertexPulled() ) {
+				continue;
+			}
+			LayoutElement layout;
+			layout.InputIndex = inputIndex;
+			layout.BufferSlot = bufferSlot;
+			layout.RelativeOffset = static_cast<uint32_t>( attribInfo.getOffset() );
+			layout.Stride = static_cast<uint32_t>( attribInfo.getStride() );
+			setLayoutElementFormat( layout, info, attribInfo );
+			mVertexLayoutElements.push_back( layout );
+			inputIndex++;
+		}
+
+		const uint32_t size = static_cast<uint32_t>( info.calcRequiredStorage( mNumVertices ) );
+		gx::BufferData data = { bufferData, size };
+		BufferRef buffer;
+		device->CreateBuffer( info.calcBufferDesc( size ), &data, &buffer );
+		mVertexBuffers.push_back( buffer );
+		mVertexBuffersInfos.push_back( info );
+		bufferSlot += info.isVertexPulled() ? 0 : 1;
+	}
+	staging.reset();
+
+	// 32-bit indices are uploaded from the TriMesh directly, only narrowed indices need a copy
+	if( mNumIndices ) {
+		const uint32_t* indices = triMesh.getIndices().data();
+		mIndexType = calcMaxIndex( indices, mNumIndices ) <= 0xFFFF ? VT_UINT16 : VT_UINT32;
+		if( mIndexType == VT_UINT16 ) {
+			vector<uint16_t> narrowed( mNumIndices );
+			narrowIndices( indices, mNumIndices, narrowed.data() );
+			mIndices = makeIndexBuffer( device, mNumIndices, narrowed.data(), VT_UINT16 );
+		}
+		else {
+			mIndices = makeIndexBuffer( device, mNumIndices, indices, VT_UINT32 );
+		}
+	}
+
+	cacheVertexBufferBindings();
 }
 
 Mesh::Mesh( RenderDevice* device, uint32_t numVertices, const std::vector<std::pair<BufferInfo, BufferRef>> &vertexBuffers, geom::Primitive primitiveType )
@@ -430,39 +1122,151 @@ Mesh::Mesh( RenderDevice* device, const std::vector<std::pair<BufferInfo, Buffer
 	for( const auto &vertexBuffer : vertexBuffers ) {
 		mVertexBuffersInfos.push_back( vertexBuffer.first );
 		mVertexBuffers.push_back( vertexBuffer.second );
+		if( vertexBuffer.first.isVertexPulled() ) {
+			continue;
+		}
 		for( const auto &attribInfo : vertexBuffer.first.getAttribs() ) {
 			LayoutElement layout;
 			layout.InputIndex = inputIndex;
 			layout.BufferSlot = bufferSlot;
-			layout.NumComponents = static_cast<uint32_t>( attribInfo.getDims() );
-			CI_ASSERT_MSG( attribInfo.getDataType() != geom::DataType::DOUBLE, "geom::DataType::DOUBLE not supported" );
-			layout.ValueType = attribInfo.getDataType() == geom::DataType::INTEGER ? gx::VT_INT32 : gx::VT_FLOAT32;
-			layout.IsNormalized = vertexBuffer.first.mIsNormalized; //TODO: wrong! should be per attrib
+			// explicit strides describe interleaved buffers whose attributes can't be packed automatically
+			if( attribInfo.getStride() ) {
+				layout.RelativeOffset = static_cast<uint32_t>( attribInfo.getOffset() );
+				layout.Stride = static_cast<uint32_t>( attribInfo.getStride() );
+			}
+			setLayoutElementFormat( layout, vertexBuffer.first, attribInfo );
 			mVertexLayoutElements.push_back( layout );
 			inputIndex++;
 		}
 		bufferSlot++;
 	}
+	cacheVertexBufferBindings();
 }
 
 Mesh::Mesh( RenderDevice* device, const void* vertexData, uint32_t vertexDataSize, const BufferInfo &bufferInfo, uint32_t numIndices, const void *indexData, VALUE_TYPE indexType, geom::Primitive primitiveType )
-	: Mesh( device, { makeBufferInfoPair( device, vertexData, vertexDataSize, bufferInfo ) }, numIndices, makeIndexBuffer( device, numIndices, indexData, indexType ), indexType, primitiveType )
+	: Mesh( device, { makeBufferInfoPair( device, vertexData, vertexDataSize, bufferInfo ) }, numIndices, makeNarrowedIndexBuffer( device, numIndices, indexData, indexType ), primitiveType )
 {
 }
 
 Mesh::Mesh( RenderDevice* device, const std::vector<Mesh::StreamData> &vertexStreams, uint32_t numIndices, const void *indexData, VALUE_TYPE indexType, geom::Primitive primitiveType )
-	: Mesh( device, makeBufferInfoPairs( device, vertexStreams ), numIndices, makeIndexBuffer( device, numIndices, indexData, indexType ), indexType, primitiveType )
+	: Mesh( device, makeBufferInfoPairs( device, vertexStreams ), numIndices, makeNarrowedIndexBuffer( device, numIndices, indexData, indexType ), primitiveType )
+{
+}
+
+Mesh::Mesh( RenderDevice* device, const std::vector<std::pair<BufferInfo, BufferRef>> &vertexBuffers, uint32_t numIndices, const std::pair<BufferRef, VALUE_TYPE> &indexBuffer, geom::Primitive primitiveType )
+	: Mesh( device, vertexBuffers, numIndices, indexBuffer.first, indexBuffer.second, primitiveType )
 {
 }
 
+Mesh::BufferInfo& Mesh::BufferInfo::attribFormat( geom::Attrib attrib, AttribFormat format )
+{
+	for( auto &attribFormat : mAttribFormats ) {
+		if( attribFormat.first == attrib ) {
+			attribFormat.second = format;
+			return *this;
+		}
+	}
+	mAttribFormats.push_back( { attrib, format } );
+	return *this;
+}
+
+Mesh::AttribFormat Mesh::BufferInfo::getAttribFormat( geom::Attrib attrib ) const
+{
+	for( const auto &attribFormat : mAttribFormats ) {
+		if( attribFormat.first == attrib ) {
+			return attribFormat.second;
+		}
+	}
+	return AttribFormat::FLOAT32;
+}
+
+size_t Mesh::BufferInfo::calcAttribByteSize( const geom::AttribInfo &attribInfo ) const
+{
+	const AttribFormat format = getAttribFormat( attribInfo.getAttrib() );
+	return getStorageDims( format, attribInfo.getDims() ) * getComponentByteSize( format, attribInfo.getDataType() );
+}
+
+Mesh::BufferInfo Mesh::BufferInfo::calcInterleaved() const
+{
+	BufferInfo interleaved = BufferInfo().bindFlags( mBindFlags ).usage( mUsage ).cpuAccess( mCPUAccessFlags ).mode( mMode ).normalized( mIsNormalized ).name( mName );
+	interleaved.mAttribFormats = mAttribFormats;
+	size_t stride = 0;
+	for( const auto &attribInfo : getAttribs() ) {
+		stride += calcAttribByteSize( attribInfo );
+	}
+	size_t offset = 0;
+	for( const auto &attribInfo : getAttribs() ) {
+		interleaved.append( attribInfo.getAttrib(), attribInfo.getDataType(), attribInfo.getDims(), stride, offset );
+		offset += calcAttribByteSize( attribInfo );
+	}
+	return interleaved;
+}
+
+BufferDesc Mesh::BufferInfo::calcBufferDesc( uint32_t sizeInBytes ) const
+{
+	BufferDesc desc = BufferDesc()
+		.name( mName.c_str() )
+		.usage( mUsage )
+		.bindFlags( mBindFlags )
+		.cpuAccessFlags( mCPUAccessFlags )
+		.mode( mMode )
+		.size( sizeInBytes );
+	// a structured buffer element is a whole vertex
+	if( mMode == BUFFER_MODE_STRUCTURED ) {
+		desc.elementByteStride( static_cast<uint32_t>( calcVertexByteSize() ) );
+	}
+	return desc;
+}
+
+size_t Mesh::BufferInfo::calcVertexByteSize() const
+{
+	if( getAttribs().empty() ) {
+		return 0;
+	}
+	// non-interleaved buffers hold a single tightly packed attribute
+	const geom::AttribInfo &attribInfo = getAttribs().front();
+	CI_ASSERT_MSG( attribInfo.getStride() || getAttribs().size() == 1, "buffers holding several attributes must be interleaved" );
+	return attribInfo.getStride() ? attribInfo.getStride() : calcAttribByteSize( attribInfo );
+}
+
+std::vector<LayoutElement> Mesh::BufferInfo::calcLayoutElements( uint32_t bufferSlot, uint32_t firstInputIndex ) const
+{
+	std::vector<LayoutElement> elements;
+	for( const auto &attribInfo : getAttribs() ) {
+		LayoutElement layout;
+		layout.InputIndex = firstInputIndex++;
+		layout.BufferSlot = bufferSlot;
+		layout.RelativeOffset = static_cast<uint32_t>( attribInfo.getOffset() );
+		layout.Stride = static_cast<uint32_t>( attribInfo.getStride() );
+		if( attribInfo.getInstanceDivisor() ) {
+			layout.Frequency = INPUT_ELEMENT_FREQUENCY_PER_INSTANCE;
+			layout.InstanceDataStepRate = attribInfo.getInstanceDivisor();
+		}
+		setLayoutElementFormat( layout, *this, attribInfo );
+		elements.push_back( layout );
+	}
+	return elements;
+}
+
 uint8_t	Mesh::getAttribDims( geom::Attrib attr ) const
 {
+	for( const auto &info : mVertexBuffersInfos ) {
+		if( info.hasAttrib( attr ) ) {
+			return info.getAttribDims( attr );
+		}
+	}
 	return 0;
 }
 
 geom::AttribSet	Mesh::getAttribs() const
 {
-	return {};
+	geom::AttribSet attribs;
+	for( const auto &info : mVertexBuffersInfos ) {
+		for( const auto &attribInfo : info.getAttribs() ) {
+			attribs.insert( attribInfo.getAttrib() );
+		}
+	}
+	return attribs;
 }
 
 InputLayoutDesc Mesh::getInputLayoutDesc() const
@@ -475,44 +1279,92 @@ void Mesh::draw( const DrawAttribs &attribs ) const
 	draw( app::getImmediateContext(), attribs );
 }
 
-void Mesh::draw( DeviceContext* context, const DrawAttribs &attribs ) const
+uint64_t Mesh::calcAttribsMask( const geom::AttribSet &attribs )
+{
+	uint64_t mask = 0;
+	for( const auto &attrib : attribs ) {
+		mask |= 1ull << static_cast<uint32_t>( attrib );
+	}
+	return mask;
+}
+
+void Mesh::cacheVertexBufferBindings()
 {
-	vector<gx::Buffer*> buffers;
-	if( attribs.mAttribs.empty() ) {
-		for( auto buffer : getVertexBuffers() ) {
-			buffers.push_back( buffer );
+	// only the buffers read through the input layout are bound to vertex buffer slots
+	mVertexBufferPtrs.clear();
+	mVertexBufferOffsets.clear();
+	mVertexBufferAttribsMasks.clear();
+	for( size_t i = 0; i < mVertexBuffers.size(); ++i ) {
+		if( mVertexBuffersInfos[i].isVertexPulled() ) {
+			continue;
 		}
+		uint64_t attribsMask = 0;
+		for( const auto &attribInfo : mVertexBuffersInfos[i].getAttribs() ) {
+			attribsMask |= 1ull << static_cast<uint32_t>( attribInfo.getAttrib() );
+		}
+		mVertexBufferPtrs.push_back( mVertexBuffers[i] );
+		mVertexBufferOffsets.push_back( 0 );
+		mVertexBufferAttribsMasks.push_back( attribsMask );
+	}
+	CI_ASSERT( mVertexBufferPtrs.size() <= MAX_BUFFER_SLOTS );
+}
+
+BufferView* Mesh::getVertexBufferView( size_t index ) const
+{
+	CI_ASSERT_MSG( mVertexBuffersInfos[index].getBindFlags() & BIND_SHADER_RESOURCE, "vertex buffer not created with BIND_SHADER_RESOURCE" );
+	return mVertexBuffers[index]->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE );
+}
+
+void Mesh::draw( DeviceContext* context, const DrawAttribs &attribs ) const
+{
+	draw( ScopedContextStateCache( context ), attribs );
+}
+
+void Mesh::bind( ContextStateCache* stateCache, const DrawAttribs &attribs ) const
+{
+	const uint32_t numVertexBuffers = static_cast<uint32_t>( mVertexBufferPtrs.size() );
+	if( ! attribs.mAttribsMask ) {
+		stateCache->setVertexBuffers( 0, numVertexBuffers, mVertexBufferPtrs.data(), mVertexBufferOffsets.data(), attribs.mVertexBuffersTransitionMode, attribs.mVertexBuffersFlags );
 	}
 	else {
-		size_t i = 0;
-		for( auto buffer : getVertexBuffers() ) {
-			bool allowed = false;
-			for( const auto &attrib : attribs.mAttribs ) {
-				if( mVertexBuffersInfos[i].hasAttrib( attrib ) ) {
-					allowed = true;
-					break;
-				}
-			}
-			if( allowed ) {
-				buffers.push_back( buffer );
-			}
-			i++;
+		// compact the buffers containing at least one of the requested attribs into consecutive slots
+		Buffer* buffers[MAX_BUFFER_SLOTS];
+		uint64_t offsets[MAX_BUFFER_SLOTS];
+		uint32_t numBuffers = 0;
+		for( uint32_t i = 0; i < numVertexBuffers; ++i ) {
+			buffers[numBuffers] = mVertexBufferPtrs[i];
+			offsets[numBuffers] = mVertexBufferOffsets[i];
+			numBuffers += ( mVertexBufferAttribsMasks[i] & attribs.mAttribsMask ) != 0;
 		}
+		stateCache->setVertexBuffers( 0, numBuffers, buffers, offsets, attribs.mVertexBuffersTransitionMode, attribs.mVertexBuffersFlags );
 	}
-	vector<uint64_t> offsets( buffers.size(), 0 );
+	if( mIndices ) {
+		stateCache->setIndexBuffer( getIndexBuffer(), 0, attribs.mIndexBufferTransitionMode );
+	}
+}
 
-	context->SetVertexBuffers( 0, static_cast<uint32_t>( buffers.size() ), &buffers[0], &offsets[0], attribs.mVertexBuffersTransitionMode, attribs.mVertexBuffersFlags );
+void Mesh::draw( ContextStateCache* stateCache, const DrawAttribs &attribs ) const
+{
+	DeviceContext* context = stateCache->getContext();
+	bind( stateCache, attribs );
 
 	if( getNumIndices() ) {
-		context->SetIndexBuffer( getIndexBuffer(), 0, attribs.mIndexBufferTransitionMode );
+		// levels of detail only differ by the range of the index buffer they use
+		uint32_t firstIndex = mFirstIndex + attribs.mFirstIndexLocation;
+		uint32_t numIndices = getNumIndices();
+		if( ! mLods.empty() ) {
+			const Lod &lod = mLods[std::min<size_t>( attribs.mLod, mLods.size() - 1 )];
+			firstIndex += lod.firstIndex;
+			numIndices = lod.numIndices;
+		}
 		context->DrawIndexed( gx::DrawIndexedAttribs()
 			.indexType( getIndexDataType() )
-			.numIndices( getNumIndices() )
+			.numIndices( numIndices )
 			.flags( attribs.mDrawFlags )
 			.numInstances( attribs.mNumInstances )
 			.firstInstanceLocation( attribs.mFirstInstanceLocation ) 
-			.baseVertex( attribs.mBaseVertex )
-			.firstIndexLocation( attribs.mFirstIndexLocation )
+			.baseVertex( mBaseVertex + attribs.mBaseVertex )
+			.firstIndexLocation( firstIndex )
 		);
 	}
 	else {
@@ -521,11 +1373,622 @@ void Mesh::draw( DeviceContext* context, const DrawAttribs &attribs ) const
 			.flags( attribs.mDrawFlags )
 			.numInstances( attribs.mNumInstances )
 			.firstInstanceLocation( attribs.mFirstInstanceLocation ) 
-			.startVertexLocation( attribs.mStartVertexLocation )
+			.startVertexLocation( mBaseVertex + attribs.mStartVertexLocation )
 		);
 	}
 }
 
+uint32_t Mesh::selectLod( const mat4 &modelViewProjection, float viewportHeight, float pixelError ) const
+{
+	if( mLods.size() < 2 ) {
+		return 0;
+	}
+
+	// around the mesh, an object space distance covers roughly length( row1.xyz ) / w of the vertical clip space range
+	const vec4 row1 = glm::row( modelViewProjection, 1 );
+	const vec4 row3 = glm::row( modelViewProjection, 3 );
+	const float radius = glm::length( mBounds.getSize() ) * 0.5f;
+	const float w = glm::dot( row3, vec4( mBounds.getCenter(), 1.0f ) ) - radius * glm::length( vec3( row3 ) );
+	// use the full detail mesh when the camera is inside the bounds
+	if( w <= 0.0f ) {
+		return 0;
+	}
+	const float pixelsPerUnit = glm::length( vec3( row1 ) ) / w * viewportHeight * 0.5f;
+
+	uint32_t lod = 0;
+	for( uint32_t i = 1; i < mLods.size() && mLods[i].error * pixelsPerUnit <= pixelError; ++i ) {
+		lod = i;
+	}
+	return lod;
+}
+
+namespace {
+	//! Mesh files start with a header, followed by the vertex buffer descriptions, the levels of detail and the vertex and index blobs
+	const char		MESH_FILE_MAGIC[8] = { 'C', 'I', 'G', 'X', 'M', 'E', 'S', 'H' };
+	//! Version 2 stores the bounding sphere radius, version 3 can encode the indices. Older versions are still loaded.
+	const uint32_t	MESH_FILE_VERSION = 3;
+	//! Index blob compressed with encodeIndexBuffer()
+	const uint16_t	MESH_FILE_INDEX_ENCODING_TRIANGLES = 1;
+	//! Blobs are aligned so that they can be handed to CreateBuffer straight from the mapped file
+	const uint64_t	MESH_FILE_BLOB_ALIGNMENT = 64;
+
+	struct MeshFileHeader {
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	primitiveTopology;
+		uint16_t	indexType;
+		//! 0 for raw indices, which can be handed to CreateBuffer without decoding
+		uint16_t	indexEncoding;
+		uint32_t	numVertices;
+		uint32_t	numIndices;
+		uint32_t	numVertexBuffers;
+		uint32_t	numLods;
+		float		boundingRadius;
+		float		positionScale[3];
+		float		positionOffset[3];
+		float		boundsMin[3];
+		float		boundsMax[3];
+		uint64_t	indexDataOffset;
+		uint64_t	indexDataSize;
+	};
+
+	//! Followed by the buffer name and \a numAttribs MeshFileAttrib
+	struct MeshFileBuffer {
+		uint32_t	bindFlags;
+		uint32_t	usage;
+		uint32_t	cpuAccessFlags;
+		uint32_t	mode;
+		uint32_t	isNormalized;
+		uint32_t	numAttribs;
+		uint32_t	nameLength;
+		uint32_t	reserved;
+		uint64_t	dataOffset;
+		uint64_t	dataSize;
+	};
+
+	struct MeshFileAttrib {
+		uint32_t	attrib;
+		uint32_t	dataType;
+		uint32_t	dims;
+		uint32_t	stride;
+		uint32_t	offset;
+		uint32_t	instanceDivisor;
+		uint32_t	format;
+		uint32_t	reserved;
+	};
+
+	struct MeshFileLod {
+		uint32_t	firstIndex;
+		uint32_t	numIndices;
+		float		error;
+		uint32_t	reserved;
+	};
+
+	struct MeshFileBlob {
+		const void*	data;
+		size_t		size;
+	};
+
+	uint64_t alignBlobOffset( uint64_t offset )
+	{
+		return ( offset + MESH_FILE_BLOB_ALIGNMENT - 1 ) & ~( MESH_FILE_BLOB_ALIGNMENT - 1 );
+	}
+
+	template<typename T>
+	void appendPod( std::vector<uint8_t> *dst, const T &value )
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>( &value );
+		dst->insert( dst->end(), bytes, bytes + sizeof( T ) );
+	}
+
+	//! Compresses the triangle list \a indexData into \a encoded, returns false if the encoding doesn't make the indices smaller
+	bool encodeIndexBlob( const void* indexData, size_t numIndices, size_t indexSize, std::vector<uint8_t>* encoded )
+	{
+		if( ! numIndices || numIndices % 3 ) {
+			return false;
+		}
+		std::vector<uint32_t> indices( numIndices );
+		if( indexSize == sizeof( uint16_t ) ) {
+			const uint16_t* indices16 = static_cast<const uint16_t*>( indexData );
+			std::copy( indices16, indices16 + numIndices, indices.begin() );
+		}
+		else {
+			std::memcpy( indices.data(), indexData, numIndices * sizeof( uint32_t ) );
+		}
+		encoded->resize( encodeIndexBufferBound( numIndices ) );
+		encoded->resize( encodeIndexBuffer( encoded->data(), encoded->size(), indices.data(), numIndices ) );
+		return encoded->size() < numIndices * indexSize;
+	}
+
+	void writeMeshFile( const fs::path &path, MeshFileHeader header, const std::vector<Mesh::BufferInfo> &bufferInfos, const std::vector<MeshFileBlob> &vertexBlobs, const MeshFileBlob &indexBlob, const std::vector<Mesh::Lod> &lods )
+	{
+		std::memcpy( header.magic, MESH_FILE_MAGIC, sizeof( MESH_FILE_MAGIC ) );
+		header.version = MESH_FILE_VERSION;
+		header.numVertexBuffers = static_cast<uint32_t>( bufferInfos.size() );
+		header.numLods = static_cast<uint32_t>( lods.size() );
+
+		// the blob offsets are only known once the descriptions are serialized, reserve their size first
+		uint64_t descriptionSize = sizeof( MeshFileHeader ) + lods.size() * sizeof( MeshFileLod );
+		for( const auto &info : bufferInfos ) {
+			descriptionSize += sizeof( MeshFileBuffer ) + info.getName().size() + info.getAttribs().size() * sizeof( MeshFileAttrib );
+		}
+		uint64_t blobOffset = alignBlobOffset( descriptionSize );
+
+		std::vector<uint8_t> description;
+		description.reserve( descriptionSize );
+		std::vector<uint64_t> blobOffsets;
+		for( const auto &blob : vertexBlobs ) {
+			blobOffsets.push_back( blobOffset );
+			blobOffset = alignBlobOffset( blobOffset + blob.size );
+		}
+		header.indexDataOffset = indexBlob.size ? blobOffset : 0;
+		header.indexDataSize = indexBlob.size;
+		appendPod( &description, header );
+
+		for( size_t i = 0; i < bufferInfos.size(); ++i ) {
+			const Mesh::BufferInfo &info = bufferInfos[i];
+			const std::string name = info.getName();
+			MeshFileBuffer buffer = {};
+			buffer.bindFlags = static_cast<uint32_t>( info.getBindFlags() );
+			buffer.usage = static_cast<uint32_t>( info.getUsage() );
+			buffer.cpuAccessFlags = static_cast<uint32_t>( info.getCPUAccessFlags() );
+			buffer.mode = static_cast<uint32_t>( info.getMode() );
+			buffer.isNormalized = info.getIsNormalized() ? 1 : 0;
+			buffer.numAttribs = static_cast<uint32_t>( info.getAttribs().size() );
+			buffer.nameLength = static_cast<uint32_t>( name.size() );
+			buffer.dataOffset = blobOffsets[i];
+			buffer.dataSize = vertexBlobs[i].size;
+			appendPod( &description, buffer );
+			description.insert( description.end(), name.begin(), name.end() );
+			for( const auto &attribInfo : info.getAttribs() ) {
+				MeshFileAttrib attrib = {};
+				attrib.attrib = static_cast<uint32_t>( attribInfo.getAttrib() );
+				attrib.dataType = static_cast<uint32_t>( attribInfo.getDataType() );
+				attrib.dims = attribInfo.getDims();
+				attrib.stride = static_cast<uint32_t>( attribInfo.getStride() );
+				attrib.offset = static_cast<uint32_t>( attribInfo.getOffset() );
+				attrib.instanceDivisor = attribInfo.getInstanceDivisor();
+				attrib.format = static_cast<uint32_t>( info.getAttribFormat( attribInfo.getAttrib() ) );
+				appendPod( &description, attrib );
+			}
+		}
+		for( const auto &lod : lods ) {
+			appendPod( &description, MeshFileLod{ lod.firstIndex, lod.numIndices, lod.error, 0 } );
+		}
+
+		std::ofstream file( path.string(), std::ios::binary | std::ios::trunc );
+		if( ! file ) {
+			throw MeshDataExc( "Failed to open " + path.string() + " for writing" );
+		}
+		const char padding[MESH_FILE_BLOB_ALIGNMENT] = {};
+		uint64_t written = description.size();
+		file.write( reinterpret_cast<const char*>( description.data() ), description.size() );
+		auto writeBlob = [&]( const MeshFileBlob &blob, uint64_t offset ) {
+			file.write( padding, static_cast<std::streamsize>( offset - written ) );
+			file.write( static_cast<const char*>( blob.data ), static_cast<std::streamsize>( blob.size ) );
+			written = offset + blob.size;
+		};
+		for( size_t i = 0; i < vertexBlobs.size(); ++i ) {
+			writeBlob( vertexBlobs[i], blobOffsets[i] );
+		}
+		if( indexBlob.size ) {
+			writeBlob( indexBlob, header.indexDataOffset );
+		}
+		if( ! file ) {
+			throw MeshDataExc( "Failed to write " + path.string() );
+		}
+	}
+
+	//! Read-only mapping of a whole file
+	class MappedFile {
+	public:
+		MappedFile( const fs::path &path )
+			: mData( nullptr ), mSize( 0 )
+		{
+#if defined( CINDER_MSW )
+			mFile = ::CreateFileW( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+			mMapping = nullptr;
+			LARGE_INTEGER size;
+			if( mFile != INVALID_HANDLE_VALUE && ::GetFileSizeEx( mFile, &size ) && size.QuadPart > 0 ) {
+				mMapping = ::CreateFileMappingW( mFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+				if( mMapping ) {
+					mData = static_cast<const uint8_t*>( ::MapViewOfFile( mMapping, FILE_MAP_READ, 0, 0, 0 ) );
+					mSize = mData ? static_cast<size_t>( size.QuadPart ) : 0;
+				}
+			}
+#else
+			mFileDescriptor = ::open( path.c_str(), O_RDONLY );
+			struct stat fileStat;
+			if( mFileDescriptor != -1 && ::fstat( mFileDescriptor, &fileStat ) == 0 && fileStat.st_size > 0 ) {
+				void* data = ::mmap( nullptr, static_cast<size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, mFileDescriptor, 0 );
+				if( data != MAP_FAILED ) {
+					mData = static_cast<const uint8_t*>( data );
+					mSize = static_cast<size_t>( fileStat.st_size );
+				}
+			}
+#endif
+		}
+		~MappedFile()
+		{
+#if defined( CINDER_MSW )
+			if( mData ) ::UnmapViewOfFile( mData );
+			if( mMapping ) ::CloseHandle( mMapping );
+			if( mFile != INVALID_HANDLE_VALUE ) ::CloseHandle( mFile );
+#else
+			if( mData ) ::munmap( const_cast<uint8_t*>( mData ), mSize );
+			if( mFileDescriptor != -1 ) ::close( mFileDescriptor );
+#endif
+		}
+		MappedFile( const MappedFile &other ) = delete;
+		MappedFile& operator=( const MappedFile &other ) = delete;
+
+		const uint8_t*	getData() const { return mData; }
+		size_t			getSize() const { return mSize; }
+
+	protected:
+		const uint8_t*	mData;
+		size_t			mSize;
+#if defined( CINDER_MSW )
+		HANDLE			mFile;
+		HANDLE			mMapping;
+#else
+		int				mFileDescriptor;
+#endif
+	};
+
+	//! Bounds checked reads from a mapped mesh file
+	class MeshFileReader {
+	public:
+		MeshFileReader( const MappedFile &file, const fs::path &path ) : mFile( file ), mPath( path ), mOffset( 0 ) {}
+
+		const void* read( size_t size )
+		{
+			if( size > mFile.getSize() || mOffset > mFile.getSize() - size ) {
+				throw MeshDataExc( "Unexpected end of file in " + mPath.string() );
+			}
+			const void* data = mFile.getData() + mOffset;
+			mOffset += size;
+			return data;
+		}
+		template<typename T>
+		T read()
+		{
+			T value;
+			std::memcpy( &value, read( sizeof( T ) ), sizeof( T ) );
+			return value;
+		}
+		const void* getBlob( uint64_t offset, uint64_t size ) const
+		{
+			if( offset % MESH_FILE_BLOB_ALIGNMENT || size > mFile.getSize() || offset > mFile.getSize() - size ) {
+				throw MeshDataExc( "Invalid data range in " + mPath.string() );
+			}
+			return mFile.getData() + offset;
+		}
+
+	protected:
+		const MappedFile	&mFile;
+		const fs::path		&mPath;
+		size_t				mOffset;
+	};
+
+	//! Validated description of a mesh file, the blobs point into the mapping
+	struct MeshFileContents {
+		MeshFileHeader	header;
+		std::vector<std::pair<Mesh::BufferInfo, MeshFileBlob>> vertexBuffers;
+		std::vector<Mesh::Lod>	lods;
+		MeshFileBlob	indexBlob;
+		//! Number of indices of every level of detail
+		uint32_t		numIndices;
+	};
+
+	MeshFileContents readMeshFile( const MappedFile &file, const fs::path &path )
+	{
+		MeshFileReader reader( file, path );
+		MeshFileContents contents = {};
+		contents.header = reader.read<MeshFileHeader>();
+		const MeshFileHeader &header = contents.header;
+		if( std::memcmp( header.magic, MESH_FILE_MAGIC, sizeof( MESH_FILE_MAGIC ) ) != 0 ) {
+			throw MeshDataExc( path.string() + " is not a mesh file" );
+		}
+		if( header.version < 1 || header.version > MESH_FILE_VERSION ) {
+			throw MeshDataExc( "Unsupported mesh file version " + std::to_string( header.version ) + " in " + path.string() );
+		}
+		const VALUE_TYPE indexType = static_cast<VALUE_TYPE>( header.indexType );
+		if( indexType != VT_UINT16 && indexType != VT_UINT32 ) {
+			throw MeshDataExc( "Invalid index type in " + path.string() );
+		}
+		if( header.indexEncoding != 0 && header.indexEncoding != MESH_FILE_INDEX_ENCODING_TRIANGLES ) {
+			throw MeshDataExc( "Unsupported index encoding in " + path.string() );
+		}
+
+		for( uint32_t i = 0; i < header.numVertexBuffers; ++i ) {
+			const MeshFileBuffer buffer = reader.read<MeshFileBuffer>();
+			const char* name = static_cast<const char*>( reader.read( buffer.nameLength ) );
+			Mesh::BufferInfo info = Mesh::BufferInfo()
+				.bindFlags( static_cast<BIND_FLAGS>( buffer.bindFlags ) )
+				.usage( static_cast<USAGE>( buffer.usage ) )
+				.cpuAccess( static_cast<CPU_ACCESS_FLAGS>( buffer.cpuAccessFlags ) )
+				.mode( static_cast<BUFFER_MODE>( buffer.mode ) )
+				.normalized( buffer.isNormalized != 0 )
+				.name( std::string( name, buffer.nameLength ) );
+			for( uint32_t a = 0; a < buffer.numAttribs; ++a ) {
+				const MeshFileAttrib attrib = reader.read<MeshFileAttrib>();
+				info.attrib( static_cast<geom::Attrib>( attrib.attrib ), static_cast<geom::DataType>( attrib.dataType ), static_cast<uint8_t>( attrib.dims ), attrib.stride, attrib.offset, attrib.instanceDivisor );
+				if( static_cast<Mesh::AttribFormat>( attrib.format ) != Mesh::AttribFormat::FLOAT32 ) {
+					info.attribFormat( static_cast<geom::Attrib>( attrib.attrib ), static_cast<Mesh::AttribFormat>( attrib.format ) );
+				}
+			}
+			contents.vertexBuffers.push_back( { info, { reader.getBlob( buffer.dataOffset, buffer.dataSize ), static_cast<size_t>( buffer.dataSize ) } } );
+		}
+
+		// the levels of detail follow the full detail indices, their ranges must stay within the index data
+		uint64_t numIndices = header.numIndices;
+		for( uint32_t i = 0; i < header.numLods; ++i ) {
+			const MeshFileLod lod = reader.read<MeshFileLod>();
+			contents.lods.push_back( { lod.firstIndex, lod.numIndices, lod.error } );
+			numIndices = std::max<uint64_t>( numIndices, uint64_t{ lod.firstIndex } + lod.numIndices );
+		}
+		if( header.indexDataSize ) {
+			contents.indexBlob = { reader.getBlob( header.indexDataOffset, header.indexDataSize ), static_cast<size_t>( header.indexDataSize ) };
+		}
+		const size_t indexSize = indexType == VT_UINT16 ? sizeof( uint16_t ) : sizeof( uint32_t );
+		// encoded triangles take at least one byte each after the codec version byte
+		const uint64_t maxIndices = header.indexEncoding == MESH_FILE_INDEX_ENCODING_TRIANGLES ? ( header.indexDataSize ? ( header.indexDataSize - 1 ) * 3 : 0 ) : header.indexDataSize / indexSize;
+		if( numIndices > maxIndices ) {
+			throw MeshDataExc( "Index ranges exceed the index data in " + path.string() );
+		}
+		contents.numIndices = static_cast<uint32_t>( numIndices );
+		return contents;
+	}
+
+	//! Returns the indices of \a contents, decoding them to \a decodedIndices if they are encoded
+	MeshFileBlob getMeshFileIndices( const MeshFileContents &contents, const fs::path &path, std::vector<uint8_t> *decodedIndices )
+	{
+		if( contents.header.indexEncoding != MESH_FILE_INDEX_ENCODING_TRIANGLES ) {
+			return contents.indexBlob;
+		}
+		const size_t indexSize = contents.header.indexType == VT_UINT16 ? sizeof( uint16_t ) : sizeof( uint32_t );
+		decodedIndices->resize( size_t{ contents.numIndices } * indexSize );
+		if( ! decodeIndexBuffer( decodedIndices->data(), contents.numIndices, indexSize, static_cast<const uint8_t*>( contents.indexBlob.data ), contents.indexBlob.size ) ) {
+			throw MeshDataExc( "Invalid encoded indices in " + path.string() );
+		}
+		return { decodedIndices->data(), decodedIndices->size() };
+	}
+
+	//! Version 1 files fall back to the sphere enclosing the bounds
+	Sphere getMeshFileBoundingSphere( const MeshFileHeader &header )
+	{
+		const AxisAlignedBox bounds( vec3( header.boundsMin[0], header.boundsMin[1], header.boundsMin[2] ), vec3( header.boundsMax[0], header.boundsMax[1], header.boundsMax[2] ) );
+		return Sphere( bounds.getCenter(), header.version == 1 ? glm::length( bounds.getExtents() ) : header.boundingRadius );
+	}
+}
+
+void Mesh::save( const fs::path &path, bool encodeIndices ) const
+{
+	save( app::getImmediateContext(), path, encodeIndices );
+}
+
+void Mesh::save( DeviceContext* context, const fs::path &path, bool encodeIndices ) const
+{
+	MeshFileHeader header = {};
+	header.primitiveTopology = static_cast<uint32_t>( mPrimitiveTopology );
+	header.indexType = static_cast<uint16_t>( mIndexType );
+	header.numVertices = mNumVertices;
+	header.numIndices = mNumIndices;
+	for( int i = 0; i < 3; ++i ) {
+		header.positionScale[i] = mPositionScale[i];
+		header.positionOffset[i] = mPositionOffset[i];
+		header.boundsMin[i] = mBounds.getMin()[i];
+		header.boundsMax[i] = mBounds.getMax()[i];
+	}
+	header.boundingRadius = mBoundingSphere.getRadius();
+
+	// pooled meshes only own a range of the shared buffers, the base vertex and first index are folded back to 0
+	std::vector<std::vector<uint8_t>> vertexData;
+	std::vector<MeshFileBlob> vertexBlobs;
+	for( size_t i = 0; i < mVertexBuffers.size(); ++i ) {
+		// non-interleaved buffers have a 0 attribute stride, their vertex size is the packed attribute size
+		const uint32_t stride = static_cast<uint32_t>( mVertexBuffersInfos[i].calcVertexByteSize() );
+		vertexData.push_back( readBuffer( mDevice, context, mVertexBuffers[i], mBaseVertex * stride, mPoolAllocation ? mNumVertices * stride : 0 ) );
+		vertexBlobs.push_back( { vertexData.back().data(), vertexData.back().size() } );
+	}
+
+	uint32_t numIndices = mNumIndices;
+	for( const auto &lod : mLods ) {
+		numIndices = std::max( numIndices, lod.firstIndex + lod.numIndices );
+	}
+	const uint32_t indexSize = mIndexType == VT_UINT16 ? sizeof( uint16_t ) : sizeof( uint32_t );
+	const std::vector<uint8_t> indexData = mIndices && numIndices ? readBuffer( mDevice, context, mIndices, mFirstIndex * indexSize, numIndices * indexSize ) : std::vector<uint8_t>();
+	MeshFileBlob indexBlob = { indexData.data(), indexData.size() };
+	std::vector<uint8_t> encodedIndices;
+	if( encodeIndices && mPrimitiveTopology == PRIMITIVE_TOPOLOGY_TRIANGLE_LIST && encodeIndexBlob( indexData.data(), indexData.size() / indexSize, indexSize, &encodedIndices ) ) {
+		header.indexEncoding = MESH_FILE_INDEX_ENCODING_TRIANGLES;
+		indexBlob = { encodedIndices.data(), encodedIndices.size() };
+	}
+
+	writeMeshFile( path, header, mVertexBuffersInfos, vertexBlobs, indexBlob, mLods );
+}
+
+void Mesh::save( const fs::path &path, const SourceData &data, bool encodeIndices )
+{
+	MeshFileHeader header = {};
+	header.primitiveTopology = static_cast<uint32_t>( convertPrimitiveType( data.primitive ) );
+	header.indexType = static_cast<uint16_t>( data.use16BitIndices ? VT_UINT16 : VT_UINT32 );
+	header.numVertices = data.numVertices;
+	header.numIndices = data.lods.empty() ? static_cast<uint32_t>( data.indices.size() ) : data.lods.front().numIndices;
+	for( int i = 0; i < 3; ++i ) {
+		header.positionScale[i] = data.positionScale[i];
+		header.positionOffset[i] = data.positionOffset[i];
+		header.boundsMin[i] = data.bounds.getMin()[i];
+		header.boundsMax[i] = data.bounds.getMax()[i];
+	}
+	header.boundingRadius = data.boundingSphere.getRadius();
+
+	std::vector<BufferInfo> bufferInfos;
+	std::vector<MeshFileBlob> vertexBlobs;
+	for( const auto &vertexBuffer : data.vertexBuffers ) {
+		bufferInfos.push_back( vertexBuffer.first );
+		vertexBlobs.push_back( { vertexBuffer.second.data(), vertexBuffer.second.size() } );
+	}
+
+	std::vector<uint16_t> indices16;
+	MeshFileBlob indexBlob = { data.indices.data(), data.indices.size() * sizeof( uint32_t ) };
+	if( data.use16BitIndices ) {
+		indices16.resize( data.indices.size() );
+		narrowIndices( data.indices.data(), data.indices.size(), indices16.data() );
+		indexBlob = { indices16.data(), indices16.size() * sizeof( uint16_t ) };
+	}
+	std::vector<uint8_t> encodedIndices;
+	if( encodeIndices && data.primitive == geom::Primitive::TRIANGLES && encodeIndexBlob( data.indices.data(), data.indices.size(), sizeof( uint32_t ), &encodedIndices ) && encodedIndices.size() < indexBlob.size ) {
+		header.indexEncoding = MESH_FILE_INDEX_ENCODING_TRIANGLES;
+		indexBlob = { encodedIndices.data(), encodedIndices.size() };
+	}
+
+	writeMeshFile( path, header, bufferInfos, vertexBlobs, indexBlob, data.lods );
+}
+
+Mesh Mesh::load( const fs::path &path )
+{
+	return load( app::getRenderDevice(), path );
+}
+
+Mesh Mesh::load( RenderDevice* device, const fs::path &path )
+{
+	MappedFile file( path );
+	if( ! file.getData() ) {
+		throw MeshDataExc( "Failed to map " + path.string() );
+	}
+	const MeshFileContents contents = readMeshFile( file, path );
+	const MeshFileHeader &header = contents.header;
+
+	// the vertex and index blobs are passed to CreateBuffer straight from the mapping
+	std::vector<std::pair<BufferInfo, BufferRef>> vertexBuffers;
+	for( const auto &vertexBuffer : contents.vertexBuffers ) {
+		BufferData bufferData = { vertexBuffer.second.data, static_cast<uint32_t>( vertexBuffer.second.size ) };
+		BufferRef buffer;
+		device->CreateBuffer( vertexBuffer.first.calcBufferDesc( static_cast<uint32_t>( vertexBuffer.second.size ) ), &bufferData, &buffer );
+		vertexBuffers.push_back( { vertexBuffer.first, buffer } );
+	}
+
+	BufferRef indexBuffer;
+	if( header.indexDataSize ) {
+		// encoded indices cover every level of detail and are decoded to an intermediate copy
+		std::vector<uint8_t> decodedIndices;
+		const MeshFileBlob indices = getMeshFileIndices( contents, path, &decodedIndices );
+		BufferData indexData = { indices.data, static_cast<uint32_t>( indices.size ) };
+		device->CreateBuffer( BufferDesc()
+				.name( "Mesh index buffer" )
+				.usage( USAGE_IMMUTABLE )
+				.bindFlags( BIND_INDEX_BUFFER )
+				.size( indexData.DataSize ),
+			&indexData, &indexBuffer );
+	}
+
+	Mesh mesh( device, vertexBuffers, header.numIndices, indexBuffer, static_cast<VALUE_TYPE>( header.indexType ), geom::Primitive::TRIANGLES );
+	mesh.mNumVertices = header.numVertices;
+	mesh.mPrimitiveTopology = static_cast<PRIMITIVE_TOPOLOGY>( header.primitiveTopology );
+	mesh.mPositionScale = vec3( header.positionScale[0], header.positionScale[1], header.positionScale[2] );
+	mesh.mPositionOffset = vec3( header.positionOffset[0], header.positionOffset[1], header.positionOffset[2] );
+	mesh.mBounds = AxisAlignedBox( vec3( header.boundsMin[0], header.boundsMin[1], header.boundsMin[2] ), vec3( header.boundsMax[0], header.boundsMax[1], header.boundsMax[2] ) );
+	mesh.mBoundingSphere = getMeshFileBoundingSphere( header );
+	mesh.mLods = contents.lods;
+	// the stored layouts are explicit, match the element offsets and strides of a Mesh built from a geom::Source
+	size_t element = 0;
+	for( const auto &vertexBuffer : vertexBuffers ) {
+		if( vertexBuffer.first.isVertexPulled() ) {
+			continue;
+		}
+		for( const auto &attribInfo : vertexBuffer.first.getAttribs() ) {
+			mesh.mVertexLayoutElements[element].RelativeOffset = static_cast<uint32_t>( attribInfo.getOffset() );
+			mesh.mVertexLayoutElements[element].Stride = static_cast<uint32_t>( attribInfo.getStride() );
+			++element;
+		}
+	}
+	return mesh;
+}
+
+Mesh::SourceData Mesh::loadSource( const fs::path &path )
+{
+	MappedFile file( path );
+	if( ! file.getData() ) {
+		throw MeshDataExc( "Failed to map " + path.string() );
+	}
+	const MeshFileContents contents = readMeshFile( file, path );
+	const MeshFileHeader &header = contents.header;
+
+	SourceData data;
+	for( const auto &vertexBuffer : contents.vertexBuffers ) {
+		const uint8_t* bytes = static_cast<const uint8_t*>( vertexBuffer.second.data );
+		data.vertexBuffers.push_back( { vertexBuffer.first, std::vector<uint8_t>( bytes, bytes + vertexBuffer.second.size ) } );
+	}
+	if( header.indexDataSize ) {
+		std::vector<uint8_t> decodedIndices;
+		const MeshFileBlob indices = getMeshFileIndices( contents, path, &decodedIndices );
+		data.indices.resize( contents.numIndices );
+		if( header.indexType == VT_UINT16 ) {
+			const uint16_t* indices16 = static_cast<const uint16_t*>( indices.data );
+			std::copy( indices16, indices16 + contents.numIndices, data.indices.begin() );
+		}
+		else {
+			std::memcpy( data.indices.data(), indices.data, data.indices.size() * sizeof( uint32_t ) );
+		}
+	}
+	data.use16BitIndices = header.indexType == VT_UINT16;
+	data.numVertices = header.numVertices;
+	data.primitive = convertPrimitiveType( static_cast<PRIMITIVE_TOPOLOGY>( header.primitiveTopology ) );
+	data.positionScale = vec3( header.positionScale[0], header.positionScale[1], header.positionScale[2] );
+	data.positionOffset = vec3( header.positionOffset[0], header.positionOffset[1], header.positionOffset[2] );
+	data.bounds = AxisAlignedBox( vec3( header.boundsMin[0], header.boundsMin[1], header.boundsMin[2] ), vec3( header.boundsMax[0], header.boundsMax[1], header.boundsMax[2] ) );
+	data.boundingSphere = getMeshFileBoundingSphere( header );
+	data.lods = contents.lods;
+	return data;
+}
+
+std::ostream& operator<<( std::ostream &os, const Mesh::OptimizationReport &report )
+{
+	os << "ACMR: " << report.acmrBefore << " -> " << report.acmrAfter
+		<< ", ATVR: " << report.atvrBefore << " -> " << report.atvrAfter
+		<< ", index bytes: " << report.indexBytesBefore << " -> " << report.indexBytesAfter
+		<< ", vertex bytes: " << report.vertexBytesBefore << " -> " << report.vertexBytesAfter;
+	return os;
+}
+
+std::future<Mesh> createMeshAsync( const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos, const Mesh::Optimization &optimization )
+{
+	return createMeshAsync( app::getRenderDevice(), source, bufferInfos, optimization );
+}
+
+std::future<Mesh> createMeshAsync( RenderDevice* device, const geom::Source &source, const std::vector<Mesh::BufferInfo> &bufferInfos, const Mesh::Optimization &optimization )
+{
+	// the source might be a temporary, the workers load a copy
+	std::shared_ptr<geom::Source> sourceCopy( source.clone() );
+	if( device->GetDeviceInfo().Features.MultithreadedResourceCreation != DEVICE_FEATURE_STATE_DISABLED ) {
+		return ThreadPool::getDefault().submit( [device, sourceCopy, bufferInfos, optimization]() {
+			return Mesh( device, Mesh::loadSource( *sourceCopy, bufferInfos, optimization ) );
+		} );
+	}
+
+	// otherwise only the loading happens on the workers and the buffers are created on the main thread
+	auto promise = std::make_shared<std::promise<Mesh>>();
+	ThreadPool::getDefault().submit( [device, sourceCopy, bufferInfos, optimization, promise]() {
+		try {
+			auto data = std::make_shared<Mesh::SourceData>( Mesh::loadSource( *sourceCopy, bufferInfos, optimization ) );
+			app::App::get()->dispatchAsync( [device, data, promise]() {
+				try {
+					promise->set_value( Mesh( device, *data ) );
+				}
+				catch( ... ) {
+					promise->set_exception( std::current_exception() );
+				}
+			} );
+		}
+		catch( ... ) {
+			promise->set_exception( std::current_exception() );
+		}
+	} );
+	return promise->get_future();
+}
+
 }
 
 namespace gx = graphics;
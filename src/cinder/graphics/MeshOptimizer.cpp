@@ -0,0 +1,922 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/MeshOptimizer.h"
+#include "cinder/CinderAssert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#if defined( CINDER_GX_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+namespace {
+	//! FIFO post-transform vertex cache simulated with per-vertex timestamps
+	class VertexCacheSimulator {
+	public:
+		VertexCacheSimulator( size_t numVertices, uint32_t cacheSize )
+			: mTimestamps( numVertices, 0 ), mTime( cacheSize + 1 ), mCacheSize( cacheSize )
+		{}
+
+		//! Returns 1 if \a vertex had to be transformed, 0 if it was found in the cache
+		uint32_t transform( uint32_t vertex )
+		{
+			if( mTime - mTimestamps[vertex] > mCacheSize ) {
+				mTimestamps[vertex] = mTime++;
+				return 1;
+			}
+			return 0;
+		}
+		//! Returns the number of vertices of the triangle \a indices that had to be transformed
+		uint32_t transformTriangle( const uint32_t* indices ) { return transform( indices[0] ) + transform( indices[1] ) + transform( indices[2] ); }
+		//! Evicts every vertex from the cache
+		void flush() { mTime += mCacheSize + 1; }
+
+	protected:
+		vector<uint32_t>	mTimestamps;
+		uint32_t			mTime;
+		uint32_t			mCacheSize;
+	};
+
+	//! Lists the triangles referencing each vertex in a single array
+	struct TriangleAdjacency {
+		TriangleAdjacency( const uint32_t* indices, size_t numIndices, size_t numVertices )
+			: mCounts( numVertices, 0 ), mOffsets( numVertices, 0 ), mTriangles( numIndices )
+		{
+			for( size_t i = 0; i < numIndices; ++i ) {
+				CI_ASSERT( indices[i] < numVertices );
+				mCounts[indices[i]]++;
+			}
+			uint32_t offset = 0;
+			for( size_t v = 0; v < numVertices; ++v ) {
+				mOffsets[v] = offset;
+				offset += mCounts[v];
+			}
+			vector<uint32_t> fill( mOffsets );
+			for( size_t i = 0; i < numIndices; ++i ) {
+				mTriangles[fill[indices[i]]++] = static_cast<uint32_t>( i / 3 );
+			}
+		}
+
+		vector<uint32_t> mCounts;
+		vector<uint32_t> mOffsets;
+		vector<uint32_t> mTriangles;
+	};
+
+	//! Symmetric matrix accumulating squared distances to a set of planes
+	struct Quadric {
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+
+		//! Adds the plane dot( n, p ) + d = 0 with \a weight
+		void addPlane( const vec3 &n, float d, float weight )
+		{
+			a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+			a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+			b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+			c += weight * d * d;
+		}
+		Quadric& operator+=( const Quadric &q )
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			return *this;
+		}
+		//! Returns the weighted sum of squared distances from \a p to the planes
+		double evaluate( const vec3 &p ) const
+		{
+			const double x = p.x, y = p.y, z = p.z;
+			return a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * ( a01 * x * y + a02 * x * z + a12 * y * z ) + 2.0 * ( b0 * x + b1 * y + b2 * z ) + c;
+		}
+	};
+
+	uint64_t makeEdgeKey( uint32_t a, uint32_t b ) { return ( static_cast<uint64_t>( a ) << 32 ) | b; }
+	//! Index codec state shared by the encoder and the decoder: recent edges and vertices, the next vertex in order of first use and the last explicit vertex
+	struct IndexCodecState {
+		//! The most recent entries come first, only the first 15 edges and 14 vertices can be referenced by a code
+		static constexpr uint32_t EDGE_FIFO_SIZE = 16;
+		static constexpr uint32_t VERTEX_FIFO_SIZE = 16;
+
+		uint32_t	edges[EDGE_FIFO_SIZE][2];
+		uint32_t	vertices[VERTEX_FIFO_SIZE];
+		uint32_t	edgeOffset = 0;
+		uint32_t	vertexOffset = 0;
+		uint32_t	next = 0;
+		uint32_t	last = 0;
+
+		IndexCodecState()
+		{
+			std::fill( &edges[0][0], &edges[0][0] + EDGE_FIFO_SIZE * 2, ~0u );
+			std::fill( vertices, vertices + VERTEX_FIFO_SIZE, ~0u );
+		}
+
+		const uint32_t* edge( uint32_t index ) const { return edges[( edgeOffset - 1 - index ) & ( EDGE_FIFO_SIZE - 1 )]; }
+		uint32_t vertex( uint32_t index ) const { return vertices[( vertexOffset - 1 - index ) & ( VERTEX_FIFO_SIZE - 1 )]; }
+
+		void pushEdge( uint32_t a, uint32_t b )
+		{
+			edges[edgeOffset & ( EDGE_FIFO_SIZE - 1 )][0] = a;
+			edges[edgeOffset & ( EDGE_FIFO_SIZE - 1 )][1] = b;
+			edgeOffset++;
+		}
+
+		void pushVertex( uint32_t v )
+		{
+			vertices[vertexOffset & ( VERTEX_FIFO_SIZE - 1 )] = v;
+			vertexOffset++;
+		}
+
+		//! Adjacent triangles traverse their shared edge in opposite directions, so the reversed edges are remembered
+		void pushTriangleEdges( uint32_t a, uint32_t b, uint32_t c, bool sharedFirstEdge )
+		{
+			if( ! sharedFirstEdge ) {
+				pushEdge( b, a );
+			}
+			pushEdge( c, b );
+			pushEdge( a, c );
+		}
+
+		int findVertex( uint32_t v, uint32_t numEntries ) const
+		{
+			for( uint32_t i = 0; i < numEntries; ++i ) {
+				if( vertex( i ) == v ) {
+					return static_cast<int>( i );
+				}
+			}
+			return -1;
+		}
+	};
+
+	//! Values are 64-bit so that the explicit vertex tag can be added to any 32-bit delta, five bytes still hold 35 bits
+	void writeVarint( uint8_t*& data, uint64_t value )
+	{
+		while( value >= 0x80 ) {
+			*data++ = static_cast<uint8_t>( value | 0x80 );
+			value >>= 7;
+		}
+		*data++ = static_cast<uint8_t>( value );
+	}
+
+	bool readVarint( const uint8_t*& data, const uint8_t* end, uint64_t* value )
+	{
+		uint64_t result = 0;
+		for( uint32_t shift = 0; shift < 35; shift += 7 ) {
+			if( data == end ) {
+				return false;
+			}
+			const uint8_t byte = *data++;
+			result |= static_cast<uint64_t>( byte & 0x7F ) << shift;
+			if( ! ( byte & 0x80 ) ) {
+				*value = result;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	uint32_t zigzag( uint32_t delta ) { return ( delta << 1 ) ^ ( 0u - ( delta >> 31 ) ); }
+	uint32_t unzigzag( uint32_t value ) { return ( value >> 1 ) ^ ( 0u - ( value & 1 ) ); }
+
+	//! Vertices of triangles without a shared edge: 0 is the next vertex, 1 to 16 a recent vertex, then the delta to the last explicit vertex
+	constexpr uint32_t VERTEX_TAG_EXPLICIT = 1 + IndexCodecState::VERTEX_FIFO_SIZE;
+
+	const uint8_t INDEX_CODEC_VERSION = 0xE1;
+} // anonymous namespace
+
+VertexCacheStats analyzeVertexCache( const uint32_t* indices, size_t numIndices, size_t numVertices, uint32_t cacheSize )
+{
+	CI_ASSERT( numIndices % 3 == 0 );
+
+	VertexCacheStats stats;
+	if( numIndices < 3 ) {
+		return stats;
+	}
+
+	VertexCacheSimulator cache( numVertices, cacheSize );
+	vector<bool> referenced( numVertices, false );
+	size_t numReferenced = 0;
+	for( size_t i = 0; i < numIndices; ++i ) {
+		CI_ASSERT( indices[i] < numVertices );
+		stats.numTransformed += cache.transform( indices[i] );
+		if( ! referenced[indices[i]] ) {
+			referenced[indices[i]] = true;
+			numReferenced++;
+		}
+	}
+	stats.acmr = static_cast<float>( stats.numTransformed ) / static_cast<float>( numIndices / 3 );
+	stats.atvr = static_cast<float>( stats.numTransformed ) / static_cast<float>( numReferenced );
+	return stats;
+}
+
+void optimizeVertexCache( uint32_t* dst, const uint32_t* indices, size_t numIndices, size_t numVertices, uint32_t cacheSize )
+{
+	CI_ASSERT( numIndices % 3 == 0 );
+
+	// work on a copy so that dst can alias indices
+	const vector<uint32_t> input( indices, indices + numIndices );
+	const TriangleAdjacency adjacency( input.data(), numIndices, numVertices );
+
+	vector<uint32_t> liveTriangles( adjacency.mCounts );
+	vector<uint32_t> cacheTimestamps( numVertices, 0 );
+	vector<bool> emitted( numIndices / 3, false );
+	vector<uint32_t> deadEnds;
+	vector<uint32_t> candidates;
+	deadEnds.reserve( numIndices );
+	uint32_t time = cacheSize + 1;
+	size_t cursor = 0;
+	size_t outputIndex = 0;
+
+	// returns the most recently emitted vertex that still has triangles left, or the next one in input order
+	auto skipDeadEnd = [&]() -> uint32_t {
+		while( ! deadEnds.empty() ) {
+			const uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if( liveTriangles[vertex] > 0 ) {
+				return vertex;
+			}
+		}
+		for( ; cursor < numVertices; ++cursor ) {
+			if( liveTriangles[cursor] > 0 ) {
+				return static_cast<uint32_t>( cursor );
+			}
+		}
+		return ~0u;
+	};
+
+	uint32_t fanningVertex = skipDeadEnd();
+	while( fanningVertex != ~0u ) {
+		// emit all the remaining triangles around the fanning vertex
+		candidates.clear();
+		const uint32_t* triangles = adjacency.mTriangles.data() + adjacency.mOffsets[fanningVertex];
+		for( uint32_t i = 0; i < adjacency.mCounts[fanningVertex]; ++i ) {
+			const uint32_t triangle = triangles[i];
+			if( emitted[triangle] ) {
+				continue;
+			}
+			for( size_t k = 0; k < 3; ++k ) {
+				const uint32_t vertex = input[triangle * 3 + k];
+				dst[outputIndex++] = vertex;
+				deadEnds.push_back( vertex );
+				candidates.push_back( vertex );
+				liveTriangles[vertex]--;
+				if( time - cacheTimestamps[vertex] > cacheSize ) {
+					cacheTimestamps[vertex] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// continue with the oldest candidate that will still be in the cache once its own fan is emitted
+		uint32_t nextVertex = ~0u;
+		int64_t bestPriority = -1;
+		for( uint32_t vertex : candidates ) {
+			if( liveTriangles[vertex] == 0 ) {
+				continue;
+			}
+			const uint32_t age = time - cacheTimestamps[vertex];
+			const int64_t priority = age + 2 * liveTriangles[vertex] <= cacheSize ? age : 0;
+			if( priority > bestPriority ) {
+				bestPriority = priority;
+				nextVertex = vertex;
+			}
+		}
+		fanningVertex = nextVertex != ~0u ? nextVertex : skipDeadEnd();
+	}
+
+	CI_ASSERT( outputIndex == numIndices );
+}
+
+void optimizeOverdraw( uint32_t* dst, const uint32_t* indices, size_t numIndices, const vec3* positions, size_t numVertices, float threshold, uint32_t cacheSize )
+{
+	CI_ASSERT( numIndices % 3 == 0 );
+
+	// work on a copy so that dst can alias indices
+	const vector<uint32_t> input( indices, indices + numIndices );
+	const size_t numTriangles = numIndices / 3;
+	if( numTriangles == 0 ) {
+		return;
+	}
+
+	// hard boundaries: triangles missing all their vertices from the cache already start a new strip
+	VertexCacheSimulator cache( numVertices, cacheSize );
+	vector<size_t> hardClusters;
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		if( cache.transformTriangle( &input[t * 3] ) == 3 || t == 0 ) {
+			hardClusters.push_back( t );
+		}
+	}
+
+	// soft boundaries: split the strips as soon as their cache efficiency is within the threshold of the whole strip
+	vector<size_t> clusters;
+	for( size_t c = 0; c < hardClusters.size(); ++c ) {
+		const size_t start = hardClusters[c];
+		const size_t end = c + 1 < hardClusters.size() ? hardClusters[c + 1] : numTriangles;
+
+		cache.flush();
+		size_t clusterMisses = 0;
+		for( size_t t = start; t < end; ++t ) {
+			clusterMisses += cache.transformTriangle( &input[t * 3] );
+		}
+		const float clusterThreshold = threshold * static_cast<float>( clusterMisses ) / static_cast<float>( end - start );
+
+		cache.flush();
+		clusters.push_back( start );
+		size_t runningMisses = 0, runningTriangles = 0;
+		for( size_t t = start; t < end; ++t ) {
+			runningMisses += cache.transformTriangle( &input[t * 3] );
+			runningTriangles++;
+			if( t + 1 < end && static_cast<float>( runningMisses ) / static_cast<float>( runningTriangles ) <= clusterThreshold ) {
+				clusters.push_back( t + 1 );
+				cache.flush();
+				runningMisses = runningTriangles = 0;
+			}
+		}
+	}
+
+	// sort the clusters by how much they face away from the mesh centroid
+	vec3 meshCentroid( 0.0f );
+	for( size_t i = 0; i < numIndices; ++i ) {
+		meshCentroid += positions[input[i]];
+	}
+	meshCentroid /= static_cast<float>( numIndices );
+
+	vector<float> sortKeys( clusters.size() );
+	for( size_t c = 0; c < clusters.size(); ++c ) {
+		const size_t start = clusters[c];
+		const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : numTriangles;
+		vec3 centroid( 0.0f ), weightedCentroid( 0.0f ), normal( 0.0f );
+		float area = 0.0f;
+		for( size_t t = start; t < end; ++t ) {
+			const vec3 &p0 = positions[input[t * 3 + 0]];
+			const vec3 &p1 = positions[input[t * 3 + 1]];
+			const vec3 &p2 = positions[input[t * 3 + 2]];
+			const vec3 n = glm::cross( p1 - p0, p2 - p0 );
+			const float triangleArea = glm::length( n );
+			centroid += ( p0 + p1 + p2 ) / 3.0f;
+			weightedCentroid += ( p0 + p1 + p2 ) / 3.0f * triangleArea;
+			normal += n;
+			area += triangleArea;
+		}
+		centroid = area > 0.0f ? weightedCentroid / area : centroid / static_cast<float>( end - start );
+		const float normalLength = glm::length( normal );
+		sortKeys[c] = normalLength > 0.0f ? glm::dot( centroid - meshCentroid, normal / normalLength ) : 0.0f;
+	}
+
+	vector<size_t> order( clusters.size() );
+	iota( order.begin(), order.end(), 0 );
+	stable_sort( order.begin(), order.end(), [&sortKeys]( size_t a, size_t b ) { return sortKeys[a] > sortKeys[b]; } );
+
+	size_t outputIndex = 0;
+	for( size_t c : order ) {
+		const size_t start = clusters[c];
+		const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : numTriangles;
+		for( size_t i = start * 3; i < end * 3; ++i ) {
+			dst[outputIndex++] = input[i];
+		}
+	}
+}
+
+size_t simplify( uint32_t* dst, const uint32_t* indices, size_t numIndices, const vec3* positions, size_t numVertices, size_t targetIndexCount, float targetError, float* resultError )
+{
+	CI_ASSERT( numIndices % 3 == 0 );
+
+	// work on a copy so that dst can alias indices
+	vector<uint32_t> result( indices, indices + numIndices );
+
+	// errors are relative to the largest dimension of the mesh bounds
+	vec3 minBounds( numeric_limits<float>::max() ), maxBounds( numeric_limits<float>::lowest() );
+	for( uint32_t index : result ) {
+		minBounds = glm::min( minBounds, positions[index] );
+		maxBounds = glm::max( maxBounds, positions[index] );
+	}
+	const vec3 size = maxBounds - minBounds;
+	const float extent = result.empty() || glm::max( size.x, glm::max( size.y, size.z ) ) <= 0.0f ? 1.0f : glm::max( size.x, glm::max( size.y, size.z ) );
+	const double maxCost = static_cast<double>( targetError * extent ) * static_cast<double>( targetError * extent );
+
+	// directed edges without a twin lie on a border or an attribute seam
+	vector<uint64_t> edges, boundaryEdges;
+	vector<bool> isBoundaryVertex( numVertices );
+	auto findBoundaryEdges = [&]() {
+		edges.clear();
+		boundaryEdges.clear();
+		for( size_t i = 0; i < result.size(); i += 3 ) {
+			for( size_t k = 0; k < 3; ++k ) {
+				edges.push_back( makeEdgeKey( result[i + k], result[i + ( k + 1 ) % 3] ) );
+			}
+		}
+		sort( edges.begin(), edges.end() );
+		fill( isBoundaryVertex.begin(), isBoundaryVertex.end(), false );
+		for( uint64_t edge : edges ) {
+			const uint32_t a = static_cast<uint32_t>( edge >> 32 ), b = static_cast<uint32_t>( edge );
+			if( ! binary_search( edges.begin(), edges.end(), makeEdgeKey( b, a ) ) ) {
+				boundaryEdges.push_back( edge );
+				isBoundaryVertex[a] = isBoundaryVertex[b] = true;
+			}
+		}
+	};
+	auto isBoundaryEdge = [&]( uint32_t a, uint32_t b ) {
+		return binary_search( boundaryEdges.begin(), boundaryEdges.end(), makeEdgeKey( a, b ) ) || binary_search( boundaryEdges.begin(), boundaryEdges.end(), makeEdgeKey( b, a ) );
+	};
+	auto calcNormal = []( const vec3 &p0, const vec3 &p1, const vec3 &p2 ) { return glm::cross( p1 - p0, p2 - p0 ); };
+
+	// accumulate the planes of the triangles around each vertex, and planes perpendicular to the boundary edges to keep them in place
+	vector<Quadric> quadrics( numVertices );
+	findBoundaryEdges();
+	for( size_t i = 0; i < result.size(); i += 3 ) {
+		const vec3 n = calcNormal( positions[result[i]], positions[result[i + 1]], positions[result[i + 2]] );
+		const float length = glm::length( n );
+		if( length <= 0.0f ) {
+			continue;
+		}
+		const vec3 normal = n / length;
+		for( size_t k = 0; k < 3; ++k ) {
+			const uint32_t a = result[i + k], b = result[i + ( k + 1 ) % 3];
+			quadrics[a].addPlane( normal, -glm::dot( normal, positions[a] ), 1.0f );
+			if( binary_search( boundaryEdges.begin(), boundaryEdges.end(), makeEdgeKey( a, b ) ) ) {
+				const vec3 edgeNormal = glm::cross( positions[b] - positions[a], normal );
+				const float edgeLength = glm::length( edgeNormal );
+				if( edgeLength > 0.0f ) {
+					const vec3 plane = edgeNormal / edgeLength;
+					const float d = -glm::dot( plane, positions[a] );
+					quadrics[a].addPlane( plane, d, 10.0f );
+					quadrics[b].addPlane( plane, d, 10.0f );
+				}
+			}
+		}
+	}
+
+	struct Collapse {
+		uint32_t	from;
+		uint32_t	to;
+		double		cost;
+	};
+	vector<Collapse> collapses;
+	vector<uint32_t> remap( numVertices );
+	vector<bool> locked( numVertices );
+	double error = 0.0;
+	bool firstPass = true;
+	while( result.size() > targetIndexCount ) {
+		if( ! firstPass ) {
+			findBoundaryEdges();
+		}
+		firstPass = false;
+
+		// find the cheapest valid direction of each edge, boundary vertices only sliding along the boundary
+		collapses.clear();
+		for( size_t i = 0; i < result.size(); i += 3 ) {
+			for( size_t k = 0; k < 3; ++k ) {
+				const uint32_t a = result[i + k], b = result[i + ( k + 1 ) % 3];
+				const bool boundaryEdge = isBoundaryEdge( a, b );
+				// interior edges are visited once from each side
+				if( a == b || ( a > b && ! boundaryEdge ) ) {
+					continue;
+				}
+				Quadric q = quadrics[a];
+				q += quadrics[b];
+				const bool canCollapseA = ! isBoundaryVertex[a] || boundaryEdge;
+				const bool canCollapseB = ! isBoundaryVertex[b] || boundaryEdge;
+				const double costA = canCollapseA ? q.evaluate( positions[b] ) : numeric_limits<double>::max();
+				const double costB = canCollapseB ? q.evaluate( positions[a] ) : numeric_limits<double>::max();
+				if( canCollapseA && costA <= costB ) {
+					collapses.push_back( { a, b, costA } );
+				}
+				else if( canCollapseB ) {
+					collapses.push_back( { b, a, costB } );
+				}
+			}
+		}
+		sort( collapses.begin(), collapses.end(), []( const Collapse &lhs, const Collapse &rhs ) { return lhs.cost < rhs.cost; } );
+
+		// apply the cheapest collapses, locking their neighborhood so that each triangle changes at most once per pass
+		const TriangleAdjacency adjacency( result.data(), result.size(), numVertices );
+		iota( remap.begin(), remap.end(), 0 );
+		fill( locked.begin(), locked.end(), false );
+		const size_t trianglesToRemove = std::max<size_t>( ( result.size() - targetIndexCount ) / 3, 1 );
+		size_t trianglesRemoved = 0;
+		size_t numCollapsed = 0;
+		for( const Collapse &collapse : collapses ) {
+			if( collapse.cost > maxCost || trianglesRemoved >= trianglesToRemove ) {
+				break;
+			}
+			if( locked[collapse.from] || locked[collapse.to] ) {
+				continue;
+			}
+
+			// reject collapses flipping any of the remaining triangles
+			const uint32_t* triangles = adjacency.mTriangles.data() + adjacency.mOffsets[collapse.from];
+			const uint32_t numTriangles = adjacency.mCounts[collapse.from];
+			bool flips = false;
+			size_t numDegenerate = 0;
+			for( uint32_t i = 0; i < numTriangles && ! flips; ++i ) {
+				const uint32_t* triangle = &result[triangles[i] * 3];
+				if( triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to ) {
+					numDegenerate++;
+					continue;
+				}
+				vec3 p[3], q[3];
+				for( size_t k = 0; k < 3; ++k ) {
+					p[k] = positions[triangle[k]];
+					q[k] = triangle[k] == collapse.from ? positions[collapse.to] : p[k];
+				}
+				flips = glm::dot( calcNormal( p[0], p[1], p[2] ), calcNormal( q[0], q[1], q[2] ) ) <= 0.0f;
+			}
+			if( flips ) {
+				continue;
+			}
+
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			for( uint32_t i = 0; i < numTriangles; ++i ) {
+				for( size_t k = 0; k < 3; ++k ) {
+					locked[result[triangles[i] * 3 + k]] = true;
+				}
+			}
+			locked[collapse.to] = true;
+			trianglesRemoved += numDegenerate;
+			error = std::max( error, collapse.cost );
+			numCollapsed++;
+		}
+		if( numCollapsed == 0 ) {
+			break;
+		}
+
+		// remap the indices and drop the collapsed triangles
+		size_t numWritten = 0;
+		for( size_t i = 0; i < result.size(); i += 3 ) {
+			const uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+			if( a != b && b != c && a != c ) {
+				result[numWritten++] = a;
+				result[numWritten++] = b;
+				result[numWritten++] = c;
+			}
+		}
+		result.resize( numWritten );
+	}
+
+	if( resultError ) {
+		*resultError = static_cast<float>( std::sqrt( error ) ) / extent;
+	}
+	copy( result.begin(), result.end(), dst );
+	return result.size();
+}
+
+size_t optimizeVertexFetchRemap( uint32_t* remap, uint32_t* indices, size_t numIndices, size_t numVertices )
+{
+	fill( remap, remap + numVertices, ~0u );
+	uint32_t numReferenced = 0;
+	for( size_t i = 0; i < numIndices; ++i ) {
+		CI_ASSERT( indices[i] < numVertices );
+		uint32_t &newIndex = remap[indices[i]];
+		if( newIndex == ~0u ) {
+			newIndex = numReferenced++;
+		}
+		indices[i] = newIndex;
+	}
+	return numReferenced;
+}
+
+size_t buildMeshletsBound( size_t numIndices, size_t maxVertices, size_t maxTriangles )
+{
+	CI_ASSERT( numIndices % 3 == 0 && maxVertices >= 3 && maxTriangles >= 1 );
+
+	// a meshlet is only flushed early when its vertices are full, so it has at least ( maxVertices - 2 ) / 3 triangles
+	const size_t numTriangles = numIndices / 3;
+	const size_t minTrianglesPerMeshlet = std::max<size_t>( std::min( maxTriangles, ( maxVertices - 2 ) / 3 ), 1 );
+	return ( numTriangles + minTrianglesPerMeshlet - 1 ) / minTrianglesPerMeshlet;
+}
+
+size_t buildMeshlets( Meshlet* meshlets, uint32_t* meshletVertices, uint8_t* meshletTriangles, const uint32_t* indices, size_t numIndices, size_t numVertices, size_t maxVertices, size_t maxTriangles )
+{
+	CI_ASSERT( numIndices % 3 == 0 );
+	CI_ASSERT_MSG( maxVertices >= 3 && maxVertices <= 256, "meshlet local indices are 8-bit" );
+	CI_ASSERT( maxTriangles >= 1 );
+
+	// local index of each vertex in the current meshlet, ~0 when the vertex isn't part of it
+	vector<uint32_t> localIndices( numVertices, ~0u );
+	Meshlet meshlet;
+	size_t numMeshlets = 0;
+	auto flush = [&]() {
+		for( uint32_t v = 0; v < meshlet.numVertices; ++v ) {
+			localIndices[meshletVertices[meshlet.vertexOffset + v]] = ~0u;
+		}
+		meshlets[numMeshlets++] = meshlet;
+		meshlet.vertexOffset += meshlet.numVertices;
+		meshlet.triangleOffset += meshlet.numTriangles;
+		meshlet.numVertices = 0;
+		meshlet.numTriangles = 0;
+	};
+
+	for( size_t i = 0; i < numIndices; i += 3 ) {
+		const uint32_t triangle[3] = { indices[i], indices[i + 1], indices[i + 2] };
+		CI_ASSERT( triangle[0] < numVertices && triangle[1] < numVertices && triangle[2] < numVertices );
+		const uint32_t numNew = ( localIndices[triangle[0]] == ~0u ? 1 : 0 )
+			+ ( triangle[1] != triangle[0] && localIndices[triangle[1]] == ~0u ? 1 : 0 )
+			+ ( triangle[2] != triangle[0] && triangle[2] != triangle[1] && localIndices[triangle[2]] == ~0u ? 1 : 0 );
+		if( meshlet.numVertices + numNew > maxVertices || meshlet.numTriangles >= maxTriangles ) {
+			flush();
+		}
+
+		uint8_t* localTriangle = meshletTriangles + ( meshlet.triangleOffset + meshlet.numTriangles ) * 3;
+		for( size_t k = 0; k < 3; ++k ) {
+			uint32_t &localIndex = localIndices[triangle[k]];
+			if( localIndex == ~0u ) {
+				localIndex = meshlet.numVertices;
+				meshletVertices[meshlet.vertexOffset + meshlet.numVertices++] = triangle[k];
+			}
+			localTriangle[k] = static_cast<uint8_t>( localIndex );
+		}
+		meshlet.numTriangles++;
+	}
+	if( meshlet.numTriangles ) {
+		flush();
+	}
+	return numMeshlets;
+}
+
+size_t encodeIndexBufferBound( size_t numIndices )
+{
+	// a code and three varints per triangle in the worst case
+	return 1 + ( numIndices / 3 ) * ( 1 + 3 * 5 );
+}
+
+size_t encodeIndexBuffer( uint8_t* buffer, size_t bufferSize, const uint32_t* indices, size_t numIndices )
+{
+	CI_ASSERT( numIndices % 3 == 0 );
+	if( bufferSize < encodeIndexBufferBound( numIndices ) ) {
+		return 0;
+	}
+
+	IndexCodecState state;
+	uint8_t* data = buffer;
+	*data++ = INDEX_CODEC_VERSION;
+	for( size_t t = 0; t < numIndices; t += 3 ) {
+		// a rotation of the triangle starting with an edge shared with a recent triangle only needs its third vertex
+		int edgeIndex = -1;
+		uint32_t a = 0, b = 0, c = 0;
+		for( uint32_t e = 0; e < IndexCodecState::EDGE_FIFO_SIZE - 1 && edgeIndex < 0; ++e ) {
+			const uint32_t* edge = state.edge( e );
+			for( int r = 0; r < 3; ++r ) {
+				if( edge[0] == indices[t + r] && edge[1] == indices[t + ( r + 1 ) % 3] ) {
+					a = indices[t + r];
+					b = indices[t + ( r + 1 ) % 3];
+					c = indices[t + ( r + 2 ) % 3];
+					edgeIndex = static_cast<int>( e );
+					break;
+				}
+			}
+		}
+
+		if( edgeIndex >= 0 ) {
+			// the low nibble is 0 for the next vertex, 1 to 14 for a recent vertex and 15 for an explicit one
+			const int vertexIndex = state.findVertex( c, 14 );
+			if( c == state.next ) {
+				*data++ = static_cast<uint8_t>( edgeIndex << 4 );
+				state.next++;
+				state.pushVertex( c );
+			}
+			else if( vertexIndex >= 0 ) {
+				*data++ = static_cast<uint8_t>( edgeIndex << 4 | ( vertexIndex + 1 ) );
+			}
+			else {
+				*data++ = static_cast<uint8_t>( edgeIndex << 4 | 15 );
+				writeVarint( data, zigzag( c - state.last ) );
+				state.last = c;
+				state.pushVertex( c );
+			}
+			state.pushTriangleEdges( a, b, c, true );
+		}
+		else {
+			*data++ = 0xF0;
+			const uint32_t triangle[3] = { indices[t], indices[t + 1], indices[t + 2] };
+			for( uint32_t v : triangle ) {
+				const int vertexIndex = state.findVertex( v, IndexCodecState::VERTEX_FIFO_SIZE );
+				if( v == state.next ) {
+					writeVarint( data, 0 );
+					state.next++;
+					state.pushVertex( v );
+				}
+				else if( vertexIndex >= 0 ) {
+					writeVarint( data, 1 + vertexIndex );
+				}
+				else {
+					writeVarint( data, uint64_t{ VERTEX_TAG_EXPLICIT } + zigzag( v - state.last ) );
+					state.last = v;
+					state.pushVertex( v );
+				}
+			}
+			state.pushTriangleEdges( triangle[0], triangle[1], triangle[2], false );
+		}
+	}
+	return static_cast<size_t>( data - buffer );
+}
+
+bool decodeIndexBuffer( void* dst, size_t numIndices, size_t indexSize, const uint8_t* buffer, size_t bufferSize )
+{
+	CI_ASSERT( indexSize == 2 || indexSize == 4 );
+	if( numIndices % 3 != 0 || bufferSize < 1 || buffer[0] != INDEX_CODEC_VERSION ) {
+		return false;
+	}
+
+	IndexCodecState state;
+	const uint8_t* data = buffer + 1;
+	const uint8_t* end = buffer + bufferSize;
+	for( size_t t = 0; t < numIndices; t += 3 ) {
+		if( data == end ) {
+			return false;
+		}
+		const uint8_t code = *data++;
+		uint32_t triangle[3];
+		if( code >> 4 != 0xF ) {
+			const uint32_t* edge = state.edge( code >> 4 );
+			triangle[0] = edge[0];
+			triangle[1] = edge[1];
+			const uint32_t vertexCode = code & 0xF;
+			if( vertexCode == 0 ) {
+				triangle[2] = state.next++;
+				state.pushVertex( triangle[2] );
+			}
+			else if( vertexCode < 15 ) {
+				triangle[2] = state.vertex( vertexCode - 1 );
+			}
+			else {
+				uint64_t value;
+				if( ! readVarint( data, end, &value ) ) {
+					return false;
+				}
+				triangle[2] = state.last + unzigzag( static_cast<uint32_t>( value ) );
+				state.last = triangle[2];
+				state.pushVertex( triangle[2] );
+			}
+			state.pushTriangleEdges( triangle[0], triangle[1], triangle[2], true );
+		}
+		else {
+			for( uint32_t &v : triangle ) {
+				uint64_t value;
+				if( ! readVarint( data, end, &value ) ) {
+					return false;
+				}
+				if( value == 0 ) {
+					v = state.next++;
+					state.pushVertex( v );
+				}
+				else if( value < VERTEX_TAG_EXPLICIT ) {
+					v = state.vertex( static_cast<uint32_t>( value - 1 ) );
+				}
+				else {
+					v = state.last + unzigzag( static_cast<uint32_t>( value - VERTEX_TAG_EXPLICIT ) );
+					state.last = v;
+					state.pushVertex( v );
+				}
+			}
+			state.pushTriangleEdges( triangle[0], triangle[1], triangle[2], false );
+		}
+
+		if( indexSize == 2 ) {
+			uint16_t* dst16 = static_cast<uint16_t*>( dst ) + t;
+			dst16[0] = static_cast<uint16_t>( triangle[0] );
+			dst16[1] = static_cast<uint16_t>( triangle[1] );
+			dst16[2] = static_cast<uint16_t>( triangle[2] );
+		}
+		else {
+			uint32_t* dst32 = static_cast<uint32_t*>( dst ) + t;
+			dst32[0] = triangle[0];
+			dst32[1] = triangle[1];
+			dst32[2] = triangle[2];
+		}
+	}
+	return true;
+}
+
+MeshletBounds computeMeshletBounds( const Meshlet &meshlet, const uint32_t* meshletVertices, const uint8_t* meshletTriangles, const vec3* positions )
+{
+	MeshletBounds bounds;
+	if( ! meshlet.numVertices ) {
+		return bounds;
+	}
+
+	// sphere centered on the box of the vertices
+	const uint32_t* vertices = meshletVertices + meshlet.vertexOffset;
+	vec3 minBounds( positions[vertices[0]] ), maxBounds( positions[vertices[0]] );
+	for( uint32_t v = 1; v < meshlet.numVertices; ++v ) {
+		minBounds = glm::min( minBounds, positions[vertices[v]] );
+		maxBounds = glm::max( maxBounds, positions[vertices[v]] );
+	}
+	bounds.center = ( minBounds + maxBounds ) * 0.5f;
+	float radius2 = 0.0f;
+	for( uint32_t v = 0; v < meshlet.numVertices; ++v ) {
+		const vec3 d = positions[vertices[v]] - bounds.center;
+		radius2 = std::max( radius2, glm::dot( d, d ) );
+	}
+	bounds.radius = std::sqrt( radius2 );
+
+	// the cone axis averages the unit normals, its spread is the largest angle between the axis and a normal
+	vector<vec3> normals;
+	normals.reserve( meshlet.numTriangles );
+	vec3 axis( 0.0f );
+	const uint8_t* triangles = meshletTriangles + meshlet.triangleOffset * 3;
+	for( uint32_t t = 0; t < meshlet.numTriangles; ++t ) {
+		const vec3 &p0 = positions[vertices[triangles[t * 3]]];
+		const vec3 &p1 = positions[vertices[triangles[t * 3 + 1]]];
+		const vec3 &p2 = positions[vertices[triangles[t * 3 + 2]]];
+		const vec3 n = glm::cross( p1 - p0, p2 - p0 );
+		const float length = glm::length( n );
+		if( length > 0.0f ) {
+			normals.push_back( n / length );
+			axis += normals.back();
+		}
+	}
+	const float axisLength = glm::length( axis );
+	if( normals.empty() || axisLength <= 0.0f ) {
+		return bounds;
+	}
+	axis /= axisLength;
+	float minDot = 1.0f;
+	for( const vec3 &n : normals ) {
+		minDot = std::min( minDot, glm::dot( n, axis ) );
+	}
+	bounds.coneAxis = axis;
+	// the normals spreading past ~85 degrees can face any viewer, otherwise the cone of back facing views is the normal cone widened by 90 degrees
+	bounds.coneCutoff = minDot <= 0.1f ? 1.0f : std::sqrt( 1.0f - minDot * minDot );
+	return bounds;
+}
+
+uint32_t calcMaxIndex( const uint32_t* indices, size_t count )
+{
+	uint32_t maximum = 0;
+	size_t i = 0;
+#if defined( CINDER_GX_SSE2 )
+	// SSE2 only compares signed integers, flipping the sign bit orders the unsigned indices the same way
+	const __m128i signBit = _mm_set1_epi32( static_cast<int>( 0x80000000u ) );
+	__m128i max0 = signBit, max1 = signBit;
+	for( ; i + 8 <= count; i += 8 ) {
+		const __m128i a = _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( indices + i ) ), signBit );
+		const __m128i b = _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( indices + i + 4 ) ), signBit );
+		const __m128i greaterA = _mm_cmpgt_epi32( a, max0 ), greaterB = _mm_cmpgt_epi32( b, max1 );
+		max0 = _mm_or_si128( _mm_and_si128( greaterA, a ), _mm_andnot_si128( greaterA, max0 ) );
+		max1 = _mm_or_si128( _mm_and_si128( greaterB, b ), _mm_andnot_si128( greaterB, max1 ) );
+	}
+	uint32_t lanes[8];
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( lanes ), _mm_xor_si128( max0, signBit ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( lanes + 4 ), _mm_xor_si128( max1, signBit ) );
+	for( uint32_t lane : lanes ) {
+		maximum = std::max( maximum, lane );
+	}
+#endif
+	for( ; i < count; ++i ) {
+		maximum = std::max( maximum, indices[i] );
+	}
+	return maximum;
+}
+
+void narrowIndices( const uint32_t* indices, size_t count, uint16_t* dst )
+{
+	size_t i = 0;
+#if defined( CINDER_GX_SSE2 )
+	// _mm_packs_epi32 saturates signed values, biasing the indices by 32768 keeps the whole 16-bit range exact
+	const __m128i bias32 = _mm_set1_epi32( 32768 );
+	const __m128i bias16 = _mm_set1_epi16( static_cast<short>( 0x8000 ) );
+	for( ; i + 8 <= count; i += 8 ) {
+		const __m128i a = _mm_sub_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( indices + i ) ), bias32 );
+		const __m128i b = _mm_sub_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( indices + i + 4 ) ), bias32 );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_xor_si128( _mm_packs_epi32( a, b ), bias16 ) );
+	}
+#endif
+	for( ; i < count; ++i ) {
+		dst[i] = static_cast<uint16_t>( indices[i] );
+	}
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -0,0 +1,277 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/MeshPool.h"
+#include "cinder/app/RendererGx.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/Log.h"
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+OffsetAllocator::OffsetAllocator( uint32_t size )
+	: mSize( size ), mNumFree( size )
+{
+	if( size ) {
+		insertFreeRange( 0, size );
+	}
+}
+
+uint32_t OffsetAllocator::allocate( uint32_t size )
+{
+	if( size == 0 ) {
+		return 0;
+	}
+
+	// smallest free range that fits, lowest offset first among equal sizes
+	auto bestFit = mFreeRangesBySize.lower_bound( { size, 0 } );
+	if( bestFit == mFreeRangesBySize.end() ) {
+		return INVALID_OFFSET;
+	}
+	const uint32_t rangeSize = bestFit->first;
+	const uint32_t offset = bestFit->second;
+	eraseFreeRange( mFreeRangesByOffset.find( offset ) );
+	if( rangeSize > size ) {
+		insertFreeRange( offset + size, rangeSize - size );
+	}
+	mNumFree -= size;
+	return offset;
+}
+
+void OffsetAllocator::release( uint32_t offset, uint32_t size )
+{
+	if( size == 0 ) {
+		return;
+	}
+	CI_ASSERT( offset + size <= mSize );
+	mNumFree += size;
+
+	// coalesce with the free ranges immediately after and before
+	auto next = mFreeRangesByOffset.lower_bound( offset );
+	CI_ASSERT_MSG( next == mFreeRangesByOffset.end() || next->first >= offset + size, "range released twice" );
+	if( next != mFreeRangesByOffset.end() && next->first == offset + size ) {
+		size += next->second;
+		auto erased = next++;
+		eraseFreeRange( erased );
+	}
+	if( next != mFreeRangesByOffset.begin() ) {
+		auto previous = std::prev( next );
+		CI_ASSERT_MSG( previous->first + previous->second <= offset, "range released twice" );
+		if( previous->first + previous->second == offset ) {
+			offset = previous->first;
+			size += previous->second;
+			eraseFreeRange( previous );
+		}
+	}
+	insertFreeRange( offset, size );
+}
+
+void OffsetAllocator::insertFreeRange( uint32_t offset, uint32_t size )
+{
+	mFreeRangesByOffset.emplace( offset, size );
+	mFreeRangesBySize.emplace( size, offset );
+}
+
+void OffsetAllocator::eraseFreeRange( std::map<uint32_t, uint32_t>::iterator range )
+{
+	mFreeRangesBySize.erase( { range->second, range->first } );
+	mFreeRangesByOffset.erase( range );
+}
+
+MeshPoolRef MeshPool::create( const Mesh::BufferInfo &layout, const Options &options )
+{
+	return create( app::getRenderDevice(), layout, options );
+}
+
+MeshPoolRef MeshPool::create( RenderDevice* device, const Mesh::BufferInfo &layout, const Options &options )
+{
+	return MeshPoolRef( new MeshPool( device, layout, options ) );
+}
+
+MeshPool::MeshPool( RenderDevice* device, const Mesh::BufferInfo &layout, const Options &options )
+	: mDevice( device ),
+	mVertexStride( 0 ),
+	mIndexType( options.mIndexType ),
+	mVertexAllocator( options.mNumVertices ),
+	mIndexAllocator( options.mNumIndices )
+{
+	CI_ASSERT_MSG( mIndexType == VT_UINT16 || mIndexType == VT_UINT32, "MeshPool indices must be VT_UINT16 or VT_UINT32" );
+
+	// pack the attributes in a single interleaved vertex, the same way Mesh::loadSource lays them out
+	for( const auto &attribInfo : layout.getAttribs() ) {
+		CI_ASSERT_MSG( attribInfo.getDims() > 0, "MeshPool layout attributes require explicit dimensions" );
+	}
+	// vertex pulled pools are bound as shader resources, every mesh of the pool then draws with the same pipeline and binding
+	mLayout = layout.calcInterleaved()
+		.bindFlags( layout.isVertexPulled() ? layout.getBindFlags() : layout.getBindFlags() | BIND_VERTEX_BUFFER )
+		.usage( USAGE_DEFAULT )
+		.cpuAccess( CPU_ACCESS_NONE )
+		.name( options.mName + " Vertex Buffer" );
+	mVertexStride = mLayout.getAttribs().empty() ? 0 : static_cast<uint32_t>( mLayout.getAttribs().front().getStride() );
+
+	const uint32_t indexSize = mIndexType == VT_UINT16 ? sizeof( uint16_t ) : sizeof( uint32_t );
+	device->CreateBuffer( mLayout.calcBufferDesc( mVertexStride * options.mNumVertices ), nullptr, &mVertexBuffer );
+	device->CreateBuffer( BufferDesc()
+		.name( ( options.mName + " Index Buffer" ).c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_INDEX_BUFFER )
+		.size( indexSize * options.mNumIndices ),
+		nullptr, &mIndexBuffer );
+}
+
+MeshPool::Allocation::~Allocation()
+{
+	lock_guard<mutex> lock( mPool->mMutex );
+	mPool->mVertexAllocator.release( mVertexOffset, mNumVertices );
+	mPool->mIndexAllocator.release( mIndexOffset, mNumIndices );
+}
+
+Mesh MeshPool::createMesh( const geom::Source &source, const Mesh::Optimization &optimization )
+{
+	return createMesh( app::getImmediateContext(), source, optimization );
+}
+
+Mesh MeshPool::createMesh( DeviceContext* context, const geom::Source &source, const Mesh::Optimization &optimization )
+{
+	return createMesh( context, Mesh::loadSource( source, { mLayout }, optimization ) );
+}
+
+Mesh MeshPool::createMesh( DeviceContext* context, const Mesh::SourceData &data )
+{
+	// the source might lack some of the layout attributes
+	if( data.vertexBuffers.size() != 1 || data.vertexBuffers.front().first.getAttribs().empty() || data.vertexBuffers.front().first.getAttribs().front().getStride() != mVertexStride ) {
+		CI_LOG_W( "Mesh data doesn't match the MeshPool layout, creating a standalone Mesh" );
+		return Mesh( mDevice, data );
+	}
+	if( mIndexType == VT_UINT16 && data.numVertices > 65536 ) {
+		CI_LOG_W( "Mesh has too many vertices for the MeshPool 16-bit indices, creating a standalone Mesh" );
+		return Mesh( mDevice, data );
+	}
+
+	auto allocation = allocate( data.numVertices, static_cast<uint32_t>( data.indices.size() ) );
+	if( ! allocation ) {
+		CI_LOG_W( "MeshPool is full, creating a standalone Mesh" );
+		return Mesh( mDevice, data );
+	}
+	upload( context, *allocation, data.vertexBuffers.front().second.data(), data.indices.data() );
+
+	Mesh mesh = makeMesh( allocation, data.primitive );
+	mesh.mPositionScale = data.positionScale;
+	mesh.mPositionOffset = data.positionOffset;
+	mesh.mBounds = data.bounds;
+	mesh.mBoundingSphere = data.boundingSphere;
+	mesh.mLods = data.lods;
+	if( ! data.lods.empty() ) {
+		mesh.mNumIndices = data.lods.front().numIndices;
+	}
+	return mesh;
+}
+
+Mesh MeshPool::createMesh( DeviceContext* context, const void* vertexData, uint32_t numVertices, const uint32_t* indexData, uint32_t numIndices, geom::Primitive primitive )
+{
+	// 16-bit pool indices can't address more vertices, the standalone Mesh keeps the 32-bit indices
+	std::shared_ptr<Allocation> allocation;
+	if( mIndexType == VT_UINT16 && numVertices > 65536 ) {
+		CI_LOG_W( "Mesh has too many vertices for the MeshPool 16-bit indices, creating a standalone Mesh" );
+	}
+	else {
+		allocation = allocate( numVertices, numIndices );
+		if( ! allocation ) {
+			CI_LOG_W( "MeshPool is full, creating a standalone Mesh" );
+		}
+	}
+	if( ! allocation ) {
+		if( ! numIndices ) {
+			return Mesh( mDevice, numVertices, vertexData, numVertices * mVertexStride, mLayout, primitive );
+		}
+		return Mesh( mDevice, vertexData, numVertices * mVertexStride, mLayout, numIndices, indexData, VT_UINT32, primitive );
+	}
+	upload( context, *allocation, vertexData, indexData );
+	return makeMesh( allocation, primitive );
+}
+
+uint32_t MeshPool::getNumFreeVertices() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mVertexAllocator.getNumFree();
+}
+
+uint32_t MeshPool::getNumFreeIndices() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mIndexAllocator.getNumFree();
+}
+
+std::shared_ptr<MeshPool::Allocation> MeshPool::allocate( uint32_t numVertices, uint32_t numIndices )
+{
+	lock_guard<mutex> lock( mMutex );
+	const uint32_t vertexOffset = mVertexAllocator.allocate( numVertices );
+	if( vertexOffset == OffsetAllocator::INVALID_OFFSET ) {
+		return nullptr;
+	}
+	const uint32_t indexOffset = mIndexAllocator.allocate( numIndices );
+	if( indexOffset == OffsetAllocator::INVALID_OFFSET ) {
+		mVertexAllocator.release( vertexOffset, numVertices );
+		return nullptr;
+	}
+
+	auto allocation = make_shared<Allocation>();
+	allocation->mPool = shared_from_this();
+	allocation->mVertexOffset = vertexOffset;
+	allocation->mNumVertices = numVertices;
+	allocation->mIndexOffset = indexOffset;
+	allocation->mNumIndices = numIndices;
+	return allocation;
+}
+
+void MeshPool::upload( DeviceContext* context, const Allocation &allocation, const void* vertexData, const uint32_t* indexData )
+{
+	context->UpdateBuffer( mVertexBuffer, allocation.mVertexOffset * mVertexStride, allocation.mNumVertices * mVertexStride, vertexData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	if( ! allocation.mNumIndices ) {
+		return;
+	}
+	// indices stay relative to the mesh, the base vertex is applied when drawing
+	if( mIndexType == VT_UINT16 ) {
+		const vector<uint16_t> indices( indexData, indexData + allocation.mNumIndices );
+		context->UpdateBuffer( mIndexBuffer, allocation.mIndexOffset * sizeof( uint16_t ), allocation.mNumIndices * sizeof( uint16_t ), indices.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+	else {
+		context->UpdateBuffer( mIndexBuffer, allocation.mIndexOffset * sizeof( uint32_t ), allocation.mNumIndices * sizeof( uint32_t ), indexData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+}
+
+Mesh MeshPool::makeMesh( const std::shared_ptr<Allocation> &allocation, geom::Primitive primitive )
+{
+	Mesh mesh( mDevice, { { mLayout, mVertexBuffer } }, allocation->mNumIndices, allocation->mNumIndices ? mIndexBuffer : BufferRef(), mIndexType, primitive );
+	mesh.mNumVertices = allocation->mNumVertices;
+	mesh.mBaseVertex = allocation->mVertexOffset;
+	mesh.mFirstIndex = allocation->mIndexOffset;
+	mesh.mPoolAllocation = allocation;
+	return mesh;
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
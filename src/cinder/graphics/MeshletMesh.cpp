@@ -0,0 +1,370 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/MeshletMesh.h"
+#include "cinder/graphics/ContextStateCache.h"
+#include "cinder/graphics/PipelineState.h"
+#include "cinder/app/RendererGx.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/Log.h"
+
+#include <glm/gtc/matrix_access.hpp>
+#include <numeric>
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+namespace {
+
+//! Meshlet as read by the culling shader, 48 bytes
+struct GpuMeshlet {
+	vec3		center;
+	float		radius;
+	vec3		coneAxis;
+	float		coneCutoff;
+	uint32_t	vertexOffset;
+	uint32_t	triangleOffset;
+	uint32_t	numVertices;
+	uint32_t	numTriangles;
+};
+
+struct MeshletCullingConstants {
+	vec4		planes[6];
+	vec3		cameraPosition;
+	uint32_t	numMeshlets;
+};
+
+//! Meshlets are culled by one thread group each, dispatched on two dimensions past the 65535 groups limit
+constexpr uint32_t MAX_DISPATCH_GROUPS = 65535;
+
+} // anonymous namespace
+
+MeshletMeshRef MeshletMesh::create( const TriMesh &triMesh, const std::vector<Mesh::BufferInfo> &bufferInfos, const Options &options )
+{
+	return create( app::getRenderDevice(), triMesh, bufferInfos, options );
+}
+
+MeshletMeshRef MeshletMesh::create( RenderDevice* device, const TriMesh &triMesh, const std::vector<Mesh::BufferInfo> &bufferInfos, const Options &options )
+{
+	return MeshletMeshRef( new MeshletMesh( device, triMesh, bufferInfos, options ) );
+}
+
+MeshletMesh::MeshletMesh( RenderDevice* device, const TriMesh &triMesh, const std::vector<Mesh::BufferInfo> &bufferInfos, const Options &options )
+	: mDevice( device ),
+	mMesh( device, triMesh, bufferInfos )
+{
+	CI_ASSERT_MSG( options.mMaxVertices >= 3 && options.mMaxVertices <= 256, "meshlets are limited to 256 vertices" );
+	CI_ASSERT_MSG( triMesh.getPrimitive() == geom::Primitive::TRIANGLES, "meshlets require a triangle list" );
+
+	const size_t numVertices = triMesh.getNumVertices();
+	const uint8_t positionDims = triMesh.getAttribDims( geom::Attrib::POSITION );
+	const float* positionData = triMesh.getBufferForAttrib( geom::Attrib::POSITION );
+	vector<vec3> positions( numVertices, vec3( 0.0f ) );
+	for( size_t i = 0; i < numVertices; ++i ) {
+		for( uint8_t c = 0; c < std::min<uint8_t>( positionDims, 3 ); ++c ) {
+			positions[i][c] = positionData[i * positionDims + c];
+		}
+	}
+
+	// non-indexed triangle lists are split in index order
+	vector<uint32_t> indices = triMesh.getIndices();
+	if( indices.empty() ) {
+		indices.resize( numVertices - numVertices % 3 );
+		std::iota( indices.begin(), indices.end(), 0 );
+	}
+	// the culled indices reference the same vertices, so only the grouping of the triangles changes
+	if( options.mOptimizeVertexCache ) {
+		optimizeVertexCache( indices.data(), indices.data(), indices.size(), numVertices );
+	}
+
+	mMeshlets.resize( buildMeshletsBound( indices.size(), options.mMaxVertices, options.mMaxTriangles ) );
+	vector<uint32_t> meshletVertices( indices.size() );
+	vector<uint8_t> meshletTriangles( indices.size() );
+	mMeshlets.resize( buildMeshlets( mMeshlets.data(), meshletVertices.data(), meshletTriangles.data(), indices.data(), indices.size(), numVertices, options.mMaxVertices, options.mMaxTriangles ) );
+	if( mMeshlets.empty() ) {
+		CI_LOG_W( "MeshletMesh created without triangles" );
+		return;
+	}
+
+	vector<GpuMeshlet> gpuMeshlets;
+	gpuMeshlets.reserve( mMeshlets.size() );
+	for( const Meshlet &meshlet : mMeshlets ) {
+		mMeshletBounds.push_back( computeMeshletBounds( meshlet, meshletVertices.data(), meshletTriangles.data(), positions.data() ) );
+		const MeshletBounds &bounds = mMeshletBounds.back();
+		gpuMeshlets.push_back( { bounds.center, bounds.radius, bounds.coneAxis, bounds.coneCutoff, meshlet.vertexOffset, meshlet.triangleOffset, meshlet.numVertices, meshlet.numTriangles } );
+	}
+	const Meshlet &lastMeshlet = mMeshlets.back();
+	const uint32_t numMeshletVertices = lastMeshlet.vertexOffset + lastMeshlet.numVertices;
+	const uint32_t numTriangles = lastMeshlet.triangleOffset + lastMeshlet.numTriangles;
+	vector<uint32_t> packedTriangles( numTriangles );
+	for( uint32_t t = 0; t < numTriangles; ++t ) {
+		packedTriangles[t] = meshletTriangles[t * 3] | ( meshletTriangles[t * 3 + 1] << 8 ) | ( meshletTriangles[t * 3 + 2] << 16 );
+	}
+
+	const string meshletsName = options.mName + " Meshlets Buffer";
+	BufferData meshletsData = { gpuMeshlets.data(), static_cast<uint32_t>( gpuMeshlets.size() * sizeof( GpuMeshlet ) ) };
+	device->CreateBuffer( BufferDesc()
+		.name( meshletsName.c_str() )
+		.usage( USAGE_IMMUTABLE )
+		.bindFlags( BIND_SHADER_RESOURCE )
+		.mode( BUFFER_MODE_STRUCTURED )
+		.elementByteStride( sizeof( GpuMeshlet ) )
+		.size( static_cast<uint32_t>( gpuMeshlets.size() * sizeof( GpuMeshlet ) ) ),
+		&meshletsData, &mMeshletsBuffer );
+
+	const string verticesName = options.mName + " Meshlet Vertices Buffer";
+	BufferData verticesData = { meshletVertices.data(), numMeshletVertices * sizeof( uint32_t ) };
+	device->CreateBuffer( BufferDesc()
+		.name( verticesName.c_str() )
+		.usage( USAGE_IMMUTABLE )
+		.bindFlags( BIND_SHADER_RESOURCE )
+		.mode( BUFFER_MODE_RAW )
+		.elementByteStride( sizeof( uint32_t ) )
+		.size( numMeshletVertices * sizeof( uint32_t ) ),
+		&verticesData, &mMeshletVerticesBuffer );
+
+	const string trianglesName = options.mName + " Meshlet Triangles Buffer";
+	BufferData trianglesData = { packedTriangles.data(), numTriangles * sizeof( uint32_t ) };
+	device->CreateBuffer( BufferDesc()
+		.name( trianglesName.c_str() )
+		.usage( USAGE_IMMUTABLE )
+		.bindFlags( BIND_SHADER_RESOURCE )
+		.mode( BUFFER_MODE_RAW )
+		.elementByteStride( sizeof( uint32_t ) )
+		.size( numTriangles * sizeof( uint32_t ) ),
+		&trianglesData, &mMeshletTrianglesBuffer );
+
+	const string culledIndicesName = options.mName + " Culled Index Buffer";
+	device->CreateBuffer( BufferDesc()
+		.name( culledIndicesName.c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_INDEX_BUFFER | BIND_UNORDERED_ACCESS )
+		.mode( BUFFER_MODE_RAW )
+		.elementByteStride( sizeof( uint32_t ) )
+		.size( numTriangles * 3 * sizeof( uint32_t ) ),
+		nullptr, &mCulledIndexBuffer );
+
+	const string drawArgsName = options.mName + " Draw Args Buffer";
+	device->CreateBuffer( BufferDesc()
+		.name( drawArgsName.c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_INDIRECT_DRAW_ARGS | BIND_UNORDERED_ACCESS )
+		.mode( BUFFER_MODE_RAW )
+		.elementByteStride( sizeof( uint32_t ) )
+		.size( 5 * sizeof( uint32_t ) ),
+		nullptr, &mDrawArgsBuffer );
+
+	const string constantsName = options.mName + " Constants Buffer";
+	device->CreateBuffer( BufferDesc()
+		.name( constantsName.c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_UNIFORM_BUFFER )
+		.size( sizeof( MeshletCullingConstants ) ),
+		nullptr, &mConstantsBuffer );
+
+	string computeShader = R"( #line 187
+
+		struct Meshlet {
+			float3	center;
+			float	radius;
+			float3	coneAxis;
+			float	coneCutoff;
+			uint	vertexOffset;
+			uint	triangleOffset;
+			uint	numVertices;
+			uint	numTriangles;
+		};
+
+		cbuffer CullingConstants {
+			float4	planes[6];
+			float3	cameraPosition;
+			uint	numMeshlets;
+		};
+
+		StructuredBuffer<Meshlet>	Meshlets;
+		ByteAddressBuffer			MeshletVertices;
+		ByteAddressBuffer			MeshletTriangles;
+		RWByteAddressBuffer			Indices;
+		RWByteAddressBuffer			DrawArgs;
+
+		groupshared uint sVisible;
+		groupshared uint sFirstIndex;
+
+		[numthreads( 128, 1, 1 )]
+		void main( uint3 groupId : SV_GroupID, uint threadIndex : SV_GroupIndex )
+		{
+			// the meshlet index is uniform across the group, so the early exit doesn't diverge
+			uint meshletIndex = groupId.y * 65535 + groupId.x;
+			if( meshletIndex >= numMeshlets ) {
+				return;
+			}
+
+			Meshlet meshlet = Meshlets[meshletIndex];
+			if( threadIndex == 0 ) {
+				bool visible = true;
+				[unroll]
+				for( uint i = 0; i < 6; ++i ) {
+					visible = visible && dot( planes[i].xyz, meshlet.center ) + planes[i].w >= -meshlet.radius;
+				}
+				// the cluster is back facing when the viewer is inside the cone opposite to its normals
+				float3 toCenter = meshlet.center - cameraPosition;
+				visible = visible && dot( toCenter, meshlet.coneAxis ) < meshlet.coneCutoff * length( toCenter ) + meshlet.radius;
+
+				uint firstIndex = 0;
+				if( visible ) {
+					DrawArgs.InterlockedAdd( 0, meshlet.numTriangles * 3, firstIndex );
+				}
+				sFirstIndex = firstIndex;
+				sVisible = visible ? 1 : 0;
+			}
+			GroupMemoryBarrierWithGroupSync();
+			if( sVisible == 0 ) {
+				return;
+			}
+
+			for( uint t = threadIndex; t < meshlet.numTriangles; t += 128 ) {
+				uint triangle = MeshletTriangles.Load( ( meshlet.triangleOffset + t ) * 4 );
+				uint3 local = uint3( triangle & 0xff, ( triangle >> 8 ) & 0xff, ( triangle >> 16 ) & 0xff );
+				uint3 vertices = uint3(
+					MeshletVertices.Load( ( meshlet.vertexOffset + local.x ) * 4 ),
+					MeshletVertices.Load( ( meshlet.vertexOffset + local.y ) * 4 ),
+					MeshletVertices.Load( ( meshlet.vertexOffset + local.z ) * 4 ) );
+				Indices.Store3( ( sFirstIndex + t * 3 ) * 4, vertices );
+			}
+		}
+	)";
+
+	mPso = gx::createComputePipelineState( device, gx::ComputePipelineCreateInfo()
+		.name( options.mName + " Culling Pipeline" )
+		.shader( gx::ShaderCreateInfo()
+			.name( options.mName + " Culling CS" )
+			.sourceLanguage( gx::SHADER_SOURCE_LANGUAGE_HLSL )
+			.shaderType( gx::SHADER_TYPE_COMPUTE )
+			.source( computeShader )
+		)
+		.defaultVariableType( gx::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE ) );
+	mPso->CreateShaderResourceBinding( &mSrb, true );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "CullingConstants" )->Set( mConstantsBuffer );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "Meshlets" )->Set( mMeshletsBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE ) );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "MeshletVertices" )->Set( mMeshletVerticesBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE ) );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "MeshletTriangles" )->Set( mMeshletTrianglesBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE ) );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "Indices" )->Set( mCulledIndexBuffer->GetDefaultView( BUFFER_VIEW_UNORDERED_ACCESS ) );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "DrawArgs" )->Set( mDrawArgsBuffer->GetDefaultView( BUFFER_VIEW_UNORDERED_ACCESS ) );
+}
+
+void MeshletMesh::cull( const mat4 &modelViewProjection, const vec3 &cameraPosition )
+{
+	cull( app::getImmediateContext(), modelViewProjection, cameraPosition );
+}
+
+void MeshletMesh::cull( DeviceContext* context, const mat4 &modelViewProjection, const vec3 &cameraPosition )
+{
+	cull( ScopedContextStateCache( context ), modelViewProjection, cameraPosition );
+}
+
+void MeshletMesh::cull( ContextStateCache* stateCache, const mat4 &modelViewProjection, const vec3 &cameraPosition )
+{
+	if( mMeshlets.empty() ) {
+		return;
+	}
+	DeviceContext* context = stateCache->getContext();
+
+	// normalized planes so that the distance to the plane compares to the sphere radius. The near plane uses the [-1,1] depth range, which is conservative for a [0,1] range.
+	const vec4 row0 = glm::row( modelViewProjection, 0 );
+	const vec4 row1 = glm::row( modelViewProjection, 1 );
+	const vec4 row2 = glm::row( modelViewProjection, 2 );
+	const vec4 row3 = glm::row( modelViewProjection, 3 );
+	MeshletCullingConstants constants = {};
+	constants.planes[0] = row3 + row0;
+	constants.planes[1] = row3 - row0;
+	constants.planes[2] = row3 + row1;
+	constants.planes[3] = row3 - row1;
+	constants.planes[4] = row3 + row2;
+	constants.planes[5] = row3 - row2;
+	for( vec4 &plane : constants.planes ) {
+		const float length = glm::length( vec3( plane ) );
+		plane = length > 0.0f ? plane / length : plane;
+	}
+	constants.cameraPosition = cameraPosition;
+	constants.numMeshlets = getNumMeshlets();
+	context->UpdateBuffer( mConstantsBuffer, 0, sizeof( MeshletCullingConstants ), &constants, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+
+	// NumIndices is accumulated by the visible meshlets, the other arguments draw a single instance of the whole buffer
+	const uint32_t drawArgs[5] = { 0, 1, 0, 0, 0 };
+	context->UpdateBuffer( mDrawArgsBuffer, 0, sizeof( drawArgs ), drawArgs, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+
+	// the draw args have just been updated so the commit has to transition them again
+	stateCache->setPipelineState( mPso );
+	stateCache->invalidateShaderResources();
+	stateCache->commitShaderResources( mSrb, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	const uint32_t numMeshlets = getNumMeshlets();
+	context->DispatchCompute( DispatchComputeAttribs( std::min( numMeshlets, MAX_DISPATCH_GROUPS ), ( numMeshlets + MAX_DISPATCH_GROUPS - 1 ) / MAX_DISPATCH_GROUPS, 1 ) );
+}
+
+void MeshletMesh::draw( const Mesh::DrawAttribs &attribs ) const
+{
+	draw( app::getImmediateContext(), attribs );
+}
+
+void MeshletMesh::draw( DeviceContext* context, const Mesh::DrawAttribs &attribs ) const
+{
+	draw( ScopedContextStateCache( context ), attribs );
+}
+
+void MeshletMesh::draw( ContextStateCache* stateCache, const Mesh::DrawAttribs &attribs ) const
+{
+	if( mMeshlets.empty() ) {
+		return;
+	}
+
+	// the vertex buffers of the mesh are indexed by the compacted indices
+	mMesh.bind( stateCache, attribs );
+	stateCache->setIndexBuffer( mCulledIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	stateCache->getContext()->DrawIndexedIndirect( gx::DrawIndexedIndirectAttribs()
+		.attribsBuffer( mDrawArgsBuffer )
+		.indexType( VT_UINT32 )
+		.attribsBufferStateTransitionMode( RESOURCE_STATE_TRANSITION_MODE_TRANSITION ) );
+}
+
+bool MeshletMesh::isMeshShaderSupported() const
+{
+	return mDevice->GetDeviceInfo().Features.MeshShaders == DEVICE_FEATURE_STATE_ENABLED;
+}
+
+void MeshletMesh::drawMeshTasks( DeviceContext* context ) const
+{
+	CI_ASSERT_MSG( isMeshShaderSupported(), "mesh shaders are not enabled on this device" );
+	if( mMeshlets.empty() ) {
+		return;
+	}
+
+	DrawMeshAttribs attribs;
+	attribs.ThreadGroupCount = getNumMeshlets();
+	context->DrawMesh( attribs );
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
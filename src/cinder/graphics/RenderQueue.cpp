@@ -0,0 +1,406 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/RenderQueue.h"
+#include "cinder/graphics/Buffer.h"
+#include "cinder/app/RendererGx.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+namespace {
+	//! Maps \a depth to 16 bits preserving the order of positive values. Negative depths are clamped to 0.
+	uint64_t quantizeDepth( float depth )
+	{
+		// positive floats compare like their integer representation
+		uint32_t bits;
+		std::memcpy( &bits, &depth, sizeof( float ) );
+		return ( bits & 0x80000000u ) ? 0 : ( bits >> 16 );
+	}
+
+	//! Appends a barrier to \a barriers if \a buffer is tracked and not already in \a requiredState
+	void addBufferBarrier( std::vector<StateTransitionDesc> &barriers, Buffer* buffer, RESOURCE_STATE requiredState )
+	{
+		const RESOURCE_STATE state = buffer->GetState();
+		if( state != RESOURCE_STATE_UNKNOWN && ( state & requiredState ) != requiredState ) {
+			barriers.emplace_back( buffer, RESOURCE_STATE_UNKNOWN, requiredState, STATE_TRANSITION_FLAG_UPDATE_STATE );
+		}
+	}
+}
+
+RenderQueue::RenderQueue( const Options &options )
+	: RenderQueue( app::getRenderDevice(), options )
+{
+}
+
+RenderQueue::RenderQueue( RenderDevice* device, const Options &options )
+	: mOptions( options ),
+	mDevice( device ),
+	mSorted( true ),
+	mRecordFrame( 0 ),
+	mFinishFrame( 0 ),
+	mNumWorkersDone( 0 ),
+	mStopWorkers( false ),
+	mRenderTarget( nullptr ),
+	mDepthStencil( nullptr )
+{
+	if( mOptions.mConstantsSize ) {
+		// uniform buffers size must be a multiple of 16
+		device->CreateBuffer( BufferDesc()
+			.name( "RenderQueue draw constants buffer" )
+			.usage( USAGE_DYNAMIC )
+			.bindFlags( BIND_UNIFORM_BUFFER )
+			.cpuAccessFlags( CPU_ACCESS_WRITE )
+			.size( ( mOptions.mConstantsSize + 15 ) & ~15u ),
+			nullptr, &mConstantsBuffer );
+	}
+}
+
+RenderQueue::~RenderQueue()
+{
+	stopWorkers();
+}
+
+template<typename T>
+uint16_t RenderQueue::getId( std::unordered_map<const void*, uint16_t> &ids, const void* key, std::vector<T*> &objects, T* object )
+{
+	auto it = ids.find( key );
+	if( it != ids.end() ) {
+		return it->second;
+	}
+	// ids saturate past 16 bits, which only makes the sort coarser
+	const uint16_t id = static_cast<uint16_t>( std::min<size_t>( ids.size(), 0xFFFF ) );
+	ids.emplace( key, id );
+	objects.push_back( object );
+	return id;
+}
+
+void RenderQueue::add( Batch* batch, float depth, const void* constants )
+{
+	for( const Mesh &mesh : batch->getMeshes() ) {
+		add( batch, &mesh, Mesh::DrawAttribs(), depth, constants );
+	}
+}
+
+void RenderQueue::add( Batch* batch, const Mesh* mesh, const Mesh::DrawAttribs &attribs, float depth, const void* constants )
+{
+	ShaderResourceBinding* srb = batch->getOrCreateShaderResourceBinding();
+	const uint64_t pipelineId = getId( mPipelineIds, batch->mPso.RawPtr(), mPipelines, batch->mPso.RawPtr() );
+	const uint64_t srbId = getId( mSrbIds, srb, mBatches, batch );
+	const uint64_t meshId = getId( mMeshIds, mesh, mMeshes, mesh );
+
+	Draw draw = { batch, mesh, attribs, static_cast<uint32_t>( mConstants.size() ) };
+	// resources are transitioned on the immediate context by prepare(), the recording contexts only verify their states
+	draw.attribs.vertexBuffersTransitionMode( RESOURCE_STATE_TRANSITION_MODE_VERIFY ).indexBufferTransitionMode( RESOURCE_STATE_TRANSITION_MODE_VERIFY );
+	if( mOptions.mConstantsSize ) {
+		mConstants.resize( mConstants.size() + mOptions.mConstantsSize );
+		if( constants ) {
+			std::memcpy( &mConstants[draw.constantsOffset], constants, mOptions.mConstantsSize );
+		}
+	}
+
+	const SortItem item = { pipelineId << 48 | srbId << 32 | meshId << 16 | quantizeDepth( depth ), static_cast<uint32_t>( mDraws.size() ) };
+	mSortItems.push_back( item );
+	mDraws.push_back( draw );
+	mSorted = false;
+}
+
+void RenderQueue::sort()
+{
+	if( mSorted ) {
+		return;
+	}
+	mSorted = true;
+	radixSort( mSortItems, mSortScratch );
+}
+
+void RenderQueue::radixSort( std::vector<SortItem> &items, std::vector<SortItem> &scratch )
+{
+	const size_t count = items.size();
+	if( count < 2 ) {
+		return;
+	}
+
+	// LSD radix sort on 8 bits digits, histograms of all digits are built in a single pass
+	uint32_t histograms[8][256] = {};
+	for( const SortItem &item : items ) {
+		for( uint32_t digit = 0; digit < 8; ++digit ) {
+			histograms[digit][( item.key >> ( digit * 8 ) ) & 0xFF]++;
+		}
+	}
+
+	scratch.resize( count );
+	SortItem* src = items.data();
+	SortItem* dst = scratch.data();
+	for( uint32_t digit = 0; digit < 8; ++digit ) {
+		const uint32_t shift = digit * 8;
+		uint32_t* histogram = histograms[digit];
+		// skip the passes where all the keys share the same digit, which is the case for most of the pso bits
+		if( histogram[( src[0].key >> shift ) & 0xFF] == count ) {
+			continue;
+		}
+		uint32_t offset = 0;
+		for( uint32_t i = 0; i < 256; ++i ) {
+			const uint32_t digitCount = histogram[i];
+			histogram[i] = offset;
+			offset += digitCount;
+		}
+		for( size_t i = 0; i < count; ++i ) {
+			dst[histogram[( src[i].key >> shift ) & 0xFF]++] = src[i];
+		}
+		std::swap( src, dst );
+	}
+	if( src != items.data() ) {
+		items.swap( scratch );
+	}
+}
+
+void RenderQueue::prepare( DeviceContext* context )
+{
+	for( Batch* batch : mBatches ) {
+		ShaderResourceBinding* srb = batch->getOrCreateShaderResourceBinding();
+		if( mConstantsBuffer ) {
+			for( SHADER_TYPE shaderType : { SHADER_TYPE_VERTEX, SHADER_TYPE_PIXEL } ) {
+				ShaderResourceVariable* variable = srb->GetVariableByName( shaderType, mOptions.mConstantsName.c_str() );
+				if( variable && variable->Get() != mConstantsBuffer.RawPtr() ) {
+					variable->Set( mConstantsBuffer );
+				}
+			}
+		}
+		// the variables might have been set since the last submit, consecutive draws of the batch share one commit
+		batch->updateShaderResourceBindingRevision();
+		context->TransitionShaderResources( batch->mPso, srb );
+	}
+
+	mBarriers.clear();
+	for( const Mesh* mesh : mMeshes ) {
+		for( size_t i = 0; i < mesh->getVertexBuffers().size(); ++i ) {
+			// vertex pulled buffers are read as shader resources
+			const RESOURCE_STATE state = mesh->getVertexBuffersInfo()[i].isVertexPulled() ? RESOURCE_STATE_SHADER_RESOURCE : RESOURCE_STATE_VERTEX_BUFFER;
+			addBufferBarrier( mBarriers, mesh->getVertexBuffers()[i], state );
+		}
+		if( Buffer* indexBuffer = mesh->getIndexBuffer() ) {
+			addBufferBarrier( mBarriers, indexBuffer, RESOURCE_STATE_INDEX_BUFFER );
+		}
+	}
+	if( ! mBarriers.empty() ) {
+		context->TransitionResourceStates( static_cast<uint32_t>( mBarriers.size() ), mBarriers.data() );
+	}
+}
+
+void RenderQueue::record( ContextStateCache* stateCache, size_t begin, size_t end, TextureView* renderTarget, TextureView* depthStencil )
+{
+	// deferred contexts start in default state, render targets have been transitioned by the immediate context
+	DeviceContext* context = stateCache->getContext();
+	context->SetRenderTargets( renderTarget ? 1 : 0, &renderTarget, depthStencil, RESOURCE_STATE_TRANSITION_MODE_VERIFY );
+	if( mOptions.mPrepareContextFn ) {
+		mOptions.mPrepareContextFn( context );
+	}
+
+	const uint32_t constantsSize = mOptions.mConstantsSize;
+	for( size_t i = begin; i < end; ++i ) {
+		const Draw &draw = mDraws[mSortItems[i].index];
+		stateCache->setPipelineState( draw.batch->mPso );
+		stateCache->commitShaderResources( draw.batch->mSrb, RESOURCE_STATE_TRANSITION_MODE_VERIFY, draw.batch->mSrbRevision );
+		// dynamic buffers allocations are per context so the same buffer can be mapped concurrently
+		if( constantsSize ) {
+			MapHelper<uint8_t> constants( context, mConstantsBuffer, MAP_WRITE, MAP_FLAG_DISCARD );
+			std::memcpy( constants, &mConstants[draw.constantsOffset], constantsSize );
+		}
+		draw.mesh->draw( stateCache, draw.attribs );
+	}
+}
+
+void RenderQueue::submit()
+{
+	SwapChain* swapChain = app::getSwapChain();
+	submit( swapChain->GetCurrentBackBufferRTV(), swapChain->GetDepthBufferDSV() );
+}
+
+void RenderQueue::submit( TextureView* renderTarget, TextureView* depthStencil )
+{
+	if( mDraws.empty() ) {
+		return;
+	}
+	sort();
+
+	const size_t numWorkers = std::min<size_t>( mOptions.mMaxThreads, app::getDeferredContextsCount() );
+	if( mWorkers.size() != numWorkers ) {
+		stopWorkers();
+		startWorkers( numWorkers );
+	}
+
+	DeviceContext* context = app::getImmediateContext();
+	ContextStateCache* stateCache = app::getContextStateCache( context );
+	prepare( context );
+	context->SetRenderTargets( renderTarget ? 1 : 0, &renderTarget, depthStencil, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+
+	// split the sorted draws in contiguous ranges, the first one being recorded on the immediate context
+	const size_t numDraws = mSortItems.size();
+	const size_t numRanges = std::max<size_t>( 1, std::min<size_t>( numWorkers + 1, numDraws / std::max( 1u, mOptions.mMinDrawsPerThread ) ) );
+	const size_t rangeSize = ( numDraws + numRanges - 1 ) / numRanges;
+	for( size_t i = 0; i < numWorkers; ++i ) {
+		mWorkers[i]->begin = std::min( numDraws, ( i + 1 ) * rangeSize );
+		mWorkers[i]->end = std::min( numDraws, ( i + 2 ) * rangeSize );
+	}
+
+	if( numRanges > 1 ) {
+		{
+			lock_guard<mutex> lock( mWorkersMutex );
+			mRenderTarget = renderTarget;
+			mDepthStencil = depthStencil;
+			mNumWorkersDone = 0;
+			mRecordFrame++;
+		}
+		mWorkersCondition.notify_all();
+	}
+
+	record( stateCache, 0, std::min( numDraws, rangeSize ), renderTarget, depthStencil );
+
+	if( numRanges > 1 ) {
+		{
+			unique_lock<mutex> lock( mWorkersMutex );
+			mWorkersDoneCondition.wait( lock, [this] { return mNumWorkersDone == mWorkers.size(); } );
+		}
+
+		// command lists are executed in the sorted order
+		mCommandLists.clear();
+		for( auto &worker : mWorkers ) {
+			if( worker->commandList ) {
+				mCommandLists.push_back( worker->commandList );
+			}
+		}
+		context->ExecuteCommandLists( static_cast<uint32_t>( mCommandLists.size() ), mCommandLists.data() );
+		stateCache->invalidate();
+		// release the command lists now, in d3d11 mode they hold references to the swap chain's back buffer
+		mCommandLists.clear();
+		for( auto &worker : mWorkers ) {
+			worker->commandList.Release();
+		}
+
+		// FinishFrame() releases the dynamic allocations of the deferred contexts, so it can only happen once the lists have been executed
+		{
+			unique_lock<mutex> lock( mWorkersMutex );
+			mNumWorkersDone = 0;
+			mFinishFrame = mRecordFrame;
+		}
+		mWorkersCondition.notify_all();
+		{
+			unique_lock<mutex> lock( mWorkersMutex );
+			mWorkersDoneCondition.wait( lock, [this] { return mNumWorkersDone == mWorkers.size(); } );
+		}
+
+		// executing command lists resets the immediate context state
+		context->SetRenderTargets( renderTarget ? 1 : 0, &renderTarget, depthStencil, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+}
+
+void RenderQueue::clear()
+{
+	mDraws.clear();
+	mSortItems.clear();
+	mConstants.clear();
+	mPipelineIds.clear();
+	mSrbIds.clear();
+	mMeshIds.clear();
+	mPipelines.clear();
+	mBatches.clear();
+	mMeshes.clear();
+	mSorted = true;
+}
+
+void RenderQueue::startWorkers( size_t numWorkers )
+{
+	for( size_t i = 0; i < numWorkers; ++i ) {
+		unique_ptr<Worker> worker( new Worker() );
+		worker->context = app::getDeferredContext( i );
+		worker->stateCache = app::getContextStateCache( worker->context );
+		worker->begin = worker->end = 0;
+		worker->thread = std::thread( &RenderQueue::workerLoop, this, worker.get(), mRecordFrame );
+		mWorkers.push_back( std::move( worker ) );
+	}
+}
+
+void RenderQueue::stopWorkers()
+{
+	{
+		lock_guard<mutex> lock( mWorkersMutex );
+		mStopWorkers = true;
+	}
+	mWorkersCondition.notify_all();
+	for( auto &worker : mWorkers ) {
+		worker->thread.join();
+	}
+	mWorkers.clear();
+	mStopWorkers = false;
+}
+
+void RenderQueue::workerLoop( Worker* worker, uint64_t frame )
+{
+	for( ;; ) {
+		{
+			unique_lock<mutex> lock( mWorkersMutex );
+			mWorkersCondition.wait( lock, [&] { return mStopWorkers || mRecordFrame != frame; } );
+			if( mStopWorkers ) {
+				return;
+			}
+			frame = mRecordFrame;
+		}
+
+		if( worker->begin < worker->end ) {
+			record( worker->stateCache, worker->begin, worker->end, mRenderTarget, mDepthStencil );
+			worker->context->FinishCommandList( &worker->commandList );
+			// finishing a command list resets the deferred context state
+			worker->stateCache->invalidate();
+		}
+		{
+			lock_guard<mutex> lock( mWorkersMutex );
+			mNumWorkersDone++;
+		}
+		mWorkersDoneCondition.notify_one();
+
+		{
+			unique_lock<mutex> lock( mWorkersMutex );
+			mWorkersCondition.wait( lock, [&] { return mStopWorkers || mFinishFrame == frame; } );
+			if( mStopWorkers ) {
+				return;
+			}
+		}
+		// must be called from the recording thread for the Metal backend
+		worker->context->FinishFrame();
+		{
+			lock_guard<mutex> lock( mWorkersMutex );
+			mNumWorkersDone++;
+		}
+		mWorkersDoneCondition.notify_one();
+	}
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -0,0 +1,462 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/SkinnedMesh.h"
+#include "cinder/graphics/ContextStateCache.h"
+#include "cinder/graphics/PipelineState.h"
+#include "cinder/app/RendererGx.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+namespace {
+
+//! Byte offsets and strides of the source attributes, in the order position, normal, bone indices and bone weights
+struct SkinningConstants {
+	uint32_t	numVertices;
+	uint32_t	numInfluences;
+	uint32_t	numMorphTargets;
+	uint32_t	boneIndicesAreIntegers;
+	uint32_t	offsets[4];
+	uint32_t	strides[4];
+	uint32_t	outputStride;
+	uint32_t	padding[3];
+};
+
+//! Vertices are skinned by groups of 64, dispatched on two dimensions past the 65535 groups limit
+constexpr uint32_t THREAD_GROUP_SIZE = 64;
+constexpr uint32_t MAX_DISPATCH_GROUPS = 65535;
+
+//! Returns the description of \a attrib and the index of the vertex buffer holding it, or nullptr if \a mesh doesn't have it
+const geom::AttribInfo* findAttrib( const Mesh &mesh, geom::Attrib attrib, size_t* bufferIndex )
+{
+	const auto &infos = mesh.getVertexBuffersInfo();
+	for( size_t i = 0; i < infos.size(); ++i ) {
+		for( const auto &attribInfo : infos[i].getAttribs() ) {
+			if( attribInfo.getAttrib() == attrib ) {
+				*bufferIndex = i;
+				return &attribInfo;
+			}
+		}
+	}
+	return nullptr;
+}
+
+//! Returns whether the compute pass can read \a attribInfo from the buffer described by \a info
+bool isReadable( const Mesh::BufferInfo &info, const geom::AttribInfo &attribInfo )
+{
+	return info.getMode() == BUFFER_MODE_RAW && ( info.getBindFlags() & BIND_SHADER_RESOURCE ) && info.getAttribFormat( attribInfo.getAttrib() ) == Mesh::AttribFormat::FLOAT32;
+}
+
+//! Returns whether \a attrib is drawn from the source mesh buffers rather than the skinning output, which excludes the skinning inputs
+bool isDrawnFromSource( geom::Attrib attrib, geom::Attrib boneIndicesAttrib, geom::Attrib boneWeightsAttrib )
+{
+	return attrib != geom::Attrib::POSITION && attrib != geom::Attrib::NORMAL && attrib != boneIndicesAttrib && attrib != boneWeightsAttrib;
+}
+
+} // anonymous namespace
+
+SkinnedMeshRef SkinnedMesh::create( const Mesh &mesh, const Options &options )
+{
+	return create( app::getRenderDevice(), mesh, options );
+}
+
+SkinnedMeshRef SkinnedMesh::create( RenderDevice* device, const Mesh &mesh, const Options &options )
+{
+	return SkinnedMeshRef( new SkinnedMesh( device, mesh, options ) );
+}
+
+SkinnedMeshRef SkinnedMesh::createInstance() const
+{
+	return SkinnedMeshRef( new SkinnedMesh( mShared ) );
+}
+
+SkinnedMesh::SkinnedMesh( const std::shared_ptr<Shared> &shared )
+	: mShared( shared )
+{
+	createInstanceResources();
+}
+
+SkinnedMesh::SkinnedMesh( RenderDevice* device, const Mesh &mesh, const Options &options )
+	: mShared( make_shared<Shared>() )
+{
+	Shared &shared = *mShared;
+	shared.device = device;
+	shared.sourceMesh = mesh;
+	shared.maxBones = std::max( options.mMaxBones, 1u );
+	shared.name = options.mName;
+
+	size_t positionBuffer = 0, normalBuffer = 0, boneIndicesBuffer = 0, boneWeightsBuffer = 0;
+	const geom::AttribInfo* position = findAttrib( mesh, geom::Attrib::POSITION, &positionBuffer );
+	const geom::AttribInfo* normal = findAttrib( mesh, geom::Attrib::NORMAL, &normalBuffer );
+	const geom::AttribInfo* boneIndices = findAttrib( mesh, options.mBoneIndicesAttrib, &boneIndicesBuffer );
+	const geom::AttribInfo* boneWeights = findAttrib( mesh, options.mBoneWeightsAttrib, &boneWeightsBuffer );
+	const auto &infos = mesh.getVertexBuffersInfo();
+	if( ! position || ! boneIndices || ! boneWeights ) {
+		CI_LOG_E( "SkinnedMesh requires positions, bone indices and bone weights" );
+		return;
+	}
+	if( ! isReadable( infos[positionBuffer], *position ) || ! isReadable( infos[boneIndicesBuffer], *boneIndices ) || ! isReadable( infos[boneWeightsBuffer], *boneWeights ) || ( normal && ! isReadable( infos[normalBuffer], *normal ) ) ) {
+		CI_LOG_E( "SkinnedMesh attributes must be FLOAT32 and stored in raw buffers bound as shader resources" );
+		return;
+	}
+	if( position->getDims() < 3 || boneIndices->getDims() > 4 || boneWeights->getDims() != boneIndices->getDims() ) {
+		CI_LOG_E( "SkinnedMesh requires 3d positions and up to four bone indices matched by as many weights" );
+		return;
+	}
+	if( mesh.getBaseVertex() ) {
+		CI_LOG_E( "SkinnedMesh doesn't support meshes allocated from a MeshPool" );
+		return;
+	}
+
+	// the skinned attributes are read from the output buffer, the other ones are drawn from their source buffers, which therefore have to be bound
+	// as vertex buffers too. The bone indices and weights are consumed by the skinning pass and aren't drawn.
+	for( size_t i = 0; i < infos.size(); ++i ) {
+		for( const auto &attribInfo : infos[i].getAttribs() ) {
+			if( isDrawnFromSource( attribInfo.getAttrib(), options.mBoneIndicesAttrib, options.mBoneWeightsAttrib ) && ! ( infos[i].getBindFlags() & BIND_VERTEX_BUFFER ) ) {
+				CI_LOG_E( "SkinnedMesh buffers holding attributes other than positions, normals and bones must be bound as vertex buffers, for instance with BIND_VERTEX_BUFFER | BIND_SHADER_RESOURCE and BUFFER_MODE_RAW" );
+				return;
+			}
+		}
+	}
+	const uint32_t outputStride = normal ? 6 * sizeof( float ) : 3 * sizeof( float );
+	shared.outputInfo = Mesh::BufferInfo()
+		.attrib( geom::Attrib::POSITION, 3, outputStride, 0 )
+		.bindFlags( BIND_VERTEX_BUFFER | BIND_UNORDERED_ACCESS )
+		.usage( USAGE_DEFAULT )
+		.mode( BUFFER_MODE_RAW )
+		.name( options.mName + " Output Buffer" );
+	if( normal ) {
+		shared.outputInfo.attrib( geom::Attrib::NORMAL, 3, outputStride, 3 * sizeof( float ) );
+	}
+	for( size_t i = 0; i < infos.size(); ++i ) {
+		const Mesh::BufferInfo &info = infos[i];
+		Mesh::BufferInfo drawInfo = Mesh::BufferInfo().bindFlags( info.getBindFlags() ).usage( info.getUsage() ).cpuAccess( info.getCPUAccessFlags() ).mode( info.getMode() ).normalized( info.getIsNormalized() ).name( info.getName() );
+		for( const auto &attribInfo : info.getAttribs() ) {
+			if( ! isDrawnFromSource( attribInfo.getAttrib(), options.mBoneIndicesAttrib, options.mBoneWeightsAttrib ) ) {
+				continue;
+			}
+			drawInfo.attrib( attribInfo.getAttrib(), attribInfo.getDataType(), attribInfo.getDims(), attribInfo.getStride(), attribInfo.getOffset(), attribInfo.getInstanceDivisor() );
+			drawInfo.attribFormat( attribInfo.getAttrib(), info.getAttribFormat( attribInfo.getAttrib() ) );
+		}
+		if( ! drawInfo.getAttribs().empty() ) {
+			shared.drawBuffers.push_back( { drawInfo, mesh.getVertexBuffers()[i] } );
+		}
+	}
+
+	SkinningConstants constants = {};
+	constants.numVertices = mesh.getNumVertices();
+	constants.numInfluences = boneIndices->getDims();
+	constants.numMorphTargets = static_cast<uint32_t>( options.mMorphTargets.size() );
+	constants.boneIndicesAreIntegers = boneIndices->getDataType() == geom::DataType::INTEGER ? 1 : 0;
+	const geom::AttribInfo* attribs[4] = { position, normal, boneIndices, boneWeights };
+	const size_t buffers[4] = { positionBuffer, normalBuffer, boneIndicesBuffer, boneWeightsBuffer };
+	for( int i = 0; i < 4; ++i ) {
+		if( attribs[i] ) {
+			constants.offsets[i] = static_cast<uint32_t>( attribs[i]->getOffset() );
+			constants.strides[i] = static_cast<uint32_t>( infos[buffers[i]].calcVertexByteSize() );
+		}
+	}
+	constants.outputStride = outputStride;
+
+	const string constantsName = options.mName + " Constants Buffer";
+	BufferData constantsData = { &constants, sizeof( SkinningConstants ) };
+	device->CreateBuffer( BufferDesc()
+		.name( constantsName.c_str() )
+		.usage( USAGE_IMMUTABLE )
+		.bindFlags( BIND_UNIFORM_BUFFER )
+		.size( sizeof( SkinningConstants ) ),
+		&constantsData, &shared.constantsBuffer );
+
+	// morph deltas are stored target after target, a position and a normal per vertex
+	shared.numMorphTargets = constants.numMorphTargets;
+	if( shared.numMorphTargets ) {
+		const uint32_t numVertices = mesh.getNumVertices();
+		vector<vec3> deltas( shared.numMorphTargets * numVertices * 2, vec3( 0.0f ) );
+		for( uint32_t t = 0; t < shared.numMorphTargets; ++t ) {
+			const auto &target = options.mMorphTargets[t];
+			CI_ASSERT_MSG( target.first.size() == numVertices, "morph targets require one position delta per vertex" );
+			for( uint32_t v = 0; v < std::min<uint32_t>( numVertices, static_cast<uint32_t>( target.first.size() ) ); ++v ) {
+				deltas[( t * numVertices + v ) * 2] = target.first[v];
+			}
+			for( uint32_t v = 0; v < std::min<uint32_t>( numVertices, static_cast<uint32_t>( target.second.size() ) ); ++v ) {
+				deltas[( t * numVertices + v ) * 2 + 1] = target.second[v];
+			}
+		}
+		const string deltasName = options.mName + " Morph Targets Buffer";
+		BufferData deltasData = { deltas.data(), static_cast<uint32_t>( deltas.size() * sizeof( vec3 ) ) };
+		device->CreateBuffer( BufferDesc()
+			.name( deltasName.c_str() )
+			.usage( USAGE_IMMUTABLE )
+			.bindFlags( BIND_SHADER_RESOURCE )
+			.mode( BUFFER_MODE_STRUCTURED )
+			.elementByteStride( 2 * sizeof( vec3 ) )
+			.size( static_cast<uint32_t>( deltas.size() * sizeof( vec3 ) ) ),
+			&deltasData, &shared.morphDeltasBuffer );
+	}
+
+	shared.positionsView = mesh.getVertexBufferView( positionBuffer );
+	shared.normalsView = normal ? mesh.getVertexBufferView( normalBuffer ) : nullptr;
+	shared.boneIndicesView = mesh.getVertexBufferView( boneIndicesBuffer );
+	shared.boneWeightsView = mesh.getVertexBufferView( boneWeightsBuffer );
+
+	string computeShader = R"( #line 214
+
+		cbuffer SkinningConstants {
+			uint	numVertices;
+			uint	numInfluences;
+			uint	numMorphTargets;
+			uint	boneIndicesAreIntegers;
+			uint4	offsets;
+			uint4	strides;
+			uint	outputStride;
+		};
+
+		ByteAddressBuffer			Positions;
+		ByteAddressBuffer			BoneIndices;
+		ByteAddressBuffer			BoneWeights;
+		StructuredBuffer<float4x4>	Bones;
+		RWByteAddressBuffer			Output;
+	#if SKINNING_NORMALS
+		ByteAddressBuffer			Normals;
+	#endif
+	#if SKINNING_MORPH_TARGETS
+		struct MorphDelta {
+			float3	position;
+			float3	normal;
+		};
+		StructuredBuffer<MorphDelta>	MorphDeltas;
+		StructuredBuffer<float>			MorphWeights;
+	#endif
+
+		[numthreads( 64, 1, 1 )]
+		void main( uint3 groupId : SV_GroupID, uint threadIndex : SV_GroupIndex )
+		{
+			uint vertex = ( groupId.y * 65535 + groupId.x ) * 64 + threadIndex;
+			if( vertex >= numVertices ) {
+				return;
+			}
+
+			float3 position = asfloat( Positions.Load3( vertex * strides.x + offsets.x ) );
+			float3 normal = float3( 0.0, 0.0, 0.0 );
+	#if SKINNING_NORMALS
+			normal = asfloat( Normals.Load3( vertex * strides.y + offsets.y ) );
+	#endif
+	#if SKINNING_MORPH_TARGETS
+			// morph targets are blended in bind pose, before skinning
+			for( uint t = 0; t < numMorphTargets; ++t ) {
+				float weight = MorphWeights[t];
+				if( weight != 0.0 ) {
+					MorphDelta delta = MorphDeltas[t * numVertices + vertex];
+					position += delta.position * weight;
+					normal += delta.normal * weight;
+				}
+			}
+	#endif
+
+			// glm matrices match the default column major packing
+			float3 skinnedPosition = float3( 0.0, 0.0, 0.0 );
+			float3 skinnedNormal = float3( 0.0, 0.0, 0.0 );
+			float totalWeight = 0.0;
+			for( uint i = 0; i < numInfluences; ++i ) {
+				uint indexBits = BoneIndices.Load( vertex * strides.z + offsets.z + i * 4 );
+				uint bone = boneIndicesAreIntegers != 0 ? indexBits : uint( asfloat( indexBits ) );
+				float weight = asfloat( BoneWeights.Load( vertex * strides.w + offsets.w + i * 4 ) );
+				float4x4 boneMatrix = Bones[bone];
+				skinnedPosition += mul( boneMatrix, float4( position, 1.0 ) ).xyz * weight;
+	#if SKINNING_NORMALS
+				// normals are transformed by the cofactor of the upper 3x3, the inverse transpose scaled by the determinant,
+				// which stays correct under non-uniform scales. The sign of the determinant keeps mirrored bones facing out.
+				float3 row0 = boneMatrix[0].xyz, row1 = boneMatrix[1].xyz, row2 = boneMatrix[2].xyz;
+				float3 cofactor0 = cross( row1, row2 ), cofactor1 = cross( row2, row0 ), cofactor2 = cross( row0, row1 );
+				float3 boneNormal = float3( dot( cofactor0, normal ), dot( cofactor1, normal ), dot( cofactor2, normal ) );
+				skinnedNormal += ( dot( row0, cofactor0 ) < 0.0 ? -boneNormal : boneNormal ) * weight;
+	#endif
+				totalWeight += weight;
+			}
+			// vertices without influences stay in bind pose
+			if( totalWeight == 0.0 ) {
+				skinnedPosition = position;
+				skinnedNormal = normal;
+			}
+
+			Output.Store3( vertex * outputStride, asuint( skinnedPosition ) );
+	#if SKINNING_NORMALS
+			float normalLength = length( skinnedNormal );
+			Output.Store3( vertex * outputStride + 12, asuint( normalLength > 0.0 ? skinnedNormal / normalLength : skinnedNormal ) );
+	#endif
+		}
+	)";
+
+	shared.pso = gx::createComputePipelineState( device, gx::ComputePipelineCreateInfo()
+		.name( options.mName + " Skinning Pipeline" )
+		.shader( gx::ShaderCreateInfo()
+			.name( options.mName + " Skinning CS" )
+			.sourceLanguage( gx::SHADER_SOURCE_LANGUAGE_HLSL )
+			.shaderType( gx::SHADER_TYPE_COMPUTE )
+			.macro( "SKINNING_NORMALS", normal ? 1 : 0 )
+			.macro( "SKINNING_MORPH_TARGETS", shared.numMorphTargets ? 1 : 0 )
+			.source( computeShader )
+		)
+		.defaultVariableType( gx::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE ) );
+
+	createInstanceResources();
+}
+
+void SkinnedMesh::createInstanceResources()
+{
+	const Shared &shared = *mShared;
+	if( ! shared.pso ) {
+		return;
+	}
+	RenderDevice* device = shared.device;
+	const Mesh &sourceMesh = shared.sourceMesh;
+
+	const uint32_t outputSize = sourceMesh.getNumVertices() * static_cast<uint32_t>( shared.outputInfo.calcVertexByteSize() );
+	device->CreateBuffer( shared.outputInfo.calcBufferDesc( outputSize ), nullptr, &mOutputBuffer );
+
+	// the bind pose is skinned until the first bone matrices are set
+	const vector<mat4> identities( shared.maxBones, mat4( 1.0f ) );
+	const string bonesName = shared.name + " Bones Buffer";
+	BufferData bonesData = { identities.data(), static_cast<uint32_t>( identities.size() * sizeof( mat4 ) ) };
+	device->CreateBuffer( BufferDesc()
+		.name( bonesName.c_str() )
+		.usage( USAGE_DEFAULT )
+		.bindFlags( BIND_SHADER_RESOURCE )
+		.mode( BUFFER_MODE_STRUCTURED )
+		.elementByteStride( sizeof( mat4 ) )
+		.size( static_cast<uint32_t>( identities.size() * sizeof( mat4 ) ) ),
+		&bonesData, &mBonesBuffer );
+
+	if( shared.numMorphTargets ) {
+		mMorphWeights.assign( shared.numMorphTargets, 0.0f );
+		const string weightsName = shared.name + " Morph Weights Buffer";
+		BufferData weightsData = { mMorphWeights.data(), static_cast<uint32_t>( mMorphWeights.size() * sizeof( float ) ) };
+		device->CreateBuffer( BufferDesc()
+			.name( weightsName.c_str() )
+			.usage( USAGE_DEFAULT )
+			.bindFlags( BIND_SHADER_RESOURCE )
+			.mode( BUFFER_MODE_STRUCTURED )
+			.elementByteStride( sizeof( float ) )
+			.size( static_cast<uint32_t>( mMorphWeights.size() * sizeof( float ) ) ),
+			&weightsData, &mMorphWeightsBuffer );
+	}
+
+	shared.pso->CreateShaderResourceBinding( &mSrb, true );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "SkinningConstants" )->Set( shared.constantsBuffer );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "Positions" )->Set( shared.positionsView );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "BoneIndices" )->Set( shared.boneIndicesView );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "BoneWeights" )->Set( shared.boneWeightsView );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "Bones" )->Set( mBonesBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE ) );
+	mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "Output" )->Set( mOutputBuffer->GetDefaultView( BUFFER_VIEW_UNORDERED_ACCESS ) );
+	if( shared.normalsView ) {
+		mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "Normals" )->Set( shared.normalsView );
+	}
+	if( shared.numMorphTargets ) {
+		mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "MorphDeltas" )->Set( shared.morphDeltasBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE ) );
+		mSrb->GetVariableByName( SHADER_TYPE_COMPUTE, "MorphWeights" )->Set( mMorphWeightsBuffer->GetDefaultView( BUFFER_VIEW_SHADER_RESOURCE ) );
+	}
+
+	// the output buffer comes first so that the skinned attributes keep the first input indices
+	std::vector<std::pair<Mesh::BufferInfo, BufferRef>> drawBuffers = { { shared.outputInfo, mOutputBuffer } };
+	drawBuffers.insert( drawBuffers.end(), shared.drawBuffers.begin(), shared.drawBuffers.end() );
+	mMesh = Mesh( device, drawBuffers, sourceMesh.getNumIndices(), sourceMesh.getIndexBuffer(), sourceMesh.getIndexDataType() );
+	mMesh.mNumVertices = sourceMesh.getNumVertices();
+	mMesh.mPrimitiveTopology = sourceMesh.getPrimitiveTopology();
+	mMesh.mFirstIndex = sourceMesh.getFirstIndex();
+	mMesh.mLods = sourceMesh.getLods();
+	mPoseChanged = true;
+}
+
+void SkinnedMesh::setBoneMatrices( const std::vector<mat4> &matrices )
+{
+	setBoneMatrices( matrices.data(), matrices.size() );
+}
+
+void SkinnedMesh::setBoneMatrices( const mat4* matrices, size_t count )
+{
+	CI_ASSERT_MSG( count <= mShared->maxBones, "more bone matrices than Options::maxBones" );
+	count = std::min<size_t>( count, mShared->maxBones );
+	if( mBoneMatrices.size() == count && std::memcmp( mBoneMatrices.data(), matrices, count * sizeof( mat4 ) ) == 0 ) {
+		return;
+	}
+	mBoneMatrices.assign( matrices, matrices + count );
+	mPoseChanged = true;
+}
+
+void SkinnedMesh::setMorphWeights( const std::vector<float> &weights )
+{
+	CI_ASSERT_MSG( weights.size() <= mMorphWeights.size(), "more morph weights than morph targets" );
+	const size_t count = std::min( weights.size(), mMorphWeights.size() );
+	if( std::memcmp( mMorphWeights.data(), weights.data(), count * sizeof( float ) ) == 0 ) {
+		return;
+	}
+	std::copy( weights.begin(), weights.begin() + count, mMorphWeights.begin() );
+	mPoseChanged = true;
+}
+
+bool SkinnedMesh::update()
+{
+	return update( app::getImmediateContext() );
+}
+
+bool SkinnedMesh::update( DeviceContext* context )
+{
+	return update( ScopedContextStateCache( context ) );
+}
+
+bool SkinnedMesh::update( ContextStateCache* stateCache )
+{
+	if( ! mPoseChanged || ! mSrb ) {
+		return false;
+	}
+	DeviceContext* context = stateCache->getContext();
+
+	if( ! mBoneMatrices.empty() ) {
+		context->UpdateBuffer( mBonesBuffer, 0, static_cast<uint32_t>( mBoneMatrices.size() * sizeof( mat4 ) ), mBoneMatrices.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+	if( ! mMorphWeights.empty() ) {
+		context->UpdateBuffer( mMorphWeightsBuffer, 0, static_cast<uint32_t>( mMorphWeights.size() * sizeof( float ) ), mMorphWeights.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	}
+
+	// the output buffer was last bound as a vertex buffer so the commit has to transition it again
+	stateCache->setPipelineState( mShared->pso );
+	stateCache->invalidateShaderResources();
+	stateCache->commitShaderResources( mSrb, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+	const uint32_t numGroups = ( mShared->sourceMesh.getNumVertices() + THREAD_GROUP_SIZE - 1 ) / THREAD_GROUP_SIZE;
+	context->DispatchCompute( DispatchComputeAttribs( std::min( numGroups, MAX_DISPATCH_GROUPS ), ( numGroups + MAX_DISPATCH_GROUPS - 1 ) / MAX_DISPATCH_GROUPS, 1 ) );
+
+	mPoseChanged = false;
+	return true;
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -22,12 +22,27 @@
 */
 
 #include "cinder/graphics/Texture.h"
+#include "cinder/graphics/ThreadPool.h"
 #include "cinder/app/RendererGx.h"
+#include "cinder/Log.h"
 
 #include "DiligentCore/Graphics/GraphicsAccessories/interface/GraphicsAccessories.hpp"
 #include "DiligentCore/Graphics/GraphicsTools/interface/GraphicsUtilities.h"
 #include "DiligentCore/Common/interface/Align.hpp"
 
+#include <cmath>
+#include <exception>
+
+#if defined( CINDER_GX_SSE2 )
+	#include <emmintrin.h>
+#endif
+#if defined( CINDER_GX_ZSTD )
+	#include <zstd.h>
+#endif
+#if defined( CINDER_GX_BASISU )
+	#include "transcoder/basisu_transcoder.h"
+#endif
+
 using namespace std;
 using namespace ci::app;
 
@@ -35,11 +50,7 @@ namespace cinder {
 namespace graphics {
 
 TextureDesc::TextureDesc() 
-	: Diligent::TextureDesc(),
-	mSrgb( true ),
-	mGenerateMips( true ),
-	mDefaultUsage( true ),
-	mDefaultMips( true )
+	: Diligent::TextureDesc()
 {
 }
 
@@ -47,7 +58,8 @@ TextureDesc::TextureDesc( const TextureDesc &other )
 	: Diligent::TextureDesc( other ),
 	mName( other.mName ), mSrgb( other.mSrgb ),
 	mGenerateMips( other.mGenerateMips ), mDefaultUsage( other.mDefaultUsage ),
-	mDefaultMips( other.mDefaultMips )
+	mDefaultMips( other.mDefaultMips ), mGenerateMipsContext( other.mGenerateMipsContext ),
+	mMipFilter( other.mMipFilter )
 {
 	updatePtrs();
 }
@@ -85,6 +97,8 @@ void TextureDesc::swap( TextureDesc &other ) noexcept
 	std::swap( mGenerateMips, other.mGenerateMips );
 	std::swap( mDefaultUsage, other.mDefaultUsage );
 	std::swap( mDefaultMips, other.mDefaultMips );
+	std::swap( mGenerateMipsContext, other.mGenerateMipsContext );
+	std::swap( mMipFilter, other.mMipFilter );
 	std::swap( Type, other.Type );
 	std::swap( Width, other.Width );
 	std::swap( Height, other.Height );
@@ -131,6 +145,413 @@ namespace {
 			}
 	}
 
+	//! Runs \a task for each index in [0, count) on the default ThreadPool and waits for all of them. Returns false if any task did.
+	template<typename Fn>
+	bool parallelFor( size_t count, const Fn &task )
+	{
+		// waiting on the pool from one of its workers could deadlock, run inline instead
+		if( count < 2 || ThreadPool::getDefault().isWorkerThread() ) {
+			bool success = true;
+			for( size_t i = 0; i < count; ++i ) {
+				success = task( i ) && success;
+			}
+			return success;
+		}
+
+		std::vector<std::future<bool>> futures;
+		futures.reserve( count );
+		std::exception_ptr exception;
+		try {
+			for( size_t i = 0; i < count; ++i ) {
+				futures.push_back( ThreadPool::getDefault().submit( [&task, i]() { return task( i ); } ) );
+			}
+		}
+		catch( ... ) {
+			exception = std::current_exception();
+		}
+
+		// the tasks reference \a task and the caller's state, every one of them has to finish before an exception unwinds
+		bool success = true;
+		for( auto &future : futures ) {
+			try {
+				success = future.get() && success;
+			}
+			catch( ... ) {
+				if( ! exception ) {
+					exception = std::current_exception();
+				}
+			}
+		}
+		if( exception ) {
+			std::rethrow_exception( exception );
+		}
+		return success;
+	}
+
+	//! Source and destination of one mip level computation
+	struct MipLevelView {
+		const uint8_t*	src;
+		uint32_t		srcStride, srcWidth, srcHeight;
+		uint8_t*		dst;
+		uint32_t		dstStride, dstWidth, dstHeight;
+	};
+
+	//! 8-bit sRGB to 16-bit linear and 16-bit linear to 8-bit sRGB tables, so sRGB texels are averaged in linear space
+	struct SrgbTables {
+		uint16_t	toLinear[256];
+		uint8_t		toSrgb[65536];
+
+		static const SrgbTables& get()
+		{
+			static const SrgbTables sTables;
+			return sTables;
+		}
+
+	private:
+		SrgbTables()
+		{
+			for( uint32_t i = 0; i < 256; ++i ) {
+				const double srgb = i / 255.0;
+				const double linear = srgb <= 0.04045 ? srgb / 12.92 : std::pow( ( srgb + 0.055 ) / 1.055, 2.4 );
+				toLinear[i] = static_cast<uint16_t>( linear * 65535.0 + 0.5 );
+			}
+			for( uint32_t i = 0; i < 65536; ++i ) {
+				const double linear = i / 65535.0;
+				const double srgb = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow( linear, 1.0 / 2.4 ) - 0.055;
+				toSrgb[i] = static_cast<uint8_t>( srgb * 255.0 + 0.5 );
+			}
+		}
+	};
+
+	template<typename T>
+	T average4( T a, T b, T c, T d )
+	{
+		if constexpr( std::is_floating_point<T>::value ) {
+			return ( a + b + c + d ) * T( 0.25 );
+		}
+		else {
+			return static_cast<T>( ( uint32_t( a ) + uint32_t( b ) + uint32_t( c ) + uint32_t( d ) + 2 ) >> 2 );
+		}
+	}
+
+	//! Box filters the texels [xBegin, view.dstWidth) of the row pair \a row0 and \a row1. Odd source sizes clamp the last column and row.
+	template<typename T>
+	void boxFilterRowTail( const MipLevelView &view, const T* row0, const T* row1, T* dst, uint32_t numComponents, uint32_t xBegin )
+	{
+		for( uint32_t x = xBegin; x < view.dstWidth; ++x ) {
+			const uint32_t x0 = std::min( 2 * x, view.srcWidth - 1 ) * numComponents;
+			const uint32_t x1 = std::min( 2 * x + 1, view.srcWidth - 1 ) * numComponents;
+			for( uint32_t c = 0; c < numComponents; ++c ) {
+				dst[x * numComponents + c] = average4( row0[x0 + c], row0[x1 + c], row1[x0 + c], row1[x1 + c] );
+			}
+		}
+	}
+
+	template<typename T>
+	void getSourceRows( const MipLevelView &view, uint32_t y, const T** row0, const T** row1, T** dst )
+	{
+		*row0 = reinterpret_cast<const T*>( view.src + size_t{ std::min( 2 * y, view.srcHeight - 1 ) } * view.srcStride );
+		*row1 = reinterpret_cast<const T*>( view.src + size_t{ std::min( 2 * y + 1, view.srcHeight - 1 ) } * view.srcStride );
+		*dst = reinterpret_cast<T*>( view.dst + size_t{ y } * view.dstStride );
+	}
+
+#if defined( CINDER_GX_SSE2 )
+	//! Sums the horizontally adjacent texels of \a v, eight 16-bit components of \a C channel texels, into its low 64 bits
+	template<uint32_t C>
+	__m128i sumTexelPairs( __m128i v )
+	{
+		if constexpr( C == 4 ) {
+			return _mm_add_epi16( v, _mm_srli_si128( v, 8 ) );
+		}
+		else if constexpr( C == 2 ) {
+			return _mm_shuffle_epi32( _mm_add_epi16( v, _mm_srli_epi64( v, 32 ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+		}
+		else {
+			const __m128i sum = _mm_add_epi16( v, _mm_srli_epi32( v, 16 ) );
+			return _mm_shuffle_epi32( _mm_shufflehi_epi16( _mm_shufflelo_epi16( sum, _MM_SHUFFLE( 3, 1, 2, 0 ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+		}
+	}
+#endif
+
+	//! 2x2 box filter of 8-bit unorm texels, 16 destination bytes per iteration
+	template<uint32_t C>
+	void boxFilterUnorm8( const MipLevelView &view, uint32_t rowBegin, uint32_t rowEnd )
+	{
+		for( uint32_t y = rowBegin; y < rowEnd; ++y ) {
+			const uint8_t *row0, *row1;
+			uint8_t* dst;
+			getSourceRows( view, y, &row0, &row1, &dst );
+			uint32_t x = 0;
+#if defined( CINDER_GX_SSE2 )
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i two = _mm_set1_epi16( 2 );
+			for( ; ( x + 16 / C ) * 2 <= view.srcWidth; x += 16 / C ) {
+				const __m128i a0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row0 + x * 2 * C ) );
+				const __m128i a1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row0 + x * 2 * C + 16 ) );
+				const __m128i b0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row1 + x * 2 * C ) );
+				const __m128i b1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row1 + x * 2 * C + 16 ) );
+				const __m128i s0 = _mm_add_epi16( _mm_unpacklo_epi8( a0, zero ), _mm_unpacklo_epi8( b0, zero ) );
+				const __m128i s1 = _mm_add_epi16( _mm_unpackhi_epi8( a0, zero ), _mm_unpackhi_epi8( b0, zero ) );
+				const __m128i s2 = _mm_add_epi16( _mm_unpacklo_epi8( a1, zero ), _mm_unpacklo_epi8( b1, zero ) );
+				const __m128i s3 = _mm_add_epi16( _mm_unpackhi_epi8( a1, zero ), _mm_unpackhi_epi8( b1, zero ) );
+				const __m128i h0 = _mm_srli_epi16( _mm_add_epi16( _mm_unpacklo_epi64( sumTexelPairs<C>( s0 ), sumTexelPairs<C>( s1 ) ), two ), 2 );
+				const __m128i h1 = _mm_srli_epi16( _mm_add_epi16( _mm_unpacklo_epi64( sumTexelPairs<C>( s2 ), sumTexelPairs<C>( s3 ) ), two ), 2 );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * C ), _mm_packus_epi16( h0, h1 ) );
+			}
+#endif
+			boxFilterRowTail( view, row0, row1, dst, C, x );
+		}
+	}
+
+	//! 2x2 box filter of 32-bit float texels, 4 destination floats per iteration
+	template<uint32_t C>
+	void boxFilterFloat32( const MipLevelView &view, uint32_t rowBegin, uint32_t rowEnd )
+	{
+		for( uint32_t y = rowBegin; y < rowEnd; ++y ) {
+			const float *row0, *row1;
+			float* dst;
+			getSourceRows( view, y, &row0, &row1, &dst );
+			uint32_t x = 0;
+#if defined( CINDER_GX_SSE2 )
+			const __m128 quarter = _mm_set1_ps( 0.25f );
+			for( ; ( x + 4 / C ) * 2 <= view.srcWidth; x += 4 / C ) {
+				const __m128 a = _mm_add_ps( _mm_loadu_ps( row0 + x * 2 * C ), _mm_loadu_ps( row1 + x * 2 * C ) );
+				const __m128 b = _mm_add_ps( _mm_loadu_ps( row0 + x * 2 * C + 4 ), _mm_loadu_ps( row1 + x * 2 * C + 4 ) );
+				__m128 sum;
+				if constexpr( C == 4 ) {
+					sum = _mm_add_ps( a, b );
+				}
+				else if constexpr( C == 2 ) {
+					sum = _mm_add_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 0, 1, 0 ) ), _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 2, 3, 2 ) ) );
+				}
+				else {
+					sum = _mm_add_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ), _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+				}
+				_mm_storeu_ps( dst + x * C, _mm_mul_ps( sum, quarter ) );
+			}
+#endif
+			boxFilterRowTail( view, row0, row1, dst, C, x );
+		}
+	}
+
+	template<uint32_t C>
+	void boxFilterUnorm16( const MipLevelView &view, uint32_t rowBegin, uint32_t rowEnd )
+	{
+		for( uint32_t y = rowBegin; y < rowEnd; ++y ) {
+			const uint16_t *row0, *row1;
+			uint16_t* dst;
+			getSourceRows( view, y, &row0, &row1, &dst );
+			boxFilterRowTail( view, row0, row1, dst, C, 0 );
+		}
+	}
+
+	//! 2x2 box filter of 8-bit sRGB texels averaged in linear space, alpha is averaged as is
+	void boxFilterSrgb8( const MipLevelView &view, uint32_t rowBegin, uint32_t rowEnd )
+	{
+		const SrgbTables &tables = SrgbTables::get();
+		for( uint32_t y = rowBegin; y < rowEnd; ++y ) {
+			const uint8_t *row0, *row1;
+			uint8_t* dst;
+			getSourceRows( view, y, &row0, &row1, &dst );
+			for( uint32_t x = 0; x < view.dstWidth; ++x ) {
+				const uint32_t x0 = std::min( 2 * x, view.srcWidth - 1 ) * 4;
+				const uint32_t x1 = std::min( 2 * x + 1, view.srcWidth - 1 ) * 4;
+				for( uint32_t c = 0; c < 3; ++c ) {
+					const uint32_t sum = tables.toLinear[row0[x0 + c]] + tables.toLinear[row0[x1 + c]] + tables.toLinear[row1[x0 + c]] + tables.toLinear[row1[x1 + c]];
+					dst[x * 4 + c] = tables.toSrgb[( sum + 2 ) >> 2];
+				}
+				dst[x * 4 + 3] = average4( row0[x0 + 3], row0[x1 + 3], row1[x0 + 3], row1[x1 + 3] );
+			}
+		}
+	}
+
+	//! Texel encodings supported by the parallel mip generation
+	enum class MipTexelType { UNORM8, SRGB8, UNORM16, FLOAT32 };
+
+	bool getMipTexelType( TEXTURE_FORMAT format, MipTexelType* type, uint32_t* numComponents )
+	{
+		switch( format ) {
+			case TEX_FORMAT_R8_UNORM:			*type = MipTexelType::UNORM8; *numComponents = 1; return true;
+			case TEX_FORMAT_RG8_UNORM:			*type = MipTexelType::UNORM8; *numComponents = 2; return true;
+			case TEX_FORMAT_RGBA8_UNORM:		*type = MipTexelType::UNORM8; *numComponents = 4; return true;
+			case TEX_FORMAT_RGBA8_UNORM_SRGB:	*type = MipTexelType::SRGB8; *numComponents = 4; return true;
+			case TEX_FORMAT_R16_UNORM:			*type = MipTexelType::UNORM16; *numComponents = 1; return true;
+			case TEX_FORMAT_RG16_UNORM:			*type = MipTexelType::UNORM16; *numComponents = 2; return true;
+			case TEX_FORMAT_RGBA16_UNORM:		*type = MipTexelType::UNORM16; *numComponents = 4; return true;
+			case TEX_FORMAT_R32_FLOAT:			*type = MipTexelType::FLOAT32; *numComponents = 1; return true;
+			case TEX_FORMAT_RG32_FLOAT:			*type = MipTexelType::FLOAT32; *numComponents = 2; return true;
+			case TEX_FORMAT_RGBA32_FLOAT:		*type = MipTexelType::FLOAT32; *numComponents = 4; return true;
+			default: return false;
+		}
+	}
+
+	//! Returns the weight of the windowed sinc \a filter at \a x, in destination texels
+	float evalMipFilter( TextureDesc::MipFilter filter, float x )
+	{
+		const float width = 3.0f;
+		x = std::abs( x );
+		if( x >= width ) {
+			return 0.0f;
+		}
+		const float pi = 3.14159265358979f;
+		const float sinc = x < 1e-5f ? 1.0f : std::sin( pi * x ) / ( pi * x );
+		if( filter == TextureDesc::MipFilter::LANCZOS ) {
+			const float xw = x / width;
+			return sinc * ( xw < 1e-5f ? 1.0f : std::sin( pi * xw ) / ( pi * xw ) );
+		}
+		// Kaiser window with alpha = 4, the modified Bessel function converges in a few terms
+		const auto besselI0 = []( float v ) {
+			float sum = 1.0f, term = 1.0f;
+			for( int k = 1; k < 16; ++k ) {
+				term *= ( v * 0.5f / k ) * ( v * 0.5f / k );
+				sum += term;
+			}
+			return sum;
+		};
+		const float alpha = 4.0f;
+		const float t = x / width;
+		return sinc * besselI0( alpha * std::sqrt( 1.0f - t * t ) ) / besselI0( alpha );
+	}
+
+	//! Normalized filter taps of one axis, numTaps source indices and weights per destination texel
+	struct MipFilterTaps {
+		MipFilterTaps( TextureDesc::MipFilter filter, uint32_t srcSize, uint32_t dstSize )
+		{
+			const float scale = static_cast<float>( srcSize ) / static_cast<float>( dstSize );
+			const float radius = 3.0f * scale;
+			numTaps = static_cast<uint32_t>( std::ceil( radius * 2.0f ) ) + 1;
+			indices.resize( size_t{ dstSize } * numTaps );
+			weights.resize( size_t{ dstSize } * numTaps );
+			for( uint32_t i = 0; i < dstSize; ++i ) {
+				const float center = ( i + 0.5f ) * scale;
+				const int32_t start = static_cast<int32_t>( std::floor( center - radius ) );
+				float total = 0.0f;
+				for( uint32_t t = 0; t < numTaps; ++t ) {
+					const int32_t j = start + static_cast<int32_t>( t );
+					const float weight = evalMipFilter( filter, ( j + 0.5f - center ) / scale );
+					indices[i * numTaps + t] = static_cast<uint32_t>( glm::clamp( j, 0, static_cast<int32_t>( srcSize ) - 1 ) );
+					weights[i * numTaps + t] = weight;
+					total += weight;
+				}
+				for( uint32_t t = 0; t < numTaps; ++t ) {
+					weights[i * numTaps + t] /= total;
+				}
+			}
+		}
+
+		uint32_t				numTaps;
+		std::vector<uint32_t>	indices;
+		std::vector<float>		weights;
+	};
+
+	float decodeMipTexel( const uint8_t* row, uint32_t index, uint32_t component, MipTexelType type )
+	{
+		switch( type ) {
+			case MipTexelType::UNORM8:	return row[index] / 255.0f;
+			case MipTexelType::SRGB8:	return component < 3 ? SrgbTables::get().toLinear[row[index]] / 65535.0f : row[index] / 255.0f;
+			case MipTexelType::UNORM16:	return reinterpret_cast<const uint16_t*>( row )[index] / 65535.0f;
+			default:					return reinterpret_cast<const float*>( row )[index];
+		}
+	}
+
+	void encodeMipTexel( uint8_t* row, uint32_t index, uint32_t component, MipTexelType type, float value )
+	{
+		switch( type ) {
+			case MipTexelType::UNORM8:	row[index] = static_cast<uint8_t>( glm::clamp( value, 0.0f, 1.0f ) * 255.0f + 0.5f ); break;
+			case MipTexelType::SRGB8:
+				row[index] = component < 3 ? SrgbTables::get().toSrgb[static_cast<uint16_t>( glm::clamp( value, 0.0f, 1.0f ) * 65535.0f + 0.5f )] : static_cast<uint8_t>( glm::clamp( value, 0.0f, 1.0f ) * 255.0f + 0.5f );
+				break;
+			case MipTexelType::UNORM16:	reinterpret_cast<uint16_t*>( row )[index] = static_cast<uint16_t>( glm::clamp( value, 0.0f, 1.0f ) * 65535.0f + 0.5f ); break;
+			default:					reinterpret_cast<float*>( row )[index] = value; break;
+		}
+	}
+
+	//! Runs \a kernel over the destination rows of \a view in parallel chunks
+	template<typename Fn>
+	void parallelRows( uint32_t numRows, uint32_t rowSize, const Fn &kernel )
+	{
+		// small levels aren't worth the scheduling, aim for at least 16k texels per task
+		const size_t maxTasks = std::max<size_t>( ThreadPool::getDefault().getNumThreads() * 4, 1 );
+		const size_t numTasks = std::min<size_t>( std::min<size_t>( numRows, maxTasks ), std::max<size_t>( size_t{ numRows } * rowSize / 16384, 1 ) );
+		const uint32_t rowsPerTask = static_cast<uint32_t>( ( numRows + numTasks - 1 ) / numTasks );
+		parallelFor( numTasks, [&]( size_t task ) {
+			const uint32_t rowBegin = static_cast<uint32_t>( task ) * rowsPerTask;
+			kernel( rowBegin, std::min( rowBegin + rowsPerTask, numRows ) );
+			return true;
+		} );
+	}
+
+	//! Separable windowed sinc downsampling of \a view, filtered in linear space
+	void resampleMipLevel( const MipLevelView &view, TextureDesc::MipFilter filter, MipTexelType type, uint32_t numComponents )
+	{
+		const MipFilterTaps tapsX( filter, view.srcWidth, view.dstWidth );
+		const MipFilterTaps tapsY( filter, view.srcHeight, view.dstHeight );
+
+		// horizontal pass into a float buffer of dstWidth by srcHeight texels
+		const size_t rowFloats = size_t{ view.dstWidth } * numComponents;
+		std::vector<float> horizontal( rowFloats * view.srcHeight );
+		parallelRows( view.srcHeight, view.srcWidth, [&]( uint32_t rowBegin, uint32_t rowEnd ) {
+			for( uint32_t y = rowBegin; y < rowEnd; ++y ) {
+				const uint8_t* src = view.src + size_t{ y } * view.srcStride;
+				float* dst = horizontal.data() + y * rowFloats;
+				for( uint32_t x = 0; x < view.dstWidth; ++x ) {
+					for( uint32_t c = 0; c < numComponents; ++c ) {
+						float sum = 0.0f;
+						for( uint32_t t = 0; t < tapsX.numTaps; ++t ) {
+							sum += tapsX.weights[x * tapsX.numTaps + t] * decodeMipTexel( src, tapsX.indices[x * tapsX.numTaps + t] * numComponents + c, c, type );
+						}
+						dst[x * numComponents + c] = sum;
+					}
+				}
+			}
+		} );
+
+		parallelRows( view.dstHeight, view.dstWidth, [&]( uint32_t rowBegin, uint32_t rowEnd ) {
+			std::vector<float> sum( rowFloats );
+			for( uint32_t y = rowBegin; y < rowEnd; ++y ) {
+				std::fill( sum.begin(), sum.end(), 0.0f );
+				for( uint32_t t = 0; t < tapsY.numTaps; ++t ) {
+					const float weight = tapsY.weights[y * tapsY.numTaps + t];
+					const float* src = horizontal.data() + tapsY.indices[y * tapsY.numTaps + t] * rowFloats;
+					for( size_t i = 0; i < rowFloats; ++i ) {
+						sum[i] += weight * src[i];
+					}
+				}
+				uint8_t* dst = view.dst + size_t{ y } * view.dstStride;
+				for( size_t i = 0; i < rowFloats; ++i ) {
+					encodeMipTexel( dst, static_cast<uint32_t>( i ), static_cast<uint32_t>( i % numComponents ), type, sum[i] );
+				}
+			}
+		} );
+	}
+
+	//! Computes the next mip level of \a view on the default ThreadPool, returns false if \a format isn't supported
+	bool computeMipLevelParallel( const MipLevelView &view, TEXTURE_FORMAT format, TextureDesc::MipFilter filter )
+	{
+		MipTexelType type;
+		uint32_t numComponents;
+		if( ! getMipTexelType( format, &type, &numComponents ) ) {
+			return false;
+		}
+
+		if( filter != TextureDesc::MipFilter::BOX ) {
+			resampleMipLevel( view, filter, type, numComponents );
+			return true;
+		}
+
+		void ( *kernel )( const MipLevelView&, uint32_t, uint32_t ) = nullptr;
+		switch( type ) {
+			case MipTexelType::UNORM8:	kernel = numComponents == 1 ? boxFilterUnorm8<1> : numComponents == 2 ? boxFilterUnorm8<2> : boxFilterUnorm8<4>; break;
+			case MipTexelType::SRGB8:	kernel = boxFilterSrgb8; break;
+			case MipTexelType::UNORM16:	kernel = numComponents == 1 ? boxFilterUnorm16<1> : numComponents == 2 ? boxFilterUnorm16<2> : boxFilterUnorm16<4>; break;
+			case MipTexelType::FLOAT32:	kernel = numComponents == 1 ? boxFilterFloat32<1> : numComponents == 2 ? boxFilterFloat32<2> : boxFilterFloat32<4>; break;
+		}
+		parallelRows( view.dstHeight, view.dstWidth, [&]( uint32_t rowBegin, uint32_t rowEnd ) {
+			kernel( view, rowBegin, rowEnd );
+		} );
+		return true;
+	}
+
 	void createTexture( IRenderDevice* pDevice, const TextureDesc& desc, uint32_t sourceNumComponents, uint32_t channelDepth, const void* data, uint32_t rowStride, ITexture** ppTexture )
 	{
 		TextureDesc textureDesc;
@@ -189,24 +610,49 @@ namespace {
 				throw TextureDataExc( "Incorrect channel size (" + to_string( channelDepth ) + ") for texture format" );
 		}
 
-		std::vector<TextureSubResData>  subResources(textureDesc.MipLevels);
-		std::vector<std::vector<Uint8>> mips(textureDesc.MipLevels);
+		// GPU mip generation renders into the levels, formats that can't be filtered and rendered to keep the CPU path
+		bool generateMipsOnGpu = false;
+		if( desc.needsGenerateMips() && desc.needsGenerateMipsOnGpu() && textureDesc.MipLevels > 1 ) {
+			const TextureFormatInfoExt &formatInfo = pDevice->GetTextureFormatInfoExt( textureDesc.Format );
+			generateMipsOnGpu = formatInfo.Filterable && ( formatInfo.BindFlags & BIND_RENDER_TARGET );
+		}
+		if( generateMipsOnGpu ) {
+			textureDesc.MiscFlags |= MISC_TEXTURE_FLAG_GENERATE_MIPS;
+			textureDesc.BindFlags |= BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
+			textureDesc.Usage      = textureDesc.Usage == USAGE_IMMUTABLE ? USAGE_DEFAULT : textureDesc.Usage;
+		}
+		const uint32_t numCpuMips = generateMipsOnGpu ? 1 : textureDesc.MipLevels;
+
+		// every level lives in one allocation, level 0 is only copied when it needs to be expanded to RGBA
+		std::vector<TextureSubResData> subResources(textureDesc.MipLevels);
+		std::vector<size_t> mipOffsets(textureDesc.MipLevels);
+		size_t storageSize = 0;
+		for( uint32_t mip = sourceNumComponents == 3 ? 0 : 1; mip < numCpuMips; ++mip ) {
+			const uint32_t mipStride = AlignUp( std::max( textureDesc.Width >> mip, 1u ) * numComponents * channelDepth / 8, 4u );
+			mipOffsets[mip] = storageSize;
+			subResources[mip].Stride = mipStride;
+			storageSize += size_t{ mipStride } * size_t{ std::max( textureDesc.Height >> mip, 1u ) };
+		}
+		std::unique_ptr<Uint8[]> storage( new Uint8[std::max<size_t>( storageSize, 1 )] );
+		if( ! desc.needsGenerateMips() ) {
+			std::memset( storage.get(), 0, storageSize );
+		}
+		for( uint32_t mip = sourceNumComponents == 3 ? 0 : 1; mip < numCpuMips; ++mip ) {
+			subResources[mip].pData = storage.get() + mipOffsets[mip];
+		}
 
 		if( sourceNumComponents == 3 ) {
 			VERIFY_EXPR( numComponents == 4 );
-			uint32_t rgbaStride = desc.Width * numComponents * channelDepth / 8;
-			rgbaStride = ( rgbaStride + 3 ) & (-4);
-			mips[0].resize( size_t{ rgbaStride } * size_t{ desc.Height } );
-			subResources[0].pData = mips[0].data();
-			subResources[0].Stride = rgbaStride;
+			Uint8* rgbaData = storage.get() + mipOffsets[0];
+			const uint32_t rgbaStride = static_cast<uint32_t>( subResources[0].Stride );
 			if( channelDepth == 8 ) {
-				RGBToRGBA<Uint8>( data, rowStride, mips[0].data(), rgbaStride, desc.Width, desc.Height);
+				RGBToRGBA<Uint8>( data, rowStride, rgbaData, rgbaStride, desc.Width, desc.Height);
 			}
 			else if (channelDepth == 16) {
-				RGBToRGBA<Uint16>( data, rowStride, mips[0].data(), rgbaStride, desc.Width, desc.Height );
+				RGBToRGBA<Uint16>( data, rowStride, rgbaData, rgbaStride, desc.Width, desc.Height );
 			}
 			else if( channelDepth == 32 ) {
-				RGBToRGBA<float>( data, rowStride, mips[0].data(), rgbaStride, desc.Width, desc.Height );
+				RGBToRGBA<float>( data, rowStride, rgbaData, rgbaStride, desc.Width, desc.Height );
 			}
 		}
 		else {
@@ -214,24 +660,28 @@ namespace {
 			subResources[0].Stride = rowStride;
 		}
 
-		uint32_t mipWidth  = textureDesc.Width;
-		uint32_t mipHeight = textureDesc.Height;
-		for( uint32_t mip = 1; mip < textureDesc.MipLevels; ++mip ) {
-			uint32_t coarseMipWidth  = std::max(mipWidth / 2u, 1u);
-			uint32_t coarseMipHeight = std::max(mipHeight / 2u, 1u);
-			uint32_t coarseMipStride = coarseMipWidth * numComponents * channelDepth / 8;
-			coarseMipStride      = ( coarseMipStride + 3) & (-4);
-			mips[mip].resize(size_t{ coarseMipStride } * size_t{ coarseMipHeight });
-
-			if( desc.needsGenerateMips() ) {
-				ComputeMipLevel( mipWidth, mipHeight, textureDesc.Format, subResources[mip - 1].pData, subResources[mip - 1].Stride, mips[mip].data(), coarseMipStride );
+		if( generateMipsOnGpu ) {
+			// only level 0 is uploaded, the remaining levels are filtered by the context the caller provided
+			pDevice->CreateTexture( textureDesc, nullptr, ppTexture );
+			if( *ppTexture ) {
+				IDeviceContext* context = desc.getGenerateMipsContext();
+				context->UpdateTexture( *ppTexture, 0, 0, Box( 0, textureDesc.Width, 0, textureDesc.Height ), subResources[0], RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION );
+				context->GenerateMips( ( *ppTexture )->GetDefaultView( TEXTURE_VIEW_SHADER_RESOURCE ) );
 			}
+			return;
+		}
 
-			subResources[mip].pData  = mips[mip].data();
-			subResources[mip].Stride = coarseMipStride;
-
-			mipWidth  = coarseMipWidth;
-			mipHeight = coarseMipHeight;
+		if( desc.needsGenerateMips() ) {
+			for( uint32_t mip = 1; mip < textureDesc.MipLevels; ++mip ) {
+				const MipLevelView view = {
+					static_cast<const uint8_t*>( subResources[mip - 1].pData ), static_cast<uint32_t>( subResources[mip - 1].Stride ), std::max( textureDesc.Width >> ( mip - 1 ), 1u ), std::max( textureDesc.Height >> ( mip - 1 ), 1u ),
+					storage.get() + mipOffsets[mip], static_cast<uint32_t>( subResources[mip].Stride ), std::max( textureDesc.Width >> mip, 1u ), std::max( textureDesc.Height >> mip, 1u )
+				};
+				// formats the parallel filters don't cover fall back to Diligent's serial implementation
+				if( ! computeMipLevelParallel( view, textureDesc.Format, desc.getMipFilter() ) ) {
+					ComputeMipLevel( view.srcWidth, view.srcHeight, textureDesc.Format, view.src, view.srcStride, view.dst, view.dstStride );
+				}
+			}
 		}
 
 		TextureData TexData;
@@ -345,6 +795,15 @@ namespace {
 
 using Diligent::TextureSubResData;
 
+bool generateMipLevel( const void* src, uint32_t srcStride, uint32_t srcWidth, uint32_t srcHeight, void* dst, uint32_t dstStride, TEXTURE_FORMAT format, TextureDesc::MipFilter filter )
+{
+	const MipLevelView view = {
+		static_cast<const uint8_t*>( src ), srcStride, srcWidth, srcHeight,
+		static_cast<uint8_t*>( dst ), dstStride, std::max( srcWidth >> 1, 1u ), std::max( srcHeight >> 1, 1u )
+	};
+	return computeMipLevelParallel( view, format, filter );
+}
+
 TextureRef createTexture( const Surface8u &surface, const TextureDesc &desc )
 {
 	return createTexture( app::getRenderDevice(), surface, desc );
@@ -591,6 +1050,290 @@ namespace {
 	}
 } // namespace
 
+namespace {
+	#define KTX2_SUPERCOMPRESSION_NONE   0
+	#define KTX2_SUPERCOMPRESSION_BASIS  1
+	#define KTX2_SUPERCOMPRESSION_ZSTD   2
+	#define KTX2_DF_MODEL_ETC1S          163
+	#define KTX2_DF_MODEL_UASTC          166
+	#define KTX2_DF_TRANSFER_SRGB        2
+
+	const uint8_t Ktx2FileIdentifier[12] = {
+		0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+	};
+
+	struct Ktx2Header {
+		uint8_t		identifier[12];
+		uint32_t	vkFormat;
+		uint32_t	typeSize;
+		uint32_t	pixelWidth;
+		uint32_t	pixelHeight;
+		uint32_t	pixelDepth;
+		uint32_t	layerCount;
+		uint32_t	faceCount;
+		uint32_t	levelCount;
+		uint32_t	supercompressionScheme;
+		uint32_t	dfdByteOffset;
+		uint32_t	dfdByteLength;
+		uint32_t	kvdByteOffset;
+		uint32_t	kvdByteLength;
+		uint64_t	sgdByteOffset;
+		uint64_t	sgdByteLength;
+	};
+
+	struct Ktx2LevelIndex {
+		uint64_t	byteOffset;
+		uint64_t	byteLength;
+		uint64_t	uncompressedByteLength;
+	};
+
+	TEXTURE_FORMAT findDiligentTextureFormatFromVk( uint32_t vkFormat )
+	{
+		switch( vkFormat ) {
+			// clang-format off
+			case 9:   return TEX_FORMAT_R8_UNORM;
+			case 10:  return TEX_FORMAT_R8_SNORM;
+			case 13:  return TEX_FORMAT_R8_UINT;
+			case 14:  return TEX_FORMAT_R8_SINT;
+			case 16:  return TEX_FORMAT_RG8_UNORM;
+			case 17:  return TEX_FORMAT_RG8_SNORM;
+			case 20:  return TEX_FORMAT_RG8_UINT;
+			case 21:  return TEX_FORMAT_RG8_SINT;
+			case 37:  return TEX_FORMAT_RGBA8_UNORM;
+			case 38:  return TEX_FORMAT_RGBA8_SNORM;
+			case 41:  return TEX_FORMAT_RGBA8_UINT;
+			case 42:  return TEX_FORMAT_RGBA8_SINT;
+			case 43:  return TEX_FORMAT_RGBA8_UNORM_SRGB;
+			case 44:  return TEX_FORMAT_BGRA8_UNORM;
+			case 50:  return TEX_FORMAT_BGRA8_UNORM_SRGB;
+			case 64:  return TEX_FORMAT_RGB10A2_UNORM;
+			case 68:  return TEX_FORMAT_RGB10A2_UINT;
+			case 70:  return TEX_FORMAT_R16_UNORM;
+			case 71:  return TEX_FORMAT_R16_SNORM;
+			case 74:  return TEX_FORMAT_R16_UINT;
+			case 75:  return TEX_FORMAT_R16_SINT;
+			case 76:  return TEX_FORMAT_R16_FLOAT;
+			case 77:  return TEX_FORMAT_RG16_UNORM;
+			case 78:  return TEX_FORMAT_RG16_SNORM;
+			case 81:  return TEX_FORMAT_RG16_UINT;
+			case 82:  return TEX_FORMAT_RG16_SINT;
+			case 83:  return TEX_FORMAT_RG16_FLOAT;
+			case 91:  return TEX_FORMAT_RGBA16_UNORM;
+			case 92:  return TEX_FORMAT_RGBA16_SNORM;
+			case 95:  return TEX_FORMAT_RGBA16_UINT;
+			case 96:  return TEX_FORMAT_RGBA16_SINT;
+			case 97:  return TEX_FORMAT_RGBA16_FLOAT;
+			case 98:  return TEX_FORMAT_R32_UINT;
+			case 99:  return TEX_FORMAT_R32_SINT;
+			case 100: return TEX_FORMAT_R32_FLOAT;
+			case 101: return TEX_FORMAT_RG32_UINT;
+			case 102: return TEX_FORMAT_RG32_SINT;
+			case 103: return TEX_FORMAT_RG32_FLOAT;
+			case 104: return TEX_FORMAT_RGB32_UINT;
+			case 105: return TEX_FORMAT_RGB32_SINT;
+			case 106: return TEX_FORMAT_RGB32_FLOAT;
+			case 107: return TEX_FORMAT_RGBA32_UINT;
+			case 108: return TEX_FORMAT_RGBA32_SINT;
+			case 109: return TEX_FORMAT_RGBA32_FLOAT;
+			case 122: return TEX_FORMAT_R11G11B10_FLOAT;
+			case 123: return TEX_FORMAT_RGB9E5_SHAREDEXP;
+			case 124: return TEX_FORMAT_D16_UNORM;
+			case 126: return TEX_FORMAT_D32_FLOAT;
+			case 129: return TEX_FORMAT_D24_UNORM_S8_UINT;
+			case 131:
+			case 133: return TEX_FORMAT_BC1_UNORM;
+			case 132:
+			case 134: return TEX_FORMAT_BC1_UNORM_SRGB;
+			case 135: return TEX_FORMAT_BC2_UNORM;
+			case 136: return TEX_FORMAT_BC2_UNORM_SRGB;
+			case 137: return TEX_FORMAT_BC3_UNORM;
+			case 138: return TEX_FORMAT_BC3_UNORM_SRGB;
+			case 139: return TEX_FORMAT_BC4_UNORM;
+			case 140: return TEX_FORMAT_BC4_SNORM;
+			case 141: return TEX_FORMAT_BC5_UNORM;
+			case 142: return TEX_FORMAT_BC5_SNORM;
+			case 143: return TEX_FORMAT_BC6H_UF16;
+			case 144: return TEX_FORMAT_BC6H_SF16;
+			case 145: return TEX_FORMAT_BC7_UNORM;
+			case 146: return TEX_FORMAT_BC7_UNORM_SRGB;
+			// clang-format on
+			default: return TEX_FORMAT_UNKNOWN;
+		}
+	}
+
+#if defined( CINDER_GX_BASISU )
+	//! Transcodes an ETC1S or UASTC KTX2 file to BC1 or BC7, or to RGBA8 without \a supportsBC, into \a source's storage
+	void transcodeBasisKtx2( const uint8_t* data, size_t dataSize, bool supportsBC, TextureSourceData* source )
+	{
+		static std::once_flag sTranscoderInitFlag;
+		std::call_once( sTranscoderInitFlag, []() { basist::basisu_transcoder_init(); } );
+
+		basist::ktx2_transcoder transcoder;
+		if( ! transcoder.init( data, static_cast<uint32_t>( dataSize ) ) || ! transcoder.start_transcoding() )
+			throw TextureDataExc( "Failed to initialize the Basis Universal transcoder" );
+
+		TextureDesc &textureDesc = source->desc;
+		const bool srgb = transcoder.get_dfd_transfer_func() == KTX2_DF_TRANSFER_SRGB;
+		basist::transcoder_texture_format targetFormat;
+		uint32_t bytesPerBlock = 16;
+		if( ! supportsBC ) {
+			CI_LOG_W( "BC texture compression not supported, transcoding to uncompressed RGBA8" );
+			targetFormat = basist::transcoder_texture_format::cTFRGBA32;
+			textureDesc.Format = srgb ? TEX_FORMAT_RGBA8_UNORM_SRGB : TEX_FORMAT_RGBA8_UNORM;
+			bytesPerBlock = 4;
+		}
+		else if( transcoder.is_etc1s() && ! transcoder.get_has_alpha() ) {
+			// ETC1S doesn't carry enough detail to benefit from BC7, BC1 halves the memory
+			targetFormat = basist::transcoder_texture_format::cTFBC1_RGB;
+			textureDesc.Format = srgb ? TEX_FORMAT_BC1_UNORM_SRGB : TEX_FORMAT_BC1_UNORM;
+			bytesPerBlock = 8;
+		}
+		else {
+			targetFormat = basist::transcoder_texture_format::cTFBC7_RGBA;
+			textureDesc.Format = srgb ? TEX_FORMAT_BC7_UNORM_SRGB : TEX_FORMAT_BC7_UNORM;
+		}
+
+		// one task per mip, layer and face, each with its own transcoder state
+		const uint32_t numFaces = transcoder.get_faces();
+		const uint32_t numLayers = std::max( transcoder.get_layers(), 1u );
+		const uint32_t numImages = textureDesc.MipLevels * numLayers * numFaces;
+		std::vector<std::vector<uint8_t>> &images = source->storage;
+		images.resize( numImages );
+		source->subresources.resize( numImages );
+		const bool success = parallelFor( numImages, [&]( size_t index ) {
+			const uint32_t mip = static_cast<uint32_t>( index % textureDesc.MipLevels );
+			const uint32_t slice = static_cast<uint32_t>( index / textureDesc.MipLevels );
+			const MipLevelProperties mipInfo = GetMipLevelProperties( textureDesc, mip );
+			images[index].resize( static_cast<size_t>( mipInfo.MipSize ) );
+			source->subresources[index] = TextureSubResData{ images[index].data(), mipInfo.RowSize, mipInfo.DepthSliceSize };
+
+			basist::ktx2_transcoder_state state;
+			return transcoder.transcode_image_level( mip, slice / numFaces, slice % numFaces, images[index].data(), static_cast<uint32_t>( mipInfo.MipSize / bytesPerBlock ), targetFormat, 0, 0, 0, -1, -1, &state );
+		} );
+		if( ! success )
+			throw TextureDataExc( "Failed to transcode Basis Universal texture" );
+	}
+#endif
+} // namespace
+
+TextureSourceData parseKtx2( const void* dataPtr, size_t dataSize, const TextureDesc &desc, bool supportsBC )
+{
+	const uint8_t* data = static_cast<const uint8_t*>( dataPtr );
+	if( dataSize < sizeof( Ktx2Header ) )
+		throw TextureDataExc( "Truncated KTX2 header" );
+	if( memcmp( data, Ktx2FileIdentifier, sizeof( Ktx2FileIdentifier ) ) )
+		throw TextureDataExc( "File identifier mismatch" );
+	const Ktx2Header &header = *reinterpret_cast<const Ktx2Header*>( data );
+	const uint32_t numLevels = std::max( header.levelCount, 1u );
+	if( sizeof( Ktx2Header ) + numLevels * sizeof( Ktx2LevelIndex ) > dataSize )
+		throw TextureDataExc( "Truncated KTX2 level index" );
+	if( header.faceCount != 1 && header.faceCount != 6 )
+		throw TextureDataExc( "Unsupported number of faces" );
+	if( header.pixelWidth == 0 || numLevels > ComputeMipLevelsCount( header.pixelWidth, header.pixelHeight, header.pixelDepth ) )
+		throw TextureDataExc( "Invalid KTX2 header" );
+	const Ktx2LevelIndex* levels = reinterpret_cast<const Ktx2LevelIndex*>( data + sizeof( Ktx2Header ) );
+	for( uint32_t level = 0; level < numLevels; ++level ) {
+		if( levels[level].byteLength > dataSize || levels[level].byteOffset > dataSize - levels[level].byteLength )
+			throw TextureDataExc( "Truncated KTX2 level data" );
+	}
+
+	TextureSourceData source;
+	TextureDesc &textureDesc = source.desc;
+	textureDesc = getDefaultTextureDesc( desc, header.pixelWidth, std::max( header.pixelHeight, 1u ) );
+	textureDesc.MipLevels = numLevels;
+	textureDesc.Depth     = 1;
+	const uint32_t numLayers = std::max( header.layerCount, 1u );
+	if( header.faceCount == 6 ) {
+		textureDesc.ArraySize = numLayers * 6;
+		textureDesc.Type      = header.layerCount > 0 ? RESOURCE_DIM_TEX_CUBE_ARRAY : RESOURCE_DIM_TEX_CUBE;
+	}
+	else if( header.pixelDepth > 1 ) {
+		textureDesc.Depth     = header.pixelDepth;
+		textureDesc.ArraySize = 1;
+		textureDesc.Type      = RESOURCE_DIM_TEX_3D;
+	}
+	else if( header.pixelHeight == 0 ) {
+		textureDesc.ArraySize = numLayers;
+		textureDesc.Type      = header.layerCount > 0 ? RESOURCE_DIM_TEX_1D_ARRAY : RESOURCE_DIM_TEX_1D;
+	}
+	else {
+		textureDesc.ArraySize = numLayers;
+		textureDesc.Type      = header.layerCount > 0 ? RESOURCE_DIM_TEX_2D_ARRAY : RESOURCE_DIM_TEX_2D;
+	}
+
+	// Basis Universal payloads are identified by the data format descriptor color model
+	uint8_t colorModel = 0;
+	if( header.dfdByteLength >= 16 && uint64_t{ header.dfdByteOffset } + header.dfdByteLength <= dataSize ) {
+		colorModel = data[header.dfdByteOffset + 12];
+	}
+	if( header.supercompressionScheme == KTX2_SUPERCOMPRESSION_BASIS || colorModel == KTX2_DF_MODEL_ETC1S || colorModel == KTX2_DF_MODEL_UASTC ) {
+#if defined( CINDER_GX_BASISU )
+		if( textureDesc.Type == RESOURCE_DIM_TEX_3D || textureDesc.Type == RESOURCE_DIM_TEX_1D || textureDesc.Type == RESOURCE_DIM_TEX_1D_ARRAY )
+			throw TextureDataExc( "Basis Universal only supports 2D, array and cube textures" );
+		transcodeBasisKtx2( data, dataSize, supportsBC, &source );
+		return source;
+#else
+		throw TextureDataExc( "Basis Universal KTX2 files require building with CINDER_GX_WITH_BASISU" );
+#endif
+	}
+
+	textureDesc.Format = findDiligentTextureFormatFromVk( header.vkFormat );
+	if( textureDesc.Format == TEX_FORMAT_UNKNOWN )
+		throw TextureDataExc( "Unsupported KTX2 vkFormat " + to_string( header.vkFormat ) );
+
+	// each level stores its layers and faces tightly packed, 3D levels store all their depth slices in one image
+	const uint32_t numSlices = textureDesc.Type != RESOURCE_DIM_TEX_3D ? textureDesc.ArraySize : 1;
+	std::vector<uint64_t> levelSizes( numLevels );
+	for( uint32_t level = 0; level < numLevels; ++level ) {
+		levelSizes[level] = GetMipLevelProperties( textureDesc, level ).MipSize * numSlices;
+	}
+
+	// uncompressed levels are uploaded straight from the file, zstd levels are inflated in parallel into the source storage first
+	std::vector<const uint8_t*> levelData( numLevels );
+	if( header.supercompressionScheme == KTX2_SUPERCOMPRESSION_NONE ) {
+		for( uint32_t level = 0; level < numLevels; ++level ) {
+			if( levelSizes[level] > levels[level].byteLength )
+				throw TextureDataExc( "Truncated KTX2 level data" );
+			levelData[level] = data + levels[level].byteOffset;
+		}
+	}
+	else if( header.supercompressionScheme == KTX2_SUPERCOMPRESSION_ZSTD ) {
+#if defined( CINDER_GX_ZSTD )
+		// the uncompressed sizes come from the file, anything but the size implied by the header is rejected before allocating
+		for( uint32_t level = 0; level < numLevels; ++level ) {
+			if( levels[level].uncompressedByteLength != levelSizes[level] )
+				throw TextureDataExc( "Invalid KTX2 uncompressed level size" );
+		}
+		std::vector<std::vector<uint8_t>> &inflatedLevels = source.storage;
+		inflatedLevels.resize( numLevels );
+		const bool success = parallelFor( numLevels, [&]( size_t level ) {
+			inflatedLevels[level].resize( static_cast<size_t>( levels[level].uncompressedByteLength ) );
+			const size_t size = ZSTD_decompress( inflatedLevels[level].data(), inflatedLevels[level].size(), data + levels[level].byteOffset, static_cast<size_t>( levels[level].byteLength ) );
+			return ! ZSTD_isError( size ) && size == inflatedLevels[level].size();
+		} );
+		if( ! success )
+			throw TextureDataExc( "Failed to decompress zstd KTX2 levels" );
+		for( uint32_t level = 0; level < numLevels; ++level ) {
+			levelData[level] = inflatedLevels[level].data();
+		}
+#else
+		throw TextureDataExc( "zstd supercompressed KTX2 files require building with CINDER_GX_WITH_ZSTD" );
+#endif
+	}
+	else {
+		throw TextureDataExc( "Unsupported KTX2 supercompression scheme " + to_string( header.supercompressionScheme ) );
+	}
+
+	source.subresources.resize( textureDesc.MipLevels * numSlices );
+	for( uint32_t mip = 0; mip < textureDesc.MipLevels; ++mip ) {
+		const MipLevelProperties mipInfo = GetMipLevelProperties( textureDesc, mip );
+		for( uint32_t slice = 0; slice < numSlices; ++slice ) {
+			source.subresources[mip + slice * textureDesc.MipLevels] = TextureSubResData{ levelData[mip] + slice * mipInfo.MipSize, mipInfo.RowSize, mipInfo.DepthSliceSize };
+		}
+	}
+
+	return source;
+}
 
 TextureRef createTextureFromKtx( RenderDevice* device, const DataSourceRef &dataSource, const TextureDesc &desc )
 {
@@ -619,6 +1362,17 @@ TextureRef createTextureFromKtx( RenderDevice* device, const DataSourceRef &data
 	size_t dataSize = dataBuffer->getSize();
 	const uint8_t* data = reinterpret_cast<const uint8_t*>( dataBuffer->getData() );
 	
+	if( dataSize >= sizeof(Ktx2FileIdentifier) && ! memcmp( data, Ktx2FileIdentifier, sizeof(Ktx2FileIdentifier) ) ) {
+		// uncompressed subresources point into the DataSource buffer, which stays alive until CreateTexture returns
+		const bool supportsBC = device->GetDeviceInfo().Features.TextureCompressionBC != DEVICE_FEATURE_STATE_DISABLED;
+		const TextureSourceData source = parseKtx2( data, dataSize, desc, supportsBC );
+
+		TextureRef texture;
+		TextureData textureData( source.subresources.data(), static_cast<uint32_t>( source.subresources.size() ) );
+		device->CreateTexture( source.desc, &textureData, &texture );
+		return texture;
+	}
+
 	if( dataSize < sizeof(FileIdentifier) || memcmp( data, FileIdentifier, sizeof(FileIdentifier) ) )
 		throw TextureDataExc( "File identifier mismatch" );			
 
@@ -678,9 +1432,291 @@ TextureRef createTextureFromKtx( RenderDevice* device, const DataSourceRef &data
 	return texture;
 }
 
+namespace {
+	#define DDS_MAGIC                 0x20534444 // "DDS "
+	#define DDSD_MIPMAPCOUNT          0x00020000
+	#define DDSD_DEPTH                0x00800000
+	#define DDPF_ALPHAPIXELS          0x00000001
+	#define DDPF_FOURCC               0x00000004
+	#define DDPF_RGB                  0x00000040
+	#define DDPF_LUMINANCE            0x00020000
+	#define DDSCAPS2_CUBEMAP          0x00000200
+	#define DDSCAPS2_CUBEMAP_ALLFACES 0x0000FC00
+	#define DDSCAPS2_VOLUME           0x00200000
+	#define DDS_RESOURCE_MISC_TEXTURECUBE 0x4
+	#define DDS_DIMENSION_TEXTURE1D   2
+	#define DDS_DIMENSION_TEXTURE3D   4
+
+	constexpr uint32_t makeFourCC( char a, char b, char c, char d )
+	{
+		return uint32_t( uint8_t( a ) ) | ( uint32_t( uint8_t( b ) ) << 8 ) | ( uint32_t( uint8_t( c ) ) << 16 ) | ( uint32_t( uint8_t( d ) ) << 24 );
+	}
+
+	struct DdsPixelFormat {
+		uint32_t	size;
+		uint32_t	flags;
+		uint32_t	fourCC;
+		uint32_t	rgbBitCount;
+		uint32_t	rBitMask;
+		uint32_t	gBitMask;
+		uint32_t	bBitMask;
+		uint32_t	aBitMask;
+	};
+
+	struct DdsHeader {
+		uint32_t		size;
+		uint32_t		flags;
+		uint32_t		height;
+		uint32_t		width;
+		uint32_t		pitchOrLinearSize;
+		uint32_t		depth;
+		uint32_t		mipMapCount;
+		uint32_t		reserved1[11];
+		DdsPixelFormat	pixelFormat;
+		uint32_t		caps;
+		uint32_t		caps2;
+		uint32_t		caps3;
+		uint32_t		caps4;
+		uint32_t		reserved2;
+	};
+
+	struct DdsHeaderDx10 {
+		uint32_t	dxgiFormat;
+		uint32_t	resourceDimension;
+		uint32_t	miscFlag;
+		uint32_t	arraySize;
+		uint32_t	miscFlags2;
+	};
+
+	TEXTURE_FORMAT findDiligentTextureFormatFromDxgi( uint32_t dxgiFormat )
+	{
+		switch( dxgiFormat ) {
+			// clang-format off
+			case 2:  return TEX_FORMAT_RGBA32_FLOAT;
+			case 3:  return TEX_FORMAT_RGBA32_UINT;
+			case 4:  return TEX_FORMAT_RGBA32_SINT;
+			case 6:  return TEX_FORMAT_RGB32_FLOAT;
+			case 7:  return TEX_FORMAT_RGB32_UINT;
+			case 8:  return TEX_FORMAT_RGB32_SINT;
+			case 10: return TEX_FORMAT_RGBA16_FLOAT;
+			case 11: return TEX_FORMAT_RGBA16_UNORM;
+			case 12: return TEX_FORMAT_RGBA16_UINT;
+			case 13: return TEX_FORMAT_RGBA16_SNORM;
+			case 14: return TEX_FORMAT_RGBA16_SINT;
+			case 16: return TEX_FORMAT_RG32_FLOAT;
+			case 17: return TEX_FORMAT_RG32_UINT;
+			case 18: return TEX_FORMAT_RG32_SINT;
+			case 24: return TEX_FORMAT_RGB10A2_UNORM;
+			case 25: return TEX_FORMAT_RGB10A2_UINT;
+			case 26: return TEX_FORMAT_R11G11B10_FLOAT;
+			case 28: return TEX_FORMAT_RGBA8_UNORM;
+			case 29: return TEX_FORMAT_RGBA8_UNORM_SRGB;
+			case 30: return TEX_FORMAT_RGBA8_UINT;
+			case 31: return TEX_FORMAT_RGBA8_SNORM;
+			case 32: return TEX_FORMAT_RGBA8_SINT;
+			case 34: return TEX_FORMAT_RG16_FLOAT;
+			case 35: return TEX_FORMAT_RG16_UNORM;
+			case 36: return TEX_FORMAT_RG16_UINT;
+			case 37: return TEX_FORMAT_RG16_SNORM;
+			case 38: return TEX_FORMAT_RG16_SINT;
+			case 41: return TEX_FORMAT_R32_FLOAT;
+			case 42: return TEX_FORMAT_R32_UINT;
+			case 43: return TEX_FORMAT_R32_SINT;
+			case 49: return TEX_FORMAT_RG8_UNORM;
+			case 50: return TEX_FORMAT_RG8_UINT;
+			case 51: return TEX_FORMAT_RG8_SNORM;
+			case 52: return TEX_FORMAT_RG8_SINT;
+			case 54: return TEX_FORMAT_R16_FLOAT;
+			case 56: return TEX_FORMAT_R16_UNORM;
+			case 57: return TEX_FORMAT_R16_UINT;
+			case 58: return TEX_FORMAT_R16_SNORM;
+			case 59: return TEX_FORMAT_R16_SINT;
+			case 61: return TEX_FORMAT_R8_UNORM;
+			case 62: return TEX_FORMAT_R8_UINT;
+			case 63: return TEX_FORMAT_R8_SNORM;
+			case 64: return TEX_FORMAT_R8_SINT;
+			case 67: return TEX_FORMAT_RGB9E5_SHAREDEXP;
+			case 71: return TEX_FORMAT_BC1_UNORM;
+			case 72: return TEX_FORMAT_BC1_UNORM_SRGB;
+			case 74: return TEX_FORMAT_BC2_UNORM;
+			case 75: return TEX_FORMAT_BC2_UNORM_SRGB;
+			case 77: return TEX_FORMAT_BC3_UNORM;
+			case 78: return TEX_FORMAT_BC3_UNORM_SRGB;
+			case 80: return TEX_FORMAT_BC4_UNORM;
+			case 81: return TEX_FORMAT_BC4_SNORM;
+			case 83: return TEX_FORMAT_BC5_UNORM;
+			case 84: return TEX_FORMAT_BC5_SNORM;
+			case 85: return TEX_FORMAT_B5G6R5_UNORM;
+			case 86: return TEX_FORMAT_B5G5R5A1_UNORM;
+			case 87: return TEX_FORMAT_BGRA8_UNORM;
+			case 88: return TEX_FORMAT_BGRX8_UNORM;
+			case 91: return TEX_FORMAT_BGRA8_UNORM_SRGB;
+			case 93: return TEX_FORMAT_BGRX8_UNORM_SRGB;
+			case 95: return TEX_FORMAT_BC6H_UF16;
+			case 96: return TEX_FORMAT_BC6H_SF16;
+			case 98: return TEX_FORMAT_BC7_UNORM;
+			case 99: return TEX_FORMAT_BC7_UNORM_SRGB;
+			// clang-format on
+			default: return TEX_FORMAT_UNKNOWN;
+		}
+	}
+
+	//! Returns the format of a pre-DX10 DDS file, legacy files don't store their colorspace so \a srgb decides it
+	TEXTURE_FORMAT findDiligentTextureFormatFromLegacyDds( const DdsPixelFormat &pf, bool srgb )
+	{
+		if( pf.flags & DDPF_FOURCC ) {
+			switch( pf.fourCC ) {
+				case makeFourCC( 'D', 'X', 'T', '1' ): return srgb ? TEX_FORMAT_BC1_UNORM_SRGB : TEX_FORMAT_BC1_UNORM;
+				case makeFourCC( 'D', 'X', 'T', '2' ):
+				case makeFourCC( 'D', 'X', 'T', '3' ): return srgb ? TEX_FORMAT_BC2_UNORM_SRGB : TEX_FORMAT_BC2_UNORM;
+				case makeFourCC( 'D', 'X', 'T', '4' ):
+				case makeFourCC( 'D', 'X', 'T', '5' ): return srgb ? TEX_FORMAT_BC3_UNORM_SRGB : TEX_FORMAT_BC3_UNORM;
+				case makeFourCC( 'A', 'T', 'I', '1' ):
+				case makeFourCC( 'B', 'C', '4', 'U' ): return TEX_FORMAT_BC4_UNORM;
+				case makeFourCC( 'B', 'C', '4', 'S' ): return TEX_FORMAT_BC4_SNORM;
+				case makeFourCC( 'A', 'T', 'I', '2' ):
+				case makeFourCC( 'B', 'C', '5', 'U' ): return TEX_FORMAT_BC5_UNORM;
+				case makeFourCC( 'B', 'C', '5', 'S' ): return TEX_FORMAT_BC5_SNORM;
+				// D3DFORMAT values stored in the FourCC field
+				case 36:  return TEX_FORMAT_RGBA16_UNORM;
+				case 110: return TEX_FORMAT_RGBA16_SNORM;
+				case 111: return TEX_FORMAT_R16_FLOAT;
+				case 112: return TEX_FORMAT_RG16_FLOAT;
+				case 113: return TEX_FORMAT_RGBA16_FLOAT;
+				case 114: return TEX_FORMAT_R32_FLOAT;
+				case 115: return TEX_FORMAT_RG32_FLOAT;
+				case 116: return TEX_FORMAT_RGBA32_FLOAT;
+				default:  return TEX_FORMAT_UNKNOWN;
+			}
+		}
+		if( ( pf.flags & DDPF_RGB ) && pf.rgbBitCount == 32 ) {
+			const bool hasAlpha = ( pf.flags & DDPF_ALPHAPIXELS ) && pf.aBitMask;
+			if( pf.rBitMask == 0x000000FF && pf.gBitMask == 0x0000FF00 && pf.bBitMask == 0x00FF0000 ) {
+				return srgb ? TEX_FORMAT_RGBA8_UNORM_SRGB : TEX_FORMAT_RGBA8_UNORM;
+			}
+			if( pf.rBitMask == 0x00FF0000 && pf.gBitMask == 0x0000FF00 && pf.bBitMask == 0x000000FF ) {
+				return hasAlpha ? ( srgb ? TEX_FORMAT_BGRA8_UNORM_SRGB : TEX_FORMAT_BGRA8_UNORM ) : ( srgb ? TEX_FORMAT_BGRX8_UNORM_SRGB : TEX_FORMAT_BGRX8_UNORM );
+			}
+			if( pf.rBitMask == 0x0000FFFF && pf.gBitMask == 0xFFFF0000 ) {
+				return TEX_FORMAT_RG16_UNORM;
+			}
+			if( pf.rBitMask == 0xFFFFFFFF ) {
+				return TEX_FORMAT_R32_FLOAT;
+			}
+		}
+		if( ( pf.flags & DDPF_RGB ) && pf.rgbBitCount == 16 && pf.rBitMask == 0xF800 && pf.gBitMask == 0x07E0 && pf.bBitMask == 0x001F ) {
+			return TEX_FORMAT_B5G6R5_UNORM;
+		}
+		if( ( pf.flags & DDPF_LUMINANCE ) && pf.rgbBitCount == 8 ) {
+			return TEX_FORMAT_R8_UNORM;
+		}
+		if( ( pf.flags & DDPF_LUMINANCE ) && pf.rgbBitCount == 16 ) {
+			return pf.rBitMask == 0xFFFF ? TEX_FORMAT_R16_UNORM : TEX_FORMAT_RG8_UNORM;
+		}
+		return TEX_FORMAT_UNKNOWN;
+	}
+} // namespace
+
+TextureSourceData parseDds( const void* dataPtr, size_t dataSize, const TextureDesc &desc )
+{
+	const uint8_t* data = static_cast<const uint8_t*>( dataPtr );
+	const uint8_t* dataEnd = data + dataSize;
+
+	if( dataSize < sizeof( uint32_t ) + sizeof( DdsHeader ) || *reinterpret_cast<const uint32_t*>( data ) != DDS_MAGIC )
+		throw TextureDataExc( "File identifier mismatch" );
+
+	const DdsHeader &header = *reinterpret_cast<const DdsHeader*>( data + sizeof( uint32_t ) );
+	if( header.size != sizeof( DdsHeader ) || header.pixelFormat.size != sizeof( DdsPixelFormat ) || header.width == 0 )
+		throw TextureDataExc( "Invalid DDS header" );
+	data += sizeof( uint32_t ) + sizeof( DdsHeader );
+
+	TextureSourceData source;
+	TextureDesc &textureDesc = source.desc;
+	textureDesc = getDefaultTextureDesc( desc, header.width, std::max( header.height, 1u ) );
+	textureDesc.Depth     = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.MipLevels = ( header.flags & DDSD_MIPMAPCOUNT ) ? std::max( header.mipMapCount, 1u ) : 1;
+
+	if( ( header.pixelFormat.flags & DDPF_FOURCC ) && header.pixelFormat.fourCC == makeFourCC( 'D', 'X', '1', '0' ) ) {
+		if( static_cast<size_t>( dataEnd - data ) < sizeof( DdsHeaderDx10 ) )
+			throw TextureDataExc( "Truncated DX10 header" );
+		const DdsHeaderDx10 &headerDx10 = *reinterpret_cast<const DdsHeaderDx10*>( data );
+		data += sizeof( DdsHeaderDx10 );
+
+		textureDesc.Format = findDiligentTextureFormatFromDxgi( headerDx10.dxgiFormat );
+		if( textureDesc.Format == TEX_FORMAT_UNKNOWN )
+			throw TextureDataExc( "Unsupported DXGI format " + to_string( headerDx10.dxgiFormat ) );
+
+		const bool isCube = ( headerDx10.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE ) != 0;
+		const uint32_t arraySize = std::max( headerDx10.arraySize, 1u );
+		if( headerDx10.resourceDimension == DDS_DIMENSION_TEXTURE3D ) {
+			textureDesc.Type  = RESOURCE_DIM_TEX_3D;
+			textureDesc.Depth = std::max( header.depth, 1u );
+		}
+		else if( headerDx10.resourceDimension == DDS_DIMENSION_TEXTURE1D ) {
+			textureDesc.Type      = arraySize > 1 ? RESOURCE_DIM_TEX_1D_ARRAY : RESOURCE_DIM_TEX_1D;
+			textureDesc.ArraySize = arraySize;
+		}
+		else if( isCube ) {
+			textureDesc.Type      = arraySize > 1 ? RESOURCE_DIM_TEX_CUBE_ARRAY : RESOURCE_DIM_TEX_CUBE;
+			textureDesc.ArraySize = arraySize * 6;
+		}
+		else {
+			textureDesc.Type      = arraySize > 1 ? RESOURCE_DIM_TEX_2D_ARRAY : RESOURCE_DIM_TEX_2D;
+			textureDesc.ArraySize = arraySize;
+		}
+	}
+	else {
+		textureDesc.Format = findDiligentTextureFormatFromLegacyDds( header.pixelFormat, desc.isSrgb() );
+		if( textureDesc.Format == TEX_FORMAT_UNKNOWN )
+			throw TextureDataExc( "Unsupported DDS pixel format" );
+
+		if( ( header.caps2 & DDSCAPS2_VOLUME ) && ( header.flags & DDSD_DEPTH ) ) {
+			textureDesc.Type  = RESOURCE_DIM_TEX_3D;
+			textureDesc.Depth = std::max( header.depth, 1u );
+		}
+		else if( header.caps2 & DDSCAPS2_CUBEMAP ) {
+			if( ( header.caps2 & DDSCAPS2_CUBEMAP_ALLFACES ) != DDSCAPS2_CUBEMAP_ALLFACES )
+				throw TextureDataExc( "Partial cubemaps are not supported" );
+			textureDesc.Type      = RESOURCE_DIM_TEX_CUBE;
+			textureDesc.ArraySize = 6;
+		}
+		else {
+			textureDesc.Type = RESOURCE_DIM_TEX_2D;
+		}
+	}
+
+	// DDS stores each array slice or cube face with its full mip chain, one after the other
+	const uint32_t arraySize = textureDesc.Type != RESOURCE_DIM_TEX_3D ? textureDesc.ArraySize : 1;
+	if( textureDesc.MipLevels > ComputeMipLevelsCount( textureDesc.Width, textureDesc.Height, textureDesc.Type == RESOURCE_DIM_TEX_3D ? textureDesc.Depth : 1 ) )
+		throw TextureDataExc( "Invalid DDS mip count" );
+	// every subresource takes at least a byte, which bounds the counts of corrupted headers before allocating
+	if( uint64_t{ textureDesc.MipLevels } * arraySize > static_cast<uint64_t>( dataEnd - data ) )
+		throw TextureDataExc( "Truncated DDS data" );
+	source.subresources.resize( textureDesc.MipLevels * arraySize );
+	for( uint32_t layer = 0; layer < arraySize; ++layer ) {
+		for( uint32_t mip = 0; mip < textureDesc.MipLevels; ++mip ) {
+			const MipLevelProperties mipInfo = GetMipLevelProperties( textureDesc, mip );
+			if( static_cast<uint64_t>( dataEnd - data ) < mipInfo.MipSize )
+				throw TextureDataExc( "Truncated DDS data" );
+			source.subresources[mip + layer * textureDesc.MipLevels] = TextureSubResData{ data, mipInfo.RowSize, mipInfo.DepthSliceSize };
+			data += mipInfo.MipSize;
+		}
+	}
+
+	return source;
+}
+
 TextureRef createTextureFromDds( RenderDevice* device, const DataSourceRef &dataSource, const TextureDesc &desc )
 {
+	// the subresources point into the DataSource buffer, which stays alive until CreateTexture returns
+	ci::BufferRef dataBuffer = dataSource->getBuffer();
+	const TextureSourceData source = parseDds( dataBuffer->getData(), dataBuffer->getSize(), desc );
+
 	TextureRef texture;
+	TextureData textureData( source.subresources.data(), static_cast<uint32_t>( source.subresources.size() ) );
+	device->CreateTexture( source.desc, &textureData, &texture );
+
 	return texture;
 }
 
@@ -0,0 +1,97 @@
+/*
+ Copyright (c) 2021, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	   the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	   the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/graphics/ThreadPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace graphics {
+
+ThreadPool::ThreadPool( size_t numThreads )
+	: mStop( false )
+{
+	if( numThreads == 0 ) {
+		numThreads = std::max<size_t>( 2, std::thread::hardware_concurrency() ) - 1;
+	}
+	for( size_t i = 0; i < numThreads; ++i ) {
+		mThreads.emplace_back( &ThreadPool::workerLoop, this );
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mStop = true;
+	}
+	mCondition.notify_all();
+	for( auto &thread : mThreads ) {
+		thread.join();
+	}
+}
+
+bool ThreadPool::isWorkerThread() const
+{
+	const auto id = std::this_thread::get_id();
+	return std::any_of( mThreads.begin(), mThreads.end(), [id]( const std::thread &thread ) { return thread.get_id() == id; } );
+}
+
+ThreadPool& ThreadPool::getDefault()
+{
+	static ThreadPool sThreadPool;
+	return sThreadPool;
+}
+
+void ThreadPool::push( std::function<void()> &&task )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mTasks.push_back( std::move( task ) );
+	}
+	mCondition.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+	while( true ) {
+		std::function<void()> task;
+		{
+			unique_lock<mutex> lock( mMutex );
+			mCondition.wait( lock, [this]() { return mStop || ! mTasks.empty(); } );
+			// pending tasks still run on shutdown so that no future is left without a value
+			if( mTasks.empty() ) {
+				return;
+			}
+			task = std::move( mTasks.front() );
+			mTasks.pop_front();
+		}
+		task();
+	}
+}
+
+}
+
+namespace gx = graphics;
+} // namespace cinder::graphics
@@ -59,6 +59,7 @@ void setBlendFactors( const float* pBlendFactors )
 void invalidateState()
 {
 	getImmediateContext()->InvalidateState();
+	getContextStateCache()->invalidate();
 }
 
 void setVertexBuffer( Buffer* buffer, RESOURCE_STATE_TRANSITION_MODE stateTransitionMode, SET_VERTEX_BUFFERS_FLAGS flags )
@@ -118,9 +119,9 @@ void drawIndexed( const Diligent::DrawIndexedAttribs &attribs )
 	getImmediateContext()->DrawIndexed( attribs );
 }
 
-void drawIndexedIndirect( const DrawIndexedIndirectAttribs &attribs )
+void drawIndexedIndirect( const Diligent::DrawIndexedIndirectAttribs &attribs )
 {
-	//getImmediateContext()->DrawIndexedIndirect( attribs );
+	getImmediateContext()->DrawIndexedIndirect( attribs );
 }
 
 void drawMesh( const DrawMeshAttribs &attribs )
@@ -130,7 +131,7 @@ void drawMesh( const DrawMeshAttribs &attribs )
 
 void drawMeshIndirect( const DrawMeshIndirectAttribs &attribs )
 {
-	//getImmediateContext()->DrawMeshIndirect( attribs );
+	getImmediateContext()->DrawMeshIndirect( attribs );
 }
 
 void dispatchCompute( const DispatchComputeAttribs &Attribs )
@@ -194,11 +195,14 @@ void clearRenderTarget( TextureView* pView, const float* RGBA, RESOURCE_STATE_TR
 void finishCommandList( ICommandList** ppCommandList )
 {
     getImmediateContext()->FinishCommandList( ppCommandList );
+    getContextStateCache()->invalidate();
 }
 
 void executeCommandLists( uint32_t NumCommandLists, ICommandList* const* ppCommandLists )
 {
     getImmediateContext()->ExecuteCommandLists( NumCommandLists, ppCommandLists );
+    // executing command lists resets the context state
+    getContextStateCache()->invalidate();
 }
 
 void enqueueSignal( IFence* pFence, uint64_t value )
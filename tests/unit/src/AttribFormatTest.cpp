@@ -0,0 +1,188 @@
+#include "cinder/graphics/Mesh.h"
+#include "cinder/TriMesh.h"
+
+#include "UnitTest.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	//! Exact value of the half float \a bits. Infinity maps to 65536, the value a larger exponent would have, so that it rounds like a finite neighbor.
+	double halfToDouble( uint16_t bits )
+	{
+		const int exponent = ( bits >> 10 ) & 0x1f, mantissa = bits & 0x3ff;
+		const double magnitude = exponent == 31 ? 65536.0 : exponent == 0 ? ldexp( mantissa, -24 ) : ldexp( 1024 + mantissa, exponent - 25 );
+		return bits & 0x8000 ? -magnitude : magnitude;
+	}
+
+	bool isHalfNan( uint16_t bits )
+	{
+		return ( bits & 0x7c00 ) == 0x7c00 && ( bits & 0x3ff );
+	}
+
+	//! Round to nearest even reference. Halves of the same sign are ordered like their bit patterns, the two surrounding \a value are found by bisection.
+	uint16_t halfReference( float value )
+	{
+		const uint16_t sign = signbit( value ) ? 0x8000 : 0;
+		const double magnitude = abs( double( value ) );
+		if( magnitude >= 65536.0 ) {
+			return sign | 0x7c00;
+		}
+		uint16_t below = 0, above = 0x7c00;
+		while( above - below > 1 ) {
+			const uint16_t middle = ( below + above ) / 2;
+			if( halfToDouble( middle ) <= magnitude ) {
+				below = middle;
+			}
+			else {
+				above = middle;
+			}
+		}
+		const double toBelow = magnitude - halfToDouble( below ), toAbove = halfToDouble( above ) - magnitude;
+		return sign | ( toBelow < toAbove || ( toBelow == toAbove && ! ( below & 1 ) ) ? below : above );
+	}
+
+	//! Returns a TriMesh of whole triangles with one vertex per \a dims components of \a values, the last vertices being padded with zeros
+	TriMesh makeTriMesh( const vector<float> &values, uint8_t dims, TriMesh::Format format )
+	{
+		TriMesh triMesh( format.positions( 3 ) );
+		const size_t numVertices = ( values.size() / dims + 2 ) / 3 * 3;
+		for( size_t i = 0; i < numVertices; ++i ) {
+			float v[3] = {};
+			for( uint8_t c = 0; c < dims && i * dims + c < values.size(); ++c ) {
+				v[c] = values[i * dims + c];
+			}
+			triMesh.appendPosition( vec3( static_cast<float>( i ), 0.0f, 0.0f ) );
+			if( dims == 2 ) {
+				triMesh.appendTexCoord0( vec2( v[0], v[1] ) );
+			}
+			else {
+				triMesh.appendNormal( vec3( v[0], v[1], v[2] ) );
+			}
+		}
+		for( uint32_t i = 0; i < numVertices; i += 3 ) {
+			triMesh.appendTriangle( i, i + 1, i + 2 );
+		}
+		return triMesh;
+	}
+
+	//! Converts \a values to half floats through a FLOAT16 texture coordinate attribute. The conversion runs on blocks of 256 vertices, the SIMD paths converting four components at a time and the scalar tail the rest.
+	vector<uint16_t> convertToHalf( const vector<float> &values )
+	{
+		const TriMesh triMesh = makeTriMesh( values, 2, TriMesh::Format().texCoords0( 2 ) );
+		const gx::Mesh::SourceData data = gx::Mesh::loadSource( triMesh, { gx::Mesh::BufferInfo().attrib( geom::TEX_COORD_0, 2, 0, 0 ).attribFormat( geom::TEX_COORD_0, gx::Mesh::AttribFormat::FLOAT16 ) } );
+		vector<uint16_t> halves( values.size() );
+		memcpy( halves.data(), data.vertexBuffers.front().second.data(), halves.size() * sizeof( uint16_t ) );
+		return halves;
+	}
+
+	//! Converts the unit vectors \a normals through an OCT_SNORM16 normal attribute
+	vector<int16_t> octEncode( const vector<vec3> &normals )
+	{
+		vector<float> values;
+		for( const vec3 &n : normals ) {
+			values.insert( values.end(), { n.x, n.y, n.z } );
+		}
+		const TriMesh triMesh = makeTriMesh( values, 3, TriMesh::Format().normals() );
+		const gx::Mesh::SourceData data = gx::Mesh::loadSource( triMesh, { gx::Mesh::BufferInfo().attrib( geom::NORMAL, 3, 0, 0 ).attribFormat( geom::NORMAL, gx::Mesh::AttribFormat::OCT_SNORM16 ) } );
+		vector<int16_t> encoded( normals.size() * 2 );
+		memcpy( encoded.data(), data.vertexBuffers.front().second.data(), encoded.size() * sizeof( int16_t ) );
+		return encoded;
+	}
+
+	//! Decodes an OCT_SNORM16 normal with the shader code documented by Mesh::AttribFormat
+	vec3 octDecode( const int16_t* e )
+	{
+		vec3 n( std::max( e[0] / 32767.0f, -1.0f ), std::max( e[1] / 32767.0f, -1.0f ), 0.0f );
+		n.z = 1.0f - abs( n.x ) - abs( n.y );
+		const float t = glm::clamp( -n.z, 0.0f, 1.0f );
+		n.x += n.x >= 0.0f ? -t : t;
+		n.y += n.y >= 0.0f ? -t : t;
+		return glm::normalize( n );
+	}
+} // anonymous namespace
+
+TEST_CASE( "FLOAT16 rounds to nearest even in the SIMD lanes and the scalar tail" )
+{
+	const float inf = numeric_limits<float>::infinity();
+	const float specials[] = {
+		0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, -65504.0f,
+		// ties between two halves round to the even one
+		1.0f + ldexp( 1.0f, -11 ), 1.0f + 3.0f * ldexp( 1.0f, -11 ), -( 1.0f + 3.0f * ldexp( 1.0f, -11 ) ), 2049.0f,
+		// the largest half, the tie with infinity and overflows
+		65519.0f, 65520.0f, -65520.0f, 1e6f, inf, -inf,
+		// subnormal halves, their ties and underflows
+		ldexp( 1.0f, -14 ), ldexp( 1.0f, -15 ) * 1.5f, ldexp( 1.0f, -24 ), ldexp( 1.0f, -25 ), 3.0f * ldexp( 1.0f, -25 ), -ldexp( 1.0f, -26 ), 1e-10f, numeric_limits<float>::denorm_min()
+	};
+	// six copies make three vertices, four components go through the SIMD path and two through the scalar tail
+	for( float special : specials ) {
+		const vector<uint16_t> halves = convertToHalf( vector<float>( 6, special ) );
+		for( uint16_t half : halves ) {
+			CHECK( half == halfReference( special ) );
+		}
+	}
+	for( float nan : { numeric_limits<float>::quiet_NaN(), -numeric_limits<float>::quiet_NaN() } ) {
+		for( uint16_t half : convertToHalf( vector<float>( 6, nan ) ) ) {
+			CHECK( isHalfNan( half ) );
+		}
+	}
+}
+
+TEST_CASE( "FLOAT16 matches the reference on random values" )
+{
+	// exponents from underflow to overflow and random mantissas and signs, 1029 vertices leave a scalar tail in the last block
+	mt19937 rng( 1 );
+	vector<float> values( 2058 );
+	for( float &value : values ) {
+		const uint32_t bits = ( rng() & 0x807fffffu ) | ( ( 127 - 26 + rng() % 44 ) << 23 );
+		memcpy( &value, &bits, sizeof( value ) );
+	}
+	const vector<uint16_t> halves = convertToHalf( values );
+	for( size_t i = 0; i < values.size(); ++i ) {
+		REQUIRE( halves[i] == halfReference( values[i] ) );
+	}
+}
+
+TEST_CASE( "OCT_SNORM16 normals decode within the quantization error" )
+{
+	vector<vec3> normals;
+	// the axes and the octant diagonals sit on the folds of the octahedron
+	for( float x : { -1.0f, 0.0f, 1.0f } ) {
+		for( float y : { -1.0f, 0.0f, 1.0f } ) {
+			for( float z : { -1.0f, 0.0f, 1.0f } ) {
+				if( x || y || z ) {
+					normals.push_back( glm::normalize( vec3( x, y, z ) ) );
+				}
+			}
+		}
+	}
+	mt19937 rng( 2 );
+	normal_distribution<float> distribution;
+	while( normals.size() < 1000 ) {
+		const vec3 n( distribution( rng ), distribution( rng ), distribution( rng ) );
+		if( glm::length( n ) > 1e-3f ) {
+			normals.push_back( glm::normalize( n ) );
+		}
+	}
+
+	const vector<int16_t> encoded = octEncode( normals );
+	float maxError = 0.0f;
+	for( size_t i = 0; i < normals.size(); ++i ) {
+		maxError = std::max( maxError, glm::distance( octDecode( &encoded[i * 2] ), normals[i] ) );
+	}
+	// a 16-bit step on the octahedron is at most about 1e-4 on the sphere
+	CHECK( maxError < 1e-4f );
+}
+
+TEST_CASE( "OCT_SNORM16 encodes zero vectors to zero" )
+{
+	const vector<int16_t> encoded = octEncode( { vec3( 0.0f ), vec3( 0.0f, 0.0f, -0.0f ), vec3( 0.0f ) } );
+	for( int16_t e : encoded ) {
+		CHECK( e == 0 );
+	}
+}
@@ -0,0 +1,151 @@
+#include "cinder/graphics/Batch.h"
+
+#include "UnitTest.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	//! Interleaved float vertex of the first buffer, the second buffer holds the texture coordinates
+	struct Vertex {
+		vec3 position;
+		vec3 normal;
+		vec3 tangent;
+	};
+
+	template<typename T>
+	vector<uint8_t> toBytes( const vector<T> &values )
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>( values.data() );
+		return vector<uint8_t>( bytes, bytes + values.size() * sizeof( T ) );
+	}
+
+	template<typename T>
+	vector<T> fromBytes( const vector<uint8_t> &bytes )
+	{
+		vector<T> values( bytes.size() / sizeof( T ) );
+		memcpy( values.data(), bytes.data(), values.size() * sizeof( T ) );
+		return values;
+	}
+
+	//! Returns \a numVertices vertices on a slanted line with perpendicular normals and tangents, indexed by \a indices when not empty
+	gx::Mesh::SourceData makeMeshData( uint32_t numVertices, const vector<uint32_t> &indices = {}, const vec3 &origin = vec3( 0.0f ) )
+	{
+		vector<Vertex> vertices;
+		vector<vec2> texCoords;
+		for( uint32_t i = 0; i < numVertices; ++i ) {
+			const float angle = static_cast<float>( i );
+			const vec3 normal( cos( angle ), sin( angle ), 0.0f );
+			const vec3 tangent = glm::normalize( glm::cross( normal, vec3( 0.3f, -0.2f, 1.0f ) ) );
+			vertices.push_back( { origin + vec3( angle, 2.0f * angle, -angle ), normal, tangent } );
+			texCoords.push_back( vec2( angle, -angle ) );
+		}
+
+		gx::Mesh::SourceData data;
+		data.vertexBuffers.push_back( { gx::Mesh::BufferInfo()
+			.attrib( geom::POSITION, 3, sizeof( Vertex ), offsetof( Vertex, position ) )
+			.attrib( geom::NORMAL, 3, sizeof( Vertex ), offsetof( Vertex, normal ) )
+			.attrib( geom::TANGENT, 3, sizeof( Vertex ), offsetof( Vertex, tangent ) ), toBytes( vertices ) } );
+		data.vertexBuffers.push_back( { gx::Mesh::BufferInfo().attrib( geom::TEX_COORD_0, 2, 0, 0 ), toBytes( texCoords ) } );
+		data.indices = indices;
+		data.numVertices = numVertices;
+		const float extent = static_cast<float>( numVertices ? numVertices - 1 : 0 );
+		data.bounds = AxisAlignedBox( origin + vec3( 0.0f, 0.0f, -extent ), origin + vec3( extent, 2.0f * extent, 0.0f ) );
+		data.boundingSphere = Sphere( data.bounds.getCenter(), glm::length( data.bounds.getExtents() ) );
+		return data;
+	}
+
+	bool isNear( const vec3 &a, const vec3 &b, float epsilon = 1e-4f )
+	{
+		return glm::length( a - b ) < epsilon;
+	}
+} // anonymous namespace
+
+TEST_CASE( "mergeSourceData offsets the indices and indexes the non-indexed meshes" )
+{
+	const vector<gx::Mesh::SourceData> meshes = { makeMeshData( 3, { 2, 1, 0 } ), makeMeshData( 3 ), makeMeshData( 4, { 0, 1, 2, 2, 1, 3 } ) };
+	const gx::Mesh::SourceData merged = gx::Batch::mergeSourceData( meshes );
+
+	CHECK( merged.numVertices == 10 );
+	CHECK( merged.use16BitIndices );
+	CHECK( merged.indices == vector<uint32_t>( { 2, 1, 0, 3, 4, 5, 6, 7, 8, 8, 7, 9 } ) );
+	// untransformed vertices are appended unchanged
+	REQUIRE( merged.vertexBuffers.size() == 2 );
+	for( size_t b = 0; b < merged.vertexBuffers.size(); ++b ) {
+		vector<uint8_t> expected;
+		for( const auto &mesh : meshes ) {
+			expected.insert( expected.end(), mesh.vertexBuffers[b].second.begin(), mesh.vertexBuffers[b].second.end() );
+		}
+		CHECK( merged.vertexBuffers[b].second == expected );
+		CHECK( merged.vertexBuffers[b].first.getUsage() == gx::USAGE_IMMUTABLE );
+	}
+}
+
+TEST_CASE( "mergeSourceData keeps non-indexed meshes non-indexed" )
+{
+	const gx::Mesh::SourceData merged = gx::Batch::mergeSourceData( { makeMeshData( 3 ), makeMeshData( 6 ) } );
+	CHECK( merged.numVertices == 9 );
+	CHECK( merged.indices.empty() );
+}
+
+TEST_CASE( "mergeSourceData narrows the indices up to 65536 vertices" )
+{
+	// the largest 16-bit index addresses the 65536th vertex
+	CHECK( gx::Batch::mergeSourceData( { makeMeshData( 32768, { 0, 1, 2 } ), makeMeshData( 32768, { 0, 1, 32767 } ) } ).use16BitIndices );
+	const gx::Mesh::SourceData merged = gx::Batch::mergeSourceData( { makeMeshData( 32768, { 0, 1, 2 } ), makeMeshData( 32769, { 0, 1, 32768 } ) } );
+	CHECK( ! merged.use16BitIndices );
+	CHECK( merged.indices.back() == 65536 );
+}
+
+TEST_CASE( "mergeSourceData transforms normals by the inverse transpose and tangents by the model matrix" )
+{
+	const vector<gx::Mesh::SourceData> meshes = { makeMeshData( 5, { 0, 1, 2, 2, 3, 4 } ), makeMeshData( 4, {}, vec3( 10.0f, 0.0f, 0.0f ) ) };
+	// the non-uniform scale skews the normals, a plain rotation would transform them like the tangents
+	const mat4 transform = glm::translate( mat4( 1.0f ), vec3( 1.0f, 2.0f, 3.0f ) ) * glm::rotate( mat4( 1.0f ), 0.7f, glm::normalize( vec3( 1.0f, 1.0f, 0.0f ) ) ) * glm::scale( mat4( 1.0f ), vec3( 3.0f, 0.5f, 1.0f ) );
+	const vector<mat4> transforms = { transform, mat4( 1.0f ) };
+	const gx::Mesh::SourceData merged = gx::Batch::mergeSourceData( meshes, transforms );
+
+	const mat3 normalMatrix = glm::transpose( glm::inverse( mat3( transform ) ) );
+	const vector<Vertex> vertices = fromBytes<Vertex>( merged.vertexBuffers[0].second );
+	REQUIRE( vertices.size() == 9 );
+	size_t v = 0;
+	for( size_t m = 0; m < meshes.size(); ++m ) {
+		for( const Vertex &source : fromBytes<Vertex>( meshes[m].vertexBuffers[0].second ) ) {
+			const Vertex &vertex = vertices[v++];
+			CHECK( isNear( vertex.position, vec3( transforms[m] * vec4( source.position, 1.0f ) ) ) );
+			CHECK( isNear( vertex.tangent, glm::normalize( mat3( transforms[m] ) * source.tangent ) ) );
+			if( m == 0 ) {
+				CHECK( isNear( vertex.normal, glm::normalize( normalMatrix * source.normal ) ) );
+			}
+			else {
+				CHECK( isNear( vertex.normal, source.normal ) );
+			}
+			// the transformed surface stays perpendicular to its normal
+			CHECK( std::abs( glm::dot( vertex.normal, vertex.tangent ) ) < 1e-4f );
+			// every vertex is within the merged bounds and bounding sphere
+			CHECK( glm::all( glm::greaterThanEqual( vertex.position, merged.bounds.getMin() - vec3( 1e-4f ) ) ) );
+			CHECK( glm::all( glm::lessThanEqual( vertex.position, merged.bounds.getMax() + vec3( 1e-4f ) ) ) );
+			CHECK( glm::distance( vertex.position, merged.boundingSphere.getCenter() ) <= merged.boundingSphere.getRadius() + 1e-4f );
+		}
+	}
+	// attributes other than positions, normals, tangents and bitangents are left alone
+	vector<uint8_t> texCoords = meshes[0].vertexBuffers[1].second;
+	texCoords.insert( texCoords.end(), meshes[1].vertexBuffers[1].second.begin(), meshes[1].vertexBuffers[1].second.end() );
+	CHECK( merged.vertexBuffers[1].second == texCoords );
+	CHECK( merged.indices == vector<uint32_t>( { 0, 1, 2, 2, 3, 4, 5, 6, 7, 8 } ) );
+}
+
+TEST_CASE( "mergeSourceData tags the vertices with their mesh index" )
+{
+	const gx::Mesh::SourceData merged = gx::Batch::mergeSourceData( { makeMeshData( 3 ), makeMeshData( 4, { 0, 1, 2, 1, 2, 3 } ), makeMeshData( 2 ) }, {}, true );
+	REQUIRE( merged.vertexBuffers.size() == 3 );
+	const gx::Mesh::BufferInfo &info = merged.vertexBuffers.back().first;
+	REQUIRE( info.getAttribs().size() == 1 );
+	CHECK( info.getAttribs().front().getAttrib() == geom::Attrib::CUSTOM_9 );
+	CHECK( fromBytes<uint32_t>( merged.vertexBuffers.back().second ) == vector<uint32_t>( { 0, 0, 0, 1, 1, 1, 1, 2, 2 } ) );
+}
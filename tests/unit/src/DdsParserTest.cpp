@@ -0,0 +1,260 @@
+#include "cinder/graphics/Texture.h"
+
+#include "UnitTest.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	const uint32_t DDSD_MIPMAPCOUNT		= 0x00020000;
+	const uint32_t DDSD_DEPTH			= 0x00800000;
+	const uint32_t DDPF_ALPHAPIXELS		= 0x00000001;
+	const uint32_t DDPF_FOURCC			= 0x00000004;
+	const uint32_t DDPF_RGB				= 0x00000040;
+	const uint32_t DDSCAPS2_CUBEMAP		= 0x00000200;
+	const uint32_t DDSCAPS2_ALLFACES	= 0x0000FC00;
+	const uint32_t DDSCAPS2_VOLUME		= 0x00200000;
+	const size_t kHeaderSize			= 4 + 124;
+	const size_t kDx10HeaderSize		= kHeaderSize + 20;
+
+	constexpr uint32_t makeFourCC( char a, char b, char c, char d )
+	{
+		return uint32_t( uint8_t( a ) ) | ( uint32_t( uint8_t( b ) ) << 8 ) | ( uint32_t( uint8_t( c ) ) << 16 ) | ( uint32_t( uint8_t( d ) ) << 24 );
+	}
+
+	//! In memory DDS file, the header fields are written in file order
+	struct DdsFixture {
+		uint32_t	width = 1, height = 1, depth = 0, mipMapCount = 0, flags = 0, caps2 = 0;
+		uint32_t	pixelFormatFlags = DDPF_RGB | DDPF_ALPHAPIXELS, fourCC = 0, rgbBitCount = 32;
+		uint32_t	masks[4] = { 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 };
+		bool		dx10 = false;
+		uint32_t	dxgiFormat = 28, resourceDimension = 3, miscFlag = 0, arraySize = 1;
+
+		//! Returns the file followed by \a payloadSize bytes of texel data, byte i of the payload is i % 251
+		vector<uint8_t> build( size_t payloadSize ) const
+		{
+			vector<uint32_t> words = { makeFourCC( 'D', 'D', 'S', ' ' ), 124, flags | ( mipMapCount ? DDSD_MIPMAPCOUNT : 0 ) | ( depth ? DDSD_DEPTH : 0 ), height, width, 0, depth, mipMapCount };
+			words.resize( words.size() + 11, 0 );
+			words.insert( words.end(), { 32, dx10 ? DDPF_FOURCC : pixelFormatFlags, dx10 ? makeFourCC( 'D', 'X', '1', '0' ) : fourCC, rgbBitCount, masks[0], masks[1], masks[2], masks[3] } );
+			words.insert( words.end(), { 0x1000, caps2, 0, 0, 0 } );
+			if( dx10 ) {
+				words.insert( words.end(), { dxgiFormat, resourceDimension, miscFlag, arraySize, 0 } );
+			}
+
+			vector<uint8_t> bytes( words.size() * sizeof( uint32_t ) + payloadSize );
+			memcpy( bytes.data(), words.data(), words.size() * sizeof( uint32_t ) );
+			for( size_t i = 0; i < payloadSize; ++i ) {
+				bytes[words.size() * sizeof( uint32_t ) + i] = static_cast<uint8_t>( i % 251 );
+			}
+			return bytes;
+		}
+	};
+
+	//! Returns whether \a subresource starts \a offset bytes into \a file with the given strides
+	bool checkSubresource( const gx::TextureSubResData &subresource, const vector<uint8_t> &file, size_t offset, uint64_t stride, uint64_t depthStride )
+	{
+		return subresource.pData == file.data() + offset && subresource.Stride == stride && subresource.DepthStride == depthStride;
+	}
+
+	bool throwsTextureDataExc( const vector<uint8_t> &file, const gx::TextureDesc &desc = gx::TextureDesc() )
+	{
+		try {
+			gx::parseDds( file.data(), file.size(), desc );
+		}
+		catch( const gx::TextureDataExc & ) {
+			return true;
+		}
+		return false;
+	}
+} // anonymous namespace
+
+TEST_CASE( "parseDds reads a legacy RGBA8 file with mips" )
+{
+	DdsFixture fixture;
+	fixture.width = 4;
+	fixture.height = 2;
+	fixture.mipMapCount = 3;
+	// 4x2, 2x1 and 1x1 texels of 4 bytes
+	const vector<uint8_t> file = fixture.build( 32 + 8 + 4 );
+
+	// legacy files don't store their colorspace, the desc decides it
+	const gx::TextureSourceData source = gx::parseDds( file.data(), file.size(), gx::TextureDesc().srgb( false ) );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_2D );
+	CHECK( source.desc.Format == gx::TEX_FORMAT_RGBA8_UNORM );
+	CHECK( source.desc.Width == 4 );
+	CHECK( source.desc.Height == 2 );
+	CHECK( source.desc.ArraySize == 1 );
+	CHECK( source.desc.MipLevels == 3 );
+	REQUIRE( source.subresources.size() == 3 );
+	CHECK( checkSubresource( source.subresources[0], file, kHeaderSize, 16, 32 ) );
+	CHECK( checkSubresource( source.subresources[1], file, kHeaderSize + 32, 8, 8 ) );
+	CHECK( checkSubresource( source.subresources[2], file, kHeaderSize + 40, 4, 4 ) );
+
+	CHECK( gx::parseDds( file.data(), file.size() ).desc.Format == gx::TEX_FORMAT_RGBA8_UNORM_SRGB );
+}
+
+TEST_CASE( "parseDds reads legacy BGRA8 and DXT1 files" )
+{
+	DdsFixture bgra;
+	bgra.masks[0] = 0x00FF0000;
+	bgra.masks[2] = 0x000000FF;
+	vector<uint8_t> file = bgra.build( 4 );
+	CHECK( gx::parseDds( file.data(), file.size(), gx::TextureDesc().srgb( false ) ).desc.Format == gx::TEX_FORMAT_BGRA8_UNORM );
+
+	DdsFixture dxt1;
+	dxt1.width = 8;
+	dxt1.height = 8;
+	dxt1.mipMapCount = 4;
+	dxt1.pixelFormatFlags = DDPF_FOURCC;
+	dxt1.fourCC = makeFourCC( 'D', 'X', 'T', '1' );
+	dxt1.rgbBitCount = 0;
+	// 2x2, 1x1, 1x1 and 1x1 blocks of 8 bytes, the last mips are padded to a whole block
+	file = dxt1.build( 32 + 8 + 8 + 8 );
+	const gx::TextureSourceData source = gx::parseDds( file.data(), file.size(), gx::TextureDesc().srgb( false ) );
+	CHECK( source.desc.Format == gx::TEX_FORMAT_BC1_UNORM );
+	CHECK( source.desc.MipLevels == 4 );
+	REQUIRE( source.subresources.size() == 4 );
+	CHECK( checkSubresource( source.subresources[0], file, kHeaderSize, 16, 32 ) );
+	CHECK( checkSubresource( source.subresources[1], file, kHeaderSize + 32, 8, 8 ) );
+	CHECK( checkSubresource( source.subresources[2], file, kHeaderSize + 40, 8, 8 ) );
+	CHECK( checkSubresource( source.subresources[3], file, kHeaderSize + 48, 8, 8 ) );
+	CHECK( gx::parseDds( file.data(), file.size() ).desc.Format == gx::TEX_FORMAT_BC1_UNORM_SRGB );
+}
+
+TEST_CASE( "parseDds reads legacy cubemaps and volumes" )
+{
+	DdsFixture cube;
+	cube.width = 2;
+	cube.height = 2;
+	cube.mipMapCount = 2;
+	cube.caps2 = DDSCAPS2_CUBEMAP | DDSCAPS2_ALLFACES;
+	vector<uint8_t> file = cube.build( 6 * ( 16 + 4 ) );
+	gx::TextureSourceData source = gx::parseDds( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_CUBE );
+	CHECK( source.desc.ArraySize == 6 );
+	REQUIRE( source.subresources.size() == 12 );
+	// each face is stored with its full mip chain
+	for( size_t face = 0; face < 6; ++face ) {
+		CHECK( checkSubresource( source.subresources[face * 2], file, kHeaderSize + face * 20, 8, 16 ) );
+		CHECK( checkSubresource( source.subresources[face * 2 + 1], file, kHeaderSize + face * 20 + 16, 4, 4 ) );
+	}
+
+	cube.caps2 = DDSCAPS2_CUBEMAP | 0x00000400;
+	file = cube.build( 6 * ( 16 + 4 ) );
+	CHECK( throwsTextureDataExc( file ) );
+
+	DdsFixture volume;
+	volume.width = 4;
+	volume.height = 4;
+	volume.depth = 4;
+	volume.mipMapCount = 2;
+	volume.caps2 = DDSCAPS2_VOLUME;
+	// 4x4x4 then 2x2x2 texels
+	file = volume.build( 256 + 32 );
+	source = gx::parseDds( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_3D );
+	CHECK( source.desc.Depth == 4 );
+	CHECK( source.desc.ArraySize == 1 );
+	REQUIRE( source.subresources.size() == 2 );
+	CHECK( checkSubresource( source.subresources[0], file, kHeaderSize, 16, 64 ) );
+	CHECK( checkSubresource( source.subresources[1], file, kHeaderSize + 256, 8, 16 ) );
+}
+
+TEST_CASE( "parseDds reads DX10 arrays and cubemaps" )
+{
+	DdsFixture array;
+	array.dx10 = true;
+	array.dxgiFormat = 98;
+	array.width = 16;
+	array.height = 16;
+	array.arraySize = 3;
+	// 4x4 blocks of 16 bytes per slice
+	vector<uint8_t> file = array.build( 3 * 256 );
+	gx::TextureSourceData source = gx::parseDds( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_2D_ARRAY );
+	CHECK( source.desc.Format == gx::TEX_FORMAT_BC7_UNORM );
+	CHECK( source.desc.ArraySize == 3 );
+	CHECK( source.desc.MipLevels == 1 );
+	REQUIRE( source.subresources.size() == 3 );
+	for( size_t slice = 0; slice < 3; ++slice ) {
+		CHECK( checkSubresource( source.subresources[slice], file, kDx10HeaderSize + slice * 256, 64, 256 ) );
+	}
+
+	// DX10 files store their colorspace, the desc doesn't change it
+	array.dxgiFormat = 99;
+	array.arraySize = 1;
+	file = array.build( 256 );
+	source = gx::parseDds( file.data(), file.size(), gx::TextureDesc().srgb( false ) );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_2D );
+	CHECK( source.desc.Format == gx::TEX_FORMAT_BC7_UNORM_SRGB );
+
+	DdsFixture cubeArray;
+	cubeArray.dx10 = true;
+	cubeArray.width = 2;
+	cubeArray.height = 2;
+	cubeArray.mipMapCount = 2;
+	cubeArray.miscFlag = 0x4;
+	cubeArray.arraySize = 2;
+	file = cubeArray.build( 12 * ( 16 + 4 ) );
+	source = gx::parseDds( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_CUBE_ARRAY );
+	CHECK( source.desc.Format == gx::TEX_FORMAT_RGBA8_UNORM );
+	CHECK( source.desc.ArraySize == 12 );
+	REQUIRE( source.subresources.size() == 24 );
+	CHECK( checkSubresource( source.subresources[23], file, kDx10HeaderSize + 11 * 20 + 16, 4, 4 ) );
+}
+
+TEST_CASE( "parseDds rejects invalid, truncated and unsupported files" )
+{
+	DdsFixture fixture;
+	fixture.width = 4;
+	fixture.height = 4;
+	fixture.mipMapCount = 3;
+	const vector<uint8_t> file = fixture.build( 64 + 16 + 4 );
+	CHECK( ! throwsTextureDataExc( file ) );
+
+	// magic, header sizes and truncation anywhere in the header or the data
+	vector<uint8_t> corrupted = file;
+	corrupted[0] = 'X';
+	CHECK( throwsTextureDataExc( corrupted ) );
+	corrupted = file;
+	corrupted[4] = 100;
+	CHECK( throwsTextureDataExc( corrupted ) );
+	corrupted = file;
+	corrupted[4 + 72] = 24;
+	CHECK( throwsTextureDataExc( corrupted ) );
+	for( size_t size : { size_t( 0 ), size_t( 3 ), size_t( 64 ), kHeaderSize - 1, kHeaderSize, file.size() - 1 } ) {
+		CHECK( throwsTextureDataExc( vector<uint8_t>( file.begin(), file.begin() + size ) ) );
+	}
+
+	// mip counts beyond the full chain, an empty texture and huge array sizes
+	DdsFixture mips = fixture;
+	mips.mipMapCount = 4;
+	CHECK( throwsTextureDataExc( mips.build( 1024 ) ) );
+	mips.mipMapCount = 0xFFFFFFFF;
+	CHECK( throwsTextureDataExc( mips.build( 1024 ) ) );
+	DdsFixture empty = fixture;
+	empty.width = 0;
+	CHECK( throwsTextureDataExc( empty.build( 1024 ) ) );
+	DdsFixture array;
+	array.dx10 = true;
+	array.arraySize = 0x40000000;
+	CHECK( throwsTextureDataExc( array.build( 1024 ) ) );
+	array.arraySize = 1;
+	const vector<uint8_t> dx10File = array.build( 4 );
+	CHECK( ! throwsTextureDataExc( dx10File ) );
+	CHECK( throwsTextureDataExc( vector<uint8_t>( dx10File.begin(), dx10File.begin() + kDx10HeaderSize - 1 ) ) );
+
+	// formats
+	DdsFixture format = fixture;
+	format.rgbBitCount = 24;
+	CHECK( throwsTextureDataExc( format.build( 1024 ) ) );
+	format.pixelFormatFlags = DDPF_FOURCC;
+	format.fourCC = makeFourCC( 'A', 'B', 'C', 'D' );
+	CHECK( throwsTextureDataExc( format.build( 1024 ) ) );
+	array.dxgiFormat = 1000;
+	CHECK( throwsTextureDataExc( array.build( 1024 ) ) );
+}
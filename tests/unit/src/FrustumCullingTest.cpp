@@ -0,0 +1,89 @@
+#include "cinder/graphics/Batch.h"
+#include "cinder/Camera.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	enum class Visibility { INSIDE, OUTSIDE, AMBIGUOUS };
+
+	//! Scalar reference testing the box corner furthest along each plane normal. Boxes within \a epsilon of deciding a plane are ambiguous, the float rounding of both tests can go either way.
+	Visibility classify( const Frustum &frustum, const AxisAlignedBox &box, float epsilon = 1e-3f )
+	{
+		Visibility visibility = Visibility::INSIDE;
+		for( int i = 0; i < 6; ++i ) {
+			const Plane &plane = frustum.getPlane( static_cast<Frustum::FrustumSection>( i ) );
+			vec3 corner;
+			for( int c = 0; c < 3; ++c ) {
+				corner[c] = plane.getNormal()[c] >= 0.0f ? box.getMax()[c] : box.getMin()[c];
+			}
+			const float distance = plane.distance( corner );
+			if( distance < -epsilon ) {
+				return Visibility::OUTSIDE;
+			}
+			if( distance <= epsilon ) {
+				visibility = Visibility::AMBIGUOUS;
+			}
+		}
+		return visibility;
+	}
+
+	CameraPersp makeCamera( const vec3 &eyePoint, const vec3 &target )
+	{
+		CameraPersp camera( 640, 480, 60.0f, 1.0f, 100.0f );
+		camera.lookAt( eyePoint, target );
+		return camera;
+	}
+} // anonymous namespace
+
+TEST_CASE( "FrustumPlanes culls the boxes outside of the frustum" )
+{
+	const Frustum frustum( makeCamera( vec3( 0.0f, 0.0f, 10.0f ), vec3( 0.0f ) ) );
+	const gx::Batch::FrustumPlanes planes( frustum );
+
+	// at the target, enclosing the camera and straddling the left plane
+	CHECK( planes.intersects( AxisAlignedBox( vec3( -1.0f ), vec3( 1.0f ) ) ) );
+	CHECK( planes.intersects( AxisAlignedBox( vec3( -200.0f ), vec3( 200.0f ) ) ) );
+	CHECK( planes.intersects( AxisAlignedBox( vec3( -40.0f, -1.0f, -10.0f ), vec3( -5.0f, 1.0f, -8.0f ) ) ) );
+	// behind the camera, closer than the near plane, past the far plane and beside the frustum
+	CHECK( ! planes.intersects( AxisAlignedBox( vec3( -1.0f, -1.0f, 12.0f ), vec3( 1.0f, 1.0f, 14.0f ) ) ) );
+	CHECK( ! planes.intersects( AxisAlignedBox( vec3( -0.1f, -0.1f, 9.5f ), vec3( 0.1f, 0.1f, 9.9f ) ) ) );
+	CHECK( ! planes.intersects( AxisAlignedBox( vec3( -1.0f, -1.0f, -120.0f ), vec3( 1.0f, 1.0f, -100.0f ) ) ) );
+	CHECK( ! planes.intersects( AxisAlignedBox( vec3( 30.0f, -1.0f, -10.0f ), vec3( 40.0f, 1.0f, -8.0f ) ) ) );
+	// degenerate boxes are points
+	CHECK( planes.intersects( AxisAlignedBox( vec3( 0.0f, 0.0f, -50.0f ), vec3( 0.0f, 0.0f, -50.0f ) ) ) );
+	CHECK( ! planes.intersects( AxisAlignedBox( vec3( 0.0f, 0.0f, 50.0f ), vec3( 0.0f, 0.0f, 50.0f ) ) ) );
+}
+
+TEST_CASE( "FrustumPlanes matches the scalar reference on random boxes" )
+{
+	mt19937 rng( 1 );
+	uniform_real_distribution<float> position( -60.0f, 60.0f ), size( 0.0f, 8.0f );
+	for( const CameraPersp &camera : { makeCamera( vec3( 0.0f, 0.0f, 10.0f ), vec3( 0.0f ) ), makeCamera( vec3( 3.0f, -4.0f, 7.0f ), vec3( 1.0f, 2.0f, -3.0f ) ), makeCamera( vec3( -20.0f, 15.0f, -5.0f ), vec3( 10.0f, -10.0f, 30.0f ) ) } ) {
+		const Frustum frustum( camera );
+		const gx::Batch::FrustumPlanes planes( frustum );
+		size_t numInside = 0, numOutside = 0;
+		for( int i = 0; i < 10000; ++i ) {
+			const vec3 minimum( position( rng ), position( rng ), position( rng ) );
+			const AxisAlignedBox box( minimum, minimum + vec3( size( rng ), size( rng ), size( rng ) ) );
+			const Visibility visibility = classify( frustum, box );
+			if( visibility == Visibility::AMBIGUOUS ) {
+				continue;
+			}
+			REQUIRE( planes.intersects( box ) == ( visibility == Visibility::INSIDE ) );
+			if( visibility == Visibility::INSIDE ) {
+				++numInside;
+			}
+			else {
+				++numOutside;
+			}
+		}
+		// both outcomes must be well represented for the comparison to mean anything
+		CHECK( numInside > 500 );
+		CHECK( numOutside > 500 );
+	}
+}
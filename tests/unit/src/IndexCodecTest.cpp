@@ -0,0 +1,136 @@
+#include "cinder/graphics/MeshOptimizer.h"
+
+#include "TestMeshes.h"
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	//! Encodes \a indices, decodes them back as \a T and returns whether the same triangles came out
+	template<typename T>
+	bool roundTrip( const vector<uint32_t> &indices )
+	{
+		vector<uint8_t> buffer( gx::encodeIndexBufferBound( indices.size() ) );
+		const size_t size = gx::encodeIndexBuffer( buffer.data(), buffer.size(), indices.data(), indices.size() );
+		if( ! size || size > buffer.size() ) {
+			return false;
+		}
+
+		vector<T> decoded( indices.size() );
+		if( ! gx::decodeIndexBuffer( decoded.data(), decoded.size(), sizeof( T ), buffer.data(), size ) ) {
+			return false;
+		}
+		return testmeshes::getTriangleSet( decoded.data(), decoded.size() ) == testmeshes::getTriangleSet( indices.data(), indices.size() );
+	}
+
+	bool roundTripBoth( const vector<uint32_t> &indices )
+	{
+		return roundTrip<uint32_t>( indices ) && roundTrip<uint16_t>( indices );
+	}
+} // anonymous namespace
+
+TEST_CASE( "index codec round trips a single triangle" )
+{
+	CHECK( roundTripBoth( { 0, 1, 2 } ) );
+	CHECK( roundTripBoth( { 2, 1, 0 } ) );
+	CHECK( roundTripBoth( { 7, 3, 5 } ) );
+}
+
+TEST_CASE( "index codec round trips degenerate triangles" )
+{
+	CHECK( roundTripBoth( { 0, 0, 0 } ) );
+	CHECK( roundTripBoth( { 1, 1, 2 } ) );
+	CHECK( roundTripBoth( { 3, 4, 3 } ) );
+	CHECK( roundTripBoth( { 0, 1, 2, 2, 1, 1, 2, 1, 3, 3, 3, 3, 0, 1, 2 } ) );
+}
+
+TEST_CASE( "index codec round trips indices at and above 65535" )
+{
+	CHECK( roundTripBoth( { 65533, 65534, 65535 } ) );
+	CHECK( roundTripBoth( { 0, 65535, 1, 65535, 0, 2 } ) );
+	CHECK( roundTrip<uint32_t>( { 65535, 65536, 65537 } ) );
+	CHECK( roundTrip<uint32_t>( { 0, 70000, 1, 70000, 0, 0xFFFFFFFEu } ) );
+	CHECK( roundTrip<uint32_t>( { 0x80000000u, 0xFFFFFFFFu, 0, 0xFFFFFFFFu, 0x80000000u, 1 } ) );
+}
+
+TEST_CASE( "index codec round trips meshes" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makeSphere( 64, 32, &positions, &indices );
+	CHECK( roundTripBoth( indices ) );
+
+	// the codec is designed for optimized meshes, which it compresses well below 16-bit indices
+	gx::optimizeVertexCache( indices.data(), indices.data(), indices.size(), positions.size() );
+	vector<uint32_t> remap( positions.size() );
+	gx::optimizeVertexFetchRemap( remap.data(), indices.data(), indices.size(), positions.size() );
+	CHECK( roundTripBoth( indices ) );
+	vector<uint8_t> buffer( gx::encodeIndexBufferBound( indices.size() ) );
+	const size_t size = gx::encodeIndexBuffer( buffer.data(), buffer.size(), indices.data(), indices.size() );
+	CHECK( size > 0 );
+	CHECK( size < indices.size() * sizeof( uint16_t ) / 2 );
+
+	// random triangles referencing a large vertex range
+	mt19937 rng( 3 );
+	vector<uint32_t> random( 3000 );
+	for( uint32_t &index : random ) {
+		index = rng() % 1000000;
+	}
+	CHECK( roundTrip<uint32_t>( random ) );
+}
+
+TEST_CASE( "index codec rejects small and malformed buffers" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makePlane( 8, 8, &positions, &indices );
+
+	const size_t bound = gx::encodeIndexBufferBound( indices.size() );
+	vector<uint8_t> buffer( bound );
+	CHECK( gx::encodeIndexBuffer( buffer.data(), bound - 1, indices.data(), indices.size() ) == 0 );
+	const size_t size = gx::encodeIndexBuffer( buffer.data(), bound, indices.data(), indices.size() );
+	REQUIRE( size > 0 );
+
+	vector<uint32_t> decoded( indices.size() );
+	CHECK( gx::decodeIndexBuffer( decoded.data(), decoded.size(), sizeof( uint32_t ), buffer.data(), size ) );
+	CHECK( ! gx::decodeIndexBuffer( decoded.data(), decoded.size(), sizeof( uint32_t ), buffer.data(), size / 2 ) );
+	CHECK( ! gx::decodeIndexBuffer( decoded.data(), decoded.size(), sizeof( uint32_t ), buffer.data(), 0 ) );
+}
+
+TEST_CASE( "calcMaxIndex finds the maximum at every position of every length" )
+{
+	// lengths around the 8 indices processed per SIMD iteration, with the maximum in the vector body and in the scalar tail
+	for( size_t count = 1; count <= 35; ++count ) {
+		for( size_t position = 0; position < count; ++position ) {
+			for( uint32_t maximum : { 1u, 65535u, 65536u, 0x7FFFFFFFu, 0x80000000u, 0xFFFFFFFFu } ) {
+				vector<uint32_t> indices( count, 0 );
+				indices[position] = maximum;
+				REQUIRE( gx::calcMaxIndex( indices.data(), count ) == maximum );
+			}
+		}
+	}
+	CHECK( gx::calcMaxIndex( nullptr, 0 ) == 0 );
+}
+
+TEST_CASE( "narrowIndices copies every index of every length" )
+{
+	mt19937 rng( 11 );
+	for( size_t count = 0; count <= 35; ++count ) {
+		// the whole 16-bit range, including the values the signed saturation of the SIMD path would clamp
+		vector<uint32_t> indices( count );
+		for( size_t i = 0; i < count; ++i ) {
+			const uint32_t edges[] = { 0, 1, 32767, 32768, 32769, 65534, 65535 };
+			indices[i] = i < 7 ? edges[( i + count ) % 7] : rng() % 65536;
+		}
+		// a guard after the destination catches writes past count
+		vector<uint16_t> narrowed( count + 1, 0xABCD );
+		gx::narrowIndices( indices.data(), count, narrowed.data() );
+		for( size_t i = 0; i < count; ++i ) {
+			REQUIRE( narrowed[i] == indices[i] );
+		}
+		CHECK( narrowed[count] == 0xABCD );
+	}
+}
@@ -0,0 +1,298 @@
+#include "cinder/graphics/Texture.h"
+
+#include "UnitTest.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	const size_t kHeaderSize		= 80;
+	const size_t kLevelIndexSize	= 24;
+	const uint32_t VK_FORMAT_R8G8B8A8_UNORM	= 37;
+	const uint32_t VK_FORMAT_R8G8B8A8_SRGB	= 43;
+	const uint32_t VK_FORMAT_BC7_UNORM		= 145;
+
+	//! In memory KTX2 file. The levels are stored after the level index from the smallest to the largest, as the specification recommends.
+	struct Ktx2Fixture {
+		uint32_t			vkFormat = VK_FORMAT_R8G8B8A8_UNORM, width = 1, height = 1, depth = 0, layerCount = 0, faceCount = 1, supercompressionScheme = 0;
+		//! Byte length of each level, mip 0 first
+		vector<uint64_t>	levelSizes = { 4 };
+
+		//! Returns the file, \a levelOffsets receives the offset of each level. Byte i of a level is i % 251.
+		vector<uint8_t> build( vector<size_t>* levelOffsets = nullptr ) const
+		{
+			const uint32_t numLevels = static_cast<uint32_t>( levelSizes.size() );
+			size_t size = kHeaderSize + numLevels * kLevelIndexSize;
+			vector<size_t> offsets( numLevels );
+			for( uint32_t level = numLevels; level-- > 0; ) {
+				offsets[level] = size;
+				size += static_cast<size_t>( levelSizes[level] );
+			}
+
+			vector<uint8_t> bytes( size, 0 );
+			const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+			memcpy( bytes.data(), identifier, sizeof( identifier ) );
+			const uint32_t fields[9] = { vkFormat, 1, width, height, depth, layerCount, faceCount, numLevels, supercompressionScheme };
+			memcpy( bytes.data() + 12, fields, sizeof( fields ) );
+			for( uint32_t level = 0; level < numLevels; ++level ) {
+				const uint64_t index[3] = { offsets[level], levelSizes[level], levelSizes[level] };
+				memcpy( bytes.data() + kHeaderSize + level * kLevelIndexSize, index, sizeof( index ) );
+				for( uint64_t i = 0; i < levelSizes[level]; ++i ) {
+					bytes[offsets[level] + i] = static_cast<uint8_t>( i % 251 );
+				}
+			}
+			if( levelOffsets ) {
+				*levelOffsets = offsets;
+			}
+			return bytes;
+		}
+	};
+
+	//! Overwrites the uint64 field \a field of the level index entry of \a level
+	void setLevelIndex( vector<uint8_t>* file, uint32_t level, uint32_t field, uint64_t value )
+	{
+		memcpy( file->data() + kHeaderSize + level * kLevelIndexSize + field * sizeof( uint64_t ), &value, sizeof( value ) );
+	}
+
+	//! Returns whether \a subresource starts \a offset bytes into \a file with the given strides
+	bool checkSubresource( const gx::TextureSubResData &subresource, const vector<uint8_t> &file, size_t offset, uint64_t stride, uint64_t depthStride )
+	{
+		return subresource.pData == file.data() + offset && subresource.Stride == stride && subresource.DepthStride == depthStride;
+	}
+
+#if defined( CINDER_GX_ZSTD )
+	//! Wraps \a data in a single segment zstd frame of one raw block, or of one RLE block repeating its first byte. Sizes are limited to 255 bytes.
+	vector<uint8_t> makeZstdFrame( const vector<uint8_t> &data, bool rle )
+	{
+		const uint32_t blockHeader = static_cast<uint32_t>( data.size() ) << 3 | ( rle ? 1u : 0u ) << 1 | 1u;
+		vector<uint8_t> frame = { 0x28, 0xB5, 0x2F, 0xFD, 0x20, static_cast<uint8_t>( data.size() ) };
+		frame.push_back( static_cast<uint8_t>( blockHeader ) );
+		frame.push_back( static_cast<uint8_t>( blockHeader >> 8 ) );
+		frame.push_back( static_cast<uint8_t>( blockHeader >> 16 ) );
+		frame.insert( frame.end(), data.begin(), rle ? data.begin() + 1 : data.end() );
+		return frame;
+	}
+#endif
+
+	bool throwsTextureDataExc( const vector<uint8_t> &file )
+	{
+		try {
+			gx::parseKtx2( file.data(), file.size() );
+		}
+		catch( const gx::TextureDataExc & ) {
+			return true;
+		}
+		return false;
+	}
+} // anonymous namespace
+
+TEST_CASE( "parseKtx2 reads an uncompressed 2D file with mips" )
+{
+	Ktx2Fixture fixture;
+	fixture.width = 4;
+	fixture.height = 2;
+	fixture.levelSizes = { 32, 8, 4 };
+	vector<size_t> offsets;
+	const vector<uint8_t> file = fixture.build( &offsets );
+
+	const gx::TextureSourceData source = gx::parseKtx2( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_2D );
+	CHECK( source.desc.Format == gx::TEX_FORMAT_RGBA8_UNORM );
+	CHECK( source.desc.Width == 4 );
+	CHECK( source.desc.Height == 2 );
+	CHECK( source.desc.ArraySize == 1 );
+	CHECK( source.desc.MipLevels == 3 );
+	CHECK( source.storage.empty() );
+	REQUIRE( source.subresources.size() == 3 );
+	CHECK( checkSubresource( source.subresources[0], file, offsets[0], 16, 32 ) );
+	CHECK( checkSubresource( source.subresources[1], file, offsets[1], 8, 8 ) );
+	CHECK( checkSubresource( source.subresources[2], file, offsets[2], 4, 4 ) );
+
+	// KTX2 files store their colorspace
+	Ktx2Fixture srgb = fixture;
+	srgb.vkFormat = VK_FORMAT_R8G8B8A8_SRGB;
+	const vector<uint8_t> srgbFile = srgb.build();
+	CHECK( gx::parseKtx2( srgbFile.data(), srgbFile.size(), gx::TextureDesc().srgb( false ) ).desc.Format == gx::TEX_FORMAT_RGBA8_UNORM_SRGB );
+}
+
+TEST_CASE( "parseKtx2 reads block compressed, array, cube and volume files" )
+{
+	Ktx2Fixture bc7;
+	bc7.vkFormat = VK_FORMAT_BC7_UNORM;
+	bc7.width = 8;
+	bc7.height = 8;
+	// 2x2 then 1x1 blocks of 16 bytes
+	bc7.levelSizes = { 64, 16 };
+	vector<size_t> offsets;
+	vector<uint8_t> file = bc7.build( &offsets );
+	gx::TextureSourceData source = gx::parseKtx2( file.data(), file.size() );
+	CHECK( source.desc.Format == gx::TEX_FORMAT_BC7_UNORM );
+	REQUIRE( source.subresources.size() == 2 );
+	CHECK( checkSubresource( source.subresources[0], file, offsets[0], 32, 64 ) );
+	CHECK( checkSubresource( source.subresources[1], file, offsets[1], 16, 16 ) );
+
+	// each level stores its layers tightly packed
+	Ktx2Fixture array;
+	array.width = 2;
+	array.height = 2;
+	array.layerCount = 3;
+	array.levelSizes = { 3 * 16, 3 * 4 };
+	file = array.build( &offsets );
+	source = gx::parseKtx2( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_2D_ARRAY );
+	CHECK( source.desc.ArraySize == 3 );
+	REQUIRE( source.subresources.size() == 6 );
+	for( size_t layer = 0; layer < 3; ++layer ) {
+		CHECK( checkSubresource( source.subresources[layer * 2], file, offsets[0] + layer * 16, 8, 16 ) );
+		CHECK( checkSubresource( source.subresources[layer * 2 + 1], file, offsets[1] + layer * 4, 4, 4 ) );
+	}
+
+	Ktx2Fixture cube;
+	cube.width = 2;
+	cube.height = 2;
+	cube.faceCount = 6;
+	cube.levelSizes = { 6 * 16, 6 * 4 };
+	file = cube.build( &offsets );
+	source = gx::parseKtx2( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_CUBE );
+	CHECK( source.desc.ArraySize == 6 );
+	REQUIRE( source.subresources.size() == 12 );
+	CHECK( checkSubresource( source.subresources[5 * 2 + 1], file, offsets[1] + 5 * 4, 4, 4 ) );
+
+	cube.layerCount = 2;
+	cube.levelSizes = { 12 * 16, 12 * 4 };
+	file = cube.build( &offsets );
+	source = gx::parseKtx2( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_CUBE_ARRAY );
+	CHECK( source.desc.ArraySize == 12 );
+	CHECK( source.subresources.size() == 24 );
+
+	// volume levels store all their depth slices in one image
+	Ktx2Fixture volume;
+	volume.width = 4;
+	volume.height = 4;
+	volume.depth = 4;
+	volume.levelSizes = { 256, 32 };
+	file = volume.build( &offsets );
+	source = gx::parseKtx2( file.data(), file.size() );
+	CHECK( source.desc.Type == gx::RESOURCE_DIM_TEX_3D );
+	CHECK( source.desc.Depth == 4 );
+	CHECK( source.desc.ArraySize == 1 );
+	REQUIRE( source.subresources.size() == 2 );
+	CHECK( checkSubresource( source.subresources[0], file, offsets[0], 16, 64 ) );
+	CHECK( checkSubresource( source.subresources[1], file, offsets[1], 8, 16 ) );
+}
+
+TEST_CASE( "parseKtx2 rejects invalid and truncated files" )
+{
+	Ktx2Fixture fixture;
+	fixture.width = 4;
+	fixture.height = 4;
+	fixture.levelSizes = { 64, 16, 4 };
+	const vector<uint8_t> file = fixture.build();
+	CHECK( ! throwsTextureDataExc( file ) );
+
+	vector<uint8_t> corrupted = file;
+	corrupted[5] = 'X';
+	CHECK( throwsTextureDataExc( corrupted ) );
+	for( size_t size : { size_t( 0 ), size_t( 12 ), kHeaderSize - 1, kHeaderSize, kHeaderSize + 3 * kLevelIndexSize - 1 } ) {
+		CHECK( throwsTextureDataExc( vector<uint8_t>( file.begin(), file.begin() + size ) ) );
+	}
+	// mip 0 is stored last, any truncation cuts it
+	CHECK( throwsTextureDataExc( vector<uint8_t>( file.begin(), file.end() - 1 ) ) );
+
+	// level lengths shorter than the texture needs, and offsets past or wrapping around the end of the file
+	corrupted = file;
+	setLevelIndex( &corrupted, 1, 1, 15 );
+	CHECK( throwsTextureDataExc( corrupted ) );
+	corrupted = file;
+	setLevelIndex( &corrupted, 2, 0, file.size() );
+	CHECK( throwsTextureDataExc( corrupted ) );
+	corrupted = file;
+	setLevelIndex( &corrupted, 0, 0, ~uint64_t( 0 ) - 8 );
+	CHECK( throwsTextureDataExc( corrupted ) );
+
+	// face counts, level counts beyond the full chain, empty textures and huge layer counts
+	Ktx2Fixture faces = fixture;
+	faces.faceCount = 2;
+	CHECK( throwsTextureDataExc( faces.build() ) );
+	Ktx2Fixture mips = fixture;
+	mips.levelSizes = { 64, 16, 4, 4 };
+	CHECK( throwsTextureDataExc( mips.build() ) );
+	Ktx2Fixture empty = fixture;
+	empty.width = 0;
+	CHECK( throwsTextureDataExc( empty.build() ) );
+	Ktx2Fixture layers = fixture;
+	layers.layerCount = 0x40000000;
+	CHECK( throwsTextureDataExc( layers.build() ) );
+}
+
+TEST_CASE( "parseKtx2 rejects unsupported formats and supercompression schemes" )
+{
+	Ktx2Fixture fixture;
+	fixture.width = 2;
+	fixture.height = 2;
+	fixture.levelSizes = { 16, 4 };
+	CHECK( ! throwsTextureDataExc( fixture.build() ) );
+
+	Ktx2Fixture format = fixture;
+	format.vkFormat = 0;
+	CHECK( throwsTextureDataExc( format.build() ) );
+	format.vkFormat = 1000;
+	CHECK( throwsTextureDataExc( format.build() ) );
+
+	// Basis Universal files need CINDER_GX_WITH_BASISU, and these levels aren't valid Basis data anyway
+	Ktx2Fixture basis = fixture;
+	basis.supercompressionScheme = 1;
+	CHECK( throwsTextureDataExc( basis.build() ) );
+
+	// zstd files need CINDER_GX_WITH_ZSTD, and an uncompressed size other than the level size is rejected before inflating
+	Ktx2Fixture zstd = fixture;
+	zstd.supercompressionScheme = 2;
+	vector<uint8_t> file = zstd.build();
+	setLevelIndex( &file, 0, 2, 1ull << 40 );
+	CHECK( throwsTextureDataExc( file ) );
+
+	Ktx2Fixture scheme = fixture;
+	scheme.supercompressionScheme = 3;
+	CHECK( throwsTextureDataExc( scheme.build() ) );
+}
+
+#if defined( CINDER_GX_ZSTD )
+TEST_CASE( "parseKtx2 inflates zstd supercompressed levels" )
+{
+	vector<uint8_t> mip0( 64 ), mip1( 16, 0x5A );
+	for( size_t i = 0; i < mip0.size(); ++i ) {
+		mip0[i] = static_cast<uint8_t>( i * 7 );
+	}
+	const vector<uint8_t> frames[2] = { makeZstdFrame( mip0, false ), makeZstdFrame( mip1, true ) };
+
+	Ktx2Fixture fixture;
+	fixture.width = 4;
+	fixture.height = 4;
+	fixture.supercompressionScheme = 2;
+	fixture.levelSizes = { frames[0].size(), frames[1].size() };
+	vector<size_t> offsets;
+	vector<uint8_t> file = fixture.build( &offsets );
+	for( uint32_t level = 0; level < 2; ++level ) {
+		memcpy( file.data() + offsets[level], frames[level].data(), frames[level].size() );
+	}
+	setLevelIndex( &file, 0, 2, mip0.size() );
+	setLevelIndex( &file, 1, 2, mip1.size() );
+
+	const gx::TextureSourceData source = gx::parseKtx2( file.data(), file.size() );
+	REQUIRE( source.storage.size() == 2 );
+	CHECK( source.storage[0] == mip0 );
+	CHECK( source.storage[1] == mip1 );
+	REQUIRE( source.subresources.size() == 2 );
+	CHECK( source.subresources[0].pData == source.storage[0].data() && source.subresources[0].Stride == 16 );
+	CHECK( source.subresources[1].pData == source.storage[1].data() && source.subresources[1].Stride == 8 );
+
+	// a corrupted frame fails to inflate
+	file[offsets[1]] = 0;
+	CHECK( throwsTextureDataExc( file ) );
+}
+#endif
@@ -0,0 +1,223 @@
+#include "cinder/graphics/Mesh.h"
+
+#include "TestMeshes.h"
+#include "UnitTest.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	//! Byte offsets of the header fields patched by the tests, shared by every version of the format
+	const size_t kVersionOffset = 8;
+	const size_t kBoundingRadiusOffset = 36;
+
+	template<typename T>
+	vector<uint8_t> toBytes( const vector<T> &values )
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>( values.data() );
+		return vector<uint8_t>( bytes, bytes + values.size() * sizeof( T ) );
+	}
+
+	//! Plane with interleaved positions and normals, separate 16-bit texture coordinates and a level of detail appended to the indices
+	gx::Mesh::SourceData makePlaneData( bool use16BitIndices )
+	{
+		vector<vec3> positions;
+		vector<uint32_t> indices;
+		testmeshes::makePlane( 8, 8, &positions, &indices );
+
+		vector<vec3> interleaved;
+		vector<uint16_t> texCoords;
+		for( const vec3 &position : positions ) {
+			interleaved.push_back( position );
+			interleaved.push_back( vec3( 0.0f, 0.0f, 1.0f ) );
+			texCoords.push_back( static_cast<uint16_t>( position.x * 65535.0f ) );
+			texCoords.push_back( static_cast<uint16_t>( position.y * 65535.0f ) );
+		}
+
+		gx::Mesh::SourceData data;
+		data.vertexBuffers.push_back( { gx::Mesh::BufferInfo()
+			.attrib( geom::POSITION, 3, 2 * sizeof( vec3 ), 0 )
+			.attrib( geom::NORMAL, 3, 2 * sizeof( vec3 ), sizeof( vec3 ) )
+			.name( "positions and normals" ), toBytes( interleaved ) } );
+		// a single non-interleaved attribute has a 0 stride
+		data.vertexBuffers.push_back( { gx::Mesh::BufferInfo()
+			.attrib( geom::TEX_COORD_0, 2, 0, 0 )
+			.attribFormat( geom::TEX_COORD_0, gx::Mesh::AttribFormat::UNORM16 )
+			.bindFlags( gx::BIND_VERTEX_BUFFER | gx::BIND_SHADER_RESOURCE ), toBytes( texCoords ) } );
+
+		const uint32_t numIndices = static_cast<uint32_t>( indices.size() );
+		data.indices = indices;
+		// the second level only keeps the first half of the triangles
+		data.indices.insert( data.indices.end(), indices.begin(), indices.begin() + numIndices / 2 );
+		data.lods = { { 0, numIndices, 0.0f }, { numIndices, numIndices / 2, 0.25f } };
+		data.use16BitIndices = use16BitIndices;
+		data.numVertices = static_cast<uint32_t>( positions.size() );
+		data.bounds = AxisAlignedBox( vec3( 0.0f ), vec3( 1.0f, 1.0f, 0.0f ) );
+		data.boundingSphere = Sphere( vec3( 0.5f, 0.5f, 0.0f ), 0.75f );
+		data.positionScale = vec3( 2.0f, 3.0f, 4.0f );
+		data.positionOffset = vec3( -1.0f, 0.5f, 0.0f );
+		return data;
+	}
+
+	fs::path getTestPath()
+	{
+		return fs::temp_directory_path() / "cinder-gx-mesh-file-test.mesh";
+	}
+
+	vector<uint8_t> readFile( const fs::path &path )
+	{
+		ifstream file( path.string(), ios::binary );
+		return vector<uint8_t>( istreambuf_iterator<char>( file ), istreambuf_iterator<char>() );
+	}
+
+	void writeFile( const fs::path &path, const vector<uint8_t> &bytes )
+	{
+		ofstream file( path.string(), ios::binary | ios::trunc );
+		file.write( reinterpret_cast<const char*>( bytes.data() ), bytes.size() );
+	}
+
+	template<typename T>
+	void writeField( vector<uint8_t> *bytes, size_t offset, T value )
+	{
+		memcpy( bytes->data() + offset, &value, sizeof( T ) );
+	}
+
+	bool loadThrows( const fs::path &path )
+	{
+		try {
+			gx::Mesh::loadSource( path );
+		}
+		catch( const gx::MeshDataExc & ) {
+			return true;
+		}
+		return false;
+	}
+
+	void checkSameBuffers( const gx::Mesh::SourceData &loaded, const gx::Mesh::SourceData &data )
+	{
+		REQUIRE( loaded.vertexBuffers.size() == data.vertexBuffers.size() );
+		for( size_t i = 0; i < data.vertexBuffers.size(); ++i ) {
+			const gx::Mesh::BufferInfo &info = loaded.vertexBuffers[i].first, &expected = data.vertexBuffers[i].first;
+			CHECK( loaded.vertexBuffers[i].second == data.vertexBuffers[i].second );
+			CHECK( info.getName() == expected.getName() );
+			CHECK( info.getBindFlags() == expected.getBindFlags() );
+			REQUIRE( info.getAttribs().size() == expected.getAttribs().size() );
+			for( size_t a = 0; a < expected.getAttribs().size(); ++a ) {
+				const geom::AttribInfo &attrib = info.getAttribs()[a], &expectedAttrib = expected.getAttribs()[a];
+				CHECK( attrib.getAttrib() == expectedAttrib.getAttrib() );
+				CHECK( attrib.getDims() == expectedAttrib.getDims() );
+				CHECK( attrib.getStride() == expectedAttrib.getStride() );
+				CHECK( attrib.getOffset() == expectedAttrib.getOffset() );
+				CHECK( info.getAttribFormat( attrib.getAttrib() ) == expected.getAttribFormat( expectedAttrib.getAttrib() ) );
+			}
+		}
+	}
+} // anonymous namespace
+
+TEST_CASE( "loadSource reads back what save wrote" )
+{
+	const fs::path path = getTestPath();
+	for( bool use16BitIndices : { true, false } ) {
+		const gx::Mesh::SourceData data = makePlaneData( use16BitIndices );
+		gx::Mesh::save( path, data );
+		const gx::Mesh::SourceData loaded = gx::Mesh::loadSource( path );
+
+		checkSameBuffers( loaded, data );
+		CHECK( loaded.indices == data.indices );
+		CHECK( loaded.use16BitIndices == use16BitIndices );
+		CHECK( loaded.numVertices == data.numVertices );
+		CHECK( loaded.primitive == geom::Primitive::TRIANGLES );
+		CHECK( loaded.bounds.getMin() == data.bounds.getMin() );
+		CHECK( loaded.bounds.getMax() == data.bounds.getMax() );
+		CHECK( loaded.boundingSphere.getRadius() == data.boundingSphere.getRadius() );
+		CHECK( loaded.positionScale == data.positionScale );
+		CHECK( loaded.positionOffset == data.positionOffset );
+		REQUIRE( loaded.lods.size() == data.lods.size() );
+		for( size_t i = 0; i < data.lods.size(); ++i ) {
+			CHECK( loaded.lods[i].firstIndex == data.lods[i].firstIndex );
+			CHECK( loaded.lods[i].numIndices == data.lods[i].numIndices );
+			CHECK( loaded.lods[i].error == data.lods[i].error );
+		}
+	}
+	fs::remove( path );
+}
+
+TEST_CASE( "loadSource decodes encoded indices of every level of detail" )
+{
+	const fs::path path = getTestPath();
+	for( bool use16BitIndices : { true, false } ) {
+		const gx::Mesh::SourceData data = makePlaneData( use16BitIndices );
+		gx::Mesh::save( path, data, true );
+		const gx::Mesh::SourceData loaded = gx::Mesh::loadSource( path );
+
+		checkSameBuffers( loaded, data );
+		REQUIRE( loaded.indices.size() == data.indices.size() );
+		// the codec may rotate the triangles but keeps the triangles of each level
+		for( const auto &lod : data.lods ) {
+			CHECK( testmeshes::getTriangleSet( loaded.indices.data() + lod.firstIndex, lod.numIndices ) == testmeshes::getTriangleSet( data.indices.data() + lod.firstIndex, lod.numIndices ) );
+		}
+	}
+	fs::remove( path );
+}
+
+TEST_CASE( "loadSource reads version 1 files" )
+{
+	const fs::path path = getTestPath();
+	const gx::Mesh::SourceData data = makePlaneData( true );
+	gx::Mesh::save( path, data );
+
+	// version 1 had no bounding radius, the field was reserved and written as 0
+	vector<uint8_t> bytes = readFile( path );
+	writeField<uint32_t>( &bytes, kVersionOffset, 1 );
+	writeField<float>( &bytes, kBoundingRadiusOffset, 0.0f );
+	writeFile( path, bytes );
+
+	const gx::Mesh::SourceData loaded = gx::Mesh::loadSource( path );
+	checkSameBuffers( loaded, data );
+	CHECK( loaded.indices == data.indices );
+	CHECK( loaded.lods.size() == data.lods.size() );
+	// the bounding sphere falls back to the sphere enclosing the bounds
+	CHECK( std::abs( loaded.boundingSphere.getRadius() - glm::length( data.bounds.getExtents() ) ) < 1e-6f );
+	fs::remove( path );
+}
+
+TEST_CASE( "loadSource rejects malformed files" )
+{
+	const fs::path path = getTestPath();
+	const gx::Mesh::SourceData data = makePlaneData( true );
+	gx::Mesh::save( path, data );
+	const vector<uint8_t> bytes = readFile( path );
+
+	vector<uint8_t> unsupported = bytes;
+	writeField<uint32_t>( &unsupported, kVersionOffset, 4 );
+	writeFile( path, unsupported );
+	CHECK( loadThrows( path ) );
+
+	writeFile( path, vector<uint8_t>( bytes.begin(), bytes.begin() + 64 ) );
+	CHECK( loadThrows( path ) );
+
+	// level of detail ranges past the stored indices, including ones overflowing 32 bits
+	const uint32_t numIndices = data.lods[1].numIndices;
+	const uint8_t* lod = nullptr;
+	// the buffer names leave the descriptions unaligned, the levels of detail are searched byte by byte
+	for( size_t offset = 0; offset + 2 * sizeof( uint32_t ) <= bytes.size(); ++offset ) {
+		const uint32_t values[] = { data.lods[1].firstIndex, numIndices };
+		if( memcmp( bytes.data() + offset, values, sizeof( values ) ) == 0 ) {
+			lod = bytes.data() + offset;
+			break;
+		}
+	}
+	REQUIRE( lod );
+	const size_t lodOffset = lod - bytes.data();
+	for( uint32_t badNumIndices : { numIndices + 3, 0xFFFFFFFFu } ) {
+		vector<uint8_t> badLod = bytes;
+		writeField<uint32_t>( &badLod, lodOffset + sizeof( uint32_t ), badNumIndices );
+		writeFile( path, badLod );
+		CHECK( loadThrows( path ) );
+	}
+	fs::remove( path );
+}
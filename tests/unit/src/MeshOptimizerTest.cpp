@@ -0,0 +1,251 @@
+#include "cinder/graphics/MeshOptimizer.h"
+
+#include "TestMeshes.h"
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	bool hasValidTriangles( const uint32_t* indices, size_t numIndices, size_t numVertices )
+	{
+		for( size_t i = 0; i < numIndices; i += 3 ) {
+			if( indices[i] >= numVertices || indices[i + 1] >= numVertices || indices[i + 2] >= numVertices ) {
+				return false;
+			}
+			if( indices[i] == indices[i + 1] || indices[i + 1] == indices[i + 2] || indices[i] == indices[i + 2] ) {
+				return false;
+			}
+		}
+		return true;
+	}
+} // anonymous namespace
+
+TEST_CASE( "simplify reaches the target index count on a plane" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makePlane( 32, 32, &positions, &indices );
+
+	// flat interiors collapse without error, only the border vertices have to stay
+	const size_t targetIndexCount = indices.size() / 4;
+	const float targetError = 0.01f;
+	vector<uint32_t> simplified( indices.size() );
+	float resultError = -1.0f;
+	const size_t numIndices = gx::simplify( simplified.data(), indices.data(), indices.size(), positions.data(), positions.size(), targetIndexCount, targetError, &resultError );
+
+	CHECK( numIndices % 3 == 0 );
+	CHECK( numIndices > 0 );
+	CHECK( numIndices <= targetIndexCount );
+	CHECK( resultError >= 0.0f );
+	CHECK( resultError <= targetError );
+	CHECK( hasValidTriangles( simplified.data(), numIndices, positions.size() ) );
+}
+
+TEST_CASE( "simplify stays within the error bound on a sphere" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makeSphere( 48, 24, &positions, &indices );
+
+	// a curved surface can't reach an empty target, the error bound stops the simplification first
+	for( float targetError : { 0.001f, 0.01f, 0.05f } ) {
+		vector<uint32_t> simplified( indices.size() );
+		float resultError = -1.0f;
+		const size_t numIndices = gx::simplify( simplified.data(), indices.data(), indices.size(), positions.data(), positions.size(), 0, targetError, &resultError );
+
+		CHECK( numIndices % 3 == 0 );
+		CHECK( numIndices > 0 );
+		CHECK( numIndices < indices.size() );
+		CHECK( resultError <= targetError );
+		CHECK( hasValidTriangles( simplified.data(), numIndices, positions.size() ) );
+	}
+}
+
+TEST_CASE( "simplify can run in place" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makePlane( 16, 16, &positions, &indices );
+
+	vector<uint32_t> expected( indices.size() );
+	const size_t expectedCount = gx::simplify( expected.data(), indices.data(), indices.size(), positions.data(), positions.size(), indices.size() / 2, 0.01f );
+	const size_t numIndices = gx::simplify( indices.data(), indices.data(), indices.size(), positions.data(), positions.size(), indices.size() / 2, 0.01f );
+
+	REQUIRE( numIndices == expectedCount );
+	CHECK( equal( indices.begin(), indices.begin() + numIndices, expected.begin() ) );
+}
+
+TEST_CASE( "optimizeVertexCache preserves the triangles and improves the ACMR" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makeSphere( 64, 32, &positions, &indices );
+
+	// shuffle the triangles so that the optimization has something to do
+	mt19937 rng( 42 );
+	vector<uint32_t> shuffled;
+	vector<size_t> order( indices.size() / 3 );
+	for( size_t i = 0; i < order.size(); ++i ) {
+		order[i] = i;
+	}
+	shuffle( order.begin(), order.end(), rng );
+	for( size_t triangle : order ) {
+		shuffled.insert( shuffled.end(), indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3 );
+	}
+
+	vector<uint32_t> optimized( shuffled.size() );
+	gx::optimizeVertexCache( optimized.data(), shuffled.data(), shuffled.size(), positions.size() );
+	CHECK( testmeshes::getTriangleSet( optimized.data(), optimized.size() ) == testmeshes::getTriangleSet( shuffled.data(), shuffled.size() ) );
+
+	const gx::VertexCacheStats before = gx::analyzeVertexCache( shuffled.data(), shuffled.size(), positions.size() );
+	const gx::VertexCacheStats after = gx::analyzeVertexCache( optimized.data(), optimized.size(), positions.size() );
+	CHECK( after.acmr < before.acmr );
+	CHECK( after.acmr < 1.0f );
+	CHECK( after.atvr >= 1.0f );
+
+	// in place
+	gx::optimizeVertexCache( shuffled.data(), shuffled.data(), shuffled.size(), positions.size() );
+	CHECK( shuffled == optimized );
+}
+
+TEST_CASE( "optimizeOverdraw preserves the triangles" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makeSphere( 32, 16, &positions, &indices );
+	gx::optimizeVertexCache( indices.data(), indices.data(), indices.size(), positions.size() );
+
+	vector<uint32_t> optimized( indices.size() );
+	gx::optimizeOverdraw( optimized.data(), indices.data(), indices.size(), positions.data(), positions.size() );
+	CHECK( testmeshes::getTriangleSet( optimized.data(), optimized.size() ) == testmeshes::getTriangleSet( indices.data(), indices.size() ) );
+}
+
+TEST_CASE( "optimizeVertexFetchRemap numbers vertices in order of first use" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makeSphere( 32, 16, &positions, &indices );
+	gx::optimizeVertexCache( indices.data(), indices.data(), indices.size(), positions.size() );
+
+	// an extra vertex nothing references
+	const size_t numVertices = positions.size() + 1;
+	const vector<uint32_t> original = indices;
+	vector<uint32_t> remap( numVertices );
+	const size_t numUsed = gx::optimizeVertexFetchRemap( remap.data(), indices.data(), indices.size(), numVertices );
+
+	CHECK( numUsed == positions.size() );
+	CHECK( remap.back() == ~0u );
+	for( size_t i = 0; i < indices.size(); ++i ) {
+		REQUIRE( indices[i] == remap[original[i]] );
+	}
+	// the remapped triangles are the original ones renamed, and the new names appear in increasing order
+	uint32_t nextVertex = 0;
+	for( uint32_t index : indices ) {
+		REQUIRE( index <= nextVertex );
+		if( index == nextVertex ) {
+			++nextVertex;
+		}
+	}
+	CHECK( nextVertex == numUsed );
+	vector<bool> seen( numUsed, false );
+	for( size_t v = 0; v + 1 < numVertices; ++v ) {
+		REQUIRE( remap[v] < numUsed );
+		CHECK( ! seen[remap[v]] );
+		seen[remap[v]] = true;
+	}
+}
+
+TEST_CASE( "buildMeshlets respects the limits and covers every triangle" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makeSphere( 64, 32, &positions, &indices );
+	gx::optimizeVertexCache( indices.data(), indices.data(), indices.size(), positions.size() );
+
+	for( size_t maxVertices : { 64, 32 } ) {
+		for( size_t maxTriangles : { 124, 40 } ) {
+			const size_t bound = gx::buildMeshletsBound( indices.size(), maxVertices, maxTriangles );
+			vector<gx::Meshlet> meshlets( bound );
+			vector<uint32_t> meshletVertices( indices.size() );
+			vector<uint8_t> meshletTriangles( indices.size() );
+			const size_t numMeshlets = gx::buildMeshlets( meshlets.data(), meshletVertices.data(), meshletTriangles.data(), indices.data(), indices.size(), positions.size(), maxVertices, maxTriangles );
+
+			REQUIRE( numMeshlets > 0 );
+			REQUIRE( numMeshlets <= bound );
+			vector<uint32_t> rebuilt;
+			for( size_t m = 0; m < numMeshlets; ++m ) {
+				const gx::Meshlet &meshlet = meshlets[m];
+				CHECK( meshlet.numVertices > 0 );
+				CHECK( meshlet.numVertices <= maxVertices );
+				CHECK( meshlet.numTriangles > 0 );
+				CHECK( meshlet.numTriangles <= maxTriangles );
+				for( uint32_t i = 0; i < meshlet.numTriangles * 3; ++i ) {
+					const uint8_t local = meshletTriangles[meshlet.triangleOffset * 3 + i];
+					REQUIRE( local < meshlet.numVertices );
+					rebuilt.push_back( meshletVertices[meshlet.vertexOffset + local] );
+				}
+			}
+			// meshlets are built in index order
+			CHECK( rebuilt == indices );
+		}
+	}
+}
+
+TEST_CASE( "computeMeshletBounds contains the vertices and bounds the normals" )
+{
+	vector<vec3> positions;
+	vector<uint32_t> indices;
+	testmeshes::makeSphere( 64, 32, &positions, &indices );
+	gx::optimizeVertexCache( indices.data(), indices.data(), indices.size(), positions.size() );
+
+	vector<gx::Meshlet> meshlets( gx::buildMeshletsBound( indices.size() ) );
+	vector<uint32_t> meshletVertices( indices.size() );
+	vector<uint8_t> meshletTriangles( indices.size() );
+	const size_t numMeshlets = gx::buildMeshlets( meshlets.data(), meshletVertices.data(), meshletTriangles.data(), indices.data(), indices.size(), positions.size() );
+
+	mt19937 rng( 7 );
+	uniform_real_distribution<float> unit( -1.0f, 1.0f );
+	size_t numCones = 0;
+	for( size_t m = 0; m < numMeshlets; ++m ) {
+		const gx::Meshlet &meshlet = meshlets[m];
+		const gx::MeshletBounds bounds = gx::computeMeshletBounds( meshlet, meshletVertices.data(), meshletTriangles.data(), positions.data() );
+		for( uint32_t v = 0; v < meshlet.numVertices; ++v ) {
+			CHECK( glm::distance( positions[meshletVertices[meshlet.vertexOffset + v]], bounds.center ) <= bounds.radius * 1.0001f + 1e-6f );
+		}
+		CHECK( std::abs( glm::length( bounds.coneAxis ) - 1.0f ) < 1e-4f );
+		CHECK( bounds.coneCutoff <= 1.0f );
+		if( bounds.coneCutoff >= 1.0f ) {
+			continue;
+		}
+		++numCones;
+
+		// every normal lies within the cone, and every viewer passing the culling test sees every triangle from behind
+		const float minCos = std::sqrt( 1.0f - bounds.coneCutoff * bounds.coneCutoff );
+		const uint8_t* triangles = meshletTriangles.data() + meshlet.triangleOffset * 3;
+		const uint32_t* vertices = meshletVertices.data() + meshlet.vertexOffset;
+		for( uint32_t t = 0; t < meshlet.numTriangles; ++t ) {
+			const vec3 &p0 = positions[vertices[triangles[t * 3]]];
+			const vec3 normal = glm::cross( positions[vertices[triangles[t * 3 + 1]]] - p0, positions[vertices[triangles[t * 3 + 2]]] - p0 );
+			if( glm::length( normal ) > 0.0f ) {
+				CHECK( glm::dot( glm::normalize( normal ), bounds.coneAxis ) >= minCos - 1e-4f );
+			}
+		}
+		for( int sample = 0; sample < 64; ++sample ) {
+			const vec3 viewer = bounds.center + vec3( unit( rng ), unit( rng ), unit( rng ) ) * 4.0f;
+			const vec3 toCenter = bounds.center - viewer;
+			if( glm::dot( toCenter, bounds.coneAxis ) < bounds.coneCutoff * glm::length( toCenter ) + bounds.radius ) {
+				continue;
+			}
+			for( uint32_t t = 0; t < meshlet.numTriangles; ++t ) {
+				const vec3 &p0 = positions[vertices[triangles[t * 3]]];
+				const vec3 normal = glm::cross( positions[vertices[triangles[t * 3 + 1]]] - p0, positions[vertices[triangles[t * 3 + 2]]] - p0 );
+				CHECK( glm::dot( p0 - viewer, normal ) >= -1e-5f );
+			}
+		}
+	}
+	// a finely tessellated sphere has plenty of cullable meshlets
+	CHECK( numCones > numMeshlets / 2 );
+}
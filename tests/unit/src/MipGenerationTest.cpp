@@ -0,0 +1,227 @@
+#include "cinder/graphics/Texture.h"
+
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	//! Odd, non power of two and degenerate sizes, so that both the SIMD bodies and the clamped tails are exercised
+	const uint32_t kSizes[][2] = { { 1, 1 }, { 1, 7 }, { 7, 1 }, { 2, 2 }, { 3, 3 }, { 5, 9 }, { 17, 33 }, { 37, 13 }, { 64, 64 }, { 255, 3 }, { 129, 129 } };
+
+	//! Source level with padded rows filled with random values of type T
+	template<typename T>
+	struct Level {
+		Level( uint32_t width, uint32_t height, uint32_t numComponents, mt19937 &rng )
+			: width( width ), height( height ), stride( ( width * numComponents * sizeof( T ) + 3 ) / 4 * 4 + 8 ), data( size_t{ stride } * height )
+		{
+			for( uint32_t y = 0; y < height; ++y ) {
+				T* row = getRow( y );
+				for( uint32_t i = 0; i < width * numComponents; ++i ) {
+					if constexpr( is_floating_point<T>::value ) {
+						row[i] = uniform_real_distribution<float>( -4.0f, 4.0f )( rng );
+					}
+					else {
+						row[i] = static_cast<T>( rng() );
+					}
+				}
+			}
+		}
+
+		T*			getRow( uint32_t y ) { return reinterpret_cast<T*>( data.data() + size_t{ y } * stride ); }
+		const T*	getRow( uint32_t y ) const { return reinterpret_cast<const T*>( data.data() + size_t{ y } * stride ); }
+
+		uint32_t				width, height, stride;
+		vector<uint8_t>			data;
+	};
+
+	//! Scalar 2x2 box filter reference. Odd sizes clamp the last column and row.
+	template<typename T>
+	vector<T> boxFilterReference( const Level<T> &src, uint32_t numComponents )
+	{
+		const uint32_t dstWidth = max( src.width / 2, 1u ), dstHeight = max( src.height / 2, 1u );
+		vector<T> dst( size_t{ dstWidth } * dstHeight * numComponents );
+		for( uint32_t y = 0; y < dstHeight; ++y ) {
+			const T* row0 = src.getRow( min( 2 * y, src.height - 1 ) );
+			const T* row1 = src.getRow( min( 2 * y + 1, src.height - 1 ) );
+			for( uint32_t x = 0; x < dstWidth; ++x ) {
+				const uint32_t x0 = min( 2 * x, src.width - 1 ), x1 = min( 2 * x + 1, src.width - 1 );
+				for( uint32_t c = 0; c < numComponents; ++c ) {
+					const T a = row0[x0 * numComponents + c], b = row0[x1 * numComponents + c], d = row1[x0 * numComponents + c], e = row1[x1 * numComponents + c];
+					T value;
+					if constexpr( is_floating_point<T>::value ) {
+						value = ( a + b + d + e ) * 0.25f;
+					}
+					else {
+						value = static_cast<T>( ( uint32_t( a ) + b + d + e + 2 ) / 4 );
+					}
+					dst[( size_t{ y } * dstWidth + x ) * numComponents + c] = value;
+				}
+			}
+		}
+		return dst;
+	}
+
+	double srgbToLinear( uint8_t value )
+	{
+		const double srgb = value / 255.0;
+		return srgb <= 0.04045 ? srgb / 12.92 : pow( ( srgb + 0.055 ) / 1.055, 2.4 );
+	}
+
+	uint8_t linearToSrgb( double linear )
+	{
+		const double srgb = linear <= 0.0031308 ? linear * 12.92 : 1.055 * pow( linear, 1.0 / 2.4 ) - 0.055;
+		return static_cast<uint8_t>( std::clamp( srgb, 0.0, 1.0 ) * 255.0 + 0.5 );
+	}
+
+	//! Runs generateMipLevel on \a src into a padded destination and returns the tightly packed result
+	template<typename T>
+	vector<T> generate( const Level<T> &src, uint32_t numComponents, gx::TEXTURE_FORMAT format, gx::TextureDesc::MipFilter filter = gx::TextureDesc::MipFilter::BOX, bool* success = nullptr )
+	{
+		const uint32_t dstWidth = max( src.width / 2, 1u ), dstHeight = max( src.height / 2, 1u );
+		const uint32_t dstStride = dstWidth * numComponents * sizeof( T ) + 12;
+		vector<uint8_t> dst( size_t{ dstStride } * dstHeight, 0xCD );
+		bool result = gx::generateMipLevel( src.data.data(), src.stride, src.width, src.height, dst.data(), dstStride, format, filter );
+
+		vector<T> packed( size_t{ dstWidth } * dstHeight * numComponents );
+		for( uint32_t y = 0; y < dstHeight; ++y ) {
+			memcpy( packed.data() + size_t{ y } * dstWidth * numComponents, dst.data() + size_t{ y } * dstStride, dstWidth * numComponents * sizeof( T ) );
+			// the row padding must be left untouched
+			for( uint32_t i = dstWidth * numComponents * sizeof( T ); i < dstStride; ++i ) {
+				result = result && dst[size_t{ y } * dstStride + i] == 0xCD;
+			}
+		}
+		if( success ) {
+			*success = result;
+		}
+		return packed;
+	}
+
+	template<typename T>
+	void checkBoxFilter( gx::TEXTURE_FORMAT format, uint32_t numComponents, mt19937 &rng )
+	{
+		for( const auto &size : kSizes ) {
+			const Level<T> src( size[0], size[1], numComponents, rng );
+			bool success = false;
+			const vector<T> result = generate( src, numComponents, format, gx::TextureDesc::MipFilter::BOX, &success );
+			const vector<T> expected = boxFilterReference( src, numComponents );
+			REQUIRE( success );
+			REQUIRE( result.size() == expected.size() );
+			for( size_t i = 0; i < result.size(); ++i ) {
+				if constexpr( is_floating_point<T>::value ) {
+					// the SIMD path sums the column pairs first, which only changes the rounding
+					REQUIRE( std::abs( result[i] - expected[i] ) <= 1e-5f );
+				}
+				else {
+					REQUIRE( result[i] == expected[i] );
+				}
+			}
+		}
+	}
+} // anonymous namespace
+
+TEST_CASE( "box filter matches the scalar reference for 8-bit unorm" )
+{
+	mt19937 rng( 1 );
+	checkBoxFilter<uint8_t>( gx::TEX_FORMAT_R8_UNORM, 1, rng );
+	checkBoxFilter<uint8_t>( gx::TEX_FORMAT_RG8_UNORM, 2, rng );
+	checkBoxFilter<uint8_t>( gx::TEX_FORMAT_RGBA8_UNORM, 4, rng );
+}
+
+TEST_CASE( "box filter matches the scalar reference for 16-bit unorm" )
+{
+	mt19937 rng( 2 );
+	checkBoxFilter<uint16_t>( gx::TEX_FORMAT_R16_UNORM, 1, rng );
+	checkBoxFilter<uint16_t>( gx::TEX_FORMAT_RG16_UNORM, 2, rng );
+	checkBoxFilter<uint16_t>( gx::TEX_FORMAT_RGBA16_UNORM, 4, rng );
+}
+
+TEST_CASE( "box filter matches the scalar reference for 32-bit float" )
+{
+	mt19937 rng( 3 );
+	checkBoxFilter<float>( gx::TEX_FORMAT_R32_FLOAT, 1, rng );
+	checkBoxFilter<float>( gx::TEX_FORMAT_RG32_FLOAT, 2, rng );
+	checkBoxFilter<float>( gx::TEX_FORMAT_RGBA32_FLOAT, 4, rng );
+}
+
+TEST_CASE( "sRGB box filter averages in linear space" )
+{
+	mt19937 rng( 4 );
+	for( const auto &size : kSizes ) {
+		const Level<uint8_t> src( size[0], size[1], 4, rng );
+		bool success = false;
+		const vector<uint8_t> result = generate( src, 4, gx::TEX_FORMAT_RGBA8_UNORM_SRGB, gx::TextureDesc::MipFilter::BOX, &success );
+		REQUIRE( success );
+
+		const uint32_t dstWidth = max( src.width / 2, 1u ), dstHeight = max( src.height / 2, 1u );
+		for( uint32_t y = 0; y < dstHeight; ++y ) {
+			const uint8_t* row0 = src.getRow( min( 2 * y, src.height - 1 ) );
+			const uint8_t* row1 = src.getRow( min( 2 * y + 1, src.height - 1 ) );
+			for( uint32_t x = 0; x < dstWidth; ++x ) {
+				const uint32_t x0 = min( 2 * x, src.width - 1 ) * 4, x1 = min( 2 * x + 1, src.width - 1 ) * 4;
+				const uint8_t* texel = &result[( size_t{ y } * dstWidth + x ) * 4];
+				// the tables quantize the linear values to 16 bits, which can round the result by one step
+				for( uint32_t c = 0; c < 3; ++c ) {
+					const double linear = ( srgbToLinear( row0[x0 + c] ) + srgbToLinear( row0[x1 + c] ) + srgbToLinear( row1[x0 + c] ) + srgbToLinear( row1[x1 + c] ) ) * 0.25;
+					REQUIRE( std::abs( int( texel[c] ) - int( linearToSrgb( linear ) ) ) <= 1 );
+				}
+				// alpha is linear
+				REQUIRE( texel[3] == ( uint32_t( row0[x0 + 3] ) + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3] + 2 ) / 4 );
+			}
+		}
+	}
+
+	// a linear average of black and white is much brighter than the sRGB average
+	Level<uint8_t> checker( 2, 2, 4, rng );
+	for( uint32_t y = 0; y < 2; ++y ) {
+		for( uint32_t x = 0; x < 2; ++x ) {
+			fill( checker.getRow( y ) + x * 4, checker.getRow( y ) + x * 4 + 4, ( x + y ) % 2 ? 255 : 0 );
+		}
+	}
+	const vector<uint8_t> gray = generate( checker, 4, gx::TEX_FORMAT_RGBA8_UNORM_SRGB );
+	CHECK( std::abs( int( gray[0] ) - 188 ) <= 1 );
+	CHECK( gray[3] == 128 );
+}
+
+TEST_CASE( "windowed sinc filters preserve constant levels" )
+{
+	mt19937 rng( 5 );
+	for( auto filter : { gx::TextureDesc::MipFilter::KAISER, gx::TextureDesc::MipFilter::LANCZOS } ) {
+		for( const auto &size : kSizes ) {
+			Level<uint8_t> src( size[0], size[1], 4, rng );
+			for( uint32_t y = 0; y < src.height; ++y ) {
+				for( uint32_t x = 0; x < src.width; ++x ) {
+					uint8_t* texel = src.getRow( y ) + x * 4;
+					texel[0] = 10;
+					texel[1] = 128;
+					texel[2] = 250;
+					texel[3] = 77;
+				}
+			}
+			for( auto format : { gx::TEX_FORMAT_RGBA8_UNORM, gx::TEX_FORMAT_RGBA8_UNORM_SRGB } ) {
+				bool success = false;
+				const vector<uint8_t> result = generate( src, 4, format, filter, &success );
+				REQUIRE( success );
+				for( size_t i = 0; i < result.size(); i += 4 ) {
+					REQUIRE( std::abs( int( result[i] ) - 10 ) <= 1 );
+					REQUIRE( std::abs( int( result[i + 1] ) - 128 ) <= 1 );
+					REQUIRE( std::abs( int( result[i + 2] ) - 250 ) <= 1 );
+					REQUIRE( std::abs( int( result[i + 3] ) - 77 ) <= 1 );
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE( "generateMipLevel rejects unsupported formats" )
+{
+	vector<uint8_t> src( 64 ), dst( 16 );
+	CHECK( ! gx::generateMipLevel( src.data(), 16, 4, 4, dst.data(), 8, gx::TEX_FORMAT_BC1_UNORM ) );
+	CHECK( ! gx::generateMipLevel( src.data(), 16, 4, 4, dst.data(), 8, gx::TEX_FORMAT_RGBA8_UINT ) );
+}
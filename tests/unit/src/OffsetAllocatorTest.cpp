@@ -0,0 +1,171 @@
+#include "cinder/graphics/MeshPool.h"
+
+#include "UnitTest.h"
+
+#include <random>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+TEST_CASE( "OffsetAllocator allocates and releases a round trip" )
+{
+	gx::OffsetAllocator allocator( 1000 );
+	CHECK( allocator.getSize() == 1000 );
+	CHECK( allocator.getNumFree() == 1000 );
+	CHECK( allocator.getLargestFreeRange() == 1000 );
+
+	const uint32_t offset = allocator.allocate( 100 );
+	CHECK( offset == 0 );
+	CHECK( allocator.getNumFree() == 900 );
+	CHECK( allocator.getLargestFreeRange() == 900 );
+
+	allocator.release( offset, 100 );
+	CHECK( allocator.getNumFree() == 1000 );
+	CHECK( allocator.getLargestFreeRange() == 1000 );
+
+	// empty allocations don't consume anything
+	CHECK( allocator.allocate( 0 ) == 0 );
+	allocator.release( 0, 0 );
+	CHECK( allocator.getNumFree() == 1000 );
+}
+
+TEST_CASE( "OffsetAllocator fails when no range is large enough" )
+{
+	gx::OffsetAllocator empty;
+	CHECK( empty.allocate( 1 ) == gx::OffsetAllocator::INVALID_OFFSET );
+
+	gx::OffsetAllocator allocator( 100 );
+	CHECK( allocator.allocate( 101 ) == gx::OffsetAllocator::INVALID_OFFSET );
+	CHECK( allocator.allocate( 100 ) == 0 );
+	CHECK( allocator.getNumFree() == 0 );
+	CHECK( allocator.allocate( 1 ) == gx::OffsetAllocator::INVALID_OFFSET );
+}
+
+TEST_CASE( "OffsetAllocator reuses the smallest released range that fits" )
+{
+	gx::OffsetAllocator allocator( 1000 );
+	const uint32_t a = allocator.allocate( 100 );
+	const uint32_t b = allocator.allocate( 100 );
+	const uint32_t c = allocator.allocate( 200 );
+	const uint32_t d = allocator.allocate( 100 );
+	CHECK( a == 0 );
+	CHECK( b == 100 );
+	CHECK( c == 200 );
+	CHECK( d == 400 );
+
+	// the 100 units hole is preferred to the 500 units tail
+	allocator.release( b, 100 );
+	CHECK( allocator.allocate( 100 ) == b );
+	allocator.release( b, 100 );
+	CHECK( allocator.allocate( 60 ) == b );
+	CHECK( allocator.allocate( 40 ) == b + 60 );
+
+	// among equal sizes the lowest offset wins
+	allocator.release( a, 100 );
+	allocator.release( d, 100 );
+	CHECK( allocator.allocate( 100 ) == a );
+	CHECK( allocator.allocate( 100 ) == d );
+}
+
+TEST_CASE( "OffsetAllocator fragments and merges released ranges" )
+{
+	gx::OffsetAllocator allocator( 1000 );
+	vector<uint32_t> offsets;
+	for( int i = 0; i < 10; ++i ) {
+		offsets.push_back( allocator.allocate( 100 ) );
+	}
+	CHECK( allocator.getNumFree() == 0 );
+
+	// every other block released, 500 free units but no range larger than 100
+	for( size_t i = 0; i < offsets.size(); i += 2 ) {
+		allocator.release( offsets[i], 100 );
+	}
+	CHECK( allocator.getNumFree() == 500 );
+	CHECK( allocator.getLargestFreeRange() == 100 );
+	CHECK( allocator.allocate( 200 ) == gx::OffsetAllocator::INVALID_OFFSET );
+
+	// releasing a block between two free ranges merges the three of them
+	allocator.release( offsets[1], 100 );
+	CHECK( allocator.getLargestFreeRange() == 300 );
+	CHECK( allocator.allocate( 300 ) == 0 );
+	allocator.release( 0, 300 );
+	for( size_t i = 3; i < offsets.size(); i += 2 ) {
+		allocator.release( offsets[i], 100 );
+	}
+	CHECK( allocator.getNumFree() == 1000 );
+	CHECK( allocator.getLargestFreeRange() == 1000 );
+	CHECK( allocator.allocate( 1000 ) == 0 );
+}
+
+TEST_CASE( "OffsetAllocator merges with the next or the previous range alone" )
+{
+	gx::OffsetAllocator allocator( 400 );
+	const uint32_t a = allocator.allocate( 100 );
+	const uint32_t b = allocator.allocate( 100 );
+	const uint32_t c = allocator.allocate( 100 );
+	const uint32_t d = allocator.allocate( 100 );
+
+	allocator.release( c, 100 );
+	CHECK( allocator.getLargestFreeRange() == 100 );
+	// next only
+	allocator.release( b, 100 );
+	CHECK( allocator.getLargestFreeRange() == 200 );
+	CHECK( allocator.allocate( 200 ) == b );
+	allocator.release( b, 200 );
+	// previous only
+	allocator.release( d, 100 );
+	CHECK( allocator.getLargestFreeRange() == 300 );
+	CHECK( allocator.getNumFree() == 300 );
+	// next only, up to the start of the address space
+	allocator.release( a, 100 );
+	CHECK( allocator.getLargestFreeRange() == 400 );
+	CHECK( allocator.allocate( 400 ) == 0 );
+}
+
+TEST_CASE( "OffsetAllocator never hands out overlapping ranges" )
+{
+	const uint32_t size = 4096;
+	gx::OffsetAllocator allocator( size );
+	vector<bool> used( size, false );
+	vector<pair<uint32_t, uint32_t>> allocations;
+	uint32_t numUsed = 0;
+
+	mt19937 rng( 1234 );
+	for( int step = 0; step < 10000; ++step ) {
+		if( allocations.empty() || rng() % 3 != 0 ) {
+			const uint32_t allocationSize = 1 + rng() % 64;
+			const uint32_t offset = allocator.allocate( allocationSize );
+			if( offset == gx::OffsetAllocator::INVALID_OFFSET ) {
+				CHECK( allocator.getLargestFreeRange() < allocationSize );
+				continue;
+			}
+			REQUIRE( offset + allocationSize <= size );
+			for( uint32_t i = offset; i < offset + allocationSize; ++i ) {
+				REQUIRE( ! used[i] );
+				used[i] = true;
+			}
+			allocations.push_back( { offset, allocationSize } );
+			numUsed += allocationSize;
+		}
+		else {
+			const size_t index = rng() % allocations.size();
+			const auto allocation = allocations[index];
+			allocations[index] = allocations.back();
+			allocations.pop_back();
+			allocator.release( allocation.first, allocation.second );
+			for( uint32_t i = allocation.first; i < allocation.first + allocation.second; ++i ) {
+				used[i] = false;
+			}
+			numUsed -= allocation.second;
+		}
+		REQUIRE( allocator.getNumFree() == size - numUsed );
+	}
+
+	// once everything is released the free ranges have merged back into one
+	for( const auto &allocation : allocations ) {
+		allocator.release( allocation.first, allocation.second );
+	}
+	CHECK( allocator.getNumFree() == size );
+	CHECK( allocator.getLargestFreeRange() == size );
+}
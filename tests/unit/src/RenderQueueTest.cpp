@@ -0,0 +1,99 @@
+#include "cinder/graphics/RenderQueue.h"
+
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+	using SortItem = gx::RenderQueue::SortItem;
+
+	//! Items whose index is their position, so that stability can be checked on the output
+	vector<SortItem> makeItems( const vector<uint64_t> &keys )
+	{
+		vector<SortItem> items;
+		for( size_t i = 0; i < keys.size(); ++i ) {
+			items.push_back( { keys[i], static_cast<uint32_t>( i ) } );
+		}
+		return items;
+	}
+
+	bool matchesStableSort( const vector<uint64_t> &keys )
+	{
+		vector<SortItem> items = makeItems( keys );
+		vector<SortItem> expected = items;
+		stable_sort( expected.begin(), expected.end(), []( const SortItem &a, const SortItem &b ) { return a.key < b.key; } );
+
+		vector<SortItem> scratch;
+		gx::RenderQueue::radixSort( items, scratch );
+		return equal( items.begin(), items.end(), expected.begin(), expected.end(), []( const SortItem &a, const SortItem &b ) { return a.key == b.key && a.index == b.index; } );
+	}
+} // anonymous namespace
+
+TEST_CASE( "radixSort sorts random keys" )
+{
+	mt19937_64 rng( 99 );
+	for( size_t count : { 2, 3, 17, 256, 1000, 65536 } ) {
+		vector<uint64_t> keys( count );
+		for( uint64_t &key : keys ) {
+			key = rng();
+		}
+		CHECK( matchesStableSort( keys ) );
+	}
+}
+
+TEST_CASE( "radixSort keeps the order of equal keys" )
+{
+	// few distinct keys spread over the pipeline, resource, mesh and depth bits, as RenderQueue builds them
+	mt19937_64 rng( 5 );
+	vector<uint64_t> keys( 5000 );
+	for( uint64_t &key : keys ) {
+		key = ( rng() % 3 ) << 48 | ( rng() % 4 ) << 32 | ( rng() % 2 ) << 16 | ( rng() % 5 );
+	}
+	CHECK( matchesStableSort( keys ) );
+
+	vector<SortItem> items = makeItems( keys );
+	vector<SortItem> scratch;
+	gx::RenderQueue::radixSort( items, scratch );
+	for( size_t i = 1; i < items.size(); ++i ) {
+		REQUIRE( items[i - 1].key <= items[i].key );
+		if( items[i - 1].key == items[i].key ) {
+			REQUIRE( items[i - 1].index < items[i].index );
+		}
+	}
+}
+
+TEST_CASE( "radixSort handles skipped and odd numbers of passes" )
+{
+	// identical keys skip every pass and leave the items untouched
+	CHECK( matchesStableSort( vector<uint64_t>( 100, 0x0123456789ABCDEFull ) ) );
+	// a single differing digit sorts in one pass, the result lives in the scratch buffer until swapped back
+	CHECK( matchesStableSort( { 5, 3, 9, 3, 1, 0xFF, 0 } ) );
+	// three differing digits
+	CHECK( matchesStableSort( { 0x010000, 0x000100, 0x000001, 0x010101, 0, 0x000100 } ) );
+	// only the top digit differs
+	CHECK( matchesStableSort( { 0xFF00000000000000ull, 0x0100000000000000ull, 0, 0xFF00000000000000ull } ) );
+	// descending keys
+	vector<uint64_t> descending( 300 );
+	for( size_t i = 0; i < descending.size(); ++i ) {
+		descending[i] = ( descending.size() - i ) * 0x0101010101ull;
+	}
+	CHECK( matchesStableSort( descending ) );
+}
+
+TEST_CASE( "radixSort leaves empty and single item lists untouched" )
+{
+	vector<SortItem> items, scratch;
+	gx::RenderQueue::radixSort( items, scratch );
+	CHECK( items.empty() );
+
+	items.push_back( { 42, 7 } );
+	gx::RenderQueue::radixSort( items, scratch );
+	REQUIRE( items.size() == 1 );
+	CHECK( items[0].key == 42 );
+	CHECK( items[0].index == 7 );
+}
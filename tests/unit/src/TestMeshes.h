@@ -0,0 +1,71 @@
+#pragma once
+
+#include "cinder/Vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+//! Procedural triangle lists shared by the mesh tests
+namespace testmeshes {
+
+//! Regular grid of \a width by \a height quads in the xy plane, two counter-clockwise triangles per quad
+inline void makePlane( uint32_t width, uint32_t height, std::vector<ci::vec3>* positions, std::vector<uint32_t>* indices )
+{
+	positions->clear();
+	indices->clear();
+	for( uint32_t y = 0; y <= height; ++y ) {
+		for( uint32_t x = 0; x <= width; ++x ) {
+			positions->push_back( ci::vec3( static_cast<float>( x ) / width, static_cast<float>( y ) / height, 0.0f ) );
+		}
+	}
+	for( uint32_t y = 0; y < height; ++y ) {
+		for( uint32_t x = 0; x < width; ++x ) {
+			const uint32_t a = y * ( width + 1 ) + x, b = a + 1, c = a + width + 1, d = c + 1;
+			indices->insert( indices->end(), { a, b, c, b, d, c } );
+		}
+	}
+}
+
+//! Unit sphere of \a numSegments by \a numRings quads, outward facing counter-clockwise triangles. The seam and pole vertices are duplicated.
+inline void makeSphere( uint32_t numSegments, uint32_t numRings, std::vector<ci::vec3>* positions, std::vector<uint32_t>* indices )
+{
+	const float pi = 3.14159265358979f;
+	positions->clear();
+	indices->clear();
+	for( uint32_t ring = 0; ring <= numRings; ++ring ) {
+		const float theta = ring * pi / numRings;
+		for( uint32_t segment = 0; segment <= numSegments; ++segment ) {
+			const float phi = segment * 2.0f * pi / numSegments;
+			positions->push_back( ci::vec3( std::sin( theta ) * std::cos( phi ), std::cos( theta ), std::sin( theta ) * std::sin( phi ) ) );
+		}
+	}
+	for( uint32_t ring = 0; ring < numRings; ++ring ) {
+		for( uint32_t segment = 0; segment < numSegments; ++segment ) {
+			const uint32_t a = ring * ( numSegments + 1 ) + segment, b = a + 1, c = a + numSegments + 1, d = c + 1;
+			indices->insert( indices->end(), { a, b, c, b, d, c } );
+		}
+	}
+}
+
+//! Returns the triangles of \a indices in their lexicographically smallest rotation, which keeps their winding, and sorted
+template<typename T>
+std::vector<std::vector<uint32_t>> getTriangleSet( const T* indices, size_t numIndices )
+{
+	std::vector<std::vector<uint32_t>> triangles;
+	for( size_t i = 0; i + 2 < numIndices; i += 3 ) {
+		const std::vector<uint32_t> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+		std::vector<uint32_t> smallest = triangle;
+		for( size_t r = 1; r < 3; ++r ) {
+			std::vector<uint32_t> rotated = triangle;
+			std::rotate( rotated.begin(), rotated.begin() + r, rotated.end() );
+			smallest = std::min( smallest, rotated );
+		}
+		triangles.push_back( smallest );
+	}
+	std::sort( triangles.begin(), triangles.end() );
+	return triangles;
+}
+
+} // namespace testmeshes
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+//! Minimal test harness: TEST_CASE registers a function, CHECK records failures without stopping the test and REQUIRE returns from it
+namespace unittest {
+
+struct TestCase {
+	const char*	name;
+	void		( *fn )();
+};
+
+inline std::vector<TestCase>& getTestCases()
+{
+	static std::vector<TestCase> sTestCases;
+	return sTestCases;
+}
+
+inline int& getNumFailures()
+{
+	static int sNumFailures = 0;
+	return sNumFailures;
+}
+
+struct Registrar {
+	Registrar( const char* name, void ( *fn )() ) { getTestCases().push_back( { name, fn } ); }
+};
+
+inline bool check( bool result, const char* expression, const char* file, int line )
+{
+	if( ! result ) {
+		std::fprintf( stderr, "%s(%d): CHECK( %s ) failed\n", file, line, expression );
+		++getNumFailures();
+	}
+	return result;
+}
+
+//! Runs every registered test case and returns the number of failed checks
+inline int runAll()
+{
+	for( const TestCase &testCase : getTestCases() ) {
+		const int numFailures = getNumFailures();
+		testCase.fn();
+		std::printf( "%s %s\n", getNumFailures() == numFailures ? "[passed]" : "[FAILED]", testCase.name );
+	}
+	return getNumFailures();
+}
+
+} // namespace unittest
+
+#define UNITTEST_CONCAT_IMPL( a, b ) a##b
+#define UNITTEST_CONCAT( a, b ) UNITTEST_CONCAT_IMPL( a, b )
+
+#define TEST_CASE( name ) \
+	static void UNITTEST_CONCAT( testCase, __LINE__ )(); \
+	static unittest::Registrar UNITTEST_CONCAT( testRegistrar, __LINE__ )( name, &UNITTEST_CONCAT( testCase, __LINE__ ) ); \
+	static void UNITTEST_CONCAT( testCase, __LINE__ )()
+
+#define CHECK( expression ) unittest::check( static_cast<bool>( expression ), #expression, __FILE__, __LINE__ )
+#define REQUIRE( expression ) do { if( ! CHECK( expression ) ) return; } while( false )
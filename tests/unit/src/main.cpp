@@ -0,0 +1,6 @@
+#include "UnitTest.h"
+
+int main()
+{
+	return unittest::runAll() == 0 ? 0 : 1;
+}